@@ -0,0 +1,1373 @@
+#include "Aggregate.hpp"
+#include "Decimal.hpp"
+#include "Hash.hpp"
+#include "Numeric.hpp"
+#include "Parallel.hpp"
+#include "Spill.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    typedef kinetica::ProcData::Column Column;
+    typedef kinetica::ProcData::OutputColumn OutputColumn;
+
+    const uint32_t NO_GROUP = 0xffffffff;
+
+    // Distance in rows at which hash table slots are prefetched
+    const std::size_t PREFETCH_DISTANCE = 16;
+
+    // Fewest rows aggregated per run before spilling
+    const std::size_t MIN_RUN_SIZE = 4096;
+
+    // Most partitions partial groups are spilled to
+    const std::size_t MAX_SPILL_PARTITIONS = 256;
+
+    //--------------------------------------------------------------------------
+    // Keys
+    //--------------------------------------------------------------------------
+
+    // Single fixed-width keys of up to 8 bytes are normalized into a 64-bit
+    // integer and UUID/CHAR16 keys into two; all other keys (wide CharN,
+    // STRING, BYTES and multi-column keys) are compared row against row.
+    enum KeyKind
+    {
+        KEY_64,
+        KEY_128,
+        KEY_ROWS
+    };
+
+    struct Key128
+    {
+        uint64_t low;
+        uint64_t high;
+
+        bool operator ==(const Key128& value) const
+        {
+            return low == value.low && high == value.high;
+        }
+    };
+
+    inline uint64_t getFloatKey(const double value)
+    {
+        uint64_t bits;
+
+        if (value == 0)
+        {
+            return 0;
+        }
+        else if (value != value)
+        {
+            return 0x7ff8000000000000;
+        }
+
+        std::memcpy(&bits, &value, 8);
+        return bits;
+    }
+
+    template<typename T>
+    inline uint64_t getKey(const T& value) { return (uint64_t)(int64_t)value; }
+
+    inline uint64_t getKey(const uint32_t value) { return value; }
+    inline uint64_t getKey(const uint64_t value) { return value; }
+    inline uint64_t getKey(const float value) { return getFloatKey(value); }
+    inline uint64_t getKey(const double value) { return getFloatKey(value); }
+    inline uint64_t getKey(const kinetica::Date& value) { return (uint64_t)(int64_t)(value.raw & ~0xfff); }
+    inline uint64_t getKey(const kinetica::DateTime& value) { return (uint64_t)(value.raw & ~(int64_t)0x1ffff); }
+    inline uint64_t getKey(const kinetica::Time& value) { return value.raw & ~0xf; }
+    inline uint64_t getKey(const kinetica::CharN<1>& value) { return value.buffer; }
+    inline uint64_t getKey(const kinetica::CharN<2>& value) { return value.buffer; }
+    inline uint64_t getKey(const kinetica::CharN<4>& value) { return value.buffer; }
+    inline uint64_t getKey(const kinetica::CharN<8>& value) { return value.buffer; }
+
+    template<typename T>
+    void loadKeys(const Column& column, const std::size_t start, const std::size_t count, uint64_t* keys, uint64_t* hashes)
+    {
+        const T* values = column.getData<T>() + start;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            keys[i] = getKey(values[i]);
+            hashes[i] = kinetica::mixHash(keys[i]);
+        }
+    }
+
+    void loadKeys(const Column& column, const std::size_t start, const std::size_t count, uint64_t* keys, uint64_t* hashes)
+    {
+        switch (column.getType())
+        {
+            case Column::BOOLEAN:
+            case Column::INT8: loadKeys<int8_t>(column, start, count, keys, hashes); break;
+            case Column::CHAR1: loadKeys<kinetica::CharN<1> >(column, start, count, keys, hashes); break;
+            case Column::CHAR2: loadKeys<kinetica::CharN<2> >(column, start, count, keys, hashes); break;
+            case Column::CHAR4: loadKeys<kinetica::CharN<4> >(column, start, count, keys, hashes); break;
+            case Column::CHAR8: loadKeys<kinetica::CharN<8> >(column, start, count, keys, hashes); break;
+            case Column::DATE: loadKeys<kinetica::Date>(column, start, count, keys, hashes); break;
+            case Column::DATETIME: loadKeys<kinetica::DateTime>(column, start, count, keys, hashes); break;
+            case Column::DECIMAL:
+            case Column::LONG:
+            case Column::TIMESTAMP: loadKeys<int64_t>(column, start, count, keys, hashes); break;
+            case Column::DOUBLE: loadKeys<double>(column, start, count, keys, hashes); break;
+            case Column::FLOAT: loadKeys<float>(column, start, count, keys, hashes); break;
+            case Column::INT: loadKeys<int32_t>(column, start, count, keys, hashes); break;
+            case Column::INT16: loadKeys<int16_t>(column, start, count, keys, hashes); break;
+            case Column::IPV4: loadKeys<uint32_t>(column, start, count, keys, hashes); break;
+            case Column::TIME: loadKeys<kinetica::Time>(column, start, count, keys, hashes); break;
+            case Column::ULONG: loadKeys<uint64_t>(column, start, count, keys, hashes); break;
+            default: throw std::runtime_error("Invalid data type");
+        }
+    }
+
+    void loadKeys(const Column& column, const std::size_t start, const std::size_t count, Key128* keys, uint64_t* hashes)
+    {
+        const uint8_t* values = column.getData<uint8_t>() + start * 16;
+
+        for (std::size_t i = 0; i < count; ++i, values += 16)
+        {
+            std::memcpy(&keys[i].low, values, 8);
+            std::memcpy(&keys[i].high, values + 8, 8);
+            hashes[i] = kinetica::combineHashes(kinetica::mixHash(keys[i].high), keys[i].low);
+        }
+    }
+
+    KeyKind getKeyKind(const std::vector<const Column*>& columns)
+    {
+        if (columns.size() != 1)
+        {
+            return KEY_ROWS;
+        }
+
+        switch (columns[0]->getType())
+        {
+            case Column::BYTES:
+            case Column::STRING:
+            case Column::CHAR32:
+            case Column::CHAR64:
+            case Column::CHAR128:
+            case Column::CHAR256: return KEY_ROWS;
+            case Column::CHAR16:
+            case Column::UUID: return KEY_128;
+            default: return KEY_64;
+        }
+    }
+
+    // Compares the keys of two rows with the same semantics as the hashes
+    class RowEqual
+    {
+    public:
+        RowEqual(const std::vector<const Column*>& columns) :
+            m_columns(columns)
+        {
+        }
+
+        bool operator ()(const std::size_t a, const std::size_t b) const
+        {
+            for (std::size_t i = 0; i < m_columns.size(); ++i)
+            {
+                const Column& column = *m_columns[i];
+
+                if (column.isNullable())
+                {
+                    bool isNull = column.getNulls()[a] != 0;
+
+                    if (isNull != (column.getNulls()[b] != 0))
+                    {
+                        return false;
+                    }
+                    else if (isNull)
+                    {
+                        continue;
+                    }
+                }
+
+                if (!equals(column, a, b))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+    private:
+        const std::vector<const Column*>& m_columns;
+
+        static bool equals(const Column& column, const std::size_t a, const std::size_t b)
+        {
+            switch (column.getType())
+            {
+                case Column::BYTES:
+                case Column::STRING:
+                {
+                    std::size_t size = column.getVarValueSize<uint8_t>(a);
+                    return size == column.getVarValueSize<uint8_t>(b)
+                           && std::memcmp(column.getVarValue<uint8_t>(a), column.getVarValue<uint8_t>(b), size) == 0;
+                }
+
+                case Column::DATE: return getKey(column.getValue<kinetica::Date>(a)) == getKey(column.getValue<kinetica::Date>(b));
+                case Column::DATETIME: return getKey(column.getValue<kinetica::DateTime>(a)) == getKey(column.getValue<kinetica::DateTime>(b));
+                case Column::TIME: return getKey(column.getValue<kinetica::Time>(a)) == getKey(column.getValue<kinetica::Time>(b));
+                case Column::DOUBLE: return getKey(column.getValue<double>(a)) == getKey(column.getValue<double>(b));
+                case Column::FLOAT: return getKey(column.getValue<float>(a)) == getKey(column.getValue<float>(b));
+
+                default:
+                {
+                    std::size_t size = Column::getTypeSize(column.getType());
+                    const uint8_t* data = column.getData<uint8_t>();
+                    return std::memcmp(data + a * size, data + b * size, size) == 0;
+                }
+            }
+        }
+    };
+
+    template<typename Key>
+    struct KeyEqual
+    {
+        bool operator ()(const Key& a, const Key& b) const
+        {
+            return a == b;
+        }
+    };
+
+    // Open-addressing (linear probing) map from keys to group numbers that
+    // doubles in size at half load
+    template<typename Key, typename Equal>
+    class GroupTable
+    {
+    public:
+        GroupTable(const Equal& equal) :
+            m_equal(equal),
+            m_count(0)
+        {
+            m_slots.resize(1024);
+            m_mask = m_slots.size() - 1;
+        }
+
+        void prefetch(const uint64_t hash) const
+        {
+            __builtin_prefetch(&m_slots[hash & m_mask]);
+        }
+
+        // Returns the group of key, assigning it group if it is not present
+        uint32_t insert(const uint64_t hash, const Key& key, const uint32_t group)
+        {
+            for (std::size_t i = hash & m_mask; ; i = (i + 1) & m_mask)
+            {
+                Slot& slot = m_slots[i];
+
+                if (slot.group == NO_GROUP)
+                {
+                    slot.hash = hash;
+                    slot.key = key;
+                    slot.group = group;
+
+                    if (++m_count * 2 > m_slots.size())
+                    {
+                        grow();
+                    }
+
+                    return group;
+                }
+
+                if (slot.hash == hash && m_equal(slot.key, key))
+                {
+                    return slot.group;
+                }
+            }
+        }
+
+    private:
+        struct Slot
+        {
+            uint64_t hash;
+            Key key;
+            uint32_t group;
+
+            Slot() :
+                group(NO_GROUP)
+            {
+            }
+        };
+
+        Equal m_equal;
+        std::vector<Slot> m_slots;
+        std::size_t m_mask;
+        std::size_t m_count;
+
+        void grow()
+        {
+            std::vector<Slot> slots(m_slots.size() * 2);
+            std::size_t mask = slots.size() - 1;
+
+            for (std::size_t i = 0; i < m_slots.size(); ++i)
+            {
+                if (m_slots[i].group != NO_GROUP)
+                {
+                    std::size_t j = m_slots[i].hash & mask;
+
+                    while (slots[j].group != NO_GROUP)
+                    {
+                        j = (j + 1) & mask;
+                    }
+
+                    slots[j] = m_slots[i];
+                }
+            }
+
+            m_slots.swap(slots);
+            m_mask = mask;
+        }
+    };
+
+    //--------------------------------------------------------------------------
+    // Aggregates
+    //--------------------------------------------------------------------------
+
+    enum Accumulator
+    {
+        INTEGER,
+        UNSIGNED,
+        REAL
+    };
+
+    struct AggregateInfo
+    {
+        kinetica::Aggregate::Function function;
+
+        // NULL for COUNT of all rows
+        const Column* column;
+
+        Accumulator accumulator;
+    };
+
+    // Per-group non-null value counts and sums or minimums/maximums; values
+    // with the UNSIGNED accumulator are stored in integers as uint64_t
+    struct AggregateState
+    {
+        std::vector<int64_t> counts;
+        std::vector<int64_t> integers;
+        std::vector<double> reals;
+    };
+
+    bool isOrdered(const Column::ColumnType type)
+    {
+        switch (type)
+        {
+            case Column::DATE:
+            case Column::DATETIME:
+            case Column::IPV4:
+            case Column::TIME: return true;
+            default: return kinetica::isNumeric(type);
+        }
+    }
+
+    template<typename A, typename T>
+    inline A load(const T& value) { return (A)value; }
+
+    template<typename A>
+    inline A load(const kinetica::Date& value) { return value.raw & ~0xfff; }
+
+    template<typename A>
+    inline A load(const kinetica::DateTime& value) { return value.raw & ~(int64_t)0x1ffff; }
+
+    template<typename A>
+    inline A load(const kinetica::Time& value) { return value.raw & ~0xf; }
+
+    template<typename T, typename A>
+    void accumulate(const AggregateInfo& info, const std::size_t* rows, const uint32_t* groups, const std::size_t count,
+                    A* values, int64_t* counts)
+    {
+        const T* data = info.column->getData<T>();
+        const uint8_t* nulls = info.column->isNullable() ? info.column->getNulls() : NULL;
+
+        switch (info.function)
+        {
+            case kinetica::Aggregate::SUM:
+            case kinetica::Aggregate::AVG:
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    if (nulls == NULL || !nulls[rows[i]])
+                    {
+                        values[groups[i]] = kinetica::add(values[groups[i]], load<A>(data[rows[i]]));
+                        counts[groups[i]]++;
+                    }
+                }
+
+                break;
+
+            case kinetica::Aggregate::MIN:
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    if (nulls == NULL || !nulls[rows[i]])
+                    {
+                        A value = load<A>(data[rows[i]]);
+
+                        if (counts[groups[i]]++ == 0 || value < values[groups[i]])
+                        {
+                            values[groups[i]] = value;
+                        }
+                    }
+                }
+
+                break;
+
+            case kinetica::Aggregate::MAX:
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    if (nulls == NULL || !nulls[rows[i]])
+                    {
+                        A value = load<A>(data[rows[i]]);
+
+                        if (counts[groups[i]]++ == 0 || value > values[groups[i]])
+                        {
+                            values[groups[i]] = value;
+                        }
+                    }
+                }
+
+                break;
+
+            default:
+                throw std::logic_error("Invalid aggregate function");
+        }
+    }
+
+    void accumulate(const AggregateInfo& info, const std::size_t* rows, const uint32_t* groups, const std::size_t count,
+                    AggregateState& state)
+    {
+        int64_t* counts = &state.counts[0];
+
+        if (info.function == kinetica::Aggregate::COUNT)
+        {
+            const uint8_t* nulls = info.column != NULL && info.column->isNullable() ? info.column->getNulls() : NULL;
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                counts[groups[i]] += nulls == NULL || !nulls[rows[i]];
+            }
+
+            return;
+        }
+
+        int64_t* integers = state.integers.empty() ? NULL : &state.integers[0];
+        uint64_t* unsignedIntegers = (uint64_t*)integers;
+        double* reals = state.reals.empty() ? NULL : &state.reals[0];
+
+        switch (info.column->getType())
+        {
+            case Column::BOOLEAN:
+            case Column::INT8: accumulate<int8_t>(info, rows, groups, count, integers, counts); break;
+            case Column::DATE: accumulate<kinetica::Date>(info, rows, groups, count, integers, counts); break;
+            case Column::DATETIME: accumulate<kinetica::DateTime>(info, rows, groups, count, integers, counts); break;
+            case Column::DECIMAL:
+            case Column::LONG:
+            case Column::TIMESTAMP: accumulate<int64_t>(info, rows, groups, count, integers, counts); break;
+            case Column::DOUBLE: accumulate<double>(info, rows, groups, count, reals, counts); break;
+            case Column::FLOAT: accumulate<float>(info, rows, groups, count, reals, counts); break;
+            case Column::INT: accumulate<int32_t>(info, rows, groups, count, integers, counts); break;
+            case Column::INT16: accumulate<int16_t>(info, rows, groups, count, integers, counts); break;
+            case Column::IPV4: accumulate<uint32_t>(info, rows, groups, count, integers, counts); break;
+            case Column::TIME: accumulate<kinetica::Time>(info, rows, groups, count, integers, counts); break;
+            case Column::ULONG: accumulate<uint64_t>(info, rows, groups, count, unsignedIntegers, counts); break;
+            default: throw std::runtime_error("Invalid data type");
+        }
+    }
+
+    void resizeState(const AggregateInfo& info, AggregateState& state, const std::size_t groupCount)
+    {
+        state.counts.resize(groupCount);
+
+        if (info.function != kinetica::Aggregate::COUNT)
+        {
+            state.integers.resize(info.accumulator == REAL ? 0 : groupCount);
+            state.reals.resize(info.accumulator == REAL ? groupCount : 0);
+        }
+    }
+
+    template<typename A>
+    inline void merge(const kinetica::Aggregate::Function function, A& target, const A source)
+    {
+        if (function == kinetica::Aggregate::MIN ? source < target : (function == kinetica::Aggregate::MAX ? source > target : false))
+        {
+            target = source;
+        }
+        else if (function == kinetica::Aggregate::SUM || function == kinetica::Aggregate::AVG)
+        {
+            target = kinetica::add(target, source);
+        }
+    }
+
+    // Value of a group as spilled: the bits of its integer or real
+    uint64_t getValue(const AggregateInfo& info, const AggregateState& state, const std::size_t group)
+    {
+        uint64_t value = 0;
+
+        if (info.function == kinetica::Aggregate::COUNT)
+        {
+            return 0;
+        }
+        else if (info.accumulator == REAL)
+        {
+            std::memcpy(&value, &state.reals[group], 8);
+            return value;
+        }
+
+        return (uint64_t)state.integers[group];
+    }
+
+    // Merges a group's count and value (as from getValue) into a group of
+    // target
+    void merge(const AggregateInfo& info, AggregateState& target, const std::size_t group, const int64_t count,
+               const uint64_t value)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        if (info.function != kinetica::Aggregate::COUNT)
+        {
+            if (info.accumulator == REAL)
+            {
+                double real;
+                std::memcpy(&real, &value, 8);
+
+                if (target.counts[group] == 0)
+                {
+                    target.reals[group] = real;
+                }
+                else
+                {
+                    merge(info.function, target.reals[group], real);
+                }
+            }
+            else if (target.counts[group] == 0)
+            {
+                target.integers[group] = (int64_t)value;
+            }
+            else if (info.accumulator == UNSIGNED)
+            {
+                merge(info.function, *(uint64_t*)&target.integers[group], value);
+            }
+            else
+            {
+                merge(info.function, target.integers[group], (int64_t)value);
+            }
+        }
+
+        target.counts[group] += count;
+    }
+
+    // Merges the first group of source into the first group of target
+    void merge(const AggregateInfo& info, AggregateState& target, const AggregateState& source)
+    {
+        merge(info, target, 0, source.counts[0], getValue(info, source, 0));
+    }
+
+    //--------------------------------------------------------------------------
+    // Output
+    //--------------------------------------------------------------------------
+
+    // Decimal places of the sums of an aggregate
+    unsigned getScale(const AggregateInfo& info)
+    {
+        return info.column != NULL && info.column->getType() == Column::DECIMAL ? kinetica::DECIMAL_SCALE : 0;
+    }
+
+    // Appends minimums or maximums to a column of the aggregated type
+    std::size_t writeOrdered(OutputColumn& column, const std::vector<int64_t>& integers, const std::vector<double>& reals,
+                             const unsigned scale)
+    {
+        std::size_t count = integers.size();
+        const int64_t* values = integers.empty() ? NULL : &integers[0];
+
+        switch (column.getType())
+        {
+            case Column::DATE:
+            {
+                std::size_t index = column.getPos();
+                kinetica::Date* data = column.appendValues<kinetica::Date>(count);
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    data[i].raw = (int32_t)values[i];
+                }
+
+                return index;
+            }
+
+            case Column::DATETIME:
+            {
+                std::size_t index = column.getPos();
+                kinetica::DateTime* data = column.appendValues<kinetica::DateTime>(count);
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    data[i].raw = values[i];
+                }
+
+                return index;
+            }
+
+            case Column::TIME:
+            {
+                std::size_t index = column.getPos();
+                kinetica::Time* data = column.appendValues<kinetica::Time>(count);
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    data[i].raw = (uint32_t)values[i];
+                }
+
+                return index;
+            }
+
+            case Column::IPV4:
+            {
+                std::size_t index = column.getPos();
+                uint32_t* data = column.appendValues<uint32_t>(count);
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    data[i] = (uint32_t)values[i];
+                }
+
+                return index;
+            }
+
+            case Column::DOUBLE:
+            case Column::FLOAT: return kinetica::appendNumbers(column, reals.empty() ? NULL : &reals[0], reals.size());
+            case Column::ULONG: return kinetica::appendNumbers(column, (const uint64_t*)values, count);
+            default: return kinetica::appendNumbers(column, values, count, scale);
+        }
+    }
+
+    void writeAggregate(OutputColumn& column, const AggregateInfo& info, const AggregateState& state)
+    {
+        std::size_t count = state.counts.size();
+        const int64_t* counts = count == 0 ? NULL : &state.counts[0];
+        unsigned scale = getScale(info);
+        std::size_t index;
+
+        switch (info.function)
+        {
+            case kinetica::Aggregate::COUNT:
+                kinetica::appendNumbers(column, counts, count);
+                return;
+
+            case kinetica::Aggregate::SUM:
+                if (info.accumulator == REAL)
+                {
+                    index = kinetica::appendNumbers(column, count == 0 ? NULL : &state.reals[0], count);
+                }
+                else if (info.accumulator == UNSIGNED)
+                {
+                    index = kinetica::appendNumbers(column, count == 0 ? NULL : (const uint64_t*)&state.integers[0], count);
+                }
+                else
+                {
+                    index = kinetica::appendNumbers(column, count == 0 ? NULL : &state.integers[0], count, scale);
+                }
+
+                break;
+
+            case kinetica::Aggregate::AVG:
+            {
+                std::vector<double> averages(count);
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    double sum = info.accumulator == REAL ? state.reals[i]
+                                 : (info.accumulator == UNSIGNED ? (double)(uint64_t)state.integers[i] : (double)state.integers[i]);
+                    averages[i] = counts[i] == 0 ? 0 : sum / counts[i];
+                }
+
+                index = kinetica::appendNumbers(column, count == 0 ? NULL : &averages[0], count, scale);
+                break;
+            }
+
+            default:
+                index = writeOrdered(column, state.integers, state.reals, scale);
+                break;
+        }
+
+        if (column.isNullable())
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                if (counts[i] == 0)
+                {
+                    column.setNull(index + i);
+                }
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Tasks
+    //--------------------------------------------------------------------------
+
+    struct Partition
+    {
+        std::size_t begin;
+        std::size_t end;
+
+        // First row of each group and the hash of its keys
+        std::vector<std::size_t> groupRows;
+        std::vector<uint64_t> groupHashes;
+
+        std::vector<AggregateState> states;
+    };
+
+    struct AggregateContext
+    {
+        std::vector<const Column*> keys;
+        KeyKind keyKind;
+        std::vector<AggregateInfo> aggregates;
+
+        // Rows being aggregated, from input row first on
+        std::size_t first;
+        std::size_t size;
+        std::size_t chunkCount;
+        std::size_t partitionBits;
+        std::vector<Partition> partitions;
+
+        // Per-row hashes and normalized keys in row order, then in partition
+        // order along with their row numbers
+        std::vector<uint64_t> hashes;
+        std::vector<uint64_t> keys64;
+        std::vector<Key128> keys128;
+        std::vector<uint64_t> partitionHashes;
+        std::vector<uint64_t> partitionKeys64;
+        std::vector<Key128> partitionKeys128;
+        std::vector<std::size_t> partitionRows;
+        std::vector<uint32_t> groups;
+
+        // Number of rows of each chunk in each partition, then the position
+        // in partition order of the chunk's first row in each partition
+        std::vector<std::size_t> counts;
+
+        inline std::size_t getPartition(const uint64_t hash) const
+        {
+            return partitionBits == 0 ? 0 : (std::size_t)(hash >> (64 - partitionBits));
+        }
+    };
+
+    class HashTask : public kinetica::ParallelTask
+    {
+    public:
+        HashTask(AggregateContext& context) :
+            m_context(context)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            AggregateContext& context = m_context;
+            std::size_t start = kinetica::getRangeStart(context.size, context.chunkCount, index);
+            std::size_t count = kinetica::getRangeStart(context.size, context.chunkCount, index + 1) - start;
+            if (count == 0)
+            {
+                return;
+            }
+
+            std::size_t row = context.first + start;
+            uint64_t* hashes = &context.hashes[start];
+
+            switch (context.keyKind)
+            {
+                case KEY_64:
+                    if (context.keys.empty())
+                    {
+                        // Spread rows over all partitions; their groups are
+                        // merged afterwards
+                        for (std::size_t i = 0; i < count; ++i)
+                        {
+                            context.keys64[start + i] = 0;
+                            hashes[i] = kinetica::mixHash(row + i);
+                        }
+                    }
+                    else
+                    {
+                        loadKeys(*context.keys[0], row, count, &context.keys64[start], hashes);
+                    }
+
+                    break;
+
+                case KEY_128:
+                    loadKeys(*context.keys[0], row, count, &context.keys128[start], hashes);
+                    break;
+
+                case KEY_ROWS:
+                    kinetica::hashColumn(*context.keys[0], row, count, hashes);
+
+                    for (std::size_t i = 1; i < context.keys.size(); ++i)
+                    {
+                        kinetica::combineColumnHashes(*context.keys[i], row, count, hashes);
+                    }
+
+                    break;
+            }
+
+            // Null single-column keys are grouped separately from the table
+            if (context.keyKind != KEY_ROWS && !context.keys.empty() && context.keys[0]->isNullable())
+            {
+                const uint8_t* nulls = context.keys[0]->getNulls() + row;
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    if (nulls[i])
+                    {
+                        hashes[i] = kinetica::NULL_HASH;
+                    }
+                }
+            }
+
+            std::size_t* counts = &context.counts[index << context.partitionBits];
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                counts[context.getPartition(hashes[i])]++;
+            }
+        }
+
+    private:
+        AggregateContext& m_context;
+    };
+
+    class ScatterTask : public kinetica::ParallelTask
+    {
+    public:
+        ScatterTask(AggregateContext& context) :
+            m_context(context)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            AggregateContext& context = m_context;
+            std::size_t start = kinetica::getRangeStart(context.size, context.chunkCount, index);
+            std::size_t end = kinetica::getRangeStart(context.size, context.chunkCount, index + 1);
+            std::size_t* positions = &context.counts[index << context.partitionBits];
+
+            for (std::size_t i = start; i < end; ++i)
+            {
+                std::size_t position = positions[context.getPartition(context.hashes[i])]++;
+                context.partitionRows[position] = context.first + i;
+                context.partitionHashes[position] = context.hashes[i];
+
+                if (context.keyKind == KEY_64)
+                {
+                    context.partitionKeys64[position] = context.keys64[i];
+                }
+                else if (context.keyKind == KEY_128)
+                {
+                    context.partitionKeys128[position] = context.keys128[i];
+                }
+            }
+        }
+
+    private:
+        AggregateContext& m_context;
+    };
+
+    class GroupTask : public kinetica::ParallelTask
+    {
+    public:
+        GroupTask(AggregateContext& context) :
+            m_context(context)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            AggregateContext& context = m_context;
+            Partition& partition = context.partitions[index];
+
+            if (context.keys.empty())
+            {
+                // All rows of the partition form a single group
+                if (partition.end > partition.begin)
+                {
+                    partition.groupRows.push_back(context.partitionRows[partition.begin]);
+                    partition.groupHashes.push_back(0);
+                    std::fill(context.groups.begin() + partition.begin, context.groups.begin() + partition.end, 0);
+                }
+            }
+            else
+            {
+                switch (context.keyKind)
+                {
+                    case KEY_64:
+                        group(partition, context.partitionKeys64.empty() ? NULL : &context.partitionKeys64[0], KeyEqual<uint64_t>());
+                        break;
+
+                    case KEY_128:
+                        group(partition, context.partitionKeys128.empty() ? NULL : &context.partitionKeys128[0], KeyEqual<Key128>());
+                        break;
+
+                    case KEY_ROWS:
+                        group(partition, context.partitionRows.empty() ? NULL : &context.partitionRows[0], RowEqual(context.keys));
+                        break;
+                }
+            }
+
+            std::size_t groupCount = partition.groupRows.size();
+            partition.states.resize(context.aggregates.size());
+
+            for (std::size_t i = 0; i < context.aggregates.size(); ++i)
+            {
+                const AggregateInfo& info = context.aggregates[i];
+                AggregateState& state = partition.states[i];
+                resizeState(info, state, groupCount);
+
+                if (groupCount == 0 || partition.end == partition.begin)
+                {
+                    continue;
+                }
+
+                accumulate(info, &context.partitionRows[partition.begin], &context.groups[partition.begin],
+                           partition.end - partition.begin, state);
+            }
+        }
+
+    private:
+        AggregateContext& m_context;
+
+        template<typename Key, typename Equal>
+        void group(Partition& partition, const Key* keys, const Equal& equal)
+        {
+            AggregateContext& context = m_context;
+            GroupTable<Key, Equal> table(equal);
+            const uint8_t* nulls = context.keyKind != KEY_ROWS && !context.keys.empty() && context.keys[0]->isNullable()
+                                   ? context.keys[0]->getNulls() : NULL;
+            uint32_t nullGroup = NO_GROUP;
+
+            for (std::size_t i = partition.begin; i < partition.end; ++i)
+            {
+                if (i + PREFETCH_DISTANCE < partition.end)
+                {
+                    table.prefetch(context.partitionHashes[i + PREFETCH_DISTANCE]);
+                }
+
+                std::size_t row = context.partitionRows[i];
+                uint32_t group;
+
+                if (nulls != NULL && nulls[row])
+                {
+                    if (nullGroup == NO_GROUP)
+                    {
+                        nullGroup = (uint32_t)partition.groupRows.size();
+                        partition.groupRows.push_back(row);
+                        partition.groupHashes.push_back(context.partitionHashes[i]);
+                    }
+
+                    group = nullGroup;
+                }
+                else
+                {
+                    uint32_t next = (uint32_t)partition.groupRows.size();
+                    group = table.insert(context.partitionHashes[i], keys[i], next);
+
+                    if (group == next)
+                    {
+                        partition.groupRows.push_back(row);
+                        partition.groupHashes.push_back(context.partitionHashes[i]);
+                    }
+                }
+
+                context.groups[i] = group;
+            }
+        }
+    };
+
+    //--------------------------------------------------------------------------
+    // Aggregation
+    //--------------------------------------------------------------------------
+
+    // Checks result against the keys and aggregates and sets up context for
+    // them
+    void initialize(AggregateContext& context, const kinetica::ProcData::InputTable& input, const std::vector<std::size_t>& keys,
+                    const std::vector<kinetica::Aggregate>& aggregates, kinetica::ProcData::OutputTable& result)
+    {
+        if (result.getColumnCount() != keys.size() + aggregates.size())
+        {
+            throw std::invalid_argument("Output table " + result.getName() + " must have one column per key and aggregate");
+        }
+
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            const Column& column = input.getColumn(keys[i]);
+
+            if (result.getColumn(i).getType() != column.getType())
+            {
+                throw std::invalid_argument("Output column " + result.getColumn(i).getName() + " does not match key column " + column.getName());
+            }
+
+            context.keys.push_back(&column);
+        }
+
+        for (std::size_t i = 0; i < aggregates.size(); ++i)
+        {
+            const kinetica::Aggregate& aggregate = aggregates[i];
+            const OutputColumn& output = result.getColumn(keys.size() + i);
+            AggregateInfo info;
+            info.function = aggregate.function;
+            info.column = aggregate.column == kinetica::Aggregate::ALL_ROWS ? NULL : &input.getColumn(aggregate.column);
+            info.accumulator = INTEGER;
+
+            if (info.column == NULL && aggregate.function != kinetica::Aggregate::COUNT)
+            {
+                throw std::invalid_argument("Only COUNT can be computed over all rows");
+            }
+
+            if (info.column != NULL)
+            {
+                Column::ColumnType type = info.column->getType();
+                info.accumulator = type == Column::DOUBLE || type == Column::FLOAT ? REAL : (type == Column::ULONG ? UNSIGNED : INTEGER);
+
+                if ((aggregate.function == kinetica::Aggregate::SUM || aggregate.function == kinetica::Aggregate::AVG) && !kinetica::isNumeric(type))
+                {
+                    throw std::invalid_argument("Column " + info.column->getName() + " is not numeric");
+                }
+
+                if ((aggregate.function == kinetica::Aggregate::MIN || aggregate.function == kinetica::Aggregate::MAX)
+                    && (!isOrdered(type) || output.getType() != type))
+                {
+                    throw std::invalid_argument("Output column " + output.getName() + " does not match column " + info.column->getName());
+                }
+            }
+
+            if ((aggregate.function == kinetica::Aggregate::COUNT || aggregate.function == kinetica::Aggregate::SUM
+                 || aggregate.function == kinetica::Aggregate::AVG)
+                && !kinetica::isNumeric(output.getType()))
+            {
+                throw std::invalid_argument("Output column " + output.getName() + " is not numeric");
+            }
+
+            context.aggregates.push_back(info);
+        }
+
+        context.keyKind = context.keys.empty() ? KEY_64 : getKeyKind(context.keys);
+    }
+
+    // Groups and aggregates size rows from input row first into
+    // context.partitions, replacing any previous groups
+    void aggregateRange(AggregateContext& context, const std::size_t first, const std::size_t size, const std::size_t threadCount)
+    {
+        context.first = first;
+        context.size = size;
+        context.partitionBits = 0;
+
+        if (context.size >= kinetica::MIN_PARALLEL_SIZE && threadCount > 1)
+        {
+            while (((std::size_t)1 << context.partitionBits) < threadCount * 4 && context.partitionBits < 8)
+            {
+                context.partitionBits++;
+            }
+        }
+
+        std::size_t partitionCount = (std::size_t)1 << context.partitionBits;
+        context.chunkCount = context.partitionBits == 0 ? 1 : threadCount * 4;
+        context.hashes.resize(context.size);
+        context.partitionHashes.resize(context.size);
+        context.partitionRows.resize(context.size);
+        context.groups.resize(context.size);
+        context.counts.assign(context.chunkCount * partitionCount, 0);
+
+        if (context.keyKind == KEY_64)
+        {
+            context.keys64.resize(context.size);
+            context.partitionKeys64.resize(context.size);
+        }
+        else if (context.keyKind == KEY_128)
+        {
+            context.keys128.resize(context.size);
+            context.partitionKeys128.resize(context.size);
+        }
+
+        HashTask hashTask(context);
+        kinetica::runParallel(hashTask, context.chunkCount, threadCount);
+
+        // Convert counts into the starting position of each chunk's rows
+        // within each partition
+        context.partitions.assign(partitionCount, Partition());
+        std::size_t position = 0;
+
+        for (std::size_t i = 0; i < partitionCount; ++i)
+        {
+            context.partitions[i].begin = position;
+
+            for (std::size_t j = 0; j < context.chunkCount; ++j)
+            {
+                std::size_t count = context.counts[(j << context.partitionBits) + i];
+                context.counts[(j << context.partitionBits) + i] = position;
+                position += count;
+            }
+
+            context.partitions[i].end = position;
+        }
+
+        ScatterTask scatterTask(context);
+        kinetica::runParallel(scatterTask, context.chunkCount, threadCount);
+        context.hashes.clear();
+        context.keys64.clear();
+        context.keys128.clear();
+
+        GroupTask groupTask(context);
+        kinetica::runParallel(groupTask, partitionCount, threadCount);
+
+        // Without key columns each partition holds part of the single group,
+        // which is output even for an empty table
+        if (context.keys.empty())
+        {
+            Partition& target = context.partitions[0];
+
+            if (target.groupRows.empty())
+            {
+                target.groupRows.push_back(0);
+                target.groupHashes.push_back(0);
+
+                for (std::size_t i = 0; i < context.aggregates.size(); ++i)
+                {
+                    resizeState(context.aggregates[i], target.states[i], 1);
+                }
+            }
+
+            for (std::size_t i = 1; i < partitionCount; ++i)
+            {
+                Partition& source = context.partitions[i];
+
+                if (!source.groupRows.empty())
+                {
+                    for (std::size_t j = 0; j < context.aggregates.size(); ++j)
+                    {
+                        merge(context.aggregates[j], target.states[j], source.states[j]);
+                        resizeState(context.aggregates[j], source.states[j], 0);
+                    }
+
+                    source.groupRows.clear();
+                    source.groupHashes.clear();
+                }
+            }
+        }
+    }
+
+    // Appends groups, given by their first rows and aggregate states, to
+    // result
+    void writeGroups(const AggregateContext& context, const std::vector<std::size_t>& groupRows,
+                     const std::vector<AggregateState>& states, kinetica::ProcData::OutputTable& result)
+    {
+        result.setSize(result.getSize() + groupRows.size());
+
+        for (std::size_t i = 0; i < context.keys.size(); ++i)
+        {
+            result.getColumn(i).appendRows(*context.keys[i], groupRows.empty() ? NULL : &groupRows[0], groupRows.size());
+        }
+
+        for (std::size_t i = 0; i < context.aggregates.size(); ++i)
+        {
+            writeAggregate(result.getColumn(context.keys.size() + i), context.aggregates[i], states[i]);
+        }
+    }
+
+    // Appends the groups of context.partitions to result
+    std::size_t writeGroups(const AggregateContext& context, kinetica::ProcData::OutputTable& result)
+    {
+        std::vector<std::size_t> groupRows;
+        std::vector<AggregateState> states(context.aggregates.size());
+
+        for (std::size_t i = 0; i < context.partitions.size(); ++i)
+        {
+            groupRows.insert(groupRows.end(), context.partitions[i].groupRows.begin(), context.partitions[i].groupRows.end());
+        }
+
+        for (std::size_t i = 0; i < context.aggregates.size(); ++i)
+        {
+            AggregateState& state = states[i];
+
+            for (std::size_t j = 0; j < context.partitions.size(); ++j)
+            {
+                const AggregateState& partitionState = context.partitions[j].states[i];
+                state.counts.insert(state.counts.end(), partitionState.counts.begin(), partitionState.counts.end());
+                state.integers.insert(state.integers.end(), partitionState.integers.begin(), partitionState.integers.end());
+                state.reals.insert(state.reals.end(), partitionState.reals.begin(), partitionState.reals.end());
+            }
+        }
+
+        writeGroups(context, groupRows, states, result);
+        return groupRows.size();
+    }
+
+    //--------------------------------------------------------------------------
+    // Spilled aggregation
+    //--------------------------------------------------------------------------
+
+    // Writes the groups of context.partitions to partials as their first row,
+    // hash and, per aggregate, count and value (unless COUNT)
+    void spillGroups(const AggregateContext& context, kinetica::SpillPartitions& partials)
+    {
+        std::vector<uint64_t> values(2 + context.aggregates.size() * 2);
+
+        for (std::size_t i = 0; i < context.partitions.size(); ++i)
+        {
+            const Partition& partition = context.partitions[i];
+
+            for (std::size_t j = 0; j < partition.groupRows.size(); ++j)
+            {
+                uint64_t hash = partition.groupHashes[j];
+                std::size_t column = 2;
+                values[0] = partition.groupRows[j];
+                values[1] = hash;
+
+                for (std::size_t k = 0; k < context.aggregates.size(); ++k)
+                {
+                    const AggregateInfo& info = context.aggregates[k];
+                    values[column++] = (uint64_t)partition.states[k].counts[j];
+
+                    if (info.function != kinetica::Aggregate::COUNT)
+                    {
+                        values[column++] = getValue(info, partition.states[k], j);
+                    }
+                }
+
+                partials.add((std::size_t)((hash >> 32) % partials.getPartitionCount()), &values[0]);
+            }
+        }
+    }
+
+    // Merges the partial groups of a spilled partition by key and appends
+    // them to result. The input rows of the groups are compared rather than
+    // normalized keys, which are not spilled.
+    std::size_t mergeGroups(const AggregateContext& context, kinetica::SpillFile& partials, kinetica::ProcData::OutputTable& result)
+    {
+        GroupTable<std::size_t, RowEqual> table((RowEqual(context.keys)));
+        std::vector<std::size_t> groupRows;
+        std::vector<AggregateState> states(context.aggregates.size());
+        std::vector<std::vector<uint64_t> > block;
+
+        while (partials.read(block))
+        {
+            for (std::size_t i = 0; i < block[0].size(); ++i)
+            {
+                std::size_t row = (std::size_t)block[0][i];
+                uint32_t next = (uint32_t)groupRows.size();
+                uint32_t group = table.insert(block[1][i], row, next);
+                std::size_t column = 2;
+
+                if (group == next)
+                {
+                    groupRows.push_back(row);
+
+                    for (std::size_t j = 0; j < context.aggregates.size(); ++j)
+                    {
+                        resizeState(context.aggregates[j], states[j], groupRows.size());
+                    }
+                }
+
+                for (std::size_t j = 0; j < context.aggregates.size(); ++j)
+                {
+                    const AggregateInfo& info = context.aggregates[j];
+                    int64_t count = (int64_t)block[column++][i];
+                    uint64_t value = info.function == kinetica::Aggregate::COUNT ? 0 : block[column++][i];
+                    merge(info, states[j], group, count, value);
+                }
+            }
+        }
+
+        writeGroups(context, groupRows, states, result);
+        return groupRows.size();
+    }
+}
+
+namespace kinetica
+{
+    const std::size_t Aggregate::ALL_ROWS;
+
+    Aggregate::Aggregate(const Function function, const std::size_t column) :
+        function(function),
+        column(column)
+    {
+    }
+
+    std::size_t aggregate(const ProcData::InputTable& input, const std::vector<std::size_t>& keys,
+                          const std::vector<Aggregate>& aggregates, ProcData::OutputTable& result,
+                          std::size_t threadCount)
+    {
+        AggregateContext context;
+        initialize(context, input, keys, aggregates, result);
+
+        if (threadCount == 0)
+        {
+            threadCount = getHardwareThreadCount();
+        }
+
+        aggregateRange(context, 0, input.getSize(), threadCount);
+        return writeGroups(context, result);
+    }
+
+    std::size_t aggregate(const ProcData::InputTable& input, const std::vector<std::size_t>& keys,
+                          const std::vector<Aggregate>& aggregates, ProcData::OutputTable& result,
+                          SpillManager& spill, std::size_t threadCount)
+    {
+        AggregateContext context;
+        initialize(context, input, keys, aggregates, result);
+        std::size_t size = input.getSize();
+
+        if (threadCount == 0)
+        {
+            threadCount = getHardwareThreadCount();
+        }
+
+        // Aggregating a run holds per row its hash and row number twice, its
+        // group, its normalized key twice and at worst a group of its own
+        // with a hash table slot and, per aggregate, a count and value
+        std::size_t keyBytes = context.keyKind == KEY_64 ? 16 : (context.keyKind == KEY_128 ? 32 : 0);
+        std::size_t groupBytes = 48 + context.aggregates.size() * 16;
+        std::size_t rowBytes = 36 + keyBytes + groupBytes;
+
+        if (size <= std::max(MIN_RUN_SIZE, spill.getMemoryBudget() / rowBytes))
+        {
+            aggregateRange(context, 0, size, threadCount);
+            return writeGroups(context, result);
+        }
+
+        // Partial groups of each run are spilled by hash, so that merging a
+        // partition holds at most its share of the distinct groups. Runs and
+        // the partitions' buffers each take at most half the budget.
+        std::size_t runSize = std::max(MIN_RUN_SIZE, spill.getMemoryBudget() / 2 / rowBytes);
+        std::size_t columnCount = 2;
+
+        for (std::size_t i = 0; i < context.aggregates.size(); ++i)
+        {
+            columnCount += context.aggregates[i].function == Aggregate::COUNT ? 1 : 2;
+        }
+
+        std::size_t partitionCount = std::min(MAX_SPILL_PARTITIONS,
+                                              std::max((std::size_t)2, size / std::max((std::size_t)1, spill.getMemoryBudget() / groupBytes) + 1));
+        SpillPartitions partials(spill, partitionCount, columnCount, spill.getMemoryBudget() / 2);
+
+        for (std::size_t first = 0; first < size; first += runSize)
+        {
+            aggregateRange(context, first, std::min(runSize, size - first), threadCount);
+            spillGroups(context, partials);
+        }
+
+        std::vector<Partition>().swap(context.partitions);
+        std::vector<uint64_t>().swap(context.partitionHashes);
+        std::vector<uint64_t>().swap(context.partitionKeys64);
+        std::vector<Key128>().swap(context.partitionKeys128);
+        std::vector<std::size_t>().swap(context.partitionRows);
+        std::vector<uint32_t>().swap(context.groups);
+        std::size_t count = 0;
+
+        for (std::size_t i = 0; i < partitionCount; ++i)
+        {
+            count += mergeGroups(context, partials.getFile(i), result);
+        }
+
+        return count;
+    }
+}
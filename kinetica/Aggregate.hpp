@@ -0,0 +1,66 @@
+#ifndef _KINETICA_AGGREGATE_HPP_
+#define _KINETICA_AGGREGATE_HPP_
+
+#include "Proc.hpp"
+#include "Spill.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace kinetica
+{
+    struct Aggregate
+    {
+        enum Function
+        {
+            COUNT,
+            SUM,
+            MIN,
+            MAX,
+            AVG
+        };
+
+        // Column index for COUNT of all rows
+        static const std::size_t ALL_ROWS = (std::size_t)-1;
+
+        Function function;
+        std::size_t column;
+
+        Aggregate(const Function function, const std::size_t column = ALL_ROWS);
+    };
+
+    // Groups the rows of input by the key columns and appends one row per
+    // group to result: the key values followed by one value per aggregate.
+    // Rows are partitioned by key hash so that each thread builds and
+    // aggregates its own open-addressing hash table. With no key columns a
+    // single row aggregates the whole table. Returns the number of groups.
+    //
+    // Key columns of result must have the input key column types. COUNT, SUM
+    // and AVG may be written to any numeric column, converted as
+    // appendNumbers does (see Numeric.hpp): DECIMAL values keep their value
+    // in columns of other types and vice versa, and values written to
+    // integer columns are rounded and clamped (BOOLEAN columns get 1 for
+    // any nonzero value). SUM accumulates integers
+    // (including DECIMAL) in 64 bits, wrapping on overflow, and FLOAT/DOUBLE
+    // in double precision.
+    // MIN and MAX also accept DATE, DATETIME, TIME and IPV4 columns and must
+    // be written to a column of the input type. Null keys form a group of
+    // their own; aggregates ignore null values and are null (or 0, if the
+    // result column is not nullable) for groups with no values.
+    std::size_t aggregate(const ProcData::InputTable& input, const std::vector<std::size_t>& keys,
+                          const std::vector<Aggregate>& aggregates, ProcData::OutputTable& result,
+                          const std::size_t threadCount = 0);
+
+    // Aggregates as above, holding to the memory budget of spill when the
+    // table is too large to group at once: runs of rows are aggregated in
+    // turn and their partial groups spilled to disk, partitioned by key hash,
+    // then the partial groups of each partition are merged and appended to
+    // result. Groups are appended in partition order. Merging a partition
+    // holds its distinct groups in memory, so with very many distinct keys
+    // the budget may still be exceeded.
+    std::size_t aggregate(const ProcData::InputTable& input, const std::vector<std::size_t>& keys,
+                          const std::vector<Aggregate>& aggregates, ProcData::OutputTable& result,
+                          SpillManager& spill, const std::size_t threadCount = 0);
+}
+
+#endif
@@ -0,0 +1,274 @@
+#include "Bloom.hpp"
+#include "Hash.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    typedef kinetica::ProcData::Column Column;
+
+    // Rows hashed at a time by each task
+    const std::size_t HASH_BATCH_SIZE = 1024;
+
+    const uint8_t BLOOM_FILTER_FORMAT = 3;
+    const uint8_t FORMAT_VERSION = 1;
+
+    // Odd multipliers that pick the bit set in each word of a block
+    const uint32_t SALTS[8] = { 0x47b6137b, 0x44974d91, 0x8824ad5b, 0xa2b7289d,
+                                0x705495c7, 0x2df1424b, 0x9efc4947, 0x5c6bfb31 };
+
+    std::size_t getChunkCount(const Column& column, const std::size_t threadCount)
+    {
+        std::size_t threads = threadCount == 0 ? kinetica::getHardwareThreadCount() : threadCount;
+        return column.getSize() >= kinetica::MIN_PARALLEL_SIZE && threads > 1 ? threads * 4 : 1;
+    }
+
+    #ifdef __AVX2__
+    inline __m256i getMask(const uint64_t hash)
+    {
+        const __m256i salts = _mm256_loadu_si256((const __m256i*)SALTS);
+        __m256i bits = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32((int)(uint32_t)hash), salts), 27);
+        return _mm256_sllv_epi32(_mm256_set1_epi32(1), bits);
+    }
+    #endif
+
+    class HashTask : public kinetica::ParallelTask
+    {
+    public:
+        HashTask(const Column& column, const std::size_t chunkCount, uint64_t* hashes) :
+            m_column(column),
+            m_chunkCount(chunkCount),
+            m_hashes(hashes)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            std::size_t start = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index);
+            std::size_t end = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index + 1);
+            kinetica::hashColumn(m_column, start, end - start, m_hashes + start);
+        }
+
+    private:
+        const Column& m_column;
+        std::size_t m_chunkCount;
+        uint64_t* m_hashes;
+    };
+
+    class ProbeTask : public kinetica::ParallelTask
+    {
+    public:
+        ProbeTask(const kinetica::BloomFilter& filter, const Column& column, const std::size_t chunkCount,
+                  std::vector<std::vector<std::size_t> >& rows) :
+            m_filter(filter),
+            m_column(column),
+            m_chunkCount(chunkCount),
+            m_rows(rows)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            std::size_t start = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index);
+            std::size_t end = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index + 1);
+            const uint8_t* nulls = m_column.isNullable() ? m_column.getNulls() : NULL;
+            std::vector<std::size_t>& rows = m_rows[index];
+            uint64_t hashes[HASH_BATCH_SIZE];
+
+            for (std::size_t batch = start; batch < end; batch += HASH_BATCH_SIZE)
+            {
+                std::size_t count = std::min(HASH_BATCH_SIZE, end - batch);
+                kinetica::hashColumn(m_column, batch, count, hashes);
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    if ((nulls == NULL || !nulls[batch + i]) && m_filter.contains(hashes[i]))
+                    {
+                        rows.push_back(batch + i);
+                    }
+                }
+            }
+        }
+
+    private:
+        const kinetica::BloomFilter& m_filter;
+        const Column& m_column;
+        std::size_t m_chunkCount;
+        std::vector<std::vector<std::size_t> >& m_rows;
+    };
+}
+
+namespace kinetica
+{
+    BloomFilter::BloomFilter(const std::size_t keyCount, const double falsePositiveRate)
+    {
+        if (!(falsePositiveRate > 0 && falsePositiveRate < 1))
+        {
+            throw std::invalid_argument("Bloom filter false positive rate must be in (0, 1)");
+        }
+
+        // Optimal bits per key for an unblocked filter, plus a quarter to
+        // make up for the uneven load of blocks
+        double bits = -(double)keyCount * std::log(falsePositiveRate) / (std::log(2.0) * std::log(2.0)) * 1.25;
+        allocate(std::max((std::size_t)1, (std::size_t)std::ceil(bits / 256)));
+    }
+
+    BloomFilter::BloomFilter(const BloomFilter& filter)
+    {
+        allocate(filter.m_blockCount);
+        std::copy(filter.m_blocks, filter.m_blocks + m_blockCount * 8, m_blocks);
+    }
+
+    BloomFilter& BloomFilter::operator =(const BloomFilter& filter)
+    {
+        if (this != &filter)
+        {
+            allocate(filter.m_blockCount);
+            std::copy(filter.m_blocks, filter.m_blocks + m_blockCount * 8, m_blocks);
+        }
+
+        return *this;
+    }
+
+    void BloomFilter::allocate(const std::size_t blockCount)
+    {
+        // Vector storage is at least 4-byte aligned, so up to 15 words
+        // precede the first boundary
+        m_words.assign(blockCount * 8 + 15, 0);
+        uintptr_t address = (uintptr_t)&m_words[0];
+        m_blocks = &m_words[0] + ((64 - (address & 63)) & 63) / 4;
+        m_blockCount = blockCount;
+    }
+
+    std::size_t BloomFilter::getSize() const
+    {
+        return m_blockCount * 32;
+    }
+
+    void BloomFilter::add(const uint64_t hash)
+    {
+        uint32_t* block = getBlock(hash);
+
+        #ifdef __AVX2__
+        __m256i words = _mm256_load_si256((const __m256i*)block);
+        _mm256_store_si256((__m256i*)block, _mm256_or_si256(words, getMask(hash)));
+        #else
+        for (std::size_t i = 0; i < 8; ++i)
+        {
+            block[i] |= (uint32_t)1 << (((uint32_t)hash * SALTS[i]) >> 27);
+        }
+        #endif
+    }
+
+    bool BloomFilter::contains(const uint64_t hash) const
+    {
+        const uint32_t* block = getBlock(hash);
+
+        #ifdef __AVX2__
+        return _mm256_testc_si256(_mm256_load_si256((const __m256i*)block), getMask(hash)) != 0;
+        #else
+        for (std::size_t i = 0; i < 8; ++i)
+        {
+            if ((block[i] & ((uint32_t)1 << (((uint32_t)hash * SALTS[i]) >> 27))) == 0)
+            {
+                return false;
+            }
+        }
+
+        return true;
+        #endif
+    }
+
+    void BloomFilter::add(const ProcData::Column& column, const std::size_t threadCount)
+    {
+        std::size_t size = column.getSize();
+
+        if (size == 0)
+        {
+            return;
+        }
+
+        // Hashing is parallel, but setting bits is cheap enough to do in one
+        // pass without synchronization
+        std::vector<uint64_t> hashes(size);
+        std::size_t chunkCount = getChunkCount(column, threadCount);
+        HashTask hashTask(column, chunkCount, &hashes[0]);
+        runParallel(hashTask, chunkCount, threadCount);
+        const uint8_t* nulls = column.isNullable() ? column.getNulls() : NULL;
+
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            if (nulls == NULL || !nulls[i])
+            {
+                add(hashes[i]);
+            }
+        }
+    }
+
+    void BloomFilter::probe(const ProcData::Column& column, std::vector<std::size_t>& rows, const std::size_t threadCount) const
+    {
+        std::size_t chunkCount = getChunkCount(column, threadCount);
+        std::vector<std::vector<std::size_t> > chunkRows(chunkCount);
+        ProbeTask probeTask(*this, column, chunkCount, chunkRows);
+        runParallel(probeTask, chunkCount, threadCount);
+
+        for (std::size_t i = 0; i < chunkCount; ++i)
+        {
+            rows.insert(rows.end(), chunkRows[i].begin(), chunkRows[i].end());
+        }
+    }
+
+    void BloomFilter::merge(const BloomFilter& filter)
+    {
+        if (filter.m_blockCount != m_blockCount)
+        {
+            throw std::invalid_argument("Bloom filter sizes do not match");
+        }
+
+        for (std::size_t i = 0; i < m_blockCount * 8; ++i)
+        {
+            m_blocks[i] |= filter.m_blocks[i];
+        }
+    }
+
+    void BloomFilter::serialize(std::vector<uint8_t>& data) const
+    {
+        data.resize(2 + m_blockCount * 32);
+        data[0] = BLOOM_FILTER_FORMAT;
+        data[1] = FORMAT_VERSION;
+
+        for (std::size_t i = 0; i < m_blockCount * 8; ++i)
+        {
+            for (unsigned j = 0; j < 4; ++j)
+            {
+                data[2 + i * 4 + j] = (uint8_t)(m_blocks[i] >> (j * 8));
+            }
+        }
+    }
+
+    void BloomFilter::deserialize(const std::vector<uint8_t>& data)
+    {
+        if (data.size() < 2 + 32 || (data.size() - 2) % 32 != 0
+            || data[0] != BLOOM_FILTER_FORMAT || data[1] != FORMAT_VERSION)
+        {
+            throw std::invalid_argument("Invalid serialized Bloom filter");
+        }
+
+        allocate((data.size() - 2) / 32);
+
+        for (std::size_t i = 0; i < m_blockCount * 8; ++i)
+        {
+            for (unsigned j = 0; j < 4; ++j)
+            {
+                m_blocks[i] |= (uint32_t)data[2 + i * 4 + j] << (j * 8);
+            }
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef _KINETICA_BLOOM_HPP_
+#define _KINETICA_BLOOM_HPP_
+
+#include "Proc.hpp"
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace kinetica
+{
+    // Split block Bloom filter over value hashes (see Hash.hpp). Each key
+    // sets one bit in each of the eight 32-bit words of a single 32-byte
+    // block, and the block array starts on a 64-byte boundary so that no
+    // block straddles a cache line and adding or probing a key touches one
+    // cache line; with AVX2 the eight bits are computed and
+    // tested in one pass. Filters built on one rank can be serialized (e.g.
+    // into ProcData::getBinResults) and probed on another, provided the key
+    // columns have the same type.
+    class BloomFilter
+    {
+    public:
+        // Sized for keyCount distinct keys at about the given false positive
+        // rate
+        BloomFilter(const std::size_t keyCount = 0, const double falsePositiveRate = 0.01);
+
+        BloomFilter(const BloomFilter& filter);
+        BloomFilter& operator =(const BloomFilter& filter);
+
+        // Size of the filter in bytes
+        std::size_t getSize() const;
+
+        void add(const uint64_t hash);
+        bool contains(const uint64_t hash) const;
+
+        // Adds the non-null values of a column of any type, hashing parts of
+        // it in parallel
+        void add(const ProcData::Column& column, const std::size_t threadCount = 0);
+
+        // Appends the rows, in order, whose values may have been added to the
+        // filter; null rows never match. Parts of the column are probed in
+        // parallel.
+        void probe(const ProcData::Column& column, std::vector<std::size_t>& rows, const std::size_t threadCount = 0) const;
+
+        // Combines the keys of a filter of the same size into this one
+        void merge(const BloomFilter& filter);
+
+        void serialize(std::vector<uint8_t>& data) const;
+        void deserialize(const std::vector<uint8_t>& data);
+
+    private:
+        // Blocks start at m_blocks, the first 64-byte boundary in m_words
+        std::vector<uint32_t> m_words;
+        uint32_t* m_blocks;
+        std::size_t m_blockCount;
+
+        // Allocates blockCount cleared blocks
+        void allocate(const std::size_t blockCount);
+
+        uint32_t* getBlock(const uint64_t hash)
+        {
+            return m_blocks + (std::size_t)(((hash >> 32) * m_blockCount) >> 32) * 8;
+        }
+
+        const uint32_t* getBlock(const uint64_t hash) const
+        {
+            return m_blocks + (std::size_t)(((hash >> 32) * m_blockCount) >> 32) * 8;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,1087 @@
+#include "Cast.hpp"
+#include "CharNText.hpp"
+#include "Decimal.hpp"
+#include "Parallel.hpp"
+#include "Temporal.hpp"
+#include "TextParse.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    typedef kinetica::ProcData::Column Column;
+    typedef kinetica::ProcData::OutputColumn OutputColumn;
+
+    // Rows converted at a time by each task
+    const std::size_t BATCH_SIZE = 1024;
+
+    const int64_t MILLISECONDS_PER_DAY = 86400000;
+
+    // Epoch days of 1000-01-01 and 2901-01-01, the bounds of valid dates
+    const int64_t MIN_EPOCH_DAY = -354285;
+    const int64_t END_EPOCH_DAY = 340041;
+
+    const char* DIGIT_PAIRS =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+    const char* HEX_DIGITS = "0123456789abcdef";
+
+    //--------------------------------------------------------------------------
+    // Types
+    //--------------------------------------------------------------------------
+
+    // How values are converted: directly, through int64_t values, doubles,
+    // epoch milliseconds, or text
+    enum Path
+    {
+        NO_PATH,
+        COPY,
+        INTEGER,
+        REAL,
+        TEMPORAL,
+        TEXT
+    };
+
+    bool isInteger(const Column::ColumnType type)
+    {
+        switch (type)
+        {
+            case Column::BOOLEAN:
+            case Column::INT8:
+            case Column::INT16:
+            case Column::INT:
+            case Column::LONG:
+            case Column::ULONG:
+            case Column::TIMESTAMP: return true;
+            default: return false;
+        }
+    }
+
+    bool isReal(const Column::ColumnType type)
+    {
+        return type == Column::FLOAT || type == Column::DOUBLE;
+    }
+
+    bool isNumeric(const Column::ColumnType type)
+    {
+        return isInteger(type) || isReal(type) || type == Column::DECIMAL;
+    }
+
+    bool isTemporal(const Column::ColumnType type)
+    {
+        return type == Column::DATE || type == Column::DATETIME || type == Column::TIME || type == Column::TIMESTAMP;
+    }
+
+    bool isText(const Column::ColumnType type)
+    {
+        return type == Column::STRING || kinetica::getCharNWidth(type) != 0;
+    }
+
+    bool isVar(const Column::ColumnType type)
+    {
+        return type == Column::STRING || type == Column::BYTES;
+    }
+
+    Path getPath(const Column::ColumnType from, const Column::ColumnType to)
+    {
+        bool isParseable = isNumeric(to) || isTemporal(to) || isText(to) || to == Column::IPV4 || to == Column::UUID;
+
+        if (from == to)
+        {
+            return COPY;
+        }
+        else if (isText(to))
+        {
+            bool isFormattable = isNumeric(from) || isTemporal(from) || isText(from)
+                                 || from == Column::IPV4 || from == Column::UUID || from == Column::BYTES;
+            return isFormattable ? TEXT : NO_PATH;
+        }
+        else if (isText(from))
+        {
+            return isParseable ? TEXT : NO_PATH;
+        }
+        else if (isNumeric(from) && isNumeric(to))
+        {
+            // Decimals go to BOOLEAN as reals so that fractions are true
+            return isReal(from) || isReal(to) || (from == Column::DECIMAL && to == Column::BOOLEAN) ? REAL : INTEGER;
+        }
+        else if (isTemporal(from) && isTemporal(to) && from != Column::TIME && !(from == Column::DATE && to == Column::TIME))
+        {
+            return TEMPORAL;
+        }
+
+        return NO_PATH;
+    }
+
+    // Values of a batch of rows at each stage of conversion
+    struct Batch
+    {
+        std::size_t start;
+        std::size_t count;
+        std::vector<uint8_t> nulls;
+        std::vector<uint8_t> errors;
+
+        // Integers (as raw bits if isUnsigned) or epoch milliseconds
+        std::vector<int64_t> integers;
+        bool isUnsigned;
+
+        std::vector<double> reals;
+
+        // Text of each row; formatted values are held in text
+        std::string text;
+        std::vector<uint64_t> offsets;
+        std::vector<const char*> values;
+        std::vector<std::size_t> lengths;
+
+        Batch() :
+            start(0),
+            count(0),
+            nulls(BATCH_SIZE),
+            errors(BATCH_SIZE),
+            integers(BATCH_SIZE),
+            isUnsigned(false),
+            reals(BATCH_SIZE),
+            values(BATCH_SIZE),
+            lengths(BATCH_SIZE)
+        {
+        }
+    };
+
+    //--------------------------------------------------------------------------
+    // Formatting
+    //--------------------------------------------------------------------------
+
+    void appendUnsigned(std::string& text, uint64_t value)
+    {
+        char buffer[20];
+        char* end = buffer + sizeof(buffer);
+        char* pos = end;
+
+        while (value >= 100)
+        {
+            pos -= 2;
+            std::memcpy(pos, DIGIT_PAIRS + (value % 100) * 2, 2);
+            value /= 100;
+        }
+
+        if (value >= 10)
+        {
+            pos -= 2;
+            std::memcpy(pos, DIGIT_PAIRS + value * 2, 2);
+        }
+        else
+        {
+            *--pos = (char)('0' + value);
+        }
+
+        text.append(pos, end - pos);
+    }
+
+    void appendInteger(std::string& text, const int64_t value)
+    {
+        if (value < 0)
+        {
+            text += '-';
+            appendUnsigned(text, 0 - (uint64_t)value);
+        }
+        else
+        {
+            appendUnsigned(text, (uint64_t)value);
+        }
+    }
+
+    // Fewest digits that read back as the same value
+    void appendReal(std::string& text, const double value)
+    {
+        char buffer[32];
+        int length = std::sprintf(buffer, "%.15g", value);
+
+        if (std::strtod(buffer, NULL) != value)
+        {
+            length = std::sprintf(buffer, "%.17g", value);
+        }
+
+        text.append(buffer, length);
+    }
+
+    void appendFloat(std::string& text, const float value)
+    {
+        char buffer[32];
+        int length = std::sprintf(buffer, "%.7g", value);
+
+        if ((float)std::strtod(buffer, NULL) != value)
+        {
+            length = std::sprintf(buffer, "%.9g", value);
+        }
+
+        text.append(buffer, length);
+    }
+
+    void appendPadded(std::string& text, const unsigned value, const std::size_t width)
+    {
+        if (width == 2 && value < 100)
+        {
+            text.append(DIGIT_PAIRS + value * 2, 2);
+            return;
+        }
+
+        std::size_t start = text.size();
+        appendUnsigned(text, value);
+
+        if (text.size() - start < width)
+        {
+            text.insert(start, width - (text.size() - start), '0');
+        }
+    }
+
+    void appendDate(std::string& text, const unsigned year, const unsigned month, const unsigned day)
+    {
+        appendPadded(text, year, 4);
+        text += '-';
+        appendPadded(text, month, 2);
+        text += '-';
+        appendPadded(text, day, 2);
+    }
+
+    void appendTime(std::string& text, const unsigned hour, const unsigned minute, const unsigned second,
+                    const unsigned millisecond)
+    {
+        appendPadded(text, hour, 2);
+        text += ':';
+        appendPadded(text, minute, 2);
+        text += ':';
+        appendPadded(text, second, 2);
+        text += '.';
+        appendPadded(text, millisecond, 3);
+    }
+
+    void appendHex(std::string& text, const uint8_t value)
+    {
+        text += HEX_DIGITS[value >> 4];
+        text += HEX_DIGITS[value & 0xf];
+    }
+
+    //--------------------------------------------------------------------------
+    // Loading
+    //--------------------------------------------------------------------------
+
+    template<typename T>
+    void loadIntegers(const Column& column, Batch& batch)
+    {
+        const T* data = column.getData<T>() + batch.start;
+
+        for (std::size_t i = 0; i < batch.count; ++i)
+        {
+            batch.integers[i] = (int64_t)data[i];
+        }
+    }
+
+    void loadIntegers(const Column& column, Batch& batch)
+    {
+        batch.isUnsigned = column.getType() == Column::ULONG;
+
+        switch (column.getType())
+        {
+            case Column::BOOLEAN:
+                loadIntegers<int8_t>(column, batch);
+
+                for (std::size_t i = 0; i < batch.count; ++i)
+                {
+                    batch.integers[i] = batch.integers[i] != 0;
+                }
+
+                break;
+
+            case Column::INT8: loadIntegers<int8_t>(column, batch); break;
+            case Column::INT16: loadIntegers<int16_t>(column, batch); break;
+            case Column::INT: loadIntegers<int32_t>(column, batch); break;
+            case Column::ULONG: loadIntegers<uint64_t>(column, batch); break;
+
+            case Column::DECIMAL:
+                loadIntegers<int64_t>(column, batch);
+
+                for (std::size_t i = 0; i < batch.count; ++i)
+                {
+                    batch.integers[i] /= kinetica::DECIMAL_FACTOR;
+                }
+
+                break;
+
+            default: loadIntegers<int64_t>(column, batch); break;
+        }
+    }
+
+    void loadReals(const Column& column, Batch& batch)
+    {
+        if (column.getType() == Column::DOUBLE)
+        {
+            std::memcpy(&batch.reals[0], column.getData<double>() + batch.start, batch.count * sizeof(double));
+        }
+        else if (column.getType() == Column::FLOAT)
+        {
+            const float* data = column.getData<float>() + batch.start;
+
+            for (std::size_t i = 0; i < batch.count; ++i)
+            {
+                batch.reals[i] = data[i];
+            }
+        }
+        else if (column.getType() == Column::DECIMAL)
+        {
+            const int64_t* data = column.getData<int64_t>() + batch.start;
+
+            for (std::size_t i = 0; i < batch.count; ++i)
+            {
+                batch.reals[i] = (double)data[i] / kinetica::DECIMAL_FACTOR;
+            }
+        }
+        else
+        {
+            loadIntegers(column, batch);
+
+            for (std::size_t i = 0; i < batch.count; ++i)
+            {
+                batch.reals[i] = batch.isUnsigned ? (double)(uint64_t)batch.integers[i] : (double)batch.integers[i];
+            }
+        }
+    }
+
+    void loadMilliseconds(const Column& column, Batch& batch)
+    {
+        int64_t* result = &batch.integers[0];
+
+        switch (column.getType())
+        {
+            case Column::DATE: kinetica::toEpochMilliseconds(column.getData<kinetica::Date>() + batch.start, batch.count, result); break;
+            case Column::DATETIME: kinetica::toEpochMilliseconds(column.getData<kinetica::DateTime>() + batch.start, batch.count, result); break;
+            default: std::memcpy(result, column.getData<int64_t>() + batch.start, batch.count * sizeof(int64_t)); break;
+        }
+    }
+
+    template<typename T>
+    void formatIntegers(const T* data, Batch& batch)
+    {
+        for (std::size_t i = 0; i < batch.count; ++i)
+        {
+            batch.offsets.push_back(batch.text.size());
+            appendInteger(batch.text, (int64_t)data[i]);
+        }
+    }
+
+    void formatValues(const Column& column, Batch& batch)
+    {
+        std::size_t start = batch.start;
+        std::size_t count = batch.count;
+        std::string& text = batch.text;
+
+        switch (column.getType())
+        {
+            case Column::BOOLEAN:
+            {
+                const int8_t* data = column.getData<int8_t>() + start;
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    batch.offsets.push_back(text.size());
+                    text += data[i] != 0 ? '1' : '0';
+                }
+
+                break;
+            }
+
+            case Column::INT8: formatIntegers(column.getData<int8_t>() + start, batch); break;
+            case Column::INT16: formatIntegers(column.getData<int16_t>() + start, batch); break;
+            case Column::INT: formatIntegers(column.getData<int32_t>() + start, batch); break;
+            case Column::LONG:
+            case Column::TIMESTAMP: formatIntegers(column.getData<int64_t>() + start, batch); break;
+
+            case Column::ULONG:
+            {
+                const uint64_t* data = column.getData<uint64_t>() + start;
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    batch.offsets.push_back(text.size());
+                    appendUnsigned(text, data[i]);
+                }
+
+                break;
+            }
+
+            case Column::DECIMAL:
+            {
+                const int64_t* data = column.getData<int64_t>() + start;
+                char buffer[24];
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    batch.offsets.push_back(text.size());
+                    text.append(buffer, kinetica::formatDecimal(data[i], kinetica::DECIMAL_SCALE, buffer));
+                }
+
+                break;
+            }
+
+            case Column::FLOAT:
+            {
+                const float* data = column.getData<float>() + start;
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    batch.offsets.push_back(text.size());
+                    appendFloat(text, data[i]);
+                }
+
+                break;
+            }
+
+            case Column::DOUBLE:
+            {
+                const double* data = column.getData<double>() + start;
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    batch.offsets.push_back(text.size());
+                    appendReal(text, data[i]);
+                }
+
+                break;
+            }
+
+            case Column::DATE:
+            {
+                const kinetica::Date* data = column.getData<kinetica::Date>() + start;
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    batch.offsets.push_back(text.size());
+                    appendDate(text, data[i].getYear(), data[i].getMonth(), data[i].getDay());
+                }
+
+                break;
+            }
+
+            case Column::DATETIME:
+            {
+                const kinetica::DateTime* data = column.getData<kinetica::DateTime>() + start;
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    batch.offsets.push_back(text.size());
+                    appendDate(text, data[i].getYear(), data[i].getMonth(), data[i].getDay());
+                    text += ' ';
+                    appendTime(text, data[i].getHour(), data[i].getMinute(), data[i].getSecond(), data[i].getMillisecond());
+                }
+
+                break;
+            }
+
+            case Column::TIME:
+            {
+                const kinetica::Time* data = column.getData<kinetica::Time>() + start;
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    batch.offsets.push_back(text.size());
+                    appendTime(text, data[i].getHour(), data[i].getMinute(), data[i].getSecond(), data[i].getMillisecond());
+                }
+
+                break;
+            }
+
+            case Column::IPV4:
+            {
+                const uint32_t* data = column.getData<uint32_t>() + start;
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    batch.offsets.push_back(text.size());
+
+                    for (int shift = 24; shift >= 0; shift -= 8)
+                    {
+                        appendUnsigned(text, (data[i] >> shift) & 0xff);
+                        text += shift > 0 ? "." : "";
+                    }
+                }
+
+                break;
+            }
+
+            case Column::UUID:
+            {
+                const kinetica::UUID* data = column.getData<kinetica::UUID>() + start;
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    batch.offsets.push_back(text.size());
+
+                    for (std::size_t j = 16; j-- > 0;)
+                    {
+                        appendHex(text, data[i].raw[j]);
+                        text += j == 12 || j == 10 || j == 8 || j == 6 ? "-" : "";
+                    }
+                }
+
+                break;
+            }
+
+            default:
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    const uint8_t* value = column.getVarValue<uint8_t>(start + i);
+                    std::size_t size = column.getVarValueSize<uint8_t>(start + i);
+                    batch.offsets.push_back(text.size());
+
+                    for (std::size_t j = 0; j < size; ++j)
+                    {
+                        appendHex(text, value[j]);
+                    }
+                }
+
+                break;
+        }
+    }
+
+    // Points values and lengths at the text of each row
+    void loadText(const Column& column, Batch& batch)
+    {
+        std::size_t width = kinetica::getCharNWidth(column.getType());
+        batch.text.clear();
+        batch.offsets.clear();
+
+        if (column.getType() == Column::STRING)
+        {
+            for (std::size_t i = 0; i < batch.count; ++i)
+            {
+                std::size_t size = column.getVarValueSize<char>(batch.start + i);
+                batch.values[i] = column.getVarValue<char>(batch.start + i);
+                batch.lengths[i] = size > 0 ? size - 1 : 0;
+            }
+        }
+        else if (width != 0)
+        {
+            batch.text.resize(batch.count * width);
+            kinetica::charNToText(column.getData<char>() + batch.start * width, width, batch.count, &batch.text[0]);
+
+            for (std::size_t i = 0; i < batch.count; ++i)
+            {
+                const char* value = batch.text.data() + i * width;
+                const char* end = (const char*)std::memchr(value, 0, width);
+                batch.values[i] = value;
+                batch.lengths[i] = end != NULL ? end - value : width;
+            }
+        }
+        else
+        {
+            formatValues(column, batch);
+            batch.offsets.push_back(batch.text.size());
+
+            for (std::size_t i = 0; i < batch.count; ++i)
+            {
+                batch.values[i] = batch.text.data() + batch.offsets[i];
+                batch.lengths[i] = batch.offsets[i + 1] - batch.offsets[i];
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Storing
+    //--------------------------------------------------------------------------
+
+    // Stores integers into data, failing values out of the range of T
+    template<typename T>
+    void storeIntegers(Batch& batch, void* result)
+    {
+        const uint64_t max = (uint64_t)std::numeric_limits<T>::max();
+        const int64_t min = (int64_t)std::numeric_limits<T>::min();
+        T* data = (T*)result;
+
+        for (std::size_t i = 0; i < batch.count; ++i)
+        {
+            int64_t value = batch.integers[i];
+            bool isValid = batch.isUnsigned ? (uint64_t)value <= max : value >= min && (value < 0 || (uint64_t)value <= max);
+            data[i] = isValid ? (T)value : 0;
+            batch.errors[i] |= !isValid;
+        }
+    }
+
+    void storeIntegers(Batch& batch, const Column::ColumnType type, void* result)
+    {
+        switch (type)
+        {
+            case Column::BOOLEAN:
+                for (std::size_t i = 0; i < batch.count; ++i)
+                {
+                    ((int8_t*)result)[i] = batch.integers[i] != 0;
+                }
+
+                break;
+
+            case Column::INT8: storeIntegers<int8_t>(batch, result); break;
+            case Column::INT16: storeIntegers<int16_t>(batch, result); break;
+            case Column::INT: storeIntegers<int32_t>(batch, result); break;
+            case Column::ULONG: storeIntegers<uint64_t>(batch, result); break;
+
+            case Column::DECIMAL:
+            {
+                const int64_t max = std::numeric_limits<int64_t>::max() / kinetica::DECIMAL_FACTOR;
+
+                for (std::size_t i = 0; i < batch.count; ++i)
+                {
+                    int64_t value = batch.integers[i];
+                    bool isValid = batch.isUnsigned ? (uint64_t)value <= (uint64_t)max : value >= -max && value <= max;
+                    ((int64_t*)result)[i] = isValid ? value * kinetica::DECIMAL_FACTOR : 0;
+                    batch.errors[i] |= !isValid;
+                }
+
+                break;
+            }
+
+            default: storeIntegers<int64_t>(batch, result); break;
+        }
+    }
+
+    // Stores reals truncated toward zero, failing NaNs and values out of the
+    // range of T; both bounds are exclusive, one past the representable range
+    // (for INT64 the lower bound rounds to the minimum itself, which is kept)
+    template<typename T>
+    void storeRealIntegers(Batch& batch, void* result)
+    {
+        const double end = (double)std::numeric_limits<T>::max() + 1.0;
+        const double min = std::numeric_limits<T>::is_signed ? -end - 1.0 : -1.0;
+        const double first = (double)std::numeric_limits<T>::min();
+        T* data = (T*)result;
+
+        for (std::size_t i = 0; i < batch.count; ++i)
+        {
+            double value = batch.reals[i];
+            bool isValid = (value > min || value == first) && value < end;
+            data[i] = isValid ? (T)value : 0;
+            batch.errors[i] |= !isValid;
+        }
+    }
+
+    void storeReals(Batch& batch, const Column::ColumnType type, void* result)
+    {
+        switch (type)
+        {
+            case Column::DOUBLE:
+                std::memcpy(result, &batch.reals[0], batch.count * sizeof(double));
+                break;
+
+            case Column::FLOAT:
+                for (std::size_t i = 0; i < batch.count; ++i)
+                {
+                    // Infinities and NaNs convert; finite values must fit
+                    double value = batch.reals[i];
+                    bool isFinite = value - value == 0;
+                    bool isValid = !isFinite || (value <= std::numeric_limits<float>::max() && value >= -std::numeric_limits<float>::max());
+                    ((float*)result)[i] = isValid ? (float)value : 0;
+                    batch.errors[i] |= !isValid;
+                }
+
+                break;
+
+            case Column::BOOLEAN:
+                for (std::size_t i = 0; i < batch.count; ++i)
+                {
+                    ((int8_t*)result)[i] = batch.reals[i] != 0;
+                }
+
+                break;
+
+            case Column::DECIMAL:
+                for (std::size_t i = 0; i < batch.count; ++i)
+                {
+                    // Rounded half away from zero; NaNs fail the range check
+                    double value = batch.reals[i] * kinetica::DECIMAL_FACTOR;
+                    value = value < 0 ? std::ceil(value - 0.5) : std::floor(value + 0.5);
+                    bool isValid = value >= -9223372036854775808.0 && value < 9223372036854775808.0;
+                    ((int64_t*)result)[i] = isValid ? (int64_t)value : 0;
+                    batch.errors[i] |= !isValid;
+                }
+
+                break;
+
+            case Column::INT8: storeRealIntegers<int8_t>(batch, result); break;
+            case Column::INT16: storeRealIntegers<int16_t>(batch, result); break;
+            case Column::INT: storeRealIntegers<int32_t>(batch, result); break;
+            case Column::ULONG: storeRealIntegers<uint64_t>(batch, result); break;
+            default: storeRealIntegers<int64_t>(batch, result); break;
+        }
+    }
+
+    void storeMilliseconds(Batch& batch, const Column::ColumnType type, void* result)
+    {
+        int64_t* values = &batch.integers[0];
+
+        if (type == Column::TIMESTAMP)
+        {
+            std::memcpy(result, values, batch.count * sizeof(int64_t));
+            return;
+        }
+        else if (type == Column::TIME)
+        {
+            for (std::size_t i = 0; i < batch.count; ++i)
+            {
+                values[i] -= kinetica::floorDivide(values[i], MILLISECONDS_PER_DAY) * MILLISECONDS_PER_DAY;
+            }
+
+            kinetica::fromMillisecondsOfDay(values, batch.count, (kinetica::Time*)result);
+            return;
+        }
+
+        for (std::size_t i = 0; i < batch.count; ++i)
+        {
+            int64_t day = kinetica::floorDivide(values[i], MILLISECONDS_PER_DAY);
+
+            if (day < MIN_EPOCH_DAY || day >= END_EPOCH_DAY)
+            {
+                values[i] = 0;
+                batch.errors[i] = 1;
+            }
+        }
+
+        if (type == Column::DATE)
+        {
+            kinetica::fromEpochMilliseconds(values, batch.count, (kinetica::Date*)result);
+        }
+        else
+        {
+            kinetica::fromEpochMilliseconds(values, batch.count, (kinetica::DateTime*)result);
+        }
+    }
+
+    // Parses the text of each row into a fixed-width column type
+    void storeText(Batch& batch, const Column::ColumnType type, void* result)
+    {
+        std::size_t width = kinetica::getCharNWidth(type);
+
+        for (std::size_t i = 0; i < batch.count; ++i)
+        {
+            const char* start = batch.values[i];
+            const char* end = start + batch.lengths[i];
+
+            if (width != 0)
+            {
+                uint64_t offsets[2] = { 0, batch.lengths[i] };
+                batch.errors[i] = batch.lengths[i] > width;
+                kinetica::stringsToCharN(start, offsets, 1, width, (char*)result + i * width);
+                continue;
+            }
+
+            std::size_t length = end - start;
+            kinetica::trimBlanks(start, length);
+            bool isValid;
+
+            switch (type)
+            {
+                case Column::BOOLEAN:
+                {
+                    int8_t value;
+                    isValid = kinetica::parseBoolean(start, length, value);
+                    batch.integers[i] = isValid ? value : 0;
+                    break;
+                }
+
+                case Column::ULONG:
+                    isValid = kinetica::parseUnsigned(start, length, (uint64_t&)batch.integers[i]);
+                    break;
+
+                case Column::TIMESTAMP:
+                    isValid = kinetica::parseTimestamp(start, length, batch.integers[i]);
+                    break;
+
+                case Column::FLOAT:
+                case Column::DOUBLE:
+                    isValid = kinetica::parseDouble(start, length, batch.reals[i]);
+                    break;
+
+                case Column::DECIMAL:
+                    isValid = kinetica::parseDecimal(start, length, kinetica::DECIMAL_SCALE, ((int64_t*)result)[i]);
+                    break;
+
+                case Column::DATE:
+                {
+                    kinetica::Date& date = ((kinetica::Date*)result)[i];
+                    isValid = kinetica::parseDate(start, length, date);
+                    date = isValid ? date : kinetica::Date();
+                    break;
+                }
+
+                case Column::DATETIME:
+                {
+                    kinetica::DateTime& dateTime = ((kinetica::DateTime*)result)[i];
+                    isValid = kinetica::parseDateTime(start, length, dateTime);
+                    dateTime = isValid ? dateTime : kinetica::DateTime();
+                    break;
+                }
+
+                case Column::TIME:
+                {
+                    kinetica::Time& time = ((kinetica::Time*)result)[i];
+                    isValid = kinetica::parseTime(start, length, time);
+                    time = isValid ? time : kinetica::Time();
+                    break;
+                }
+
+                case Column::IPV4:
+                    isValid = kinetica::parseIPv4(start, length, ((uint32_t*)result)[i]);
+                    break;
+
+                case Column::UUID:
+                    isValid = kinetica::parseUUID(start, length, ((kinetica::UUID*)result)[i]);
+                    break;
+
+                default:
+                    isValid = kinetica::parseSigned(start, length, std::numeric_limits<int64_t>::min(),
+                                                    std::numeric_limits<int64_t>::max(), batch.integers[i]);
+                    break;
+            }
+
+            batch.errors[i] = !isValid;
+
+            if (!isValid)
+            {
+                batch.integers[i] = 0;
+                batch.reals[i] = 0;
+            }
+        }
+
+        if (isInteger(type))
+        {
+            batch.isUnsigned = type == Column::ULONG;
+            storeIntegers(batch, type, result);
+        }
+        else if (isReal(type))
+        {
+            storeReals(batch, type, result);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Tasks
+    //--------------------------------------------------------------------------
+
+    // Converts chunks of the column a batch at a time, into the appended rows
+    // of a fixed-width result or into packed values of a STRING or BYTES one
+    class CastTask : public kinetica::ParallelTask
+    {
+    public:
+        struct Chunk
+        {
+            std::string data;
+            std::vector<uint64_t> offsets;
+            std::vector<uint8_t> nulls;
+            std::vector<std::size_t> errors;
+        };
+
+        std::vector<Chunk> chunks;
+
+        CastTask(const Column& column, OutputColumn& result, const Path path, const std::size_t index, const std::size_t chunkCount) :
+            chunks(chunkCount),
+            m_column(column),
+            m_result(result),
+            m_path(path),
+            m_index(index),
+            m_chunkCount(chunkCount)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            Batch batch;
+            std::size_t start = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index);
+            std::size_t end = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index + 1);
+
+            for (std::size_t position = start; position < end; position += BATCH_SIZE)
+            {
+                batch.start = position;
+                batch.count = std::min(BATCH_SIZE, end - position);
+                convert(batch, chunks[index]);
+            }
+        }
+
+    private:
+        const Column& m_column;
+        OutputColumn& m_result;
+        Path m_path;
+        std::size_t m_index;
+        std::size_t m_chunkCount;
+
+        void convert(Batch& batch, Chunk& chunk)
+        {
+            if (m_column.isNullable())
+            {
+                std::memcpy(&batch.nulls[0], m_column.getNulls() + batch.start, batch.count);
+            }
+            else
+            {
+                std::memset(&batch.nulls[0], 0, batch.count);
+            }
+
+            std::memset(&batch.errors[0], 0, batch.count);
+            Column::ColumnType type = m_result.getType();
+
+            if (isVar(type))
+            {
+                if (m_path == TEXT)
+                {
+                    loadText(m_column, batch);
+                }
+
+                writeVar(batch, chunk);
+                return;
+            }
+
+            std::size_t typeSize = Column::getTypeSize(type);
+            uint8_t* data = m_result.getData<uint8_t>() + (m_index + batch.start) * typeSize;
+
+            switch (m_path)
+            {
+                case COPY:
+                    std::memcpy(data, m_column.getData<uint8_t>() + batch.start * typeSize, batch.count * typeSize);
+                    break;
+
+                case INTEGER:
+                    loadIntegers(m_column, batch);
+                    storeIntegers(batch, type, data);
+                    break;
+
+                case REAL:
+                    loadReals(m_column, batch);
+                    storeReals(batch, type, data);
+                    break;
+
+                case TEMPORAL:
+                    loadMilliseconds(m_column, batch);
+                    storeMilliseconds(batch, type, data);
+                    break;
+
+                default:
+                    loadText(m_column, batch);
+                    storeText(batch, type, data);
+                    break;
+            }
+
+            // Nulls and failed rows are zeroed, and null where possible
+            for (std::size_t i = 0; i < batch.count; ++i)
+            {
+                if (batch.nulls[i] | batch.errors[i])
+                {
+                    if (!batch.nulls[i])
+                    {
+                        chunk.errors.push_back(batch.start + i);
+                    }
+
+                    std::memset(data + i * typeSize, 0, typeSize);
+
+                    if (m_result.isNullable())
+                    {
+                        m_result.setNull(m_index + batch.start + i);
+                    }
+                }
+            }
+        }
+
+        void writeVar(Batch& batch, Chunk& chunk)
+        {
+            bool isString = m_result.getType() == Column::STRING;
+
+            for (std::size_t i = 0; i < batch.count; ++i)
+            {
+                chunk.offsets.push_back(chunk.data.size());
+                chunk.nulls.push_back(batch.nulls[i]);
+
+                if (!batch.nulls[i])
+                {
+                    if (m_path == COPY)
+                    {
+                        const char* value = m_column.getVarValue<char>(batch.start + i);
+                        chunk.data.append(value, m_column.getVarValueSize<char>(batch.start + i));
+                        continue;
+                    }
+
+                    chunk.data.append(batch.values[i], batch.lengths[i]);
+                }
+
+                if (isString)
+                {
+                    chunk.data += '\0';
+                }
+            }
+        }
+    };
+}
+
+namespace kinetica
+{
+    bool canCast(const ProcData::Column::ColumnType from, const ProcData::Column::ColumnType to)
+    {
+        return getPath(from, to) != NO_PATH;
+    }
+
+    std::size_t castColumn(const ProcData::Column& column, ProcData::OutputColumn& result,
+                           std::vector<std::size_t>* errors, const std::size_t threadCount)
+    {
+        Path path = getPath(column.getType(), result.getType());
+
+        if (path == NO_PATH)
+        {
+            throw std::invalid_argument("Cannot cast column " + column.getName() + " to the type of column " + result.getName());
+        }
+
+        std::size_t size = column.getSize();
+        std::size_t threads = threadCount == 0 ? getHardwareThreadCount() : threadCount;
+        std::size_t chunkCount = size >= kinetica::MIN_PARALLEL_SIZE && threads > 1 ? threads * 4 : 1;
+        bool isVarResult = isVar(result.getType());
+        std::size_t index = 0;
+
+        if (!isVarResult)
+        {
+            // Fixed-width rows are appended up front and filled in place
+            index = result.getPos();
+            result.appendValues(size);
+        }
+
+        CastTask castTask(column, result, path, index, chunkCount);
+        runParallel(castTask, chunkCount, threadCount);
+
+        for (std::size_t i = 0; i < chunkCount; ++i)
+        {
+            CastTask::Chunk& chunk = castTask.chunks[i];
+
+            if (isVarResult)
+            {
+                std::size_t count = chunk.offsets.size();
+                std::size_t chunkIndex = result.appendVarValues<char>(chunk.data.data(), chunk.data.size(),
+                                                                      count > 0 ? &chunk.offsets[0] : NULL, count);
+                index = i == 0 ? chunkIndex : index;
+
+                for (std::size_t j = 0; j < count && result.isNullable(); ++j)
+                {
+                    if (chunk.nulls[j])
+                    {
+                        result.setNull(chunkIndex + j);
+                    }
+                }
+            }
+
+            if (errors != NULL)
+            {
+                errors->insert(errors->end(), chunk.errors.begin(), chunk.errors.end());
+            }
+        }
+
+        return index;
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef _KINETICA_CAST_HPP_
+#define _KINETICA_CAST_HPP_
+
+#include "Proc.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace kinetica
+{
+    // Bulk conversion of column values between column types. Supported
+    // conversions are:
+    //
+    // - between any two of the numeric types (BOOLEAN, INT8, INT16, INT,
+    //   LONG, ULONG, TIMESTAMP, DECIMAL, FLOAT and DOUBLE); values out of the
+    //   target range (and NaN to integers) fail, reals and decimals truncate
+    //   toward zero to integers, reals round half away from zero to DECIMAL
+    //   (at DECIMAL_SCALE) and nonzero values are true as BOOLEAN
+    // - between DATE, DATETIME and TIMESTAMP, and from DATETIME and TIMESTAMP
+    //   to TIME (the time of day); dates outside 1000-01-01 to 2900-12-31 fail
+    // - from any type but BYTES to STRING or CHARn, as Column::toString
+    //   formats them except that reals use the fewest digits that read back
+    //   exactly and decimals have their decimal places (as formatDecimal);
+    //   text longer than a CHARn width fails
+    // - from STRING and CHARn to any of the above types, IPV4 and UUID,
+    //   ignoring leading and trailing spaces: integers in decimal, reals as
+    //   strtod reads them, DECIMAL as parseDecimal does, BOOLEAN as true,
+    //   false, 1 or 0 in any case, dates as YYYY-MM-DD, times as
+    //   HH:MM[:SS[.fff]], datetimes as a date optionally followed by a space
+    //   or T and a time, and TIMESTAMP as an integer or a datetime
+    // - from BYTES to STRING or CHARn as hexadecimal
+    // - from any type to itself
+    bool canCast(const ProcData::Column::ColumnType from, const ProcData::Column::ColumnType to);
+
+    // Appends each row of column converted to the type of result, converting
+    // parts of the column in parallel. Nulls stay null. Rows that fail to
+    // convert are null, and appended to errors if given; in a result column
+    // that is not nullable, nulls and failed rows are 0 or empty. The table
+    // of result must already be sized for the rows. Throws
+    // std::invalid_argument if the conversion is not supported. Returns the
+    // index of the first appended row.
+    std::size_t castColumn(const ProcData::Column& column, ProcData::OutputColumn& result,
+                           std::vector<std::size_t>* errors = NULL, const std::size_t threadCount = 0);
+}
+
+#endif
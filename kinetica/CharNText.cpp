@@ -0,0 +1,303 @@
+#include "CharNText.hpp"
+
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+namespace
+{
+    #ifdef __SSE2__
+    inline __m128i reverseBytes(__m128i value)
+    {
+        #ifdef __SSSE3__
+        return _mm_shuffle_epi8(value, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+        #else
+        value = _mm_shuffle_epi32(value, _MM_SHUFFLE(0, 1, 2, 3));
+        value = _mm_shufflelo_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+        value = _mm_shufflehi_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+        return _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+        #endif
+    }
+    #endif
+
+    // Copies width bytes from source to result in reverse order; CharN values
+    // and their text are mirror images of each other
+    inline void reverseCopy(const char* source, const std::size_t width, char* result)
+    {
+        switch (width)
+        {
+            case 1:
+                *result = *source;
+                return;
+
+            case 2:
+            {
+                uint16_t value;
+                std::memcpy(&value, source, 2);
+                value = kinetica::swapBytes(value);
+                std::memcpy(result, &value, 2);
+                return;
+            }
+
+            case 4:
+            {
+                uint32_t value;
+                std::memcpy(&value, source, 4);
+                value = kinetica::swapBytes(value);
+                std::memcpy(result, &value, 4);
+                return;
+            }
+
+            case 8:
+            {
+                uint64_t value;
+                std::memcpy(&value, source, 8);
+                value = kinetica::swapBytes(value);
+                std::memcpy(result, &value, 8);
+                return;
+            }
+        }
+
+        #ifdef __SSE2__
+        for (std::size_t i = 0; i < width; i += 16)
+        {
+            __m128i value = _mm_loadu_si128((const __m128i*)(source + width - 16 - i));
+            _mm_storeu_si128((__m128i*)(result + i), reverseBytes(value));
+        }
+        #else
+        for (std::size_t i = 0; i < width; i += 8)
+        {
+            uint64_t value;
+            std::memcpy(&value, source + width - 8 - i, 8);
+            value = kinetica::swapBytes(value);
+            std::memcpy(result + i, &value, 8);
+        }
+        #endif
+    }
+
+    // Length of NUL-padded text of at most width bytes
+    inline std::size_t getTextLength(const char* text, const std::size_t width)
+    {
+        #ifdef __SSE2__
+        if (width >= 16)
+        {
+            for (std::size_t i = 0; i < width; i += 16)
+            {
+                __m128i value = _mm_loadu_si128((const __m128i*)(text + i));
+                int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(value, _mm_setzero_si128()));
+
+                if (mask != 0)
+                {
+                    return i + __builtin_ctz(mask);
+                }
+            }
+
+            return width;
+        }
+        #endif
+
+        const char* end = (const char*)std::memchr(text, 0, width);
+        return end ? end - text : width;
+    }
+
+    void checkWidth(const std::size_t width)
+    {
+        if (width == 0 || width > 256 || (width & (width - 1)) != 0)
+        {
+            throw std::invalid_argument("Invalid CharN width");
+        }
+    }
+
+    // Appends count uninitialized rows to a CHARn column
+    char* appendRows(kinetica::ProcData::OutputColumn& column, const std::size_t width, const std::size_t count)
+    {
+        switch (width)
+        {
+            case 1: return column.appendValues<kinetica::CharN<1> >(count)->raw;
+            case 2: return column.appendValues<kinetica::CharN<2> >(count)->raw;
+            case 4: return column.appendValues<kinetica::CharN<4> >(count)->raw;
+            case 8: return column.appendValues<kinetica::CharN<8> >(count)->raw;
+            case 16: return column.appendValues<kinetica::CharN<16> >(count)->raw;
+            case 32: return column.appendValues<kinetica::CharN<32> >(count)->raw;
+            case 64: return column.appendValues<kinetica::CharN<64> >(count)->raw;
+            case 128: return column.appendValues<kinetica::CharN<128> >(count)->raw;
+            case 256: return column.appendValues<kinetica::CharN<256> >(count)->raw;
+            default: throw std::invalid_argument("Column " + column.getName() + " is not a CharN column");
+        }
+    }
+
+    std::size_t getColumnWidth(const kinetica::ProcData::Column& column, const std::size_t start, const std::size_t count)
+    {
+        std::size_t width = kinetica::getCharNWidth(column.getType());
+
+        if (width == 0)
+        {
+            throw std::invalid_argument("Column " + column.getName() + " is not a CharN column");
+        }
+
+        if (start + count > column.getSize())
+        {
+            throw std::out_of_range("Row range out of bounds for column " + column.getName());
+        }
+
+        return width;
+    }
+}
+
+namespace kinetica
+{
+    std::size_t getCharNWidth(const ProcData::Column::ColumnType type)
+    {
+        switch (type)
+        {
+            case ProcData::Column::CHAR1: return 1;
+            case ProcData::Column::CHAR2: return 2;
+            case ProcData::Column::CHAR4: return 4;
+            case ProcData::Column::CHAR8: return 8;
+            case ProcData::Column::CHAR16: return 16;
+            case ProcData::Column::CHAR32: return 32;
+            case ProcData::Column::CHAR64: return 64;
+            case ProcData::Column::CHAR128: return 128;
+            case ProcData::Column::CHAR256: return 256;
+            default: return 0;
+        }
+    }
+
+    void charNToText(const void* values, const std::size_t width, const std::size_t count, char* result)
+    {
+        checkWidth(width);
+        const char* source = (const char*)values;
+
+        for (std::size_t i = 0; i < count; ++i, source += width, result += width)
+        {
+            reverseCopy(source, width, result);
+        }
+    }
+
+    void textToCharN(const char* text, const std::size_t width, const std::size_t count, void* result)
+    {
+        checkWidth(width);
+        char* target = (char*)result;
+
+        for (std::size_t i = 0; i < count; ++i, text += width, target += width)
+        {
+            reverseCopy(text, width, target);
+        }
+    }
+
+    std::size_t charNToStrings(const void* values, const std::size_t width, const std::size_t count, char* result, uint64_t* offsets)
+    {
+        checkWidth(width);
+        const char* source = (const char*)values;
+        std::size_t pos = 0;
+
+        for (std::size_t i = 0; i < count; ++i, source += width)
+        {
+            // The full width is written and then overwritten by the next
+            // value, which stays within count * (width + 1) bytes
+            offsets[i] = pos;
+            reverseCopy(source, width, result + pos);
+            pos += getTextLength(result + pos, width);
+            result[pos++] = 0;
+        }
+
+        offsets[count] = pos;
+        return pos;
+    }
+
+    void stringsToCharN(const char* data, const uint64_t* offsets, const std::size_t count, const std::size_t width, void* result)
+    {
+        checkWidth(width);
+        char* target = (char*)result;
+        char buffer[256];
+
+        for (std::size_t i = 0; i < count; ++i, target += width)
+        {
+            std::size_t length = offsets[i + 1] - offsets[i];
+
+            if (length >= width)
+            {
+                reverseCopy(data + offsets[i], width, target);
+            }
+            else
+            {
+                std::memcpy(buffer, data + offsets[i], length);
+                std::memset(buffer + length, 0, width - length);
+                reverseCopy(buffer, width, target);
+            }
+        }
+    }
+
+    void getCharNText(const ProcData::Column& column, const std::size_t start, const std::size_t count, char* result)
+    {
+        std::size_t width = getColumnWidth(column, start, count);
+        charNToText(column.getData<char>() + start * width, width, count, result);
+
+        if (column.isNullable())
+        {
+            const uint8_t* nulls = column.getNulls() + start;
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                if (nulls[i])
+                {
+                    std::memset(result + i * width, 0, width);
+                }
+            }
+        }
+    }
+
+    std::size_t getCharNStrings(const ProcData::Column& column, const std::size_t start, const std::size_t count, char* result, uint64_t* offsets)
+    {
+        std::size_t width = getColumnWidth(column, start, count);
+
+        if (!column.isNullable())
+        {
+            return charNToStrings(column.getData<char>() + start * width, width, count, result, offsets);
+        }
+
+        const char* source = column.getData<char>() + start * width;
+        const uint8_t* nulls = column.getNulls() + start;
+        std::size_t pos = 0;
+
+        for (std::size_t i = 0; i < count; ++i, source += width)
+        {
+            offsets[i] = pos;
+
+            if (!nulls[i])
+            {
+                reverseCopy(source, width, result + pos);
+                pos += getTextLength(result + pos, width);
+            }
+
+            result[pos++] = 0;
+        }
+
+        offsets[count] = pos;
+        return pos;
+    }
+
+    std::size_t appendCharNText(ProcData::OutputColumn& column, const char* text, const std::size_t count)
+    {
+        std::size_t width = getCharNWidth(column.getType());
+        std::size_t index = column.getPos();
+        char* data = appendRows(column, width, count);
+        textToCharN(text, width, count, data);
+        return index;
+    }
+
+    std::size_t appendCharNStrings(ProcData::OutputColumn& column, const char* data, const uint64_t* offsets, const std::size_t count)
+    {
+        std::size_t width = getCharNWidth(column.getType());
+        std::size_t index = column.getPos();
+        char* values = appendRows(column, width, count);
+        stringsToCharN(data, offsets, count, width, values);
+        return index;
+    }
+}
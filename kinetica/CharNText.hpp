@@ -0,0 +1,40 @@
+#ifndef _KINETICA_CHARN_TEXT_HPP_
+#define _KINETICA_CHARN_TEXT_HPP_
+
+#include "Proc.hpp"
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace kinetica
+{
+    // Bulk conversion between CharN values, which store their characters in
+    // reverse order, and plain text. Text is either fixed-stride (width bytes
+    // per value, NUL-padded) or packed NUL-terminated strings, where value i
+    // starts at offsets[i] and offsets[count] is the total size; packed
+    // strings can be appended directly to a STRING column with
+    // appendVarValues(data, offsets[count], offsets, count).
+
+    // Width of a CHAR1 to CHAR256 column type, or 0 for other types
+    std::size_t getCharNWidth(const ProcData::Column::ColumnType type);
+
+    // values holds count CharN values of the given width (1, 2, 4, ..., 256)
+    void charNToText(const void* values, const std::size_t width, const std::size_t count, char* result);
+    void textToCharN(const char* text, const std::size_t width, const std::size_t count, void* result);
+
+    // result must hold count * (width + 1) bytes; offsets receives count + 1
+    // entries. Returns the total size.
+    std::size_t charNToStrings(const void* values, const std::size_t width, const std::size_t count, char* result, uint64_t* offsets);
+
+    // Value i spans offsets[i] to offsets[i + 1] and is truncated to width
+    void stringsToCharN(const char* data, const uint64_t* offsets, const std::size_t count, const std::size_t width, void* result);
+
+    // Column forms of the above for rows [start, start + count) of a CHARn
+    // column. Nulls convert to empty strings.
+    void getCharNText(const ProcData::Column& column, const std::size_t start, const std::size_t count, char* result);
+    std::size_t getCharNStrings(const ProcData::Column& column, const std::size_t start, const std::size_t count, char* result, uint64_t* offsets);
+    std::size_t appendCharNText(ProcData::OutputColumn& column, const char* text, const std::size_t count);
+    std::size_t appendCharNStrings(ProcData::OutputColumn& column, const char* data, const uint64_t* offsets, const std::size_t count);
+}
+
+#endif
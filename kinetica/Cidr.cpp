@@ -0,0 +1,584 @@
+#include "Cidr.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    typedef kinetica::ProcData::Column Column;
+    typedef kinetica::CidrTable CidrTable;
+
+    // Marks direct table entries that index split /16s; ids are below it
+    const uint32_t RANGE_FLAG = 0x80000000;
+
+    const uint32_t CHUNK_SIZE = 0x10000;
+
+    // Addresses looked up together by the batch lookup
+    const std::size_t BATCH_SIZE = 32;
+
+    struct Prefix
+    {
+        uint32_t address;
+        uint32_t length;
+        uint32_t id;
+    };
+
+    // Shorter prefixes of the same address first, then in id order
+    bool isBefore(const Prefix& a, const Prefix& b)
+    {
+        if (a.address != b.address)
+        {
+            return a.address < b.address;
+        }
+
+        return a.length != b.length ? a.length < b.length : a.id < b.id;
+    }
+
+    bool isShorter(const Prefix& a, const Prefix& b)
+    {
+        return a.length < b.length;
+    }
+
+    inline uint32_t getMask(const uint32_t length)
+    {
+        return length == 0 ? 0 : 0xffffffff << (32 - length);
+    }
+
+    inline bool isSpace(const char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == ',';
+    }
+
+    bool readNumber(const char*& pos, const char* end, const unsigned max, unsigned& value)
+    {
+        const char* start = pos;
+        value = 0;
+
+        while (pos < end && pos - start < 3 && *pos >= '0' && *pos <= '9')
+        {
+            value = value * 10 + (*pos++ - '0');
+        }
+
+        return pos > start && value <= max;
+    }
+
+    CidrTable::Network parseNetwork(const char* start, const char* end)
+    {
+        const char* pos = start;
+        CidrTable::Network network;
+        network.address = 0;
+        network.prefixLength = 32;
+
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            unsigned octet;
+
+            if ((i > 0 && (pos == end || *pos++ != '.')) || !readNumber(pos, end, 255, octet))
+            {
+                throw std::invalid_argument("Invalid CIDR network: " + std::string(start, end));
+            }
+
+            network.address = (network.address << 8) | octet;
+        }
+
+        if (pos < end && *pos == '/')
+        {
+            ++pos;
+            unsigned length;
+
+            if (!readNumber(pos, end, 32, length))
+            {
+                throw std::invalid_argument("Invalid CIDR network: " + std::string(start, end));
+            }
+
+            network.prefixLength = length;
+        }
+
+        if (pos != end)
+        {
+            throw std::invalid_argument("Invalid CIDR network: " + std::string(start, end));
+        }
+
+        return network;
+    }
+
+    //--------------------------------------------------------------------------
+    // Lookup
+    //--------------------------------------------------------------------------
+
+    class FindTask : public kinetica::ParallelTask
+    {
+    public:
+        FindTask(const CidrTable& table, const Column& addresses, uint32_t* ids, const std::size_t chunkCount) :
+            m_table(table),
+            m_addresses(addresses),
+            m_ids(ids),
+            m_chunkCount(chunkCount)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            std::size_t start = kinetica::getRangeStart(m_addresses.getSize(), m_chunkCount, index);
+            std::size_t end = kinetica::getRangeStart(m_addresses.getSize(), m_chunkCount, index + 1);
+            m_table.find(m_addresses.getData<uint32_t>() + start, end - start, m_ids + start);
+
+            if (m_addresses.isNullable())
+            {
+                const uint8_t* nulls = m_addresses.getNulls();
+
+                for (std::size_t i = start; i < end; ++i)
+                {
+                    if (nulls[i])
+                    {
+                        m_ids[i] = CidrTable::NOT_FOUND;
+                    }
+                }
+            }
+        }
+
+    private:
+        const CidrTable& m_table;
+        const Column& m_addresses;
+        uint32_t* m_ids;
+        std::size_t m_chunkCount;
+    };
+
+    void findAll(const CidrTable& table, const Column& addresses, uint32_t* ids, const std::size_t threadCount)
+    {
+        if (addresses.getType() != Column::IPV4)
+        {
+            throw std::invalid_argument("Column " + addresses.getName() + " must be IPV4");
+        }
+
+        std::size_t threads = threadCount == 0 ? kinetica::getHardwareThreadCount() : threadCount;
+        std::size_t chunkCount = addresses.getSize() >= kinetica::MIN_PARALLEL_SIZE && threads > 1 ? threads * 4 : 1;
+        FindTask findTask(table, addresses, ids, chunkCount);
+        kinetica::runParallel(findTask, chunkCount, threadCount);
+    }
+}
+
+namespace kinetica
+{
+    const uint32_t CidrTable::NOT_FOUND;
+
+    CidrTable::CidrTable(const std::vector<Network>& networks)
+    {
+        build(networks, NULL);
+    }
+
+    CidrTable::CidrTable(const std::string& networks)
+    {
+        std::vector<Network> parsed;
+        const char* pos = networks.data();
+        const char* end = pos + networks.size();
+
+        while (pos < end)
+        {
+            if (isSpace(*pos))
+            {
+                ++pos;
+                continue;
+            }
+
+            const char* start = pos;
+
+            while (pos < end && !isSpace(*pos))
+            {
+                ++pos;
+            }
+
+            parsed.push_back(parseNetwork(start, pos));
+        }
+
+        build(parsed, NULL);
+    }
+
+    CidrTable::CidrTable(const std::vector<uint8_t>& networks)
+    {
+        if (networks.size() % sizeof(Network) != 0)
+        {
+            throw std::invalid_argument("CIDR networks must be a multiple of the network size");
+        }
+
+        std::vector<Network> values(networks.size() / sizeof(Network));
+
+        if (!values.empty())
+        {
+            std::memcpy(&values[0], &networks[0], networks.size());
+        }
+
+        build(values, NULL);
+    }
+
+    CidrTable::CidrTable(const ProcData::Column& networks)
+    {
+        if (networks.getType() != ProcData::Column::STRING)
+        {
+            throw std::invalid_argument("Column " + networks.getName() + " must be STRING");
+        }
+
+        const uint8_t* nulls = networks.isNullable() ? networks.getNulls() : NULL;
+        std::vector<Network> parsed(networks.getSize());
+
+        for (std::size_t i = 0; i < networks.getSize(); ++i)
+        {
+            if (nulls != NULL && nulls[i])
+            {
+                continue;
+            }
+
+            const char* start = networks.getVarValue<char>(i);
+            const char* end = start + networks.getVarValueSize<char>(i);
+
+            // Values end with a NUL, and may be padded with spaces
+            while (end > start && (end[-1] == '\0' || end[-1] == ' '))
+            {
+                --end;
+            }
+
+            while (start < end && *start == ' ')
+            {
+                ++start;
+            }
+
+            parsed[i] = parseNetwork(start, end);
+        }
+
+        build(parsed, nulls);
+    }
+
+    std::size_t CidrTable::getSize() const
+    {
+        return m_size;
+    }
+
+    // Index of the last range of a split /16 starting at or before the low
+    // bits of an address; the first range of each /16 starts at 0
+    inline std::size_t CidrTable::findRange(const uint32_t chunk, const uint32_t address) const
+    {
+        std::size_t first = m_chunkStarts[chunk];
+        std::size_t count = m_chunkStarts[chunk + 1] - first;
+        const uint16_t* starts = &m_rangeStarts[first];
+        uint16_t low = (uint16_t)address;
+
+        while (count > 1)
+        {
+            std::size_t half = count / 2;
+            starts = starts[half] <= low ? starts + half : starts;
+            count -= half;
+        }
+
+        return starts - &m_rangeStarts[0];
+    }
+
+    uint32_t CidrTable::find(const uint32_t address) const
+    {
+        uint32_t entry = m_directs[address >> 16];
+        return entry < RANGE_FLAG || entry == NOT_FOUND ? entry : m_rangeIds[findRange(entry - RANGE_FLAG, address)];
+    }
+
+    void CidrTable::find(const uint32_t* addresses, const std::size_t count, uint32_t* ids) const
+    {
+        // Addresses are looked up in batches, first in the direct table
+        // (prefetching the ranges of split /16s) and then in the ranges, so
+        // that the cache misses of a batch overlap
+        std::size_t splits[BATCH_SIZE];
+        std::size_t ranges[BATCH_SIZE];
+
+        for (std::size_t i = 0; i < count; i += BATCH_SIZE)
+        {
+            std::size_t size = std::min(count - i, BATCH_SIZE);
+            std::size_t splitCount = 0;
+            std::size_t j = 0;
+
+            #ifdef __AVX2__
+            // Gathers eight direct table entries at a time
+            const int* directs = (const int*)&m_directs[0];
+            const __m256i notFound = _mm256_set1_epi32(-1);
+
+            for (; j + 8 <= size; j += 8)
+            {
+                __m256i values = _mm256_loadu_si256((const __m256i*)(addresses + i + j));
+                __m256i entries = _mm256_i32gather_epi32(directs, _mm256_srli_epi32(values, 16), 4);
+                _mm256_storeu_si256((__m256i*)(ids + i + j), entries);
+
+                // Sign bit of entries at or past RANGE_FLAG other than NOT_FOUND
+                __m256i split = _mm256_andnot_si256(_mm256_cmpeq_epi32(entries, notFound), entries);
+                unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(split));
+
+                while (mask != 0)
+                {
+                    std::size_t lane = (std::size_t)__builtin_ctz(mask);
+                    splits[splitCount++] = j + lane;
+                    __builtin_prefetch(&m_rangeStarts[m_chunkStarts[ids[i + j + lane] - RANGE_FLAG]]);
+                    mask &= mask - 1;
+                }
+            }
+            #endif
+
+            for (; j < size; ++j)
+            {
+                uint32_t entry = m_directs[addresses[i + j] >> 16];
+                ids[i + j] = entry;
+
+                if (entry >= RANGE_FLAG && entry != NOT_FOUND)
+                {
+                    splits[splitCount++] = j;
+                    __builtin_prefetch(&m_rangeStarts[m_chunkStarts[entry - RANGE_FLAG]]);
+                }
+            }
+
+            for (std::size_t k = 0; k < splitCount; ++k)
+            {
+                j = splits[k];
+                ranges[k] = findRange(ids[i + j] - RANGE_FLAG, addresses[i + j]);
+                __builtin_prefetch(&m_rangeIds[ranges[k]]);
+            }
+
+            for (std::size_t k = 0; k < splitCount; ++k)
+            {
+                ids[i + splits[k]] = m_rangeIds[ranges[k]];
+            }
+        }
+    }
+
+    void CidrTable::find(const ProcData::Column& addresses, std::vector<uint32_t>& ids, const std::size_t threadCount) const
+    {
+        ids.resize(addresses.getSize());
+
+        if (!ids.empty())
+        {
+            findAll(*this, addresses, &ids[0], threadCount);
+        }
+    }
+
+    std::size_t CidrTable::appendIds(const ProcData::Column& addresses, ProcData::OutputColumn& result,
+                                     const std::size_t threadCount) const
+    {
+        if (result.getType() != ProcData::Column::INT)
+        {
+            throw std::invalid_argument("Column " + result.getName() + " must be INT");
+        }
+
+        if (addresses.getType() != ProcData::Column::IPV4)
+        {
+            throw std::invalid_argument("Column " + addresses.getName() + " must be IPV4");
+        }
+
+        std::size_t count = addresses.getSize();
+        std::size_t index = result.getPos();
+        uint32_t* ids = result.appendValues<uint32_t>(count);
+
+        if (count == 0)
+        {
+            return index;
+        }
+
+        // NOT_FOUND is -1 as an INT
+        findAll(*this, addresses, ids, threadCount);
+
+        if (result.isNullable())
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                if (ids[i] == NOT_FOUND)
+                {
+                    result.setNull(index + i);
+                }
+            }
+        }
+
+        return index;
+    }
+
+    std::size_t CidrTable::appendAttributes(const ProcData::Column& addresses,
+                                            const std::vector<const ProcData::Column*>& attributes,
+                                            const std::vector<ProcData::OutputColumn*>& results,
+                                            const std::size_t threadCount) const
+    {
+        if (attributes.size() != results.size())
+        {
+            throw std::invalid_argument("There must be one result column per attribute column");
+        }
+
+        for (std::size_t i = 0; i < attributes.size(); ++i)
+        {
+            if (results[i]->getType() != attributes[i]->getType())
+            {
+                throw std::invalid_argument("Column " + results[i]->getName() + " does not match column " + attributes[i]->getName());
+            }
+
+            if (!results[i]->isNullable())
+            {
+                throw std::invalid_argument("Column " + results[i]->getName() + " must be nullable");
+            }
+
+            if (attributes[i]->getSize() < m_size)
+            {
+                throw std::invalid_argument("Column " + attributes[i]->getName() + " must have a row per network");
+            }
+        }
+
+        std::vector<uint32_t> ids;
+        find(addresses, ids, threadCount);
+        std::vector<std::size_t> rows(ids.size());
+
+        for (std::size_t i = 0; i < ids.size(); ++i)
+        {
+            rows[i] = ids[i] == NOT_FOUND ? ProcData::OutputColumn::NO_ROW : ids[i];
+        }
+
+        std::size_t index = 0;
+
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            index = results[i]->appendRows(*attributes[i], rows.empty() ? NULL : &rows[0], rows.size());
+        }
+
+        return index;
+    }
+
+    void CidrTable::build(const std::vector<Network>& networks, const uint8_t* nulls)
+    {
+        if (networks.size() >= RANGE_FLAG)
+        {
+            throw std::invalid_argument("Too many CIDR networks");
+        }
+
+        m_size = networks.size();
+        std::vector<Prefix> prefixes;
+        prefixes.reserve(networks.size());
+
+        for (std::size_t i = 0; i < networks.size(); ++i)
+        {
+            if (networks[i].prefixLength > 32)
+            {
+                throw std::invalid_argument("Invalid CIDR prefix length");
+            }
+
+            if (nulls == NULL || !nulls[i])
+            {
+                Prefix prefix;
+                prefix.length = networks[i].prefixLength;
+                prefix.address = networks[i].address & getMask(prefix.length);
+                prefix.id = (uint32_t)i;
+                prefixes.push_back(prefix);
+            }
+        }
+
+        // Drops repeated prefixes, keeping the first
+        std::sort(prefixes.begin(), prefixes.end(), isBefore);
+        std::size_t count = 0;
+
+        for (std::size_t i = 0; i < prefixes.size(); ++i)
+        {
+            if (count == 0 || prefixes[i].address != prefixes[count - 1].address
+                || prefixes[i].length != prefixes[count - 1].length)
+            {
+                prefixes[count++] = prefixes[i];
+            }
+        }
+
+        prefixes.resize(count);
+
+        // Prefixes of up to 16 bits fill the direct table in order of
+        // length, so that longer ones overwrite the shorter ones they are
+        // within
+        std::vector<Prefix> shortPrefixes;
+        std::vector<Prefix> longPrefixes;
+
+        for (std::size_t i = 0; i < prefixes.size(); ++i)
+        {
+            (prefixes[i].length <= 16 ? shortPrefixes : longPrefixes).push_back(prefixes[i]);
+        }
+
+        std::stable_sort(shortPrefixes.begin(), shortPrefixes.end(), isShorter);
+        m_directs.assign(CHUNK_SIZE, NOT_FOUND);
+
+        for (std::size_t i = 0; i < shortPrefixes.size(); ++i)
+        {
+            std::vector<uint32_t>::iterator first = m_directs.begin() + (shortPrefixes[i].address >> 16);
+            std::fill(first, first + (1u << (16 - shortPrefixes[i].length)), shortPrefixes[i].id);
+        }
+
+        // Longer prefixes split their /16s into ranges. They are in address
+        // order, enclosing prefixes first, so each /16 is swept once keeping
+        // the (end, id) of the prefixes enclosing the current address.
+        m_chunkStarts.clear();
+        m_rangeStarts.clear();
+        m_rangeIds.clear();
+        std::vector<std::pair<uint32_t, uint32_t> > enclosing;
+
+        for (std::size_t i = 0; i < longPrefixes.size();)
+        {
+            uint32_t chunk = longPrefixes[i].address >> 16;
+            uint32_t base = m_directs[chunk];
+            std::size_t first = m_rangeStarts.size();
+            addRange(first, 0, base);
+
+            for (; i < longPrefixes.size() && longPrefixes[i].address >> 16 == chunk; ++i)
+            {
+                uint32_t start = longPrefixes[i].address & (CHUNK_SIZE - 1);
+
+                while (!enclosing.empty() && enclosing.back().first <= start)
+                {
+                    uint32_t end = enclosing.back().first;
+                    enclosing.pop_back();
+                    addRange(first, end, enclosing.empty() ? base : enclosing.back().second);
+                }
+
+                enclosing.push_back(std::make_pair(start + (1u << (32 - longPrefixes[i].length)), longPrefixes[i].id));
+                addRange(first, start, longPrefixes[i].id);
+            }
+
+            while (!enclosing.empty())
+            {
+                uint32_t end = enclosing.back().first;
+                enclosing.pop_back();
+
+                if (end < CHUNK_SIZE)
+                {
+                    addRange(first, end, enclosing.empty() ? base : enclosing.back().second);
+                }
+            }
+
+            m_directs[chunk] = RANGE_FLAG + (uint32_t)m_chunkStarts.size();
+            m_chunkStarts.push_back((uint32_t)first);
+        }
+
+        m_chunkStarts.push_back((uint32_t)m_rangeStarts.size());
+    }
+
+    // Appends a range to those of a /16 starting at first, replacing a range
+    // at the same start and merging with a previous range of the same id
+    void CidrTable::addRange(const std::size_t first, const uint32_t start, const uint32_t id)
+    {
+        std::size_t size = m_rangeStarts.size();
+
+        if (size > first && m_rangeStarts[size - 1] == start)
+        {
+            if (size - 1 > first && m_rangeIds[size - 2] == id)
+            {
+                m_rangeStarts.pop_back();
+                m_rangeIds.pop_back();
+            }
+            else
+            {
+                m_rangeIds[size - 1] = id;
+            }
+        }
+        else if (size == first || m_rangeIds[size - 1] != id)
+        {
+            m_rangeStarts.push_back((uint16_t)start);
+            m_rangeIds.push_back(id);
+        }
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef _KINETICA_CIDR_HPP_
+#define _KINETICA_CIDR_HPP_
+
+#include "Proc.hpp"
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace kinetica
+{
+    // Longest-prefix match of IPV4 values against a list of CIDR networks,
+    // each identified by its position in the list. The list is compiled into
+    // a DXR-style table: a direct table indexed by the top 16 bits of an
+    // address holds the network of each /16 outright, or for /16s split by
+    // longer prefixes the start of a sorted run of ranges over the low 16
+    // bits, searched branch-free. Lookups of a column are batched so that
+    // their cache misses overlap, and with AVX2 the direct table entries are
+    // gathered eight at a time.
+    class CidrTable
+    {
+    public:
+        // Id of an address in none of the networks
+        static const uint32_t NOT_FOUND = 0xffffffff;
+
+        struct Network
+        {
+            uint32_t address;
+            uint32_t prefixLength;
+        };
+
+        // Host bits past the prefix of each network are ignored, and of
+        // repeated networks the first is matched. Throws
+        // std::invalid_argument if a prefix length is over 32.
+        explicit CidrTable(const std::vector<Network>& networks);
+
+        // Networks written as a.b.c.d/n (a.b.c.d alone being a /32) and
+        // separated by commas or whitespace, e.g. from ProcData::getParams.
+        // Throws std::invalid_argument if a network is not valid.
+        explicit CidrTable(const std::string& networks);
+
+        // Networks packed as Network values in host byte order, e.g. from
+        // ProcData::getBinParams. Throws std::invalid_argument if they are
+        // not a whole number of networks or a prefix length is over 32.
+        explicit CidrTable(const std::vector<uint8_t>& networks);
+
+        // Networks written as above in the rows of a STRING column, each
+        // identified by its row; null rows match nothing
+        explicit CidrTable(const ProcData::Column& networks);
+
+        // Number of networks, including null and repeated ones
+        std::size_t getSize() const;
+
+        // Id of the longest network containing an address, or NOT_FOUND
+        uint32_t find(const uint32_t address) const;
+
+        // Sets ids to the ids of count addresses
+        void find(const uint32_t* addresses, const std::size_t count, uint32_t* ids) const;
+
+        // Sets ids to the id of each row of an IPV4 column, NOT_FOUND for
+        // null rows, looking up parts of the column in parallel. Throws
+        // std::invalid_argument if the column is not IPV4.
+        void find(const ProcData::Column& addresses, std::vector<uint32_t>& ids, const std::size_t threadCount = 0) const;
+
+        // Appends the id of each row of addresses to an INT result column:
+        // null if it matches nothing and result is nullable, otherwise -1.
+        // The table of result must already be sized for the rows. Returns the
+        // index of the first appended row.
+        std::size_t appendIds(const ProcData::Column& addresses, ProcData::OutputColumn& result,
+                              const std::size_t threadCount = 0) const;
+
+        // Appends to each result column the value of the matching attribute
+        // column at the row of the network each address matches (so row i of
+        // an attribute column describes network i), or null if there is
+        // none. Result columns must be nullable and of the types of their
+        // attribute columns, and their tables already sized for the rows.
+        // Throws std::invalid_argument if they are not, or if an attribute
+        // column has fewer rows than there are networks. Returns the index of
+        // the first appended row.
+        std::size_t appendAttributes(const ProcData::Column& addresses,
+                                     const std::vector<const ProcData::Column*>& attributes,
+                                     const std::vector<ProcData::OutputColumn*>& results,
+                                     const std::size_t threadCount = 0) const;
+
+    private:
+        std::size_t m_size;
+
+        // Id of each /16, or RANGE_FLAG plus the index of its ranges
+        std::vector<uint32_t> m_directs;
+
+        // Start of the ranges of each split /16 in m_rangeStarts, and the
+        // end of the last
+        std::vector<uint32_t> m_chunkStarts;
+
+        // Low 16 bits of the first address of each range, and its id
+        std::vector<uint16_t> m_rangeStarts;
+        std::vector<uint32_t> m_rangeIds;
+
+        // Null networks (where nulls is set) match nothing
+        void build(const std::vector<Network>& networks, const uint8_t* nulls);
+
+        std::size_t findRange(const uint32_t chunk, const uint32_t address) const;
+        void addRange(const std::size_t first, const uint32_t start, const uint32_t id);
+    };
+}
+
+#endif
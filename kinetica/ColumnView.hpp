@@ -0,0 +1,454 @@
+#ifndef _KINETICA_COLUMN_VIEW_HPP_
+#define _KINETICA_COLUMN_VIEW_HPP_
+
+#include "Parallel.hpp"
+#include "Proc.hpp"
+
+#include <cstddef>
+#include <stdexcept>
+#include <stdint.h>
+
+namespace kinetica
+{
+    // Expression templates over typed views of fixed-width columns. Arithmetic
+    // on views and scalars builds a lazy expression that assign evaluates in
+    // a single loop over the rows, which the compiler can vectorize, straight
+    // into an output column with no intermediate buffers:
+    //
+    //     ColumnView<double> a(input[0]), b(input[1]), c(input[2]);
+    //     OutputView result(output[0]);
+    //     result = a * b + c;
+    //
+    // Operands are promoted as in C++ (INT8 and INT16 values to int32_t, and
+    // mixed types to the wider or floating-point type), except that integer
+    // division by zero yields 0 and signed integer arithmetic wraps around
+    // on overflow, as in Expression. A row of an expression is null if any
+    // of its column values is.
+
+    // Value types of views: the column types they read, their type for
+    // arithmetic, and a rank for promoting mixed operands
+    template<typename T> struct ViewTraits {};
+
+    template<typename T> class ScalarView;
+
+    template<> struct ViewTraits<int8_t>
+    {
+        typedef int32_t Arithmetic;
+        typedef ScalarView<int32_t> Scalar;
+        static const int RANK = 0;
+        static bool isColumnType(const ProcData::Column::ColumnType type) { return type == ProcData::Column::INT8 || type == ProcData::Column::BOOLEAN; }
+    };
+
+    template<> struct ViewTraits<int16_t>
+    {
+        typedef int32_t Arithmetic;
+        typedef ScalarView<int32_t> Scalar;
+        static const int RANK = 1;
+        static bool isColumnType(const ProcData::Column::ColumnType type) { return type == ProcData::Column::INT16; }
+    };
+
+    template<> struct ViewTraits<int32_t>
+    {
+        typedef int32_t Arithmetic;
+        typedef ScalarView<int32_t> Scalar;
+        static const int RANK = 2;
+        static bool isColumnType(const ProcData::Column::ColumnType type) { return type == ProcData::Column::INT; }
+    };
+
+    // Only for scalars, as no column type holds unsigned 32-bit values
+    template<> struct ViewTraits<uint32_t>
+    {
+        typedef uint32_t Arithmetic;
+        typedef ScalarView<uint32_t> Scalar;
+        static const int RANK = 3;
+        static bool isColumnType(const ProcData::Column::ColumnType) { return false; }
+    };
+
+    template<> struct ViewTraits<int64_t>
+    {
+        typedef int64_t Arithmetic;
+        typedef ScalarView<int64_t> Scalar;
+        static const int RANK = 4;
+        static bool isColumnType(const ProcData::Column::ColumnType type) { return type == ProcData::Column::LONG || type == ProcData::Column::TIMESTAMP; }
+    };
+
+    template<> struct ViewTraits<uint64_t>
+    {
+        typedef uint64_t Arithmetic;
+        typedef ScalarView<uint64_t> Scalar;
+        static const int RANK = 5;
+        static bool isColumnType(const ProcData::Column::ColumnType type) { return type == ProcData::Column::ULONG; }
+    };
+
+    // long long and unsigned long long, where they are distinct types from
+    // int64_t and uint64_t (as on LP64), so that literals such as 2LL work as
+    // scalars; otherwise these specialize an unused placeholder type
+    template<typename T, typename U> struct ViewDistinct { typedef T Type; };
+    template<typename T> struct ViewDistinct<T, T> { struct Type {}; };
+
+    // Only for scalars, as columns are read through the fixed-width types
+    template<> struct ViewTraits<ViewDistinct<long long, int64_t>::Type>
+    {
+        typedef int64_t Arithmetic;
+        typedef ScalarView<int64_t> Scalar;
+        static const int RANK = 4;
+        static bool isColumnType(const ProcData::Column::ColumnType) { return false; }
+    };
+
+    template<> struct ViewTraits<ViewDistinct<unsigned long long, uint64_t>::Type>
+    {
+        typedef uint64_t Arithmetic;
+        typedef ScalarView<uint64_t> Scalar;
+        static const int RANK = 5;
+        static bool isColumnType(const ProcData::Column::ColumnType) { return false; }
+    };
+
+    template<> struct ViewTraits<float>
+    {
+        typedef float Arithmetic;
+        typedef ScalarView<float> Scalar;
+        static const int RANK = 6;
+        static bool isColumnType(const ProcData::Column::ColumnType type) { return type == ProcData::Column::FLOAT; }
+    };
+
+    template<> struct ViewTraits<double>
+    {
+        typedef double Arithmetic;
+        typedef ScalarView<double> Scalar;
+        static const int RANK = 7;
+        static bool isColumnType(const ProcData::Column::ColumnType type) { return type == ProcData::Column::DOUBLE; }
+    };
+
+    template<bool C, typename A, typename B> struct ViewSelect { typedef A Type; };
+    template<typename A, typename B> struct ViewSelect<false, A, B> { typedef B Type; };
+
+    // Type of arithmetic on values of types A and B
+    template<typename A, typename B>
+    struct ViewPromote
+    {
+        typedef typename ViewTraits<A>::Arithmetic PromotedA;
+        typedef typename ViewTraits<B>::Arithmetic PromotedB;
+        typedef typename ViewSelect<(ViewTraits<PromotedA>::RANK >= ViewTraits<PromotedB>::RANK), PromotedA, PromotedB>::Type Type;
+    };
+
+    // Size of views that match any size
+    const std::size_t ANY_VIEW_SIZE = (std::size_t)-1;
+
+    // Base of all views, E being the view type. Views have a ValueType, a
+    // size, operator[] giving the value of a row, and isNullable and isNull.
+    template<typename E>
+    struct View
+    {
+        const E& get() const
+        {
+            return static_cast<const E&>(*this);
+        }
+    };
+
+    // Values of a fixed-width column read as T, which must be the column's
+    // value type: int8_t (INT8 and BOOLEAN), int16_t, int32_t (INT), int64_t
+    // (LONG and TIMESTAMP), uint64_t (ULONG), float or double
+    template<typename T>
+    class ColumnView : public View<ColumnView<T> >
+    {
+    public:
+        typedef T ValueType;
+
+        explicit ColumnView(const ProcData::Column& column) :
+            m_data(column.getData<T>()),
+            m_nulls(column.isNullable() ? column.getNulls() : NULL),
+            m_size(column.getSize())
+        {
+            if (!ViewTraits<T>::isColumnType(column.getType()))
+            {
+                throw std::invalid_argument("Column " + column.getName() + " does not have the view's value type");
+            }
+        }
+
+        std::size_t getSize() const { return m_size; }
+        bool isNullable() const { return m_nulls != NULL; }
+        T operator [](const std::size_t index) const { return m_data[index]; }
+        bool isNull(const std::size_t index) const { return m_nulls != NULL && m_nulls[index] != 0; }
+
+    private:
+        const T* m_data;
+        const uint8_t* m_nulls;
+        std::size_t m_size;
+    };
+
+    template<typename T>
+    class ScalarView : public View<ScalarView<T> >
+    {
+    public:
+        typedef T ValueType;
+
+        ScalarView(const T value) :
+            m_value(value)
+        {
+        }
+
+        std::size_t getSize() const { return ANY_VIEW_SIZE; }
+        bool isNullable() const { return false; }
+        T operator [](const std::size_t) const { return m_value; }
+        bool isNull(const std::size_t) const { return false; }
+
+    private:
+        T m_value;
+    };
+
+    // Integer division by zero yields 0; division by -1 negates to avoid
+    // trapping on the minimum value
+    inline float divideValues(const float a, const float b) { return a / b; }
+    inline double divideValues(const double a, const double b) { return a / b; }
+    inline uint32_t divideValues(const uint32_t a, const uint32_t b) { return b == 0 ? 0 : a / b; }
+    inline uint64_t divideValues(const uint64_t a, const uint64_t b) { return b == 0 ? 0 : a / b; }
+
+    inline int32_t divideValues(const int32_t a, const int32_t b)
+    {
+        return b == 0 ? 0 : b == -1 ? (int32_t)(0 - (uint32_t)a) : a / b;
+    }
+
+    inline int64_t divideValues(const int64_t a, const int64_t b)
+    {
+        return b == 0 ? 0 : b == -1 ? (int64_t)(0 - (uint64_t)a) : a / b;
+    }
+
+    // Signed integers are added, subtracted, multiplied and negated as the
+    // unsigned type of their width, so that overflow wraps around
+    template<typename T> inline T addValues(const T a, const T b) { return a + b; }
+    template<typename T> inline T subtractValues(const T a, const T b) { return a - b; }
+    template<typename T> inline T multiplyValues(const T a, const T b) { return a * b; }
+    template<typename T> inline T negateValues(const T a) { return (T)(0 - a); }
+
+    inline int32_t addValues(const int32_t a, const int32_t b) { return (int32_t)((uint32_t)a + (uint32_t)b); }
+    inline int32_t subtractValues(const int32_t a, const int32_t b) { return (int32_t)((uint32_t)a - (uint32_t)b); }
+    inline int32_t multiplyValues(const int32_t a, const int32_t b) { return (int32_t)((uint32_t)a * (uint32_t)b); }
+    inline int32_t negateValues(const int32_t a) { return (int32_t)(0 - (uint32_t)a); }
+
+    inline int64_t addValues(const int64_t a, const int64_t b) { return (int64_t)((uint64_t)a + (uint64_t)b); }
+    inline int64_t subtractValues(const int64_t a, const int64_t b) { return (int64_t)((uint64_t)a - (uint64_t)b); }
+    inline int64_t multiplyValues(const int64_t a, const int64_t b) { return (int64_t)((uint64_t)a * (uint64_t)b); }
+    inline int64_t negateValues(const int64_t a) { return (int64_t)(0 - (uint64_t)a); }
+
+    struct ViewAdd { template<typename T> static T apply(const T a, const T b) { return addValues(a, b); } };
+    struct ViewSubtract { template<typename T> static T apply(const T a, const T b) { return subtractValues(a, b); } };
+    struct ViewMultiply { template<typename T> static T apply(const T a, const T b) { return multiplyValues(a, b); } };
+    struct ViewDivide { template<typename T> static T apply(const T a, const T b) { return divideValues(a, b); } };
+    struct ViewNegate { template<typename T> static T apply(const T a) { return negateValues(a); } };
+
+    // Operand views are held by value, as they are small
+    template<typename O, typename A>
+    class UnaryView : public View<UnaryView<O, A> >
+    {
+    public:
+        typedef typename ViewTraits<typename A::ValueType>::Arithmetic ValueType;
+
+        UnaryView(const A& a) :
+            m_a(a)
+        {
+        }
+
+        std::size_t getSize() const { return m_a.getSize(); }
+        bool isNullable() const { return m_a.isNullable(); }
+        ValueType operator [](const std::size_t index) const { return O::apply((ValueType)m_a[index]); }
+        bool isNull(const std::size_t index) const { return m_a.isNull(index); }
+
+    private:
+        A m_a;
+    };
+
+    template<typename O, typename A, typename B>
+    class BinaryView : public View<BinaryView<O, A, B> >
+    {
+    public:
+        typedef typename ViewPromote<typename A::ValueType, typename B::ValueType>::Type ValueType;
+
+        BinaryView(const A& a, const B& b) :
+            m_a(a),
+            m_b(b)
+        {
+            if (a.getSize() != b.getSize() && a.getSize() != ANY_VIEW_SIZE && b.getSize() != ANY_VIEW_SIZE)
+            {
+                throw std::invalid_argument("Views have different sizes");
+            }
+        }
+
+        std::size_t getSize() const { return m_a.getSize() != ANY_VIEW_SIZE ? m_a.getSize() : m_b.getSize(); }
+        bool isNullable() const { return m_a.isNullable() || m_b.isNullable(); }
+
+        ValueType operator [](const std::size_t index) const
+        {
+            return O::apply((ValueType)m_a[index], (ValueType)m_b[index]);
+        }
+
+        bool isNull(const std::size_t index) const { return m_a.isNull(index) || m_b.isNull(index); }
+
+    private:
+        A m_a;
+        B m_b;
+    };
+
+    #define KINETICA_VIEW_OPERATOR(symbol, O) \
+        template<typename A, typename B> \
+        inline BinaryView<O, A, B> operator symbol(const View<A>& a, const View<B>& b) \
+        { \
+            return BinaryView<O, A, B>(a.get(), b.get()); \
+        } \
+        \
+        template<typename A, typename T> \
+        inline BinaryView<O, A, typename ViewTraits<T>::Scalar> operator symbol(const View<A>& a, const T b) \
+        { \
+            return BinaryView<O, A, typename ViewTraits<T>::Scalar>(a.get(), typename ViewTraits<T>::Scalar(b)); \
+        } \
+        \
+        template<typename T, typename B> \
+        inline BinaryView<O, typename ViewTraits<T>::Scalar, B> operator symbol(const T a, const View<B>& b) \
+        { \
+            return BinaryView<O, typename ViewTraits<T>::Scalar, B>(typename ViewTraits<T>::Scalar(a), b.get()); \
+        }
+
+    KINETICA_VIEW_OPERATOR(+, ViewAdd)
+    KINETICA_VIEW_OPERATOR(-, ViewSubtract)
+    KINETICA_VIEW_OPERATOR(*, ViewMultiply)
+    KINETICA_VIEW_OPERATOR(/, ViewDivide)
+
+    #undef KINETICA_VIEW_OPERATOR
+
+    template<typename A>
+    inline UnaryView<ViewNegate, A> operator -(const View<A>& a)
+    {
+        return UnaryView<ViewNegate, A>(a.get());
+    }
+
+    // Evaluates rows [start, end) of chunk index into data, which holds the
+    // appended rows from index onwards
+    template<typename T, typename E>
+    class ViewAssignTask : public ParallelTask
+    {
+    public:
+        ViewAssignTask(const E& expression, ProcData::OutputColumn& column, const std::size_t index,
+                       const std::size_t chunkCount) :
+            m_expression(expression),
+            m_column(column),
+            m_index(index),
+            m_chunkCount(chunkCount)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            std::size_t size = m_expression.getSize();
+            std::size_t start = getRangeStart(size, m_chunkCount, index);
+            std::size_t end = getRangeStart(size, m_chunkCount, index + 1);
+            T* data = m_column.getData<T>() + m_index;
+
+            if (m_column.getType() == ProcData::Column::BOOLEAN)
+            {
+                for (std::size_t i = start; i < end; ++i)
+                {
+                    data[i] = m_expression[i] != 0;
+                }
+            }
+            else
+            {
+                for (std::size_t i = start; i < end; ++i)
+                {
+                    data[i] = (T)m_expression[i];
+                }
+            }
+
+            if (m_column.isNullable() && m_expression.isNullable())
+            {
+                for (std::size_t i = start; i < end; ++i)
+                {
+                    if (m_expression.isNull(i))
+                    {
+                        m_column.setNull(m_index + i);
+                    }
+                }
+            }
+        }
+
+    private:
+        const E& m_expression;
+        ProcData::OutputColumn& m_column;
+        std::size_t m_index;
+        std::size_t m_chunkCount;
+    };
+
+    template<typename T, typename E>
+    std::size_t assignView(ProcData::OutputColumn& column, const E& expression, const std::size_t threadCount)
+    {
+        std::size_t size = expression.getSize();
+        std::size_t threads = threadCount == 0 ? getHardwareThreadCount() : threadCount;
+        std::size_t chunkCount = size >= MIN_PARALLEL_SIZE && threads > 1 ? threads * 4 : 1;
+        std::size_t index = column.getPos();
+        column.appendValues<T>(size);
+        ViewAssignTask<T, E> task(expression, column, index, chunkCount);
+        runParallel(task, chunkCount, threadCount);
+        return index;
+    }
+
+    // Appends the value of every row of expression to column, which may have
+    // any numeric type; values are converted as by a C++ cast (BOOLEAN
+    // columns take nonzero values as true). Nulls are kept if column is
+    // nullable. Rows are evaluated in parallel when there are many. The
+    // table of column must already be sized for the rows. Returns the index
+    // of the first appended row.
+    template<typename E>
+    std::size_t assign(ProcData::OutputColumn& column, const View<E>& view, const std::size_t threadCount = 0)
+    {
+        const E& expression = view.get();
+
+        if (expression.getSize() == ANY_VIEW_SIZE)
+        {
+            throw std::invalid_argument("Expression has no column views");
+        }
+
+        switch (column.getType())
+        {
+            case ProcData::Column::BOOLEAN:
+            case ProcData::Column::INT8: return assignView<int8_t>(column, expression, threadCount);
+            case ProcData::Column::INT16: return assignView<int16_t>(column, expression, threadCount);
+            case ProcData::Column::INT: return assignView<int32_t>(column, expression, threadCount);
+            case ProcData::Column::LONG:
+            case ProcData::Column::TIMESTAMP: return assignView<int64_t>(column, expression, threadCount);
+            case ProcData::Column::ULONG: return assignView<uint64_t>(column, expression, threadCount);
+            case ProcData::Column::FLOAT: return assignView<float>(column, expression, threadCount);
+            case ProcData::Column::DOUBLE: return assignView<double>(column, expression, threadCount);
+            default: throw std::invalid_argument("Column " + column.getName() + " is not numeric");
+        }
+    }
+
+    // Output column as the target of assignments of expressions
+    class OutputView
+    {
+    public:
+        explicit OutputView(ProcData::OutputColumn& column, const std::size_t threadCount = 0) :
+            m_column(column),
+            m_threadCount(threadCount),
+            m_index(0)
+        {
+        }
+
+        template<typename E>
+        OutputView& operator =(const View<E>& expression)
+        {
+            m_index = assign(m_column, expression, m_threadCount);
+            return *this;
+        }
+
+        // Index of the first row appended by the last assignment
+        std::size_t getIndex() const
+        {
+            return m_index;
+        }
+
+    private:
+        ProcData::OutputColumn& m_column;
+        std::size_t m_threadCount;
+        std::size_t m_index;
+    };
+}
+
+#endif
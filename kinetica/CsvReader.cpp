@@ -0,0 +1,1027 @@
+#include "CsvReader.hpp"
+#include "Decimal.hpp"
+#include "Parallel.hpp"
+#include "Temporal.hpp"
+#include "TextParse.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef __PCLMUL__
+#include <wmmintrin.h>
+#endif
+
+namespace
+{
+    typedef kinetica::ProcData::Column Column;
+    typedef kinetica::ProcData::OutputColumn OutputColumn;
+
+    const std::size_t NO_FIELD = (std::size_t)-1;
+
+    template<typename T>
+    std::string toString(const T& value)
+    {
+        std::ostringstream oss;
+        oss << value;
+        return oss.str();
+    }
+
+    //--------------------------------------------------------------------------
+    // Block scanning
+    //--------------------------------------------------------------------------
+
+    struct BlockMasks
+    {
+        uint64_t quote;
+        uint64_t delimiter;
+        uint64_t newline;
+    };
+
+    inline void scanBlock(const char* data, const char delimiter, const char quote, BlockMasks& masks)
+    {
+        #ifdef __SSE2__
+        const __m128i delimiters = _mm_set1_epi8(delimiter);
+        const __m128i quotes = _mm_set1_epi8(quote);
+        const __m128i newlines = _mm_set1_epi8('\n');
+        masks.quote = 0;
+        masks.delimiter = 0;
+        masks.newline = 0;
+
+        for (unsigned i = 0; i < 4; ++i)
+        {
+            __m128i block = _mm_loadu_si128((const __m128i*)(data + i * 16));
+            masks.quote |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, quotes)) << (i * 16);
+            masks.delimiter |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, delimiters)) << (i * 16);
+            masks.newline |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, newlines)) << (i * 16);
+        }
+        #else
+        masks.quote = 0;
+        masks.delimiter = 0;
+        masks.newline = 0;
+
+        for (unsigned i = 0; i < 64; ++i)
+        {
+            masks.quote |= (uint64_t)(data[i] == quote) << i;
+            masks.delimiter |= (uint64_t)(data[i] == delimiter) << i;
+            masks.newline |= (uint64_t)(data[i] == '\n') << i;
+        }
+        #endif
+    }
+
+    // Bit i of the result is the parity of the set bits at or below bit i,
+    // i.e. whether position i is inside a quoted section
+    inline uint64_t prefixXor(uint64_t value)
+    {
+        #ifdef __PCLMUL__
+        __m128i product = _mm_clmulepi64_si128(_mm_set_epi64x(0, (long long)value), _mm_set1_epi8(-1), 0);
+        return (uint64_t)_mm_cvtsi128_si64(product);
+        #else
+        value ^= value << 1;
+        value ^= value << 2;
+        value ^= value << 4;
+        value ^= value << 8;
+        value ^= value << 16;
+        value ^= value << 32;
+        return value;
+        #endif
+    }
+
+    inline std::size_t countTrailingZeros(const uint64_t value)
+    {
+        return (std::size_t)__builtin_ctzll(value);
+    }
+
+    class BlockScanner
+    {
+    public:
+        BlockScanner(const char* data, const std::size_t begin, const std::size_t end, const char delimiter, const char quote, const bool inQuote) :
+            m_data(data),
+            m_pos(begin),
+            m_end(end),
+            m_delimiter(delimiter),
+            m_quote(quote),
+            m_inQuote(inQuote ? ~(uint64_t)0 : 0)
+        {
+        }
+
+        // Scans the next 64 bytes; inQuote has a bit set for every position
+        // inside a quoted section (including opening quotes)
+        bool next(std::size_t& pos, BlockMasks& masks, uint64_t& inQuote)
+        {
+            if (m_pos >= m_end)
+            {
+                return false;
+            }
+
+            pos = m_pos;
+            std::size_t length = m_end - m_pos;
+
+            if (length >= 64)
+            {
+                scanBlock(m_data + m_pos, m_delimiter, m_quote, masks);
+            }
+            else
+            {
+                char buffer[64];
+                std::memcpy(buffer, m_data + m_pos, length);
+                std::memset(buffer + length, 0, 64 - length);
+                scanBlock(buffer, m_delimiter, m_quote, masks);
+                uint64_t valid = ((uint64_t)1 << length) - 1;
+                masks.quote &= valid;
+                masks.delimiter &= valid;
+                masks.newline &= valid;
+            }
+
+            inQuote = prefixXor(masks.quote) ^ m_inQuote;
+            m_inQuote = (uint64_t)((int64_t)inQuote >> 63);
+            m_pos += 64;
+            return true;
+        }
+
+    private:
+        const char* m_data;
+        std::size_t m_pos;
+        std::size_t m_end;
+        char m_delimiter;
+        char m_quote;
+        uint64_t m_inQuote;
+    };
+
+    //--------------------------------------------------------------------------
+    // Value parsers
+    //--------------------------------------------------------------------------
+
+    bool appendHexBytes(const char* value, const std::size_t length, std::vector<char>& result)
+    {
+        if (length % 2 != 0)
+        {
+            return false;
+        }
+
+        std::size_t start = result.size();
+        result.resize(start + length / 2);
+
+        for (std::size_t i = 0; i < length; i += 2)
+        {
+            int high = kinetica::getHexValue(value[i]);
+            int low = kinetica::getHexValue(value[i + 1]);
+
+            if (high < 0 || low < 0)
+            {
+                result.resize(start);
+                return false;
+            }
+
+            result[start + i / 2] = (char)((high << 4) | low);
+        }
+
+        return true;
+    }
+
+    template<std::size_t N>
+    bool parseCharN(const char* value, const std::size_t length, void* result)
+    {
+        if (length > N)
+        {
+            return false;
+        }
+
+        ((kinetica::CharN<N>*)result)->set(value, length);
+        return true;
+    }
+
+    template<typename T>
+    bool parseInteger(const char* value, const std::size_t length, const int64_t min, const int64_t max, void* result)
+    {
+        int64_t parsed;
+
+        if (!kinetica::parseSigned(value, length, min, max, parsed))
+        {
+            return false;
+        }
+
+        *(T*)result = (T)parsed;
+        return true;
+    }
+
+    bool parseFixedValue(const Column::ColumnType type, const unsigned decimalScale, const char* value, const std::size_t length, void* result)
+    {
+        switch (type)
+        {
+            case Column::BOOLEAN: return kinetica::parseBoolean(value, length, *(int8_t*)result);
+            case Column::CHAR1: return parseCharN<1>(value, length, result);
+            case Column::CHAR2: return parseCharN<2>(value, length, result);
+            case Column::CHAR4: return parseCharN<4>(value, length, result);
+            case Column::CHAR8: return parseCharN<8>(value, length, result);
+            case Column::CHAR16: return parseCharN<16>(value, length, result);
+            case Column::CHAR32: return parseCharN<32>(value, length, result);
+            case Column::CHAR64: return parseCharN<64>(value, length, result);
+            case Column::CHAR128: return parseCharN<128>(value, length, result);
+            case Column::CHAR256: return parseCharN<256>(value, length, result);
+            case Column::DATE: return kinetica::parseDate(value, length, *(kinetica::Date*)result);
+            case Column::DATETIME: return kinetica::parseDateTime(value, length, *(kinetica::DateTime*)result);
+            case Column::DECIMAL: return kinetica::parseDecimal(value, length, decimalScale, *(int64_t*)result);
+            case Column::DOUBLE: return kinetica::parseDouble(value, length, *(double*)result);
+
+            case Column::FLOAT:
+            {
+                double parsed;
+
+                if (!kinetica::parseDouble(value, length, parsed))
+                {
+                    return false;
+                }
+
+                *(float*)result = (float)parsed;
+                return true;
+            }
+
+            case Column::INT: return parseInteger<int32_t>(value, length, -2147483647 - 1, 2147483647, result);
+            case Column::INT8: return parseInteger<int8_t>(value, length, -128, 127, result);
+            case Column::INT16: return parseInteger<int16_t>(value, length, -32768, 32767, result);
+            case Column::IPV4: return kinetica::parseIPv4(value, length, *(uint32_t*)result);
+            case Column::LONG: return kinetica::parseSigned(value, length, -9223372036854775807LL - 1, 9223372036854775807LL, *(int64_t*)result);
+            case Column::TIME: return kinetica::parseTime(value, length, *(kinetica::Time*)result);
+            case Column::TIMESTAMP: return kinetica::parseTimestamp(value, length, *(int64_t*)result);
+            case Column::ULONG: return kinetica::parseUnsigned(value, length, *(uint64_t*)result);
+            case Column::UUID: return kinetica::parseUUID(value, length, *(kinetica::UUID*)result);
+            default: return false;
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Record parsing
+    //--------------------------------------------------------------------------
+
+    struct Target
+    {
+        OutputColumn* column;
+        Column::ColumnType type;
+        std::size_t typeSize;
+        bool isVar;
+        std::size_t field;
+        std::size_t next;
+        uint8_t* data;
+        uint8_t* nulls;
+        std::size_t varIndex;
+    };
+
+    struct VarStage
+    {
+        std::vector<char> data;
+        std::vector<uint64_t> offsets;
+        std::vector<std::size_t> nulls;
+
+        void clear()
+        {
+            std::vector<char>().swap(data);
+            std::vector<uint64_t>().swap(offsets);
+            std::vector<std::size_t>().swap(nulls);
+        }
+    };
+
+    // Copies a field into the scratch buffer without its enclosing quotes and
+    // with doubled quotes collapsed
+    void unquote(const char* value, const std::size_t length, const char quote, std::string& result)
+    {
+        result.clear();
+
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            result.push_back(value[i]);
+
+            if (value[i] == quote && i + 1 < length && value[i + 1] == quote)
+            {
+                ++i;
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Splitting
+    //--------------------------------------------------------------------------
+
+    class QuoteCountTask : public kinetica::ParallelTask
+    {
+    public:
+        const char* data;
+        std::size_t begin;
+        std::size_t end;
+        std::size_t chunkSize;
+        char delimiter;
+        char quote;
+        std::vector<std::size_t> quoteCounts;
+
+        virtual void run(const std::size_t index)
+        {
+            std::size_t chunkBegin = begin + index * chunkSize;
+            std::size_t chunkEnd = chunkBegin + chunkSize < end ? chunkBegin + chunkSize : end;
+            BlockScanner scanner(data, chunkBegin, chunkEnd, delimiter, quote, false);
+            std::size_t blockPos;
+            BlockMasks masks;
+            uint64_t inQuote;
+            std::size_t count = 0;
+
+            while (scanner.next(blockPos, masks, inQuote))
+            {
+                count += __builtin_popcountll(masks.quote);
+            }
+
+            quoteCounts[index] = count;
+        }
+    };
+
+    class BoundaryTask : public kinetica::ParallelTask
+    {
+    public:
+        const char* data;
+        std::size_t begin;
+        std::size_t end;
+        std::size_t chunkSize;
+        char delimiter;
+        char quote;
+        std::vector<bool> inQuote;
+        std::vector<std::size_t> boundaries;
+
+        virtual void run(const std::size_t index)
+        {
+            std::size_t chunkBegin = begin + index * chunkSize;
+            std::size_t chunkEnd = chunkBegin + chunkSize < end ? chunkBegin + chunkSize : end;
+            BlockScanner scanner(data, chunkBegin, chunkEnd, delimiter, quote, inQuote[index]);
+            std::size_t blockPos;
+            BlockMasks masks;
+            uint64_t quoted;
+            boundaries[index] = NO_FIELD;
+
+            while (scanner.next(blockPos, masks, quoted))
+            {
+                uint64_t newlines = masks.newline & ~quoted;
+
+                if (newlines != 0)
+                {
+                    boundaries[index] = blockPos + countTrailingZeros(newlines) + 1;
+                    return;
+                }
+            }
+        }
+    };
+
+    class RecordCountTask : public kinetica::ParallelTask
+    {
+    public:
+        const char* data;
+        char delimiter;
+        char quote;
+        std::vector<std::size_t> begins;
+        std::vector<std::size_t> ends;
+        std::vector<std::size_t> recordCounts;
+
+        virtual void run(const std::size_t index)
+        {
+            BlockScanner scanner(data, begins[index], ends[index], delimiter, quote, false);
+            std::size_t blockPos;
+            BlockMasks masks;
+            uint64_t inQuote;
+            std::size_t lineStart = begins[index];
+            std::size_t count = 0;
+
+            while (scanner.next(blockPos, masks, inQuote))
+            {
+                uint64_t newlines = masks.newline & ~inQuote;
+
+                while (newlines != 0)
+                {
+                    std::size_t pos = blockPos + countTrailingZeros(newlines);
+                    newlines &= newlines - 1;
+
+                    if (!isBlank(lineStart, pos))
+                    {
+                        ++count;
+                    }
+
+                    lineStart = pos + 1;
+                }
+            }
+
+            if (!isBlank(lineStart, ends[index]))
+            {
+                ++count;
+            }
+
+            recordCounts[index] = count;
+        }
+
+    private:
+        bool isBlank(const std::size_t begin, const std::size_t end) const
+        {
+            return end == begin || (end == begin + 1 && data[begin] == '\r');
+        }
+    };
+}
+
+namespace kinetica
+{
+    // Parses the records of chunks[chunkOffset + index] into the targets
+    class CsvReader::ParseTask : public ParallelTask
+    {
+    public:
+        const char* data;
+        char delimiter;
+        char quote;
+        std::string nullValue;
+        unsigned decimalScale;
+        std::size_t requiredFields;
+        std::vector<std::size_t> fieldTargets;
+        std::vector<Target> targets;
+        std::size_t varCount;
+        const std::vector<Chunk>* chunks;
+        std::size_t chunkOffset;
+        std::vector<std::vector<VarStage> > stages;
+
+        virtual void run(const std::size_t index)
+        {
+            const Chunk& chunk = (*chunks)[chunkOffset + index];
+            std::vector<VarStage>& stage = stages[index];
+            stage.resize(varCount);
+
+            for (std::size_t i = 0; i < varCount; ++i)
+            {
+                stage[i].offsets.reserve(chunk.recordCount);
+            }
+
+            std::string scratch;
+            BlockScanner scanner(data, chunk.begin, chunk.end, delimiter, quote, false);
+            std::size_t blockPos;
+            BlockMasks masks;
+            uint64_t inQuote;
+            std::size_t fieldStart = chunk.begin;
+            std::size_t field = 0;
+            std::size_t row = 0;
+
+            while (scanner.next(blockPos, masks, inQuote))
+            {
+                uint64_t structural = (masks.delimiter | masks.newline) & ~inQuote;
+
+                while (structural != 0)
+                {
+                    std::size_t pos = blockPos + countTrailingZeros(structural);
+                    bool endOfRecord = data[pos] == '\n';
+                    structural &= structural - 1;
+                    processField(chunk, stage, scratch, fieldStart, pos, endOfRecord, field, row);
+                    fieldStart = pos + 1;
+                }
+            }
+
+            // The last record of the file may not be terminated
+            if (fieldStart < chunk.end || field > 0)
+            {
+                processField(chunk, stage, scratch, fieldStart, chunk.end, true, field, row);
+            }
+
+            if (row != chunk.recordCount)
+            {
+                throw std::runtime_error("Record count mismatch in chunk at offset " + toString(chunk.begin));
+            }
+        }
+
+    private:
+        void processField(const Chunk& chunk, std::vector<VarStage>& stage, std::string& scratch,
+                          const std::size_t start, std::size_t end, const bool endOfRecord, std::size_t& field, std::size_t& row)
+        {
+            if (endOfRecord && end > start && data[end - 1] == '\r')
+            {
+                --end;
+            }
+
+            if (endOfRecord && field == 0 && end == start)
+            {
+                // Blank line
+                return;
+            }
+
+            if (field < fieldTargets.size())
+            {
+                for (std::size_t t = fieldTargets[field]; t != NO_FIELD; t = targets[t].next)
+                {
+                    storeValue(chunk, stage, scratch, targets[t], start, end, row);
+                }
+            }
+
+            if (endOfRecord)
+            {
+                if (field + 1 < requiredFields)
+                {
+                    throw std::runtime_error("Expected " + toString(requiredFields) + " fields but found "
+                                             + toString(field + 1) + " at record " + toString(chunk.recordStart + row + 1));
+                }
+
+                field = 0;
+                ++row;
+            }
+            else
+            {
+                ++field;
+            }
+        }
+
+        void storeValue(const Chunk& chunk, std::vector<VarStage>& stage, std::string& scratch, const Target& target,
+                        const std::size_t start, const std::size_t end, const std::size_t row)
+        {
+            const char* value = data + start;
+            std::size_t length = end - start;
+            bool isNull = false;
+
+            if (length > 0 && value[0] == quote)
+            {
+                if (length < 2 || value[length - 1] != quote)
+                {
+                    throw std::runtime_error("Malformed quoted value for column " + target.column->getName()
+                                             + " at record " + toString(chunk.recordStart + row + 1));
+                }
+
+                ++value;
+                length -= 2;
+
+                if (std::memchr(value, quote, length) != NULL)
+                {
+                    unquote(value, length, quote, scratch);
+                    value = scratch.data();
+                    length = scratch.length();
+                }
+            }
+            else
+            {
+                isNull = length == nullValue.length() && std::memcmp(value, nullValue.data(), length) == 0;
+            }
+
+            if (isNull && target.column->isNullable())
+            {
+                if (target.isVar)
+                {
+                    VarStage& varStage = stage[target.varIndex];
+                    varStage.nulls.push_back(varStage.offsets.size());
+                    varStage.offsets.push_back(varStage.data.size());
+                }
+                else
+                {
+                    target.nulls[chunk.recordStart + row] = 1;
+                }
+
+                return;
+            }
+
+            if (target.isVar)
+            {
+                VarStage& varStage = stage[target.varIndex];
+                varStage.offsets.push_back(varStage.data.size());
+
+                if (target.type == Column::STRING)
+                {
+                    varStage.data.insert(varStage.data.end(), value, value + length);
+                    varStage.data.push_back('\0');
+                    return;
+                }
+
+                if (appendHexBytes(value, length, varStage.data))
+                {
+                    return;
+                }
+            }
+            else if (parseFixedValue(target.type, decimalScale, value, length,
+                                     target.data + (chunk.recordStart + row) * target.typeSize))
+            {
+                return;
+            }
+
+            throw std::runtime_error("Invalid value for column " + target.column->getName() + " at record "
+                                     + toString(chunk.recordStart + row + 1) + ": " + std::string(value, length));
+        }
+    };
+
+    //--------------------------------------------------------------------------
+    // CsvReader
+    //--------------------------------------------------------------------------
+
+    CsvReader::Options::Options() :
+        delimiter(','),
+        quote('"'),
+        hasHeader(true),
+        nullValue(),
+        decimalScale(kinetica::DECIMAL_SCALE),
+        threadCount(0),
+        chunkSize(8 * 1024 * 1024)
+    {
+    }
+
+    CsvReader::CsvReader(const std::string& path, const Options& options) :
+        m_options(options),
+        m_file(-1),
+        m_data(NULL),
+        m_size(0),
+        m_fieldCount(0),
+        m_recordCount(0)
+    {
+        if (m_options.delimiter == '\n' || m_options.quote == '\n' || m_options.delimiter == m_options.quote)
+        {
+            throw std::invalid_argument("Invalid CSV delimiter or quote character");
+        }
+
+        if (m_options.chunkSize < 64)
+        {
+            m_options.chunkSize = 64;
+        }
+
+        open(path);
+
+        try
+        {
+            split(readHeader());
+        }
+        catch (...)
+        {
+            close();
+            throw;
+        }
+    }
+
+    CsvReader::~CsvReader()
+    {
+        close();
+    }
+
+    const std::vector<std::string>& CsvReader::getHeader() const
+    {
+        return m_header;
+    }
+
+    std::size_t CsvReader::getFieldCount() const
+    {
+        return m_fieldCount;
+    }
+
+    std::size_t CsvReader::getRecordCount() const
+    {
+        return m_recordCount;
+    }
+
+    std::size_t CsvReader::read(ProcData::OutputTable& table)
+    {
+        std::vector<std::size_t> fields(table.getColumnCount(), NO_FIELD);
+
+        for (std::size_t i = 0; i < fields.size(); ++i)
+        {
+            if (m_options.hasHeader)
+            {
+                for (std::size_t j = 0; j < m_header.size(); ++j)
+                {
+                    if (m_header[j] == table.getColumn(i).getName())
+                    {
+                        fields[i] = j;
+                        break;
+                    }
+                }
+            }
+            else if (i < m_fieldCount)
+            {
+                fields[i] = i;
+            }
+        }
+
+        return read(table, fields);
+    }
+
+    std::size_t CsvReader::read(ProcData::OutputTable& table, const std::vector<std::size_t>& fields)
+    {
+        if (fields.size() != table.getColumnCount())
+        {
+            throw std::invalid_argument("Field mapping must have one entry per column");
+        }
+
+        ParseTask task;
+        task.data = m_data;
+        task.delimiter = m_options.delimiter;
+        task.quote = m_options.quote;
+        task.nullValue = m_options.nullValue;
+        task.decimalScale = m_options.decimalScale;
+        task.requiredFields = 0;
+        task.varCount = 0;
+
+        for (std::size_t i = 0; i < fields.size(); ++i)
+        {
+            OutputColumn& column = table.getColumn(i);
+
+            if (fields[i] == NO_FIELD)
+            {
+                if (!column.isNullable() && m_recordCount > 0)
+                {
+                    throw std::invalid_argument("No field for non-nullable column " + column.getName());
+                }
+
+                continue;
+            }
+
+            if (task.fieldTargets.size() <= fields[i])
+            {
+                task.fieldTargets.resize(fields[i] + 1, NO_FIELD);
+                task.requiredFields = fields[i] + 1;
+            }
+
+            Target target;
+            target.column = &column;
+            target.type = column.getType();
+            target.typeSize = Column::getTypeSize(target.type);
+            target.isVar = target.type == Column::STRING || target.type == Column::BYTES;
+            target.field = fields[i];
+            target.next = task.fieldTargets[fields[i]];
+            target.data = NULL;
+            target.nulls = NULL;
+            target.varIndex = target.isVar ? task.varCount++ : NO_FIELD;
+            task.fieldTargets[fields[i]] = task.targets.size();
+            task.targets.push_back(target);
+        }
+
+        table.setSize(table.getSize() + m_recordCount);
+
+        for (std::size_t i = 0; i < fields.size(); ++i)
+        {
+            if (fields[i] == NO_FIELD)
+            {
+                OutputColumn& column = table.getColumn(i);
+
+                for (std::size_t j = 0; j < m_recordCount; ++j)
+                {
+                    column.appendNull();
+                }
+            }
+        }
+
+        for (std::size_t i = 0; i < task.targets.size(); ++i)
+        {
+            Target& target = task.targets[i];
+
+            if (!target.isVar)
+            {
+                target.data = (uint8_t*)target.column->appendValues(m_recordCount);
+                std::size_t index = (target.data - target.column->getData<uint8_t>()) / target.typeSize;
+                target.nulls = target.column->isNullable() ? target.column->getNulls() + index : NULL;
+            }
+        }
+
+        task.chunks = &m_chunks;
+
+        // Parse in batches so that staged variable-length data is bounded
+        std::size_t threadCount = m_options.threadCount == 0 ? getHardwareThreadCount() : m_options.threadCount;
+        std::size_t batchSize = threadCount * 2;
+
+        for (std::size_t batchStart = 0; batchStart < m_chunks.size(); batchStart += batchSize)
+        {
+            std::size_t batchEnd = batchStart + batchSize < m_chunks.size() ? batchStart + batchSize : m_chunks.size();
+            task.chunkOffset = batchStart;
+            task.stages.clear();
+            task.stages.resize(batchEnd - batchStart);
+            runParallel(task, batchEnd - batchStart, threadCount);
+
+            for (std::size_t i = 0; i < task.targets.size(); ++i)
+            {
+                Target& target = task.targets[i];
+
+                if (!target.isVar)
+                {
+                    continue;
+                }
+
+                for (std::size_t j = 0; j < task.stages.size(); ++j)
+                {
+                    VarStage& stage = task.stages[j][target.varIndex];
+                    std::size_t index = target.column->appendVarValues<char>(stage.data.empty() ? NULL : &stage.data[0], stage.data.size(),
+                                                                              stage.offsets.empty() ? NULL : &stage.offsets[0], stage.offsets.size());
+
+                    for (std::size_t k = 0; k < stage.nulls.size(); ++k)
+                    {
+                        target.column->setNull(index + stage.nulls[k]);
+                    }
+
+                    stage.clear();
+                }
+            }
+        }
+
+        return m_recordCount;
+    }
+
+    void CsvReader::open(const std::string& path)
+    {
+        m_file = ::open(path.c_str(), O_RDONLY);
+
+        if (m_file == -1)
+        {
+            throw std::runtime_error("Could not open CSV file " + path + ": " + std::string(std::strerror(errno)));
+        }
+
+        struct stat st;
+
+        if (fstat(m_file, &st) != 0)
+        {
+            int err = errno;
+            close();
+            throw std::runtime_error("Could not get size of CSV file " + path + ": " + std::string(std::strerror(err)));
+        }
+
+        m_size = st.st_size;
+
+        if (m_size == 0)
+        {
+            return;
+        }
+
+        void* data = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+
+        if (data == MAP_FAILED)
+        {
+            int err = errno;
+            close();
+            throw std::runtime_error("Could not map CSV file " + path + ": " + std::string(std::strerror(err)));
+        }
+
+        madvise(data, m_size, MADV_SEQUENTIAL);
+        m_data = (const char*)data;
+    }
+
+    void CsvReader::close()
+    {
+        if (m_data)
+        {
+            munmap((void*)m_data, m_size);
+            m_data = NULL;
+        }
+
+        if (m_file != -1)
+        {
+            ::close(m_file);
+            m_file = -1;
+        }
+
+        m_size = 0;
+    }
+
+    std::size_t CsvReader::readHeader()
+    {
+        // Scans the first record; it is only kept when the file has a header,
+        // otherwise it just provides the field count
+        std::vector<std::string> fields;
+        std::string field;
+        bool quoted = false;
+        std::size_t pos = 0;
+
+        for (; pos < m_size; ++pos)
+        {
+            char c = m_data[pos];
+
+            if (quoted)
+            {
+                if (c == m_options.quote)
+                {
+                    if (pos + 1 < m_size && m_data[pos + 1] == m_options.quote)
+                    {
+                        field.push_back(c);
+                        ++pos;
+                    }
+                    else
+                    {
+                        quoted = false;
+                    }
+                }
+                else
+                {
+                    field.push_back(c);
+                }
+            }
+            else if (c == m_options.quote)
+            {
+                quoted = true;
+            }
+            else if (c == m_options.delimiter)
+            {
+                fields.push_back(field);
+                field.clear();
+            }
+            else if (c == '\n')
+            {
+                break;
+            }
+            else
+            {
+                field.push_back(c);
+            }
+        }
+
+        if (!field.empty() && field[field.length() - 1] == '\r')
+        {
+            field.erase(field.length() - 1);
+        }
+
+        if (pos > 0)
+        {
+            fields.push_back(field);
+        }
+
+        m_fieldCount = fields.size();
+
+        if (!m_options.hasHeader)
+        {
+            return 0;
+        }
+
+        m_header.swap(fields);
+        return pos < m_size ? pos + 1 : m_size;
+    }
+
+    void CsvReader::split(const std::size_t dataStart)
+    {
+        m_chunks.clear();
+        m_recordCount = 0;
+
+        if (dataStart >= m_size)
+        {
+            return;
+        }
+
+        std::size_t chunkSize = m_options.chunkSize;
+        std::size_t rawCount = (m_size - dataStart + chunkSize - 1) / chunkSize;
+
+        // Pass 1: quote parity at the start of each raw chunk
+        QuoteCountTask quoteTask;
+        quoteTask.data = m_data;
+        quoteTask.begin = dataStart;
+        quoteTask.end = m_size;
+        quoteTask.chunkSize = chunkSize;
+        quoteTask.delimiter = m_options.delimiter;
+        quoteTask.quote = m_options.quote;
+        quoteTask.quoteCounts.resize(rawCount);
+        runParallel(quoteTask, rawCount, m_options.threadCount);
+
+        // Pass 2: first record boundary at or after each raw chunk start
+        BoundaryTask boundaryTask;
+        boundaryTask.data = m_data;
+        boundaryTask.begin = dataStart;
+        boundaryTask.end = m_size;
+        boundaryTask.chunkSize = chunkSize;
+        boundaryTask.delimiter = m_options.delimiter;
+        boundaryTask.quote = m_options.quote;
+        boundaryTask.inQuote.resize(rawCount);
+        boundaryTask.boundaries.resize(rawCount);
+        std::size_t quoteCount = 0;
+
+        for (std::size_t i = 0; i < rawCount; ++i)
+        {
+            boundaryTask.inQuote[i] = quoteCount % 2 != 0;
+            quoteCount += quoteTask.quoteCounts[i];
+        }
+
+        runParallel(boundaryTask, rawCount, m_options.threadCount);
+
+        // Pass 3: record counts between boundaries (raw chunks without a
+        // boundary are merged into the preceding chunk)
+        RecordCountTask countTask;
+        countTask.data = m_data;
+        countTask.delimiter = m_options.delimiter;
+        countTask.quote = m_options.quote;
+        countTask.begins.push_back(dataStart);
+
+        for (std::size_t i = 1; i < rawCount; ++i)
+        {
+            std::size_t boundary = boundaryTask.boundaries[i];
+
+            if (boundary != NO_FIELD && boundary > countTask.begins.back() && boundary < m_size)
+            {
+                countTask.ends.push_back(boundary);
+                countTask.begins.push_back(boundary);
+            }
+        }
+
+        countTask.ends.push_back(m_size);
+        countTask.recordCounts.resize(countTask.begins.size());
+        runParallel(countTask, countTask.begins.size(), m_options.threadCount);
+
+        for (std::size_t i = 0; i < countTask.begins.size(); ++i)
+        {
+            Chunk chunk;
+            chunk.begin = countTask.begins[i];
+            chunk.end = countTask.ends[i];
+            chunk.recordStart = m_recordCount;
+            chunk.recordCount = countTask.recordCounts[i];
+            m_recordCount += chunk.recordCount;
+            m_chunks.push_back(chunk);
+        }
+    }
+}
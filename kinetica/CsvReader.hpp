@@ -0,0 +1,82 @@
+#ifndef _KINETICA_CSV_READER_HPP_
+#define _KINETICA_CSV_READER_HPP_
+
+#include "Proc.hpp"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace kinetica
+{
+    // Memory-maps a delimited text file and loads it into an output table.
+    // The file is split into chunks at record boundaries (quote-aware) when
+    // opened; read() parses the chunks in parallel and writes parsed values
+    // directly into the output column buffers.
+    class CsvReader
+    {
+    public:
+        struct Options
+        {
+            char delimiter;
+            char quote;
+            bool hasHeader;
+
+            // Unquoted fields equal to this value are loaded as nulls
+            std::string nullValue;
+
+            // Number of implied decimal places of DECIMAL columns
+            unsigned decimalScale;
+
+            std::size_t threadCount;
+            std::size_t chunkSize;
+
+            Options();
+        };
+
+        CsvReader(const std::string& path, const Options& options = Options());
+        ~CsvReader();
+
+        const std::vector<std::string>& getHeader() const;
+        std::size_t getFieldCount() const;
+        std::size_t getRecordCount() const;
+
+        // Appends all records to the table, growing it by getRecordCount()
+        // rows. With a header, columns are matched to fields by name,
+        // otherwise by position.
+        std::size_t read(ProcData::OutputTable& table);
+
+        // Appends all records to the table, loading field fields[i] into
+        // column i; (std::size_t)-1 leaves the column null.
+        std::size_t read(ProcData::OutputTable& table, const std::vector<std::size_t>& fields);
+
+    private:
+        struct Chunk
+        {
+            std::size_t begin;
+            std::size_t end;
+            std::size_t recordStart;
+            std::size_t recordCount;
+        };
+
+        class ParseTask;
+
+        Options m_options;
+        int m_file;
+        const char* m_data;
+        std::size_t m_size;
+        std::vector<std::string> m_header;
+        std::size_t m_fieldCount;
+        std::vector<Chunk> m_chunks;
+        std::size_t m_recordCount;
+
+        CsvReader(const CsvReader&);
+        CsvReader& operator=(const CsvReader&);
+        void open(const std::string& path);
+        void close();
+        std::size_t readHeader();
+        void split(const std::size_t dataStart);
+    };
+}
+
+#endif
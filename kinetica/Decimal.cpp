@@ -0,0 +1,736 @@
+#include "Decimal.hpp"
+#include "Parallel.hpp"
+#include "TextParse.hpp"
+
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    typedef kinetica::ProcData::Column Column;
+    typedef __int128 Int128;
+
+    // Rows summed into 64-bit halves before being added to a 128-bit sum; the
+    // halves cannot overflow within a block
+    const std::size_t SUM_BLOCK_SIZE = 1 << 20;
+
+    const int64_t MAX_VALUE = 9223372036854775807LL;
+    const int64_t MIN_VALUE = -MAX_VALUE - 1;
+
+    //--------------------------------------------------------------------------
+    // Arithmetic
+    //--------------------------------------------------------------------------
+
+    inline void checkScale(const unsigned scale)
+    {
+        if (scale > kinetica::MAX_DECIMAL_SCALE)
+        {
+            throw std::invalid_argument("Decimal scale must be at most 18");
+        }
+    }
+
+    // 10^exponent for exponent up to 38
+    inline Int128 getPowerOfTen(const unsigned exponent)
+    {
+        Int128 result = 1;
+
+        for (unsigned i = 0; i < exponent; ++i)
+        {
+            result *= 10;
+        }
+
+        return result;
+    }
+
+    inline Int128 absolute(const Int128 value)
+    {
+        return value < 0 ? -value : value;
+    }
+
+    inline bool fits(const Int128 value)
+    {
+        return value >= MIN_VALUE && value <= MAX_VALUE;
+    }
+
+    // Divides with the quotient rounded half away from zero
+    inline Int128 divideRounded(const Int128 value, const Int128 divisor)
+    {
+        Int128 quotient = value / divisor;
+        Int128 remainder = value % divisor;
+
+        if (2 * absolute(remainder) >= absolute(divisor))
+        {
+            quotient += (value < 0) != (divisor < 0) ? -1 : 1;
+        }
+
+        return quotient;
+    }
+
+    // Converts value at scale (up to 36) to resultScale, returning false if
+    // the result does not fit in 64 bits
+    inline bool rescaleValue(Int128 value, const unsigned scale, const unsigned resultScale, int64_t& result)
+    {
+        if (resultScale < scale)
+        {
+            value = divideRounded(value, getPowerOfTen(scale - resultScale));
+        }
+        else if (resultScale > scale)
+        {
+            Int128 factor = getPowerOfTen(resultScale - scale);
+
+            if (absolute(value) > MAX_VALUE / factor)
+            {
+                return false;
+            }
+
+            value *= factor;
+        }
+
+        if (!fits(value))
+        {
+            return false;
+        }
+
+        result = (int64_t)value;
+        return true;
+    }
+
+    // Computes numerator * 10^exponent / denominator rounded half away from
+    // zero, without forming the full scaled numerator, returning false if the
+    // denominator is 0 or the result does not fit in 64 bits
+    bool divideScaled(const Int128 numerator, const Int128 denominator, int exponent, int64_t& result)
+    {
+        if (denominator == 0)
+        {
+            return false;
+        }
+
+        if (exponent < 0)
+        {
+            Int128 quotient = divideRounded(numerator, denominator * getPowerOfTen(-exponent));
+
+            if (!fits(quotient))
+            {
+                return false;
+            }
+
+            result = (int64_t)quotient;
+            return true;
+        }
+
+        // Long division, bringing down up to 18 digits at a time
+        Int128 quotient = numerator / denominator;
+        Int128 remainder = numerator % denominator;
+
+        while (true)
+        {
+            // 2^63 is allowed through so that INT64_MIN can be returned
+            if (absolute(quotient) > (Int128)MAX_VALUE + 1)
+            {
+                return false;
+            }
+
+            if (exponent == 0)
+            {
+                break;
+            }
+
+            int step = exponent < 18 ? exponent : 18;
+            Int128 factor = getPowerOfTen(step);
+            quotient *= factor;
+            remainder *= factor;
+            quotient += remainder / denominator;
+            remainder %= denominator;
+            exponent -= step;
+        }
+
+        if (2 * absolute(remainder) >= absolute(denominator))
+        {
+            quotient += (numerator < 0) != (denominator < 0) ? -1 : 1;
+        }
+
+        if (!fits(quotient))
+        {
+            return false;
+        }
+
+        result = (int64_t)quotient;
+        return true;
+    }
+
+    // Adds or subtracts values at a common scale with wrapping arithmetic,
+    // detecting overflow from the signs
+    template<bool Subtract>
+    std::size_t addSameScale(const int64_t* a, const int64_t* b, const std::size_t count, int64_t* result, uint8_t* errors)
+    {
+        std::size_t failures = 0;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            uint64_t x = (uint64_t)a[i];
+            uint64_t y = (uint64_t)b[i];
+            int64_t value = (int64_t)(Subtract ? x - y : x + y);
+            bool overflow = Subtract
+                ? ((a[i] ^ b[i]) & (a[i] ^ value)) < 0
+                : ((a[i] ^ value) & (b[i] ^ value)) < 0;
+            result[i] = overflow ? 0 : value;
+            errors[i] |= (uint8_t)overflow;
+            failures += overflow;
+        }
+
+        return failures;
+    }
+
+    template<bool Subtract>
+    std::size_t addValues(const int64_t* a, const unsigned scaleA, const int64_t* b, const unsigned scaleB,
+                          const std::size_t count, const unsigned resultScale, int64_t* result, uint8_t* errors)
+    {
+        checkScale(scaleA);
+        checkScale(scaleB);
+        checkScale(resultScale);
+
+        if (scaleA == scaleB && scaleA == resultScale)
+        {
+            return addSameScale<Subtract>(a, b, count, result, errors);
+        }
+
+        unsigned scale = scaleA > scaleB ? scaleA : scaleB;
+        Int128 factorA = getPowerOfTen(scale - scaleA);
+        Int128 factorB = getPowerOfTen(scale - scaleB);
+        std::size_t failures = 0;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            Int128 x = a[i] * factorA;
+            Int128 y = b[i] * factorB;
+
+            if (!rescaleValue(Subtract ? x - y : x + y, scale, resultScale, result[i]))
+            {
+                result[i] = 0;
+                errors[i] = 1;
+                ++failures;
+            }
+        }
+
+        return failures;
+    }
+
+    //--------------------------------------------------------------------------
+    // Aggregation
+    //--------------------------------------------------------------------------
+
+    // Sums the non-null values of a range of rows, keeping the high and low
+    // 32 bits of the values in separate 64-bit sums so the loop vectorizes
+    Int128 sumRange(const int64_t* values, const uint8_t* nulls, const std::size_t start, const std::size_t end, std::size_t& count)
+    {
+        Int128 sum = 0;
+
+        for (std::size_t block = start; block < end; block += SUM_BLOCK_SIZE)
+        {
+            std::size_t blockEnd = end - block > SUM_BLOCK_SIZE ? block + SUM_BLOCK_SIZE : end;
+            int64_t high = 0;
+            uint64_t low = 0;
+
+            if (nulls)
+            {
+                uint64_t valueCount = 0;
+
+                for (std::size_t i = block; i < blockEnd; ++i)
+                {
+                    uint64_t isValue = nulls[i] == 0;
+                    int64_t value = values[i] & -(int64_t)isValue;
+                    high += value >> 32;
+                    low += (uint32_t)value;
+                    valueCount += isValue;
+                }
+
+                count += valueCount;
+            }
+            else
+            {
+                for (std::size_t i = block; i < blockEnd; ++i)
+                {
+                    high += values[i] >> 32;
+                    low += (uint32_t)values[i];
+                }
+
+                count += blockEnd - block;
+            }
+
+            sum += high * ((Int128)1 << 32) + low;
+        }
+
+        return sum;
+    }
+
+    class SumTask : public kinetica::ParallelTask
+    {
+    public:
+        std::vector<Int128> sums;
+        std::vector<std::size_t> counts;
+
+        SumTask(const Column& column, const std::size_t chunkCount) :
+            sums(chunkCount),
+            counts(chunkCount),
+            m_column(column),
+            m_chunkCount(chunkCount)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            std::size_t start = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index);
+            std::size_t end = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index + 1);
+            const uint8_t* nulls = m_column.isNullable() ? m_column.getNulls() : NULL;
+            counts[index] = 0;
+            sums[index] = sumRange(m_column.getData<int64_t>(), nulls, start, end, counts[index]);
+        }
+
+    private:
+        const Column& m_column;
+        std::size_t m_chunkCount;
+    };
+
+    Int128 sumColumn(const Column& column, const std::size_t threadCount, std::size_t& count)
+    {
+        if (column.getType() != Column::DECIMAL && column.getType() != Column::LONG)
+        {
+            throw std::invalid_argument("Column " + column.getName() + " must be DECIMAL or LONG");
+        }
+
+        std::size_t threads = threadCount == 0 ? kinetica::getHardwareThreadCount() : threadCount;
+        std::size_t chunkCount = column.getSize() >= kinetica::MIN_PARALLEL_SIZE && threads > 1 ? threads * 4 : 1;
+        SumTask sumTask(column, chunkCount);
+        kinetica::runParallel(sumTask, chunkCount, threadCount);
+        Int128 sum = 0;
+        count = 0;
+
+        for (std::size_t i = 0; i < chunkCount; ++i)
+        {
+            sum += sumTask.sums[i];
+            count += sumTask.counts[i];
+        }
+
+        return sum;
+    }
+}
+
+namespace kinetica
+{
+    //--------------------------------------------------------------------------
+    // Decimal
+    //--------------------------------------------------------------------------
+
+    Decimal::Decimal() :
+        m_unscaled(0),
+        m_scale(DECIMAL_SCALE)
+    {
+    }
+
+    Decimal::Decimal(const int64_t unscaled, const unsigned scale) :
+        m_unscaled(unscaled),
+        m_scale(scale)
+    {
+        checkScale(scale);
+    }
+
+    Decimal Decimal::parse(const std::string& text, const unsigned scale)
+    {
+        checkScale(scale);
+        int64_t unscaled;
+
+        if (!parseDecimal(text.data(), text.size(), scale, unscaled))
+        {
+            throw std::invalid_argument("Invalid decimal: " + text);
+        }
+
+        return Decimal(unscaled, scale);
+    }
+
+    int64_t Decimal::getUnscaled() const
+    {
+        return m_unscaled;
+    }
+
+    unsigned Decimal::getScale() const
+    {
+        return m_scale;
+    }
+
+    Decimal Decimal::rescale(const unsigned scale) const
+    {
+        checkScale(scale);
+        int64_t unscaled;
+
+        if (!rescaleValue(m_unscaled, m_scale, scale, unscaled))
+        {
+            throw std::overflow_error("Decimal overflow");
+        }
+
+        return Decimal(unscaled, scale);
+    }
+
+    double Decimal::toDouble() const
+    {
+        return (double)m_unscaled / (double)getPowerOfTen(m_scale);
+    }
+
+    std::string Decimal::toString() const
+    {
+        char buffer[24];
+        return std::string(buffer, formatDecimal(m_unscaled, m_scale, buffer));
+    }
+
+    Decimal Decimal::operator +(const Decimal& value) const
+    {
+        unsigned scale = m_scale > value.m_scale ? m_scale : value.m_scale;
+        int64_t unscaled;
+        uint8_t error = 0;
+
+        if (addDecimals(&m_unscaled, m_scale, &value.m_unscaled, value.m_scale, 1, scale, &unscaled, &error) != 0)
+        {
+            throw std::overflow_error("Decimal overflow");
+        }
+
+        return Decimal(unscaled, scale);
+    }
+
+    Decimal Decimal::operator -(const Decimal& value) const
+    {
+        unsigned scale = m_scale > value.m_scale ? m_scale : value.m_scale;
+        int64_t unscaled;
+        uint8_t error = 0;
+
+        if (subtractDecimals(&m_unscaled, m_scale, &value.m_unscaled, value.m_scale, 1, scale, &unscaled, &error) != 0)
+        {
+            throw std::overflow_error("Decimal overflow");
+        }
+
+        return Decimal(unscaled, scale);
+    }
+
+    Decimal Decimal::operator *(const Decimal& value) const
+    {
+        unsigned scale = m_scale > value.m_scale ? m_scale : value.m_scale;
+        int64_t unscaled;
+        uint8_t error = 0;
+
+        if (multiplyDecimals(&m_unscaled, m_scale, &value.m_unscaled, value.m_scale, 1, scale, &unscaled, &error) != 0)
+        {
+            throw std::overflow_error("Decimal overflow");
+        }
+
+        return Decimal(unscaled, scale);
+    }
+
+    Decimal Decimal::operator /(const Decimal& value) const
+    {
+        if (value.m_unscaled == 0)
+        {
+            throw std::domain_error("Decimal division by zero");
+        }
+
+        unsigned scale = m_scale > value.m_scale ? m_scale : value.m_scale;
+        int64_t unscaled;
+        uint8_t error = 0;
+
+        if (divideDecimals(&m_unscaled, m_scale, &value.m_unscaled, value.m_scale, 1, scale, &unscaled, &error) != 0)
+        {
+            throw std::overflow_error("Decimal overflow");
+        }
+
+        return Decimal(unscaled, scale);
+    }
+
+    Decimal Decimal::operator -() const
+    {
+        if (m_unscaled == MIN_VALUE)
+        {
+            throw std::overflow_error("Decimal overflow");
+        }
+
+        return Decimal(-m_unscaled, m_scale);
+    }
+
+    int Decimal::compare(const Decimal& value) const
+    {
+        unsigned scale = m_scale > value.m_scale ? m_scale : value.m_scale;
+        Int128 a = m_unscaled * getPowerOfTen(scale - m_scale);
+        Int128 b = value.m_unscaled * getPowerOfTen(scale - value.m_scale);
+        return a < b ? -1 : a > b ? 1 : 0;
+    }
+
+    bool Decimal::operator ==(const Decimal& value) const
+    {
+        return compare(value) == 0;
+    }
+
+    bool Decimal::operator !=(const Decimal& value) const
+    {
+        return compare(value) != 0;
+    }
+
+    bool Decimal::operator <(const Decimal& value) const
+    {
+        return compare(value) < 0;
+    }
+
+    bool Decimal::operator <=(const Decimal& value) const
+    {
+        return compare(value) <= 0;
+    }
+
+    bool Decimal::operator >(const Decimal& value) const
+    {
+        return compare(value) > 0;
+    }
+
+    bool Decimal::operator >=(const Decimal& value) const
+    {
+        return compare(value) >= 0;
+    }
+
+    std::ostream& operator <<(std::ostream& os, const Decimal& value)
+    {
+        return os << value.toString();
+    }
+
+    //--------------------------------------------------------------------------
+    // Text
+    //--------------------------------------------------------------------------
+
+    std::size_t formatDecimal(const int64_t value, const unsigned scale, char* result)
+    {
+        char buffer[24];
+        char* end = buffer + sizeof(buffer);
+        char* pos = end;
+        uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+
+        for (unsigned i = 0; i < scale; ++i)
+        {
+            *--pos = (char)('0' + magnitude % 10);
+            magnitude /= 10;
+        }
+
+        if (scale > 0)
+        {
+            *--pos = '.';
+        }
+
+        do
+        {
+            *--pos = (char)('0' + magnitude % 10);
+            magnitude /= 10;
+        }
+        while (magnitude != 0);
+
+        if (value < 0)
+        {
+            *--pos = '-';
+        }
+
+        std::size_t length = end - pos;
+        memcpy(result, pos, length);
+        return length;
+    }
+
+    bool parseDecimal(const char* value, const std::size_t length, const unsigned scale, int64_t& result)
+    {
+        std::size_t i = 0;
+        bool negative = false;
+
+        if (i < length && (value[i] == '-' || value[i] == '+'))
+        {
+            negative = value[i] == '-';
+            ++i;
+        }
+
+        uint64_t magnitude = 0;
+        std::size_t digits = 0;
+        const uint64_t limit = (uint64_t)MAX_VALUE + negative;
+
+        for (; i < length && isDigit(value[i]); ++i, ++digits)
+        {
+            if (magnitude > (limit - (value[i] - '0')) / 10)
+            {
+                return false;
+            }
+
+            magnitude = magnitude * 10 + (value[i] - '0');
+        }
+
+        unsigned fraction = 0;
+        bool roundUp = false;
+
+        if (i < length && value[i] == '.')
+        {
+            ++i;
+
+            for (; i < length && isDigit(value[i]); ++i, ++digits)
+            {
+                if (fraction < scale)
+                {
+                    if (magnitude > (limit - (value[i] - '0')) / 10)
+                    {
+                        return false;
+                    }
+
+                    magnitude = magnitude * 10 + (value[i] - '0');
+                    ++fraction;
+                }
+                else if (fraction == scale)
+                {
+                    roundUp = value[i] >= '5';
+                    ++fraction;
+                }
+            }
+        }
+
+        if (digits == 0 || i != length)
+        {
+            return false;
+        }
+
+        for (; fraction < scale; ++fraction)
+        {
+            if (magnitude > limit / 10)
+            {
+                return false;
+            }
+
+            magnitude *= 10;
+        }
+
+        if (roundUp)
+        {
+            if (magnitude == limit)
+            {
+                return false;
+            }
+
+            ++magnitude;
+        }
+
+        result = (int64_t)(negative ? 0 - magnitude : magnitude);
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    // Kernels
+    //--------------------------------------------------------------------------
+
+    std::size_t addDecimals(const int64_t* a, const unsigned scaleA, const int64_t* b, const unsigned scaleB,
+                            const std::size_t count, const unsigned resultScale, int64_t* result, uint8_t* errors)
+    {
+        return addValues<false>(a, scaleA, b, scaleB, count, resultScale, result, errors);
+    }
+
+    std::size_t subtractDecimals(const int64_t* a, const unsigned scaleA, const int64_t* b, const unsigned scaleB,
+                                 const std::size_t count, const unsigned resultScale, int64_t* result, uint8_t* errors)
+    {
+        return addValues<true>(a, scaleA, b, scaleB, count, resultScale, result, errors);
+    }
+
+    std::size_t multiplyDecimals(const int64_t* a, const unsigned scaleA, const int64_t* b, const unsigned scaleB,
+                                 const std::size_t count, const unsigned resultScale, int64_t* result, uint8_t* errors)
+    {
+        checkScale(scaleA);
+        checkScale(scaleB);
+        checkScale(resultScale);
+        std::size_t failures = 0;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (!rescaleValue((Int128)a[i] * b[i], scaleA + scaleB, resultScale, result[i]))
+            {
+                result[i] = 0;
+                errors[i] = 1;
+                ++failures;
+            }
+        }
+
+        return failures;
+    }
+
+    std::size_t divideDecimals(const int64_t* a, const unsigned scaleA, const int64_t* b, const unsigned scaleB,
+                               const std::size_t count, const unsigned resultScale, int64_t* result, uint8_t* errors)
+    {
+        checkScale(scaleA);
+        checkScale(scaleB);
+        checkScale(resultScale);
+        int exponent = (int)scaleB + (int)resultScale - (int)scaleA;
+        std::size_t failures = 0;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (!divideScaled(a[i], b[i], exponent, result[i]))
+            {
+                result[i] = 0;
+                errors[i] = 1;
+                ++failures;
+            }
+        }
+
+        return failures;
+    }
+
+    std::size_t rescaleDecimals(const int64_t* values, const unsigned scale, const std::size_t count,
+                                const unsigned resultScale, int64_t* result, uint8_t* errors)
+    {
+        checkScale(scale);
+        checkScale(resultScale);
+        std::size_t failures = 0;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (!rescaleValue(values[i], scale, resultScale, result[i]))
+            {
+                result[i] = 0;
+                errors[i] = 1;
+                ++failures;
+            }
+        }
+
+        return failures;
+    }
+
+    //--------------------------------------------------------------------------
+    // Aggregation
+    //--------------------------------------------------------------------------
+
+    int64_t sumDecimals(const ProcData::Column& column, const std::size_t threadCount)
+    {
+        std::size_t count;
+        Int128 sum = sumColumn(column, threadCount, count);
+
+        if (!fits(sum))
+        {
+            throw std::overflow_error("Sum of column " + column.getName() + " overflows");
+        }
+
+        return (int64_t)sum;
+    }
+
+    bool averageDecimals(const ProcData::Column& column, int64_t& result, const unsigned scale,
+                         const unsigned resultScale, const std::size_t threadCount)
+    {
+        checkScale(scale);
+        checkScale(resultScale);
+        std::size_t count;
+        Int128 sum = sumColumn(column, threadCount, count);
+
+        if (count == 0)
+        {
+            return false;
+        }
+
+        if (!divideScaled(sum, count, (int)resultScale - (int)scale, result))
+        {
+            throw std::overflow_error("Average of column " + column.getName() + " overflows");
+        }
+
+        return true;
+    }
+}
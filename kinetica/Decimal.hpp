@@ -0,0 +1,110 @@
+#ifndef _KINETICA_DECIMAL_HPP_
+#define _KINETICA_DECIMAL_HPP_
+
+#include "Proc.hpp"
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+
+namespace kinetica
+{
+    // Fixed-point decimals held as 64-bit unscaled values with a number of
+    // implied decimal places (the scale, 0 to 18). DECIMAL columns hold
+    // unscaled values at DECIMAL_SCALE. Intermediate results are computed in
+    // 128 bits and rounded half away from zero to the result scale.
+
+    const unsigned DECIMAL_SCALE = 4;
+    const unsigned MAX_DECIMAL_SCALE = 18;
+
+    template<unsigned N> struct PowerOfTen { static const int64_t VALUE = PowerOfTen<N - 1>::VALUE * 10; };
+    template<> struct PowerOfTen<0> { static const int64_t VALUE = 1; };
+
+    // 10^DECIMAL_SCALE, the unscaled value of a DECIMAL 1
+    const int64_t DECIMAL_FACTOR = PowerOfTen<DECIMAL_SCALE>::VALUE;
+
+    class Decimal
+    {
+    public:
+        Decimal();
+
+        // Throws std::invalid_argument if scale is over MAX_DECIMAL_SCALE
+        explicit Decimal(const int64_t unscaled, const unsigned scale = DECIMAL_SCALE);
+
+        // Digits past scale are rounded. Throws std::invalid_argument if text
+        // is not a decimal number in range at scale.
+        static Decimal parse(const std::string& text, const unsigned scale = DECIMAL_SCALE);
+
+        int64_t getUnscaled() const;
+        unsigned getScale() const;
+
+        // Throws std::overflow_error if the value does not fit at scale
+        Decimal rescale(const unsigned scale) const;
+
+        double toDouble() const;
+
+        // All decimal places are written, e.g. -12.3400 at scale 4
+        std::string toString() const;
+
+        // Results have the larger scale of the operands. Throw
+        // std::overflow_error if the result does not fit, and division
+        // std::domain_error on division by zero.
+        Decimal operator +(const Decimal& value) const;
+        Decimal operator -(const Decimal& value) const;
+        Decimal operator *(const Decimal& value) const;
+        Decimal operator /(const Decimal& value) const;
+        Decimal operator -() const;
+
+        // Compare values exactly, regardless of scale
+        int compare(const Decimal& value) const;
+        bool operator ==(const Decimal& value) const;
+        bool operator !=(const Decimal& value) const;
+        bool operator <(const Decimal& value) const;
+        bool operator <=(const Decimal& value) const;
+        bool operator >(const Decimal& value) const;
+        bool operator >=(const Decimal& value) const;
+
+    private:
+        int64_t m_unscaled;
+        unsigned m_scale;
+    };
+
+    std::ostream& operator <<(std::ostream& os, const Decimal& value);
+
+    // Writes the text of an unscaled value to result, which must hold at least
+    // 22 bytes, and returns its length (no NUL is written)
+    std::size_t formatDecimal(const int64_t value, const unsigned scale, char* result);
+
+    // Parses an optionally signed decimal number, rounding digits past scale.
+    // Returns false if the text is not a number or is out of range.
+    bool parseDecimal(const char* value, const std::size_t length, const unsigned scale, int64_t& result);
+
+    // Element-wise arithmetic on unscaled values a at scaleA and b at scaleB,
+    // writing results at resultScale. Rows whose result does not fit in 64
+    // bits, and for division rows divided by zero, are set to 0 and flagged
+    // in errors (which is not cleared first). Returns the number of such
+    // rows. Adding and subtracting values at one scale runs branch-free.
+    std::size_t addDecimals(const int64_t* a, const unsigned scaleA, const int64_t* b, const unsigned scaleB,
+                            const std::size_t count, const unsigned resultScale, int64_t* result, uint8_t* errors);
+    std::size_t subtractDecimals(const int64_t* a, const unsigned scaleA, const int64_t* b, const unsigned scaleB,
+                                 const std::size_t count, const unsigned resultScale, int64_t* result, uint8_t* errors);
+    std::size_t multiplyDecimals(const int64_t* a, const unsigned scaleA, const int64_t* b, const unsigned scaleB,
+                                 const std::size_t count, const unsigned resultScale, int64_t* result, uint8_t* errors);
+    std::size_t divideDecimals(const int64_t* a, const unsigned scaleA, const int64_t* b, const unsigned scaleB,
+                               const std::size_t count, const unsigned resultScale, int64_t* result, uint8_t* errors);
+
+    // Rounds or extends values from scale to resultScale, as above
+    std::size_t rescaleDecimals(const int64_t* values, const unsigned scale, const std::size_t count,
+                                const unsigned resultScale, int64_t* result, uint8_t* errors);
+
+    // Sum and average of the non-null values of a DECIMAL or LONG column,
+    // summed exactly in parallel chunks. The sum is at the column's scale
+    // and the average is rounded to resultScale. Both throw
+    // std::overflow_error if the result does not fit in 64 bits; the average
+    // returns false if there are no values.
+    int64_t sumDecimals(const ProcData::Column& column, const std::size_t threadCount = 0);
+    bool averageDecimals(const ProcData::Column& column, int64_t& result, const unsigned scale = DECIMAL_SCALE,
+                         const unsigned resultScale = DECIMAL_SCALE, const std::size_t threadCount = 0);
+}
+
+#endif
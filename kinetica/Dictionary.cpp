@@ -0,0 +1,302 @@
+#include "Dictionary.hpp"
+#include "Hash.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    typedef kinetica::ProcData::Column Column;
+
+    // Rows whose values are gathered into a single var data write
+    const std::size_t APPEND_BATCH_SIZE = 4096;
+
+    const std::size_t MIN_SLOT_COUNT = 64;
+
+    class HashTask : public kinetica::ParallelTask
+    {
+    public:
+        HashTask(const Column& column, const std::size_t chunkCount, uint64_t* hashes) :
+            m_column(column),
+            m_chunkCount(chunkCount),
+            m_hashes(hashes)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            std::size_t start = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index);
+            std::size_t end = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index + 1);
+            kinetica::hashColumn(m_column, start, end - start, m_hashes + start);
+        }
+
+    private:
+        const Column& m_column;
+        std::size_t m_chunkCount;
+        uint64_t* m_hashes;
+    };
+}
+
+namespace kinetica
+{
+    const uint32_t Dictionary::NULL_CODE;
+
+    Dictionary::Dictionary(const ProcData::Column::ColumnType type) :
+        m_type(type),
+        m_offsets(1, 0),
+        m_slots(MIN_SLOT_COUNT, NULL_CODE)
+    {
+        if (type != Column::STRING && type != Column::BYTES)
+        {
+            throw std::invalid_argument("Dictionary type must be STRING or BYTES");
+        }
+    }
+
+    ProcData::Column::ColumnType Dictionary::getType() const
+    {
+        return m_type;
+    }
+
+    std::size_t Dictionary::getSize() const
+    {
+        return m_hashes.size();
+    }
+
+    const uint8_t* Dictionary::getValue(const uint32_t code) const
+    {
+        if (code >= m_hashes.size())
+        {
+            throw std::out_of_range("Dictionary code out of range");
+        }
+
+        return m_data.empty() ? NULL : &m_data[m_offsets[code]];
+    }
+
+    std::size_t Dictionary::getValueSize(const uint32_t code) const
+    {
+        if (code >= m_hashes.size())
+        {
+            throw std::out_of_range("Dictionary code out of range");
+        }
+
+        return (std::size_t)(m_offsets[code + 1] - m_offsets[code]);
+    }
+
+    std::string Dictionary::getString(const uint32_t code) const
+    {
+        std::size_t size = getValueSize(code);
+        std::size_t terminator = m_type == Column::STRING && size > 0 ? 1 : 0;
+        return std::string((const char*)getValue(code), size - terminator);
+    }
+
+    uint32_t Dictionary::add(const void* value, const std::size_t size)
+    {
+        return add(value, size, hash(value, size));
+    }
+
+    uint32_t Dictionary::addString(const std::string& value)
+    {
+        return add(value.c_str(), value.length() + (m_type == Column::STRING ? 1 : 0));
+    }
+
+    uint32_t Dictionary::find(const void* value, const std::size_t size) const
+    {
+        return find(value, size, hash(value, size));
+    }
+
+    uint32_t Dictionary::findString(const std::string& value) const
+    {
+        return find(value.c_str(), value.length() + (m_type == Column::STRING ? 1 : 0));
+    }
+
+    void Dictionary::encode(const ProcData::Column& column, std::vector<uint32_t>& codes, const std::size_t threadCount)
+    {
+        if (column.getType() != m_type)
+        {
+            throw std::invalid_argument("Column " + column.getName() + " does not match dictionary type");
+        }
+
+        std::size_t size = column.getSize();
+        codes.resize(size);
+
+        if (size == 0)
+        {
+            return;
+        }
+
+        std::vector<uint64_t> hashes(size);
+        std::size_t threads = threadCount == 0 ? getHardwareThreadCount() : threadCount;
+        std::size_t chunkCount = size >= kinetica::MIN_PARALLEL_SIZE && threads > 1 ? threads * 4 : 1;
+        HashTask hashTask(column, chunkCount, &hashes[0]);
+        runParallel(hashTask, chunkCount, threadCount);
+
+        const uint64_t* offsets = column.getData<uint64_t>();
+        const uint8_t* data = column.getVarData<uint8_t>();
+        const uint8_t* nulls = column.isNullable() ? column.getNulls() : NULL;
+
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            if (nulls != NULL && nulls[i])
+            {
+                codes[i] = NULL_CODE;
+            }
+            else
+            {
+                codes[i] = add(data + offsets[i], column.getVarValueSize<uint8_t>(i), hashes[i]);
+            }
+        }
+    }
+
+    std::size_t Dictionary::append(ProcData::OutputColumn& column, const uint32_t* codes, const std::size_t count) const
+    {
+        if (column.getType() != m_type)
+        {
+            throw std::invalid_argument("Column " + column.getName() + " does not match dictionary type");
+        }
+
+        std::size_t index = 0;
+        std::vector<uint8_t> buffer;
+        std::vector<uint64_t> offsets;
+        std::size_t start = 0;
+
+        // A single empty batch still reports the index of the next row
+        do
+        {
+            std::size_t batchCount = std::min(APPEND_BATCH_SIZE, count - start);
+            bool hasNulls = false;
+            buffer.clear();
+            offsets.resize(batchCount);
+
+            for (std::size_t i = 0; i < batchCount; ++i)
+            {
+                uint32_t code = codes[start + i];
+                offsets[i] = buffer.size();
+
+                if (code == NULL_CODE)
+                {
+                    if (!column.isNullable())
+                    {
+                        throw std::logic_error("Column " + column.getName() + " is not nullable");
+                    }
+
+                    hasNulls = true;
+                }
+                else if (code < m_hashes.size())
+                {
+                    buffer.insert(buffer.end(), m_data.begin() + m_offsets[code], m_data.begin() + m_offsets[code + 1]);
+                }
+                else
+                {
+                    throw std::out_of_range("Dictionary code out of range");
+                }
+            }
+
+            std::size_t first = column.appendVarValues<uint8_t>(buffer.empty() ? NULL : &buffer[0], buffer.size(),
+                                                                offsets.empty() ? NULL : &offsets[0], batchCount);
+            index = start == 0 ? first : index;
+
+            if (hasNulls)
+            {
+                for (std::size_t i = 0; i < batchCount; ++i)
+                {
+                    if (codes[start + i] == NULL_CODE)
+                    {
+                        column.setNull(first + i);
+                    }
+                }
+            }
+
+            start += batchCount;
+        }
+        while (start < count);
+
+        return index;
+    }
+
+    uint64_t Dictionary::hash(const void* value, const std::size_t size) const
+    {
+        // Matches hashColumn, which does not hash the terminating null of
+        // STRING values
+        std::size_t terminator = m_type == Column::STRING && size > 0 ? 1 : 0;
+        return hashBytes(value, size - terminator);
+    }
+
+    uint32_t Dictionary::find(const void* value, const std::size_t size, const uint64_t hash) const
+    {
+        std::size_t mask = m_slots.size() - 1;
+
+        for (std::size_t slot = (std::size_t)hash & mask; ; slot = (slot + 1) & mask)
+        {
+            uint32_t code = m_slots[slot];
+
+            if (code == NULL_CODE)
+            {
+                return NULL_CODE;
+            }
+
+            if (m_hashes[code] == hash && m_offsets[code + 1] - m_offsets[code] == size
+                && (size == 0 || std::memcmp(&m_data[m_offsets[code]], value, size) == 0))
+            {
+                return code;
+            }
+        }
+    }
+
+    uint32_t Dictionary::add(const void* value, const std::size_t size, const uint64_t hash)
+    {
+        std::size_t mask = m_slots.size() - 1;
+        std::size_t slot = (std::size_t)hash & mask;
+
+        for (; m_slots[slot] != NULL_CODE; slot = (slot + 1) & mask)
+        {
+            uint32_t code = m_slots[slot];
+
+            if (m_hashes[code] == hash && m_offsets[code + 1] - m_offsets[code] == size
+                && (size == 0 || std::memcmp(&m_data[m_offsets[code]], value, size) == 0))
+            {
+                return code;
+            }
+        }
+
+        if (m_hashes.size() >= NULL_CODE)
+        {
+            throw std::length_error("Dictionary size limit exceeded");
+        }
+
+        uint32_t code = (uint32_t)m_hashes.size();
+        m_data.insert(m_data.end(), (const uint8_t*)value, (const uint8_t*)value + size);
+        m_offsets.push_back(m_data.size());
+        m_hashes.push_back(hash);
+        m_slots[slot] = code;
+
+        // Keep the table at most half full
+        if (m_hashes.size() * 2 > m_slots.size())
+        {
+            grow();
+        }
+
+        return code;
+    }
+
+    void Dictionary::grow()
+    {
+        std::vector<uint32_t> slots(m_slots.size() * 2, NULL_CODE);
+        std::size_t mask = slots.size() - 1;
+
+        for (uint32_t code = 0; code < m_hashes.size(); ++code)
+        {
+            std::size_t slot = (std::size_t)m_hashes[code] & mask;
+
+            while (slots[slot] != NULL_CODE)
+            {
+                slot = (slot + 1) & mask;
+            }
+
+            slots[slot] = code;
+        }
+
+        m_slots.swap(slots);
+    }
+}
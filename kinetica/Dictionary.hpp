@@ -0,0 +1,73 @@
+#ifndef _KINETICA_DICTIONARY_HPP_
+#define _KINETICA_DICTIONARY_HPP_
+
+#include "Proc.hpp"
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace kinetica
+{
+    // Set of distinct STRING or BYTES values, each identified by a 32-bit
+    // code in order of first insertion. Values are stored as they appear in
+    // column var data, so STRING values include their terminating null.
+    class Dictionary
+    {
+    public:
+        // Code of a null value
+        static const uint32_t NULL_CODE = 0xffffffff;
+
+        Dictionary(const ProcData::Column::ColumnType type = ProcData::Column::STRING);
+
+        ProcData::Column::ColumnType getType() const;
+
+        // Number of distinct values
+        std::size_t getSize() const;
+
+        const uint8_t* getValue(const uint32_t code) const;
+        std::size_t getValueSize(const uint32_t code) const;
+
+        // Value of a STRING dictionary without its terminating null
+        std::string getString(const uint32_t code) const;
+
+        // Returns the code of a value, adding it if it is not present
+        uint32_t add(const void* value, const std::size_t size);
+        uint32_t addString(const std::string& value);
+
+        // Returns the code of a value, or NULL_CODE if it is not present
+        uint32_t find(const void* value, const std::size_t size) const;
+        uint32_t findString(const std::string& value) const;
+
+        // Replaces codes with the code of each row of a column of the
+        // dictionary's type, adding any new values; null rows get NULL_CODE.
+        // Rows are hashed in parallel and then inserted in a single pass.
+        void encode(const ProcData::Column& column, std::vector<uint32_t>& codes, const std::size_t threadCount = 0);
+
+        // Appends the values with the given codes to a column of the
+        // dictionary's type, copying their bytes into its var data in bulk;
+        // NULL_CODE appends a null. Returns the index of the first appended
+        // row.
+        std::size_t append(ProcData::OutputColumn& column, const uint32_t* codes, const std::size_t count) const;
+
+    private:
+        ProcData::Column::ColumnType m_type;
+        std::vector<uint8_t> m_data;
+
+        // Start of each value in m_data, and the end of the last
+        std::vector<uint64_t> m_offsets;
+
+        std::vector<uint64_t> m_hashes;
+
+        // Open-addressed table of codes indexed by hash
+        std::vector<uint32_t> m_slots;
+
+        uint64_t hash(const void* value, const std::size_t size) const;
+        uint32_t find(const void* value, const std::size_t size, const uint64_t hash) const;
+        uint32_t add(const void* value, const std::size_t size, const uint64_t hash);
+        void grow();
+    };
+}
+
+#endif
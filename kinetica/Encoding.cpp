@@ -0,0 +1,417 @@
+#include "Encoding.hpp"
+#include "Hash.hpp"
+#include "Parallel.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    typedef kinetica::ProcData::Column Column;
+
+    const std::size_t NO_VALUE = (std::size_t)-1;
+
+    void checkFixedWidth(const Column& column)
+    {
+        if (column.getType() == Column::STRING || column.getType() == Column::BYTES)
+        {
+            throw std::invalid_argument("Column " + column.getName() + " is not fixed-width");
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Runs
+    //--------------------------------------------------------------------------
+
+    template<typename T>
+    struct TypedEqual
+    {
+        const T* values;
+
+        bool operator ()(const std::size_t a, const std::size_t b) const
+        {
+            return values[a] == values[b];
+        }
+    };
+
+    struct WideEqual
+    {
+        const uint8_t* values;
+        std::size_t size;
+
+        bool operator ()(const std::size_t a, const std::size_t b) const
+        {
+            return std::memcmp(values + a * size, values + b * size, size) == 0;
+        }
+    };
+
+    // Counts the rows in [start, end), other than row 0, that start a run,
+    // appending them to starts unless it is NULL
+    template<typename Equal>
+    std::size_t scanRuns(const Equal& equal, const uint8_t* nulls, std::size_t start, const std::size_t end,
+                         std::vector<std::size_t>* starts)
+    {
+        std::size_t count = 0;
+
+        for (std::size_t i = start == 0 ? 1 : start; i < end; ++i)
+        {
+            bool isNew = nulls == NULL ? !equal(i - 1, i)
+                                       : nulls[i] != nulls[i - 1] || (!nulls[i] && !equal(i - 1, i));
+
+            if (isNew)
+            {
+                ++count;
+
+                if (starts != NULL)
+                {
+                    starts->push_back(i);
+                }
+            }
+        }
+
+        return count;
+    }
+
+    template<typename T>
+    std::size_t scanRuns(const Column& column, const std::size_t start, const std::size_t end, std::vector<std::size_t>* starts)
+    {
+        TypedEqual<T> equal;
+        equal.values = column.getData<T>();
+        return scanRuns(equal, column.isNullable() ? column.getNulls() : NULL, start, end, starts);
+    }
+
+    std::size_t scanRuns(const Column& column, const std::size_t start, const std::size_t end, std::vector<std::size_t>* starts)
+    {
+        switch (Column::getTypeSize(column.getType()))
+        {
+            case 1: return scanRuns<uint8_t>(column, start, end, starts);
+            case 2: return scanRuns<uint16_t>(column, start, end, starts);
+            case 4: return scanRuns<uint32_t>(column, start, end, starts);
+            case 8: return scanRuns<uint64_t>(column, start, end, starts);
+
+            default:
+            {
+                WideEqual equal;
+                equal.values = column.getData<uint8_t>();
+                equal.size = Column::getTypeSize(column.getType());
+                return scanRuns(equal, column.isNullable() ? column.getNulls() : NULL, start, end, starts);
+            }
+        }
+    }
+
+    // Finds the run starts of each chunk of a column, or only counts them if
+    // starts is empty
+    class RunTask : public kinetica::ParallelTask
+    {
+    public:
+        RunTask(const Column& column, const std::size_t chunkCount, std::vector<std::vector<std::size_t> >& starts,
+                std::vector<std::size_t>& counts) :
+            m_column(column),
+            m_chunkCount(chunkCount),
+            m_starts(starts),
+            m_counts(counts)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            std::size_t start = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index);
+            std::size_t end = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index + 1);
+            m_counts[index] = scanRuns(m_column, start, end, m_starts.empty() ? NULL : &m_starts[index]);
+        }
+
+    private:
+        const Column& m_column;
+        std::size_t m_chunkCount;
+        std::vector<std::vector<std::size_t> >& m_starts;
+        std::vector<std::size_t>& m_counts;
+    };
+
+    std::size_t getChunkCount(const Column& column, const std::size_t threadCount)
+    {
+        std::size_t threads = threadCount == 0 ? kinetica::getHardwareThreadCount() : threadCount;
+        return column.getSize() >= kinetica::MIN_PARALLEL_SIZE && threads > 1 ? threads * 4 : 1;
+    }
+
+    //--------------------------------------------------------------------------
+    // Values
+    //--------------------------------------------------------------------------
+
+    // Open-addressed table of up to maxValueCount distinct values of a
+    // column, each identified by the first row holding it
+    class ValueTable
+    {
+    public:
+        ValueTable(const Column& column, const std::size_t maxValueCount) :
+            m_values(column.getData<uint8_t>()),
+            m_size(Column::getTypeSize(column.getType())),
+            m_maxValueCount(maxValueCount)
+        {
+            std::size_t slotCount = 16;
+
+            while (slotCount < maxValueCount * 2)
+            {
+                slotCount *= 2;
+            }
+
+            m_slots.resize(slotCount, NO_VALUE);
+        }
+
+        const std::vector<std::size_t>& getRows() const
+        {
+            return m_rows;
+        }
+
+        // Returns the index of the value of a row, adding it if it is new, or
+        // NO_VALUE if the table already holds maxValueCount values
+        std::size_t find(const std::size_t row)
+        {
+            const uint8_t* value = m_values + row * m_size;
+            std::size_t mask = m_slots.size() - 1;
+            std::size_t slot = (std::size_t)hash(value) & mask;
+
+            for (; m_slots[slot] != NO_VALUE; slot = (slot + 1) & mask)
+            {
+                if (std::memcmp(m_values + m_rows[m_slots[slot]] * m_size, value, m_size) == 0)
+                {
+                    return m_slots[slot];
+                }
+            }
+
+            if (m_rows.size() == m_maxValueCount)
+            {
+                return NO_VALUE;
+            }
+
+            m_slots[slot] = m_rows.size();
+            m_rows.push_back(row);
+            return m_slots[slot];
+        }
+
+    private:
+        const uint8_t* m_values;
+        std::size_t m_size;
+        std::size_t m_maxValueCount;
+        std::vector<std::size_t> m_slots;
+        std::vector<std::size_t> m_rows;
+
+        uint64_t hash(const uint8_t* value) const
+        {
+            if (m_size <= 8)
+            {
+                uint64_t bits = 0;
+                std::memcpy(&bits, value, m_size);
+                return kinetica::mixHash(bits);
+            }
+
+            return kinetica::hashBytes(value, m_size);
+        }
+    };
+}
+
+namespace kinetica
+{
+    //--------------------------------------------------------------------------
+    // RunView
+    //--------------------------------------------------------------------------
+
+    RunView::RunView() :
+        m_column(NULL),
+        m_starts(1, 0)
+    {
+    }
+
+    void RunView::build(const ProcData::Column& column, const std::size_t threadCount)
+    {
+        checkFixedWidth(column);
+        std::size_t chunkCount = getChunkCount(column, threadCount);
+        std::vector<std::vector<std::size_t> > starts(chunkCount);
+        std::vector<std::size_t> counts(chunkCount);
+        RunTask runTask(column, chunkCount, starts, counts);
+        runParallel(runTask, chunkCount, threadCount);
+
+        m_column = &column;
+        m_starts.assign(1, 0);
+
+        for (std::size_t i = 0; i < chunkCount; ++i)
+        {
+            m_starts.insert(m_starts.end(), starts[i].begin(), starts[i].end());
+        }
+
+        if (column.getSize() > 0)
+        {
+            m_starts.push_back(column.getSize());
+        }
+    }
+
+    const ProcData::Column& RunView::getColumn() const
+    {
+        if (m_column == NULL)
+        {
+            throw std::logic_error("Run view has not been built");
+        }
+
+        return *m_column;
+    }
+
+    std::size_t RunView::getRunCount() const
+    {
+        return m_starts.size() - 1;
+    }
+
+    //--------------------------------------------------------------------------
+    // BitmapIndex
+    //--------------------------------------------------------------------------
+
+    const std::size_t BitmapIndex::DEFAULT_MAX_VALUE_COUNT;
+
+    BitmapIndex::BitmapIndex() :
+        m_column(NULL),
+        m_wordCount(0),
+        m_nullCount(0)
+    {
+    }
+
+    bool BitmapIndex::build(const ProcData::Column& column, const std::size_t maxValueCount)
+    {
+        checkFixedWidth(column);
+        m_column = &column;
+        m_wordCount = (column.getSize() + 63) / 64;
+        m_nullCount = 0;
+        m_rows.clear();
+        m_counts.clear();
+        m_bitmaps.clear();
+
+        ValueTable table(column, maxValueCount);
+        const uint8_t* nulls = column.isNullable() ? column.getNulls() : NULL;
+        const uint8_t* values = column.getData<uint8_t>();
+        std::size_t typeSize = Column::getTypeSize(column.getType());
+        std::size_t value = NO_VALUE;
+
+        for (std::size_t i = 0; i < column.getSize(); ++i)
+        {
+            if (nulls != NULL && nulls[i])
+            {
+                ++m_nullCount;
+                continue;
+            }
+
+            // Consecutive rows often repeat the previous value
+            if (value == NO_VALUE || std::memcmp(values + m_rows[value] * typeSize, values + i * typeSize, typeSize) != 0)
+            {
+                value = table.find(i);
+
+                if (value == NO_VALUE)
+                {
+                    m_nullCount = 0;
+                    m_rows.clear();
+                    m_counts.clear();
+                    m_bitmaps.clear();
+                    return false;
+                }
+
+                if (value == m_rows.size())
+                {
+                    m_rows.push_back(i);
+                    m_counts.push_back(0);
+                    m_bitmaps.resize(m_bitmaps.size() + m_wordCount, 0);
+                }
+            }
+
+            m_bitmaps[value * m_wordCount + i / 64] |= (uint64_t)1 << (i % 64);
+            ++m_counts[value];
+        }
+
+        return true;
+    }
+
+    const ProcData::Column& BitmapIndex::getColumn() const
+    {
+        if (m_column == NULL)
+        {
+            throw std::logic_error("Bitmap index has not been built");
+        }
+
+        return *m_column;
+    }
+
+    std::size_t BitmapIndex::getValueCount() const
+    {
+        return m_rows.size();
+    }
+
+    std::size_t BitmapIndex::getNullCount() const
+    {
+        return m_nullCount;
+    }
+
+    void BitmapIndex::getRows(const std::vector<std::size_t>& values, std::vector<std::size_t>& rows) const
+    {
+        if (values.empty())
+        {
+            return;
+        }
+
+        for (std::size_t i = 0; i < m_wordCount; ++i)
+        {
+            uint64_t word = 0;
+
+            for (std::size_t j = 0; j < values.size(); ++j)
+            {
+                word |= m_bitmaps[values[j] * m_wordCount + i];
+            }
+
+            while (word != 0)
+            {
+                rows.push_back(i * 64 + __builtin_ctzll(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Detection
+    //--------------------------------------------------------------------------
+
+    ColumnEncoding detectEncoding(const ProcData::Column& column, const std::size_t minRunLength,
+                                  const std::size_t maxValueCount, const std::size_t threadCount)
+    {
+        checkFixedWidth(column);
+        std::size_t size = column.getSize();
+
+        if (size == 0)
+        {
+            return PLAIN_ENCODING;
+        }
+
+        std::size_t chunkCount = getChunkCount(column, threadCount);
+        std::vector<std::vector<std::size_t> > starts;
+        std::vector<std::size_t> counts(chunkCount);
+        RunTask runTask(column, chunkCount, starts, counts);
+        runParallel(runTask, chunkCount, threadCount);
+        std::size_t runCount = 1;
+
+        for (std::size_t i = 0; i < chunkCount; ++i)
+        {
+            runCount += counts[i];
+        }
+
+        if (size / runCount >= minRunLength)
+        {
+            return RUN_LENGTH_ENCODING;
+        }
+
+        ValueTable table(column, maxValueCount);
+        const uint8_t* nulls = column.isNullable() ? column.getNulls() : NULL;
+
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            if ((nulls == NULL || !nulls[i]) && table.find(i) == NO_VALUE)
+            {
+                return PLAIN_ENCODING;
+            }
+        }
+
+        return BITMAP_ENCODING;
+    }
+}
@@ -0,0 +1,222 @@
+#ifndef _KINETICA_ENCODING_HPP_
+#define _KINETICA_ENCODING_HPP_
+
+#include "Proc.hpp"
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace kinetica
+{
+    // Compressed views of fixed-width input columns, so that kernels can
+    // process each repeated value once rather than once per row. Values
+    // are compared by their bytes, and all nulls are equal to each other.
+
+    // Runs of equal consecutive values
+    class RunView
+    {
+    public:
+        RunView();
+
+        // Splits column into runs, scanning parts of it in parallel
+        void build(const ProcData::Column& column, const std::size_t threadCount = 0);
+
+        const ProcData::Column& getColumn() const;
+        std::size_t getRunCount() const;
+
+        std::size_t getRunStart(const std::size_t run) const
+        {
+            return m_starts[run];
+        }
+
+        std::size_t getRunLength(const std::size_t run) const
+        {
+            return m_starts[run + 1] - m_starts[run];
+        }
+
+        bool isNull(const std::size_t run) const
+        {
+            return m_column->isNullable() && m_column->isNull(m_starts[run]);
+        }
+
+        template<typename T>
+        const T& getValue(const std::size_t run) const
+        {
+            return m_column->getValue<T>(m_starts[run]);
+        }
+
+    private:
+        const ProcData::Column* m_column;
+
+        // Start of each run, and the end of the last
+        std::vector<std::size_t> m_starts;
+    };
+
+    // Bitmap of the rows holding each distinct non-null value of a column
+    // with few distinct values
+    class BitmapIndex
+    {
+    public:
+        static const std::size_t DEFAULT_MAX_VALUE_COUNT = 16;
+
+        BitmapIndex();
+
+        // Indexes column, returning false (and leaving the index empty) if it
+        // has more than maxValueCount distinct non-null values. Each value
+        // takes one bit per row.
+        bool build(const ProcData::Column& column, const std::size_t maxValueCount = DEFAULT_MAX_VALUE_COUNT);
+
+        const ProcData::Column& getColumn() const;
+
+        // Number of distinct non-null values, in order of first appearance
+        std::size_t getValueCount() const;
+
+        std::size_t getNullCount() const;
+
+        template<typename T>
+        const T& getValue(const std::size_t value) const
+        {
+            return m_column->getValue<T>(m_rows[value]);
+        }
+
+        // Number of rows holding a value
+        std::size_t getRowCount(const std::size_t value) const
+        {
+            return m_counts[value];
+        }
+
+        const uint64_t* getBitmap(const std::size_t value) const
+        {
+            return &m_bitmaps[value * m_wordCount];
+        }
+
+        // Appends the rows, in order, that hold any of the given values
+        void getRows(const std::vector<std::size_t>& values, std::vector<std::size_t>& rows) const;
+
+    private:
+        const ProcData::Column* m_column;
+        std::size_t m_wordCount;
+        std::size_t m_nullCount;
+
+        // First row, row count and bitmap of each value
+        std::vector<std::size_t> m_rows;
+        std::vector<std::size_t> m_counts;
+        std::vector<uint64_t> m_bitmaps;
+    };
+
+    enum ColumnEncoding
+    {
+        PLAIN_ENCODING,
+        RUN_LENGTH_ENCODING,
+        BITMAP_ENCODING
+    };
+
+    // Chooses the view to process a fixed-width column with: runs if they
+    // average at least minRunLength rows, otherwise a bitmap index if the
+    // column has at most maxValueCount distinct non-null values, otherwise
+    // the plain column
+    ColumnEncoding detectEncoding(const ProcData::Column& column, const std::size_t minRunLength = 8,
+                                  const std::size_t maxValueCount = BitmapIndex::DEFAULT_MAX_VALUE_COUNT,
+                                  const std::size_t threadCount = 0);
+
+    // COUNT, SUM, MIN and MAX of the non-null values of a numeric column,
+    // summing in S
+    template<typename T, typename S>
+    struct Summary
+    {
+        std::size_t count;
+        S sum;
+        T min;
+        T max;
+
+        Summary() :
+            count(0),
+            sum(),
+            min(),
+            max()
+        {
+        }
+
+        void add(const T& value, const std::size_t count)
+        {
+            if (this->count == 0 || value < min)
+            {
+                min = value;
+            }
+
+            if (this->count == 0 || max < value)
+            {
+                max = value;
+            }
+
+            sum += (S)value * (S)count;
+            this->count += count;
+        }
+    };
+
+    template<typename T, typename S>
+    Summary<T, S> summarize(const RunView& view)
+    {
+        Summary<T, S> result;
+
+        for (std::size_t i = 0; i < view.getRunCount(); ++i)
+        {
+            if (!view.isNull(i))
+            {
+                result.add(view.getValue<T>(i), view.getRunLength(i));
+            }
+        }
+
+        return result;
+    }
+
+    template<typename T, typename S>
+    Summary<T, S> summarize(const BitmapIndex& index)
+    {
+        Summary<T, S> result;
+
+        for (std::size_t i = 0; i < index.getValueCount(); ++i)
+        {
+            result.add(index.getValue<T>(i), index.getRowCount(i));
+        }
+
+        return result;
+    }
+
+    // Appends the rows, in order, whose non-null values satisfy predicate,
+    // evaluating it once per run
+    template<typename T, typename Predicate>
+    void filter(const RunView& view, Predicate predicate, std::vector<std::size_t>& rows)
+    {
+        for (std::size_t i = 0; i < view.getRunCount(); ++i)
+        {
+            if (!view.isNull(i) && predicate(view.getValue<T>(i)))
+            {
+                for (std::size_t row = view.getRunStart(i), end = row + view.getRunLength(i); row < end; ++row)
+                {
+                    rows.push_back(row);
+                }
+            }
+        }
+    }
+
+    // As above, evaluating predicate once per distinct value
+    template<typename T, typename Predicate>
+    void filter(const BitmapIndex& index, Predicate predicate, std::vector<std::size_t>& rows)
+    {
+        std::vector<std::size_t> values;
+
+        for (std::size_t i = 0; i < index.getValueCount(); ++i)
+        {
+            if (predicate(index.getValue<T>(i)))
+            {
+                values.push_back(i);
+            }
+        }
+
+        index.getRows(values, rows);
+    }
+}
+
+#endif
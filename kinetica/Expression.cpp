@@ -0,0 +1,1984 @@
+#include "Expression.hpp"
+#include "CharNText.hpp"
+#include "Numeric.hpp"
+#include "Parallel.hpp"
+#include "TextParse.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    // Rows evaluated at a time by each task
+    const std::size_t BATCH_SIZE = 1024;
+
+    // Values of a node for a batch of rows: BOOLEAN and INTEGER values are
+    // held in integers, REAL values in reals and STRING values in strings
+    struct Vector
+    {
+        std::vector<int64_t> integers;
+        std::vector<double> reals;
+        std::vector<std::string> strings;
+        std::vector<uint8_t> nulls;
+    };
+
+    struct Batch
+    {
+        // Rows of the batch, or NULL for rows [start, start + count)
+        const std::size_t* rows;
+        std::size_t start;
+        std::size_t count;
+
+        // Vectors of the nodes, by node index
+        std::vector<Vector>* vectors;
+
+        std::size_t getRow(const std::size_t i) const
+        {
+            return rows == NULL ? start + i : rows[i];
+        }
+    };
+}
+
+namespace kinetica
+{
+    // Operator that computes its value for a batch of rows into the vector
+    // of the batch with its index
+    class Expression::Node
+    {
+    public:
+        Type type;
+        std::size_t index;
+
+        Node(const Type type) :
+            type(type),
+            index(0)
+        {
+        }
+
+        virtual ~Node()
+        {
+        }
+
+        virtual void evaluate(Batch& batch) const = 0;
+    };
+}
+
+namespace
+{
+    typedef kinetica::ProcData::Column Column;
+    typedef kinetica::ProcData::OutputColumn OutputColumn;
+    typedef kinetica::Expression Expression;
+    typedef kinetica::Expression::Node Node;
+
+    //--------------------------------------------------------------------------
+    // Values
+    //--------------------------------------------------------------------------
+
+    Expression::Type getColumnType(const Column& column)
+    {
+        switch (column.getType())
+        {
+            case Column::BOOLEAN: return Expression::BOOLEAN;
+            case Column::INT:
+            case Column::INT8:
+            case Column::INT16:
+            case Column::LONG:
+            case Column::TIMESTAMP:
+            case Column::ULONG: return Expression::INTEGER;
+            case Column::DOUBLE:
+            case Column::FLOAT: return Expression::REAL;
+            case Column::STRING: return Expression::STRING;
+
+            default:
+                if (kinetica::getCharNWidth(column.getType()) == 0)
+                {
+                    throw std::invalid_argument("Column " + column.getName() + " has an unsupported type");
+                }
+
+                return Expression::STRING;
+        }
+    }
+
+    inline bool isNumeric(const Expression::Type type)
+    {
+        return type == Expression::INTEGER || type == Expression::REAL;
+    }
+
+    // Wrapping integer arithmetic
+    inline int64_t add(const int64_t a, const int64_t b) { return (int64_t)((uint64_t)a + (uint64_t)b); }
+    inline int64_t subtract(const int64_t a, const int64_t b) { return (int64_t)((uint64_t)a - (uint64_t)b); }
+    inline int64_t multiply(const int64_t a, const int64_t b) { return (int64_t)((uint64_t)a * (uint64_t)b); }
+
+    // ASCII case mapping from the letters starting at first to the other
+    // case; other bytes, including those of UTF-8 sequences, are unchanged
+    struct CaseMapping
+    {
+        char first;
+
+        char operator ()(const char value) const
+        {
+            return (char)(value ^ ((uint8_t)(value - first) < 26 ? 0x20 : 0));
+        }
+    };
+
+    void copyValue(const Expression::Type type, const Vector& source, const std::size_t from, Vector& target, const std::size_t to)
+    {
+        target.nulls[to] = source.nulls[from];
+
+        switch (type)
+        {
+            case Expression::REAL: target.reals[to] = source.reals[from]; break;
+            case Expression::STRING: target.strings[to] = source.strings[from]; break;
+            default: target.integers[to] = source.integers[from]; break;
+        }
+    }
+
+    std::string formatReal(const double value)
+    {
+        char buffer[32];
+        std::sprintf(buffer, "%.15g", value);
+
+        if (std::strtod(buffer, NULL) != value)
+        {
+            std::sprintf(buffer, "%.17g", value);
+        }
+
+        return buffer;
+    }
+
+    // Strings are cast with the parsers used for CSV files and column casts,
+    // ignoring surrounding spaces and tabs
+    bool parseInteger(const std::string& text, int64_t& value)
+    {
+        const char* start = text.data();
+        std::size_t length = text.size();
+        kinetica::trimBlanks(start, length);
+        return kinetica::parseSigned(start, length, std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max(), value);
+    }
+
+    bool parseReal(const std::string& text, double& value)
+    {
+        const char* start = text.data();
+        std::size_t length = text.size();
+        kinetica::trimBlanks(start, length);
+        return kinetica::parseDouble(start, length, value);
+    }
+
+    bool parseBoolean(const std::string& text, int64_t& value)
+    {
+        const char* start = text.data();
+        std::size_t length = text.size();
+        kinetica::trimBlanks(start, length);
+        int8_t result;
+
+        if (!kinetica::parseBoolean(start, length, result))
+        {
+            return false;
+        }
+
+        value = result;
+        return true;
+    }
+
+    // Converts values between types; conversions that fail yield nulls
+    void castValues(const Expression::Type from, const Expression::Type to, const Vector& source, Vector& target,
+                    const std::size_t count)
+    {
+        std::memcpy(&target.nulls[0], &source.nulls[0], count);
+
+        if (from == to)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                copyValue(from, source, i, target, i);
+            }
+
+            return;
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (source.nulls[i])
+            {
+                continue;
+            }
+
+            switch (to)
+            {
+                case Expression::BOOLEAN:
+                    if (from == Expression::STRING)
+                    {
+                        target.nulls[i] = !parseBoolean(source.strings[i], target.integers[i]);
+                    }
+                    else
+                    {
+                        target.integers[i] = from == Expression::REAL ? source.reals[i] != 0 : source.integers[i] != 0;
+                    }
+
+                    break;
+
+                case Expression::INTEGER:
+                    if (from == Expression::STRING)
+                    {
+                        target.nulls[i] = !parseInteger(source.strings[i], target.integers[i]);
+                    }
+                    else if (from == Expression::REAL)
+                    {
+                        double value = source.reals[i];
+                        target.nulls[i] = !(value >= -9223372036854775808.0 && value < 9223372036854775808.0);
+                        target.integers[i] = target.nulls[i] ? 0 : (int64_t)value;
+                    }
+                    else
+                    {
+                        target.integers[i] = source.integers[i];
+                    }
+
+                    break;
+
+                case Expression::REAL:
+                    if (from == Expression::STRING)
+                    {
+                        target.nulls[i] = !parseReal(source.strings[i], target.reals[i]);
+                    }
+                    else
+                    {
+                        target.reals[i] = (double)source.integers[i];
+                    }
+
+                    break;
+
+                case Expression::STRING:
+                    if (from == Expression::BOOLEAN)
+                    {
+                        target.strings[i] = source.integers[i] ? "true" : "false";
+                    }
+                    else if (from == Expression::REAL)
+                    {
+                        target.strings[i] = formatReal(source.reals[i]);
+                    }
+                    else
+                    {
+                        char buffer[24];
+                        std::sprintf(buffer, "%lld", (long long)source.integers[i]);
+                        target.strings[i] = buffer;
+                    }
+
+                    break;
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Nodes
+    //--------------------------------------------------------------------------
+
+    class ColumnNode : public Node
+    {
+    public:
+        ColumnNode(const Column& column) :
+            Node(getColumnType(column)),
+            m_column(column)
+        {
+        }
+
+        virtual void evaluate(Batch& batch) const
+        {
+            Vector& result = (*batch.vectors)[index];
+
+            if (m_column.isNullable())
+            {
+                const uint8_t* nulls = m_column.getNulls();
+
+                for (std::size_t i = 0; i < batch.count; ++i)
+                {
+                    result.nulls[i] = nulls[batch.getRow(i)];
+                }
+            }
+            else
+            {
+                std::memset(&result.nulls[0], 0, batch.count);
+            }
+
+            switch (m_column.getType())
+            {
+                case Column::BOOLEAN:
+                case Column::INT8: load<int8_t>(batch, &result.integers[0]); break;
+                case Column::INT: load<int32_t>(batch, &result.integers[0]); break;
+                case Column::INT16: load<int16_t>(batch, &result.integers[0]); break;
+                case Column::LONG:
+                case Column::TIMESTAMP: load<int64_t>(batch, &result.integers[0]); break;
+                case Column::ULONG: load<uint64_t>(batch, &result.integers[0]); break;
+                case Column::DOUBLE: load<double>(batch, &result.reals[0]); break;
+                case Column::FLOAT: load<float>(batch, &result.reals[0]); break;
+
+                case Column::STRING:
+                    for (std::size_t i = 0; i < batch.count; ++i)
+                    {
+                        std::size_t row = batch.getRow(i);
+                        std::size_t size = m_column.getVarValueSize<char>(row);
+                        result.strings[i].assign(m_column.getVarValue<char>(row), size > 0 ? size - 1 : 0);
+                    }
+
+                    break;
+
+                default:
+                {
+                    std::size_t width = kinetica::getCharNWidth(m_column.getType());
+                    const char* data = m_column.getData<char>();
+                    char text[256];
+
+                    for (std::size_t i = 0; i < batch.count; ++i)
+                    {
+                        kinetica::charNToText(data + batch.getRow(i) * width, width, 1, text);
+                        result.strings[i].assign(text, std::find(text, text + width, 0) - text);
+                    }
+
+                    break;
+                }
+            }
+        }
+
+    private:
+        const Column& m_column;
+
+        template<typename T, typename A>
+        void load(const Batch& batch, A* result) const
+        {
+            const T* data = m_column.getData<T>();
+
+            if (batch.rows == NULL)
+            {
+                data += batch.start;
+
+                for (std::size_t i = 0; i < batch.count; ++i)
+                {
+                    result[i] = (A)data[i];
+                }
+            }
+            else
+            {
+                for (std::size_t i = 0; i < batch.count; ++i)
+                {
+                    result[i] = (A)data[batch.rows[i]];
+                }
+            }
+        }
+    };
+
+    class ConstantNode : public Node
+    {
+    public:
+        int64_t integer;
+        double real;
+        std::string string;
+        bool isNull;
+
+        ConstantNode(const Expression::Type type) :
+            Node(type),
+            integer(0),
+            real(0),
+            isNull(false)
+        {
+        }
+
+        virtual void evaluate(Batch& batch) const
+        {
+            Vector& result = (*batch.vectors)[index];
+            std::memset(&result.nulls[0], isNull ? 1 : 0, batch.count);
+
+            switch (type)
+            {
+                case Expression::REAL: std::fill(result.reals.begin(), result.reals.begin() + batch.count, real); break;
+                case Expression::STRING: std::fill(result.strings.begin(), result.strings.begin() + batch.count, string); break;
+                default: std::fill(result.integers.begin(), result.integers.begin() + batch.count, integer); break;
+            }
+        }
+    };
+
+    enum Operation
+    {
+        NEGATE,
+        ADD,
+        SUBTRACT,
+        MULTIPLY,
+        DIVIDE,
+        MODULO,
+        EQUAL,
+        NOT_EQUAL,
+        LESS,
+        LESS_EQUAL,
+        GREATER,
+        GREATER_EQUAL,
+        AND,
+        OR,
+        NOT,
+        IS_NULL,
+        IS_NOT_NULL,
+        CASE,
+        CAST,
+        ABS,
+        LENGTH,
+        LOWER,
+        UPPER,
+        TRIM,
+        SUBSTR,
+        CONCAT,
+        COALESCE
+    };
+
+    template<typename T>
+    void compareValues(const Operation operation, const T* a, const T* b, int64_t* result, const std::size_t count)
+    {
+        switch (operation)
+        {
+            case EQUAL: for (std::size_t i = 0; i < count; ++i) result[i] = a[i] == b[i]; break;
+            case NOT_EQUAL: for (std::size_t i = 0; i < count; ++i) result[i] = a[i] != b[i]; break;
+            case LESS: for (std::size_t i = 0; i < count; ++i) result[i] = a[i] < b[i]; break;
+            case LESS_EQUAL: for (std::size_t i = 0; i < count; ++i) result[i] = a[i] <= b[i]; break;
+            case GREATER: for (std::size_t i = 0; i < count; ++i) result[i] = a[i] > b[i]; break;
+            default: for (std::size_t i = 0; i < count; ++i) result[i] = a[i] >= b[i]; break;
+        }
+    }
+
+    // Operator over the values of its arguments, which have the types it
+    // expects (see Parser)
+    class OperationNode : public Node
+    {
+    public:
+        OperationNode(const Operation operation, const Expression::Type type, const std::vector<const Node*>& arguments) :
+            Node(type),
+            m_operation(operation),
+            m_arguments(arguments)
+        {
+        }
+
+        virtual void evaluate(Batch& batch) const
+        {
+            for (std::size_t i = 0; i < m_arguments.size(); ++i)
+            {
+                m_arguments[i]->evaluate(batch);
+            }
+
+            Vector& result = (*batch.vectors)[index];
+            std::size_t count = batch.count;
+
+            switch (m_operation)
+            {
+                case NEGATE:
+                case ABS:
+                    computeSign(batch, result);
+                    break;
+
+                case ADD:
+                case SUBTRACT:
+                case MULTIPLY:
+                case DIVIDE:
+                case MODULO:
+                    mergeNulls(batch, result);
+
+                    if (type == Expression::REAL)
+                    {
+                        computeReals(batch, result);
+                    }
+                    else
+                    {
+                        computeIntegers(batch, result);
+                    }
+
+                    break;
+
+                case EQUAL:
+                case NOT_EQUAL:
+                case LESS:
+                case LESS_EQUAL:
+                case GREATER:
+                case GREATER_EQUAL:
+                {
+                    mergeNulls(batch, result);
+                    const Vector& a = getArgument(batch, 0);
+                    const Vector& b = getArgument(batch, 1);
+
+                    switch (m_arguments[0]->type)
+                    {
+                        case Expression::REAL: compareValues(m_operation, &a.reals[0], &b.reals[0], &result.integers[0], count); break;
+                        case Expression::STRING: compareValues(m_operation, &a.strings[0], &b.strings[0], &result.integers[0], count); break;
+                        default: compareValues(m_operation, &a.integers[0], &b.integers[0], &result.integers[0], count); break;
+                    }
+
+                    break;
+                }
+
+                case AND:
+                case OR:
+                {
+                    const Vector& a = getArgument(batch, 0);
+                    const Vector& b = getArgument(batch, 1);
+
+                    // A known false (AND) or true (OR) argument decides the
+                    // result even if the other is null
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        bool isA = !a.nulls[i] && (a.integers[i] != 0) == (m_operation == OR);
+                        bool isB = !b.nulls[i] && (b.integers[i] != 0) == (m_operation == OR);
+                        bool isDecided = isA || isB;
+                        result.integers[i] = isDecided ? m_operation == OR : m_operation == AND;
+                        result.nulls[i] = !isDecided && (a.nulls[i] | b.nulls[i]);
+                    }
+
+                    break;
+                }
+
+                case NOT:
+                {
+                    const Vector& a = getArgument(batch, 0);
+
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        result.integers[i] = a.integers[i] == 0;
+                        result.nulls[i] = a.nulls[i];
+                    }
+
+                    break;
+                }
+
+                case IS_NULL:
+                case IS_NOT_NULL:
+                {
+                    const Vector& a = getArgument(batch, 0);
+
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        result.integers[i] = (a.nulls[i] != 0) == (m_operation == IS_NULL);
+                        result.nulls[i] = 0;
+                    }
+
+                    break;
+                }
+
+                case CASE:
+                {
+                    // Arguments are condition and value pairs and an optional
+                    // else value; the first true condition wins
+                    std::size_t pairCount = m_arguments.size() / 2;
+
+                    if (m_arguments.size() % 2 == 1)
+                    {
+                        castValues(type, type, getArgument(batch, m_arguments.size() - 1), result, count);
+                    }
+                    else
+                    {
+                        std::memset(&result.nulls[0], 1, count);
+                    }
+
+                    for (std::size_t j = pairCount; j-- > 0;)
+                    {
+                        const Vector& condition = getArgument(batch, j * 2);
+                        const Vector& value = getArgument(batch, j * 2 + 1);
+
+                        for (std::size_t i = 0; i < count; ++i)
+                        {
+                            if (!condition.nulls[i] && condition.integers[i])
+                            {
+                                copyValue(type, value, i, result, i);
+                            }
+                        }
+                    }
+
+                    break;
+                }
+
+                case CAST:
+                    castValues(m_arguments[0]->type, type, getArgument(batch, 0), result, count);
+                    break;
+
+                case COALESCE:
+                    castValues(type, type, getArgument(batch, 0), result, count);
+
+                    for (std::size_t j = 1; j < m_arguments.size(); ++j)
+                    {
+                        const Vector& value = getArgument(batch, j);
+
+                        for (std::size_t i = 0; i < count; ++i)
+                        {
+                            if (result.nulls[i] && !value.nulls[i])
+                            {
+                                copyValue(type, value, i, result, i);
+                            }
+                        }
+                    }
+
+                    break;
+
+                default:
+                    mergeNulls(batch, result);
+                    computeStrings(batch, result);
+                    break;
+            }
+        }
+
+    private:
+        Operation m_operation;
+        std::vector<const Node*> m_arguments;
+
+        const Vector& getArgument(const Batch& batch, const std::size_t argument) const
+        {
+            return (*batch.vectors)[m_arguments[argument]->index];
+        }
+
+        // Result is null if any argument is null
+        void mergeNulls(const Batch& batch, Vector& result) const
+        {
+            std::memcpy(&result.nulls[0], &getArgument(batch, 0).nulls[0], batch.count);
+
+            for (std::size_t j = 1; j < m_arguments.size(); ++j)
+            {
+                const uint8_t* nulls = &getArgument(batch, j).nulls[0];
+
+                for (std::size_t i = 0; i < batch.count; ++i)
+                {
+                    result.nulls[i] |= nulls[i];
+                }
+            }
+        }
+
+        void computeSign(const Batch& batch, Vector& result) const
+        {
+            const Vector& a = getArgument(batch, 0);
+            std::memcpy(&result.nulls[0], &a.nulls[0], batch.count);
+
+            if (type == Expression::REAL)
+            {
+                for (std::size_t i = 0; i < batch.count; ++i)
+                {
+                    result.reals[i] = m_operation == NEGATE ? -a.reals[i] : std::fabs(a.reals[i]);
+                }
+            }
+            else
+            {
+                for (std::size_t i = 0; i < batch.count; ++i)
+                {
+                    result.integers[i] = m_operation == NEGATE || a.integers[i] < 0 ? subtract(0, a.integers[i]) : a.integers[i];
+                }
+            }
+        }
+
+        void computeIntegers(const Batch& batch, Vector& result) const
+        {
+            const int64_t* a = &getArgument(batch, 0).integers[0];
+            const int64_t* b = &getArgument(batch, 1).integers[0];
+            int64_t* values = &result.integers[0];
+            std::size_t count = batch.count;
+
+            switch (m_operation)
+            {
+                case ADD: for (std::size_t i = 0; i < count; ++i) values[i] = add(a[i], b[i]); break;
+                case SUBTRACT: for (std::size_t i = 0; i < count; ++i) values[i] = subtract(a[i], b[i]); break;
+                case MULTIPLY: for (std::size_t i = 0; i < count; ++i) values[i] = multiply(a[i], b[i]); break;
+
+                default:
+                    // Division by -1 negates to avoid overflowing on the
+                    // minimum value
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        if (b[i] == 0)
+                        {
+                            values[i] = 0;
+                            result.nulls[i] = 1;
+                        }
+                        else if (b[i] == -1)
+                        {
+                            values[i] = m_operation == DIVIDE ? subtract(0, a[i]) : 0;
+                        }
+                        else
+                        {
+                            values[i] = m_operation == DIVIDE ? a[i] / b[i] : a[i] % b[i];
+                        }
+                    }
+
+                    break;
+            }
+        }
+
+        void computeReals(const Batch& batch, Vector& result) const
+        {
+            const double* a = &getArgument(batch, 0).reals[0];
+            const double* b = &getArgument(batch, 1).reals[0];
+            double* values = &result.reals[0];
+            std::size_t count = batch.count;
+
+            switch (m_operation)
+            {
+                case ADD: for (std::size_t i = 0; i < count; ++i) values[i] = a[i] + b[i]; break;
+                case SUBTRACT: for (std::size_t i = 0; i < count; ++i) values[i] = a[i] - b[i]; break;
+                case MULTIPLY: for (std::size_t i = 0; i < count; ++i) values[i] = a[i] * b[i]; break;
+
+                default:
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        result.nulls[i] |= b[i] == 0;
+                        values[i] = b[i] == 0 ? 0 : (m_operation == DIVIDE ? a[i] / b[i] : std::fmod(a[i], b[i]));
+                    }
+
+                    break;
+            }
+        }
+
+        void computeStrings(const Batch& batch, Vector& result) const
+        {
+            const Vector& a = getArgument(batch, 0);
+
+            for (std::size_t i = 0; i < batch.count; ++i)
+            {
+                if (result.nulls[i])
+                {
+                    continue;
+                }
+
+                const std::string& value = a.strings[i];
+
+                switch (m_operation)
+                {
+                    case LENGTH:
+                        result.integers[i] = (int64_t)value.size();
+                        break;
+
+                    case LOWER:
+                    case UPPER:
+                    {
+                        CaseMapping mapping = { m_operation == LOWER ? 'A' : 'a' };
+                        result.strings[i].resize(value.size());
+                        std::transform(value.begin(), value.end(), result.strings[i].begin(), mapping);
+                        break;
+                    }
+
+                    case TRIM:
+                    {
+                        std::size_t start = 0;
+                        std::size_t end = value.size();
+
+                        while (start < end && std::isspace((unsigned char)value[start]))
+                        {
+                            ++start;
+                        }
+
+                        while (end > start && std::isspace((unsigned char)value[end - 1]))
+                        {
+                            --end;
+                        }
+
+                        result.strings[i].assign(value, start, end - start);
+                        break;
+                    }
+
+                    case SUBSTR:
+                    {
+                        // Positions before the first character count against
+                        // the length, as in SQL
+                        int64_t start = subtract(getArgument(batch, 1).integers[i], 1);
+                        int64_t end = (int64_t)value.size();
+
+                        if (m_arguments.size() > 2)
+                        {
+                            int64_t length = getArgument(batch, 2).integers[i];
+
+                            if (length < 0)
+                            {
+                                result.nulls[i] = 1;
+                                break;
+                            }
+
+                            end = start > end - length ? end : std::max(start + length, (int64_t)0);
+                        }
+
+                        start = std::min(std::max(start, (int64_t)0), (int64_t)value.size());
+                        end = std::max(end, start);
+                        result.strings[i].assign(value, (std::size_t)start, (std::size_t)(end - start));
+                        break;
+                    }
+
+                    default:
+                        result.strings[i] = value;
+
+                        for (std::size_t j = 1; j < m_arguments.size(); ++j)
+                        {
+                            result.strings[i] += getArgument(batch, j).strings[i];
+                        }
+
+                        break;
+                }
+            }
+        }
+    };
+
+    //--------------------------------------------------------------------------
+    // Parser
+    //--------------------------------------------------------------------------
+
+    // Recursive descent parser that builds the nodes of an expression, adding
+    // implicit INTEGER to REAL casts and giving NULL literals the type their
+    // context needs
+    class Parser
+    {
+    public:
+        Parser(const std::string& text, const kinetica::ProcData::InputTable& table, std::vector<Node*>& nodes) :
+            m_text(text),
+            m_table(table),
+            m_nodes(nodes),
+            m_pos(0)
+        {
+        }
+
+        const Node* parse()
+        {
+            Node* node = parseOr();
+            skipSpace();
+
+            if (m_pos < m_text.size())
+            {
+                fail("unexpected text");
+            }
+
+            return node;
+        }
+
+    private:
+        const std::string& m_text;
+        const kinetica::ProcData::InputTable& m_table;
+        std::vector<Node*>& m_nodes;
+        std::size_t m_pos;
+
+        void fail(const std::string& message) const
+        {
+            char position[24];
+            std::sprintf(position, "%llu", (unsigned long long)m_pos + 1);
+            throw std::invalid_argument("Invalid expression at position " + std::string(position) + ": " + message);
+        }
+
+        Node* add(Node* node)
+        {
+            m_nodes.push_back(node);
+            node->index = m_nodes.size() - 1;
+            return node;
+        }
+
+        Node* add(const Operation operation, const Expression::Type type, Node* a, Node* b = NULL)
+        {
+            std::vector<const Node*> arguments(1, a);
+
+            if (b != NULL)
+            {
+                arguments.push_back(b);
+            }
+
+            return add(new OperationNode(operation, type, arguments));
+        }
+
+        void skipSpace()
+        {
+            while (m_pos < m_text.size() && std::isspace((unsigned char)m_text[m_pos]))
+            {
+                ++m_pos;
+            }
+        }
+
+        static bool isNameChar(const char c)
+        {
+            return std::isalnum((unsigned char)c) || c == '_';
+        }
+
+        bool acceptSymbol(const char* symbol)
+        {
+            skipSpace();
+            std::size_t length = std::strlen(symbol);
+
+            if (m_text.compare(m_pos, length, symbol) != 0)
+            {
+                return false;
+            }
+
+            m_pos += length;
+            return true;
+        }
+
+        bool acceptKeyword(const char* keyword)
+        {
+            skipSpace();
+            std::size_t length = std::strlen(keyword);
+
+            if (m_pos + length > m_text.size() || (m_pos + length < m_text.size() && isNameChar(m_text[m_pos + length])))
+            {
+                return false;
+            }
+
+            for (std::size_t i = 0; i < length; ++i)
+            {
+                if (std::toupper((unsigned char)m_text[m_pos + i]) != keyword[i])
+                {
+                    return false;
+                }
+            }
+
+            m_pos += length;
+            return true;
+        }
+
+        void expectSymbol(const char* symbol)
+        {
+            if (!acceptSymbol(symbol))
+            {
+                fail(std::string("expected ") + symbol);
+            }
+        }
+
+        void expectKeyword(const char* keyword)
+        {
+            if (!acceptKeyword(keyword))
+            {
+                fail(std::string("expected ") + keyword);
+            }
+        }
+
+        std::string parseName()
+        {
+            skipSpace();
+            std::size_t start = m_pos;
+
+            while (m_pos < m_text.size() && isNameChar(m_text[m_pos]))
+            {
+                ++m_pos;
+            }
+
+            if (m_pos == start || std::isdigit((unsigned char)m_text[start]))
+            {
+                m_pos = start;
+                fail("expected a name");
+            }
+
+            return m_text.substr(start, m_pos - start);
+        }
+
+        std::string parseQuoted(const char quote)
+        {
+            std::string result;
+            ++m_pos;
+
+            while (true)
+            {
+                if (m_pos >= m_text.size())
+                {
+                    fail("unterminated quote");
+                }
+
+                if (m_text[m_pos] == quote)
+                {
+                    if (m_pos + 1 < m_text.size() && m_text[m_pos + 1] == quote)
+                    {
+                        result += quote;
+                        m_pos += 2;
+                        continue;
+                    }
+
+                    ++m_pos;
+                    return result;
+                }
+
+                result += m_text[m_pos++];
+            }
+        }
+
+        static bool isNullLiteral(const Node* node)
+        {
+            const ConstantNode* constant = dynamic_cast<const ConstantNode*>(node);
+            return constant != NULL && constant->isNull;
+        }
+
+        // Converts a node to a type with an implicit cast
+        Node* coerce(Node* node, const Expression::Type type)
+        {
+            if (node->type == type)
+            {
+                return node;
+            }
+            else if (isNullLiteral(node))
+            {
+                node->type = type;
+                return node;
+            }
+            else if (node->type == Expression::INTEGER && type == Expression::REAL)
+            {
+                return add(CAST, Expression::REAL, node);
+            }
+
+            fail("type mismatch");
+            return NULL;
+        }
+
+        // Common type of values that must have the same type
+        Expression::Type unify(const std::vector<Node*>& nodes)
+        {
+            Expression::Type type = Expression::INTEGER;
+            bool isTyped = false;
+
+            for (std::size_t i = 0; i < nodes.size(); ++i)
+            {
+                if (isNullLiteral(nodes[i]))
+                {
+                    continue;
+                }
+
+                if (!isTyped)
+                {
+                    type = nodes[i]->type;
+                    isTyped = true;
+                }
+                else if (isNumeric(type) && isNumeric(nodes[i]->type))
+                {
+                    type = type == Expression::REAL || nodes[i]->type == Expression::REAL ? Expression::REAL : Expression::INTEGER;
+                }
+                else if (type != nodes[i]->type)
+                {
+                    fail("type mismatch");
+                }
+            }
+
+            return type;
+        }
+
+        Node* parseOr()
+        {
+            Node* node = parseAnd();
+
+            while (acceptKeyword("OR"))
+            {
+                node = add(OR, Expression::BOOLEAN, coerce(node, Expression::BOOLEAN), coerce(parseAnd(), Expression::BOOLEAN));
+            }
+
+            return node;
+        }
+
+        Node* parseAnd()
+        {
+            Node* node = parseNot();
+
+            while (acceptKeyword("AND"))
+            {
+                node = add(AND, Expression::BOOLEAN, coerce(node, Expression::BOOLEAN), coerce(parseNot(), Expression::BOOLEAN));
+            }
+
+            return node;
+        }
+
+        Node* parseNot()
+        {
+            if (acceptKeyword("NOT"))
+            {
+                return add(NOT, Expression::BOOLEAN, coerce(parseNot(), Expression::BOOLEAN));
+            }
+
+            return parseComparison();
+        }
+
+        Node* parseComparison()
+        {
+            Node* node = parseConcat();
+            Operation operation;
+
+            if (acceptKeyword("IS"))
+            {
+                operation = acceptKeyword("NOT") ? IS_NOT_NULL : IS_NULL;
+                expectKeyword("NULL");
+                return add(operation, Expression::BOOLEAN, node);
+            }
+
+            if (acceptSymbol("==") || acceptSymbol("="))
+            {
+                operation = EQUAL;
+            }
+            else if (acceptSymbol("!=") || acceptSymbol("<>"))
+            {
+                operation = NOT_EQUAL;
+            }
+            else if (acceptSymbol("<="))
+            {
+                operation = LESS_EQUAL;
+            }
+            else if (acceptSymbol("<"))
+            {
+                operation = LESS;
+            }
+            else if (acceptSymbol(">="))
+            {
+                operation = GREATER_EQUAL;
+            }
+            else if (acceptSymbol(">"))
+            {
+                operation = GREATER;
+            }
+            else
+            {
+                return node;
+            }
+
+            std::vector<Node*> arguments(1, node);
+            arguments.push_back(parseConcat());
+            Expression::Type type = unify(arguments);
+            return add(operation, Expression::BOOLEAN, coerce(arguments[0], type), coerce(arguments[1], type));
+        }
+
+        Node* parseConcat()
+        {
+            Node* node = parseAdditive();
+
+            while (acceptSymbol("||"))
+            {
+                node = add(CONCAT, Expression::STRING, coerce(node, Expression::STRING), coerce(parseAdditive(), Expression::STRING));
+            }
+
+            return node;
+        }
+
+        Node* parseArithmetic(const Operation operation, Node* a, Node* b)
+        {
+            std::vector<Node*> arguments(1, a);
+            arguments.push_back(b);
+            Expression::Type type = unify(arguments);
+
+            if (!isNumeric(type))
+            {
+                fail("arithmetic on non-numeric values");
+            }
+
+            return add(operation, type, coerce(a, type), coerce(b, type));
+        }
+
+        Node* parseAdditive()
+        {
+            Node* node = parseTerm();
+
+            while (true)
+            {
+                if (acceptSymbol("+"))
+                {
+                    node = parseArithmetic(ADD, node, parseTerm());
+                }
+                else if (acceptSymbol("-"))
+                {
+                    node = parseArithmetic(SUBTRACT, node, parseTerm());
+                }
+                else
+                {
+                    return node;
+                }
+            }
+        }
+
+        Node* parseTerm()
+        {
+            Node* node = parseUnary();
+
+            while (true)
+            {
+                if (acceptSymbol("*"))
+                {
+                    node = parseArithmetic(MULTIPLY, node, parseUnary());
+                }
+                else if (acceptSymbol("/"))
+                {
+                    node = parseArithmetic(DIVIDE, node, parseUnary());
+                }
+                else if (acceptSymbol("%"))
+                {
+                    node = parseArithmetic(MODULO, node, parseUnary());
+                }
+                else
+                {
+                    return node;
+                }
+            }
+        }
+
+        Node* parseUnary()
+        {
+            if (acceptSymbol("-"))
+            {
+                Node* node = parseUnary();
+
+                if (!isNumeric(node->type) && !isNullLiteral(node))
+                {
+                    fail("negation of a non-numeric value");
+                }
+
+                return add(NEGATE, node->type, node);
+            }
+            else if (acceptSymbol("+"))
+            {
+                return parseUnary();
+            }
+
+            return parsePrimary();
+        }
+
+        Node* parseNumber()
+        {
+            const char* start = m_text.c_str() + m_pos;
+            char* end;
+            bool isReal = false;
+
+            for (const char* c = start; std::isalnum((unsigned char)*c) || *c == '.'
+                 || ((*c == '+' || *c == '-') && (c[-1] == 'e' || c[-1] == 'E')); ++c)
+            {
+                isReal |= *c == '.' || *c == 'e' || *c == 'E';
+            }
+
+            ConstantNode* node = new ConstantNode(isReal ? Expression::REAL : Expression::INTEGER);
+            add(node);
+            errno = 0;
+
+            if (!isReal)
+            {
+                node->integer = std::strtoll(start, &end, 10);
+            }
+
+            if (isReal || errno == ERANGE)
+            {
+                node->type = Expression::REAL;
+                node->real = std::strtod(start, &end);
+            }
+
+            if (isNameChar(*end) || *end == '.')
+            {
+                fail("invalid number");
+            }
+
+            m_pos = end - m_text.c_str();
+            return node;
+        }
+
+        Node* parseCase()
+        {
+            std::vector<Node*> arguments;
+
+            while (acceptKeyword("WHEN"))
+            {
+                arguments.push_back(coerce(parseOr(), Expression::BOOLEAN));
+                expectKeyword("THEN");
+                arguments.push_back(parseOr());
+            }
+
+            if (arguments.empty())
+            {
+                fail("expected WHEN");
+            }
+
+            if (acceptKeyword("ELSE"))
+            {
+                arguments.push_back(parseOr());
+            }
+
+            expectKeyword("END");
+            std::vector<Node*> values;
+
+            for (std::size_t i = 1; i < arguments.size(); i += 2)
+            {
+                values.push_back(arguments[i]);
+            }
+
+            if (arguments.size() % 2 == 1)
+            {
+                values.push_back(arguments.back());
+            }
+
+            Expression::Type type = unify(values);
+            std::vector<const Node*> coerced;
+
+            for (std::size_t i = 0; i < arguments.size(); ++i)
+            {
+                coerced.push_back(i % 2 == 1 || i == arguments.size() - 1 ? coerce(arguments[i], type) : arguments[i]);
+            }
+
+            return add(new OperationNode(CASE, type, coerced));
+        }
+
+        Node* parseCast()
+        {
+            expectSymbol("(");
+            Node* node = parseOr();
+            expectKeyword("AS");
+            std::string name = parseName();
+            std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+            Expression::Type type;
+
+            if (name == "BOOLEAN" || name == "BOOL")
+            {
+                type = Expression::BOOLEAN;
+            }
+            else if (name == "INTEGER" || name == "INT" || name == "LONG" || name == "BIGINT")
+            {
+                type = Expression::INTEGER;
+            }
+            else if (name == "REAL" || name == "FLOAT" || name == "DOUBLE")
+            {
+                type = Expression::REAL;
+            }
+            else if (name == "STRING" || name == "VARCHAR")
+            {
+                type = Expression::STRING;
+            }
+            else
+            {
+                fail("unknown type " + name);
+                return NULL;
+            }
+
+            expectSymbol(")");
+            return isNullLiteral(node) ? coerce(node, type) : add(CAST, type, node);
+        }
+
+        Node* parseFunction(const std::string& name, const std::size_t start)
+        {
+            std::string upper(name);
+            std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+
+            if (upper == "CAST")
+            {
+                return parseCast();
+            }
+
+            expectSymbol("(");
+            std::vector<Node*> arguments;
+
+            if (!acceptSymbol(")"))
+            {
+                do
+                {
+                    arguments.push_back(parseOr());
+                }
+                while (acceptSymbol(","));
+
+                expectSymbol(")");
+            }
+
+            Operation operation;
+            std::size_t minCount = 1;
+            std::size_t maxCount = 1;
+
+            if (upper == "ABS")
+            {
+                operation = ABS;
+            }
+            else if (upper == "LENGTH")
+            {
+                operation = LENGTH;
+            }
+            else if (upper == "LOWER")
+            {
+                operation = LOWER;
+            }
+            else if (upper == "UPPER")
+            {
+                operation = UPPER;
+            }
+            else if (upper == "TRIM")
+            {
+                operation = TRIM;
+            }
+            else if (upper == "SUBSTR" || upper == "SUBSTRING")
+            {
+                operation = SUBSTR;
+                minCount = 2;
+                maxCount = 3;
+            }
+            else if (upper == "CONCAT")
+            {
+                operation = CONCAT;
+                maxCount = (std::size_t)-1;
+            }
+            else if (upper == "COALESCE")
+            {
+                operation = COALESCE;
+                maxCount = (std::size_t)-1;
+            }
+            else
+            {
+                m_pos = start;
+                fail("unknown function " + name);
+                return NULL;
+            }
+
+            if (arguments.size() < minCount || arguments.size() > maxCount)
+            {
+                fail("wrong number of arguments to " + upper);
+            }
+
+            Expression::Type type;
+            std::vector<const Node*> coerced;
+
+            switch (operation)
+            {
+                case ABS:
+                    type = unify(arguments);
+
+                    if (!isNumeric(type))
+                    {
+                        fail("ABS of a non-numeric value");
+                    }
+
+                    coerced.push_back(coerce(arguments[0], type));
+                    break;
+
+                case COALESCE:
+                    type = unify(arguments);
+
+                    for (std::size_t i = 0; i < arguments.size(); ++i)
+                    {
+                        coerced.push_back(coerce(arguments[i], type));
+                    }
+
+                    break;
+
+                default:
+                    type = operation == LENGTH ? Expression::INTEGER : Expression::STRING;
+
+                    for (std::size_t i = 0; i < arguments.size(); ++i)
+                    {
+                        bool isString = operation != SUBSTR || i == 0;
+                        coerced.push_back(coerce(arguments[i], isString ? Expression::STRING : Expression::INTEGER));
+                    }
+
+                    break;
+            }
+
+            return add(new OperationNode(operation, type, coerced));
+        }
+
+        Node* parsePrimary()
+        {
+            skipSpace();
+
+            if (m_pos >= m_text.size())
+            {
+                fail("unexpected end");
+            }
+
+            char c = m_text[m_pos];
+
+            if (std::isdigit((unsigned char)c) || (c == '.' && m_pos + 1 < m_text.size() && std::isdigit((unsigned char)m_text[m_pos + 1])))
+            {
+                return parseNumber();
+            }
+            else if (c == '\'')
+            {
+                ConstantNode* node = new ConstantNode(Expression::STRING);
+                add(node);
+                node->string = parseQuoted('\'');
+                return node;
+            }
+            else if (c == '"')
+            {
+                std::size_t start = m_pos;
+                return parseColumn(parseQuoted('"'), start);
+            }
+            else if (acceptSymbol("("))
+            {
+                Node* node = parseOr();
+                expectSymbol(")");
+                return node;
+            }
+            else if (acceptKeyword("TRUE") || acceptKeyword("FALSE"))
+            {
+                ConstantNode* node = new ConstantNode(Expression::BOOLEAN);
+                add(node);
+                node->integer = std::toupper((unsigned char)c) == 'T';
+                return node;
+            }
+            else if (acceptKeyword("NULL"))
+            {
+                ConstantNode* node = new ConstantNode(Expression::INTEGER);
+                add(node);
+                node->isNull = true;
+                return node;
+            }
+            else if (acceptKeyword("CASE"))
+            {
+                return parseCase();
+            }
+
+            std::size_t start = m_pos;
+            std::string name = parseName();
+            skipSpace();
+
+            if (m_pos < m_text.size() && m_text[m_pos] == '(')
+            {
+                return parseFunction(name, start);
+            }
+
+            return parseColumn(name, start);
+        }
+
+        Node* parseColumn(const std::string& name, const std::size_t start)
+        {
+            for (std::size_t i = 0; i < m_table.getColumnCount(); ++i)
+            {
+                if (m_table.getColumn(i).getName() == name)
+                {
+                    return add(new ColumnNode(m_table.getColumn(i)));
+                }
+            }
+
+            m_pos = start;
+            fail("unknown column " + name);
+            return NULL;
+        }
+    };
+
+    //--------------------------------------------------------------------------
+    // Evaluation
+    //--------------------------------------------------------------------------
+
+    bool isNumericColumn(const Column::ColumnType type)
+    {
+        switch (type)
+        {
+            case Column::BOOLEAN:
+            case Column::DOUBLE:
+            case Column::FLOAT:
+            case Column::INT:
+            case Column::INT8:
+            case Column::INT16:
+            case Column::LONG:
+            case Column::TIMESTAMP:
+            case Column::ULONG: return true;
+            default: return false;
+        }
+    }
+
+    // Evaluates the expression over chunks of the rows, a batch at a time,
+    // passing each batch of values to write
+    class EvaluateTask : public kinetica::ParallelTask
+    {
+    public:
+        EvaluateTask(const std::vector<Node*>& nodes, const Node& root, const std::size_t* rows, const std::size_t size,
+                     const std::size_t chunkCount) :
+            m_root(root),
+            m_nodes(nodes),
+            m_rows(rows),
+            m_size(size),
+            m_chunkCount(chunkCount)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            std::vector<Vector> vectors(m_nodes.size());
+
+            for (std::size_t i = 0; i < m_nodes.size(); ++i)
+            {
+                vectors[i].nulls.resize(BATCH_SIZE);
+
+                switch (m_nodes[i]->type)
+                {
+                    case Expression::REAL: vectors[i].reals.resize(BATCH_SIZE); break;
+                    case Expression::STRING: vectors[i].strings.resize(BATCH_SIZE); break;
+                    default: vectors[i].integers.resize(BATCH_SIZE); break;
+                }
+            }
+
+            std::size_t start = kinetica::getRangeStart(m_size, m_chunkCount, index);
+            std::size_t end = kinetica::getRangeStart(m_size, m_chunkCount, index + 1);
+            Batch batch;
+            batch.vectors = &vectors;
+
+            for (std::size_t position = start; position < end; position += BATCH_SIZE)
+            {
+                batch.rows = m_rows == NULL ? NULL : m_rows + position;
+                batch.start = position;
+                batch.count = std::min(BATCH_SIZE, end - position);
+                m_root.evaluate(batch);
+                write(index, position, batch, vectors[m_root.index]);
+            }
+        }
+
+    protected:
+        const Node& m_root;
+
+        // Receives the values of the rows at position to position + count of
+        // the rows being evaluated
+        virtual void write(const std::size_t chunk, const std::size_t position, const Batch& batch, const Vector& values) = 0;
+
+    private:
+        const std::vector<Node*>& m_nodes;
+        const std::size_t* m_rows;
+        std::size_t m_size;
+        std::size_t m_chunkCount;
+    };
+
+    // Converts values as appendNumbers does, rounding and clamping values
+    // written to integer columns
+    template<typename T>
+    void convertValues(const Expression::Type type, const Vector& values, const std::size_t count, T* result)
+    {
+        if (type == Expression::REAL)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                result[i] = values.nulls[i] ? 0 : kinetica::convertNumber<T>(values.reals[i]);
+            }
+        }
+        else
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                result[i] = values.nulls[i] ? 0 : kinetica::convertNumber<T>(values.integers[i]);
+            }
+        }
+    }
+
+    void convertBooleans(const Expression::Type type, const Vector& values, const std::size_t count, int8_t* result)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            result[i] = values.nulls[i] ? 0 : type == Expression::REAL ? kinetica::toBoolean(values.reals[i])
+                                                                       : kinetica::toBoolean(values.integers[i]);
+        }
+    }
+
+    // Writes values into space already appended to a fixed-width column
+    class FixedWriteTask : public EvaluateTask
+    {
+    public:
+        FixedWriteTask(const std::vector<Node*>& nodes, const Node& root, const std::size_t* rows, const std::size_t size,
+                       const std::size_t chunkCount, OutputColumn& column, const std::size_t index) :
+            EvaluateTask(nodes, root, rows, size, chunkCount),
+            m_column(column),
+            m_index(index)
+        {
+        }
+
+    protected:
+        virtual void write(const std::size_t, const std::size_t position, const Batch& batch, const Vector& values)
+        {
+            std::size_t index = m_index + position;
+            std::size_t count = batch.count;
+
+            switch (m_column.getType())
+            {
+                case Column::BOOLEAN: convertBooleans(m_root.type, values, count, m_column.getData<int8_t>() + index); break;
+                case Column::INT8: convertValues(m_root.type, values, count, m_column.getData<int8_t>() + index); break;
+                case Column::INT: convertValues(m_root.type, values, count, m_column.getData<int32_t>() + index); break;
+                case Column::INT16: convertValues(m_root.type, values, count, m_column.getData<int16_t>() + index); break;
+                case Column::LONG:
+                case Column::TIMESTAMP: convertValues(m_root.type, values, count, m_column.getData<int64_t>() + index); break;
+                case Column::ULONG: convertValues(m_root.type, values, count, m_column.getData<uint64_t>() + index); break;
+                case Column::DOUBLE: convertValues(m_root.type, values, count, m_column.getData<double>() + index); break;
+                case Column::FLOAT: convertValues(m_root.type, values, count, m_column.getData<float>() + index); break;
+
+                default:
+                {
+                    std::size_t width = kinetica::getCharNWidth(m_column.getType());
+                    char* data = m_column.getData<char>() + index * width;
+
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        const std::string& value = values.strings[i];
+                        uint64_t offsets[2] = { 0, values.nulls[i] ? 0 : value.size() };
+                        kinetica::stringsToCharN(value.data(), offsets, 1, width, data + i * width);
+                    }
+
+                    break;
+                }
+            }
+
+            if (m_column.isNullable())
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    if (values.nulls[i])
+                    {
+                        m_column.setNull(index + i);
+                    }
+                }
+            }
+        }
+
+    private:
+        OutputColumn& m_column;
+        std::size_t m_index;
+    };
+
+    // Packs the strings of each chunk for a bulk append
+    class StringWriteTask : public EvaluateTask
+    {
+    public:
+        struct Chunk
+        {
+            std::string data;
+            std::vector<uint64_t> offsets;
+            std::vector<uint8_t> nulls;
+        };
+
+        std::vector<Chunk> chunks;
+
+        StringWriteTask(const std::vector<Node*>& nodes, const Node& root, const std::size_t* rows, const std::size_t size,
+                        const std::size_t chunkCount) :
+            EvaluateTask(nodes, root, rows, size, chunkCount),
+            chunks(chunkCount)
+        {
+        }
+
+    protected:
+        virtual void write(const std::size_t chunk, const std::size_t, const Batch& batch, const Vector& values)
+        {
+            Chunk& result = chunks[chunk];
+
+            for (std::size_t i = 0; i < batch.count; ++i)
+            {
+                result.offsets.push_back(result.data.size());
+                result.nulls.push_back(values.nulls[i]);
+
+                if (!values.nulls[i])
+                {
+                    result.data.append(values.strings[i].c_str(), values.strings[i].size() + 1);
+                }
+            }
+        }
+    };
+
+    class FilterTask : public EvaluateTask
+    {
+    public:
+        std::vector<std::vector<std::size_t> > chunkRows;
+
+        FilterTask(const std::vector<Node*>& nodes, const Node& root, const std::size_t size, const std::size_t chunkCount) :
+            EvaluateTask(nodes, root, NULL, size, chunkCount),
+            chunkRows(chunkCount)
+        {
+        }
+
+    protected:
+        virtual void write(const std::size_t chunk, const std::size_t position, const Batch& batch, const Vector& values)
+        {
+            std::vector<std::size_t>& rows = chunkRows[chunk];
+
+            for (std::size_t i = 0; i < batch.count; ++i)
+            {
+                if (!values.nulls[i] && values.integers[i])
+                {
+                    rows.push_back(position + i);
+                }
+            }
+        }
+    };
+
+    std::size_t getChunkCount(const std::size_t size, const std::size_t threadCount)
+    {
+        std::size_t threads = threadCount == 0 ? kinetica::getHardwareThreadCount() : threadCount;
+        return size >= kinetica::MIN_PARALLEL_SIZE && threads > 1 ? threads * 4 : 1;
+    }
+
+    std::size_t evaluateRows(const std::vector<Node*>& nodes, const Node& root, const std::size_t* rows,
+                             const std::size_t size, OutputColumn& column, const std::size_t threadCount)
+    {
+        bool isString = column.getType() == Column::STRING || kinetica::getCharNWidth(column.getType()) != 0;
+
+        if (isString ? root.type != Expression::STRING : (!isNumericColumn(column.getType()) || root.type == Expression::STRING))
+        {
+            throw std::invalid_argument("Output column " + column.getName() + " does not match expression type");
+        }
+
+        std::size_t chunkCount = getChunkCount(size, threadCount);
+
+        if (column.getType() != Column::STRING)
+        {
+            // Fixed-width values are appended up front and filled in place
+            std::size_t index = column.getPos();
+            column.appendValues(size);
+            FixedWriteTask writeTask(nodes, root, rows, size, chunkCount, column, index);
+            runParallel(writeTask, chunkCount, threadCount);
+            return index;
+        }
+
+        StringWriteTask writeTask(nodes, root, rows, size, chunkCount);
+        runParallel(writeTask, chunkCount, threadCount);
+        std::size_t index = column.getPos();
+
+        for (std::size_t i = 0; i < chunkCount; ++i)
+        {
+            StringWriteTask::Chunk& chunk = writeTask.chunks[i];
+            std::size_t count = chunk.offsets.size();
+
+            if (count == 0)
+            {
+                continue;
+            }
+
+            // Nulls take no space; in columns that are not nullable they
+            // are written as empty strings
+            if (!column.isNullable())
+            {
+                std::string data;
+                std::vector<uint64_t> offsets(count);
+
+                for (std::size_t j = 0; j < count; ++j)
+                {
+                    offsets[j] = data.size();
+                    std::size_t end = j + 1 < count ? chunk.offsets[j + 1] : chunk.data.size();
+                    data.append(chunk.data, chunk.offsets[j], end - chunk.offsets[j]);
+
+                    if (chunk.nulls[j])
+                    {
+                        data += '\0';
+                    }
+                }
+
+                chunk.data.swap(data);
+                chunk.offsets.swap(offsets);
+            }
+
+            std::size_t chunkIndex = column.appendVarValues<char>(chunk.data.data(), chunk.data.size(), &chunk.offsets[0], count);
+
+            if (column.isNullable())
+            {
+                for (std::size_t j = 0; j < count; ++j)
+                {
+                    if (chunk.nulls[j])
+                    {
+                        column.setNull(chunkIndex + j);
+                    }
+                }
+            }
+        }
+
+        return index;
+    }
+
+    // Owns the expressions of a projection
+    struct Expressions
+    {
+        std::vector<kinetica::Expression*> items;
+
+        ~Expressions()
+        {
+            for (std::size_t i = 0; i < items.size(); ++i)
+            {
+                delete items[i];
+            }
+        }
+    };
+}
+
+namespace kinetica
+{
+    Expression::Expression(const std::string& text, const ProcData::InputTable& table) :
+        m_table(table),
+        m_root(NULL)
+    {
+        try
+        {
+            Parser parser(text, table, m_nodes);
+            m_root = parser.parse();
+        }
+        catch (...)
+        {
+            for (std::size_t i = 0; i < m_nodes.size(); ++i)
+            {
+                delete m_nodes[i];
+            }
+
+            throw;
+        }
+    }
+
+    Expression::~Expression()
+    {
+        for (std::size_t i = 0; i < m_nodes.size(); ++i)
+        {
+            delete m_nodes[i];
+        }
+    }
+
+    Expression::Type Expression::getType() const
+    {
+        return m_root->type;
+    }
+
+    std::size_t Expression::evaluate(ProcData::OutputColumn& column, const std::size_t threadCount) const
+    {
+        return evaluateRows(m_nodes, *m_root, NULL, m_table.getSize(), column, threadCount);
+    }
+
+    std::size_t Expression::evaluate(const std::vector<std::size_t>& rows, ProcData::OutputColumn& column,
+                                     const std::size_t threadCount) const
+    {
+        return evaluateRows(m_nodes, *m_root, rows.empty() ? NULL : &rows[0], rows.size(), column, threadCount);
+    }
+
+    void Expression::filter(std::vector<std::size_t>& rows, const std::size_t threadCount) const
+    {
+        if (m_root->type != BOOLEAN)
+        {
+            throw std::invalid_argument("Filter expression is not BOOLEAN");
+        }
+
+        std::size_t chunkCount = getChunkCount(m_table.getSize(), threadCount);
+        FilterTask filterTask(m_nodes, *m_root, m_table.getSize(), chunkCount);
+        runParallel(filterTask, chunkCount, threadCount);
+
+        for (std::size_t i = 0; i < chunkCount; ++i)
+        {
+            rows.insert(rows.end(), filterTask.chunkRows[i].begin(), filterTask.chunkRows[i].end());
+        }
+    }
+
+    std::size_t project(const ProcData::InputTable& input, const std::map<std::string, std::string>& params,
+                        ProcData::OutputTable& result, const std::size_t threadCount)
+    {
+        // All expressions are parsed before any rows are appended
+        Expressions expressions;
+
+        for (std::size_t i = 0; i < result.getColumnCount(); ++i)
+        {
+            const std::string& name = result.getColumn(i).getName();
+            std::map<std::string, std::string>::const_iterator param = params.find(name);
+
+            if (param == params.end())
+            {
+                throw std::invalid_argument("No expression for output column " + name);
+            }
+
+            expressions.items.push_back(new Expression(param->second, input));
+        }
+
+        std::map<std::string, std::string>::const_iterator filterParam = params.find("filter");
+        std::vector<std::size_t> rows;
+
+        if (filterParam != params.end())
+        {
+            Expression(filterParam->second, input).filter(rows, threadCount);
+        }
+
+        std::size_t size = filterParam != params.end() ? rows.size() : input.getSize();
+        std::size_t index = result.getSize();
+        result.setSize(index + size);
+
+        for (std::size_t i = 0; i < expressions.items.size(); ++i)
+        {
+            if (filterParam != params.end())
+            {
+                expressions.items[i]->evaluate(rows, result.getColumn(i), threadCount);
+            }
+            else
+            {
+                expressions.items[i]->evaluate(result.getColumn(i), threadCount);
+            }
+        }
+
+        return index;
+    }
+}
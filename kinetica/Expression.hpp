@@ -0,0 +1,86 @@
+#ifndef _KINETICA_EXPRESSION_HPP_
+#define _KINETICA_EXPRESSION_HPP_
+
+#include "Proc.hpp"
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace kinetica
+{
+    // Expression over the columns of an input table, parsed from text such
+    // as a UDF parameter and evaluated a batch of rows at a time, each
+    // operator running a tight loop over the batch. The language has:
+    //
+    // - column names, optionally in double quotes, and literals: integers,
+    //   reals, 'strings' (with '' for a quote), TRUE, FALSE and NULL
+    // - arithmetic (+ - * / %), comparisons (= == != <> < <= > >=), string
+    //   concatenation (||), AND, OR, NOT, IS [NOT] NULL, and
+    //   CASE WHEN condition THEN value ... [ELSE value] END
+    // - CAST(value AS type), where type is BOOLEAN, INTEGER, REAL or STRING
+    //   (or the SQL names INT, LONG, BIGINT, FLOAT, DOUBLE and VARCHAR)
+    // - ABS, LENGTH, LOWER, UPPER, TRIM, SUBSTR(string, start[, length])
+    //   with start counting from 1, CONCAT and COALESCE
+    //
+    // Keywords and function names are case-insensitive. Nulls propagate as
+    // in SQL, with three-valued AND/OR; division by zero and failed casts
+    // from strings yield null. Integer arithmetic is 64-bit and wraps.
+    //
+    // Integer columns (including TIMESTAMP and ULONG, whose values wrap) are
+    // INTEGER, FLOAT and DOUBLE columns are REAL, BOOLEAN columns are
+    // BOOLEAN, and STRING and CHAR1 to CHAR256 columns are STRING.
+    class Expression
+    {
+    public:
+        enum Type
+        {
+            BOOLEAN,
+            INTEGER,
+            REAL,
+            STRING
+        };
+
+        class Node;
+
+        // Throws std::invalid_argument if the text is not a valid expression
+        // over the columns of table
+        Expression(const std::string& text, const ProcData::InputTable& table);
+        ~Expression();
+
+        Type getType() const;
+
+        // Appends the value of every row, or of the given rows, to column,
+        // evaluating parts of the table in parallel. Numeric columns take
+        // BOOLEAN, INTEGER and REAL values, converted as appendNumbers does
+        // (see Numeric.hpp); STRING and CHARn columns take STRING values.
+        // Nulls are written as 0 or empty strings if the column is not
+        // nullable. Returns the index of the first appended row; the table
+        // of column must already be sized for the rows.
+        std::size_t evaluate(ProcData::OutputColumn& column, const std::size_t threadCount = 0) const;
+        std::size_t evaluate(const std::vector<std::size_t>& rows, ProcData::OutputColumn& column,
+                             const std::size_t threadCount = 0) const;
+
+        // Appends the rows, in order, for which a BOOLEAN expression is true
+        void filter(std::vector<std::size_t>& rows, const std::size_t threadCount = 0) const;
+
+    private:
+        const ProcData::InputTable& m_table;
+        std::vector<Node*> m_nodes;
+        const Node* m_root;
+
+        Expression(const Expression&);
+        Expression& operator =(const Expression&);
+    };
+
+    // Evaluates a projection given by parameters (e.g. ProcData::getParams):
+    // each column of result is computed by the expression in the parameter
+    // named after it, over the rows of input for which the "filter"
+    // parameter, if present, is true. Returns the index of the first
+    // appended row.
+    std::size_t project(const ProcData::InputTable& input, const std::map<std::string, std::string>& params,
+                        ProcData::OutputTable& result, const std::size_t threadCount = 0);
+}
+
+#endif
@@ -0,0 +1,195 @@
+#include "Hash.hpp"
+
+namespace
+{
+    const uint64_t PRIME1 = 0x9e3779b185ebca87;
+    const uint64_t PRIME2 = 0xc2b2ae3d27d4eb4f;
+    const uint64_t PRIME3 = 0x165667b19e3779f9;
+    const uint64_t PRIME4 = 0x85ebca77c2b2ae63;
+    const uint64_t PRIME5 = 0x27d4eb2f165667c5;
+
+    inline uint64_t rotateLeft(const uint64_t value, const int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    inline uint64_t read64(const uint8_t* data)
+    {
+        uint64_t value;
+        std::memcpy(&value, data, 8);
+        return value;
+    }
+
+    inline uint32_t read32(const uint8_t* data)
+    {
+        uint32_t value;
+        std::memcpy(&value, data, 4);
+        return value;
+    }
+
+    inline uint64_t accumulate(const uint64_t accumulator, const uint64_t input)
+    {
+        return rotateLeft(accumulator + input * PRIME2, 31) * PRIME1;
+    }
+
+    inline uint64_t mergeRound(const uint64_t accumulator, const uint64_t value)
+    {
+        return (accumulator ^ accumulate(0, value)) * PRIME1 + PRIME4;
+    }
+
+    template<typename T>
+    void hashFixed(const kinetica::ProcData::Column& column, const std::size_t start, const std::size_t count, uint64_t* result, const bool combine)
+    {
+        const T* values = column.getData<T>() + start;
+
+        if (combine)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                result[i] = kinetica::combineHashes(result[i], kinetica::hash(values[i]));
+            }
+        }
+        else
+        {
+            kinetica::hashValues(values, count, result);
+        }
+    }
+
+    void hashVar(const kinetica::ProcData::Column& column, const std::size_t start, const std::size_t count, uint64_t* result, const bool combine)
+    {
+        const uint64_t* offsets = column.getData<uint64_t>();
+        const uint8_t* data = column.getVarData<uint8_t>();
+
+        // STRING values include a terminating null that is not hashed
+        std::size_t terminator = column.getType() == kinetica::ProcData::Column::STRING ? 1 : 0;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            std::size_t size = column.getVarValueSize<uint8_t>(start + i);
+            uint64_t value = kinetica::hashBytes(data + offsets[start + i], size >= terminator ? size - terminator : 0);
+            result[i] = combine ? kinetica::combineHashes(result[i], value) : value;
+        }
+    }
+
+    void hashColumn(const kinetica::ProcData::Column& column, const std::size_t start, const std::size_t count, uint64_t* result, const bool combine)
+    {
+        if (start + count > column.getSize())
+        {
+            throw std::out_of_range("Row range out of bounds for column " + column.getName());
+        }
+
+        switch (column.getType())
+        {
+            case kinetica::ProcData::Column::BOOLEAN:
+            case kinetica::ProcData::Column::INT8: hashFixed<int8_t>(column, start, count, result, combine); break;
+            case kinetica::ProcData::Column::BYTES:
+            case kinetica::ProcData::Column::STRING: hashVar(column, start, count, result, combine); break;
+            case kinetica::ProcData::Column::CHAR1: hashFixed<kinetica::CharN<1> >(column, start, count, result, combine); break;
+            case kinetica::ProcData::Column::CHAR2: hashFixed<kinetica::CharN<2> >(column, start, count, result, combine); break;
+            case kinetica::ProcData::Column::CHAR4: hashFixed<kinetica::CharN<4> >(column, start, count, result, combine); break;
+            case kinetica::ProcData::Column::CHAR8: hashFixed<kinetica::CharN<8> >(column, start, count, result, combine); break;
+            case kinetica::ProcData::Column::CHAR16: hashFixed<kinetica::CharN<16> >(column, start, count, result, combine); break;
+            case kinetica::ProcData::Column::CHAR32: hashFixed<kinetica::CharN<32> >(column, start, count, result, combine); break;
+            case kinetica::ProcData::Column::CHAR64: hashFixed<kinetica::CharN<64> >(column, start, count, result, combine); break;
+            case kinetica::ProcData::Column::CHAR128: hashFixed<kinetica::CharN<128> >(column, start, count, result, combine); break;
+            case kinetica::ProcData::Column::CHAR256: hashFixed<kinetica::CharN<256> >(column, start, count, result, combine); break;
+            case kinetica::ProcData::Column::DATE: hashFixed<kinetica::Date>(column, start, count, result, combine); break;
+            case kinetica::ProcData::Column::DATETIME: hashFixed<kinetica::DateTime>(column, start, count, result, combine); break;
+            case kinetica::ProcData::Column::DECIMAL:
+            case kinetica::ProcData::Column::LONG:
+            case kinetica::ProcData::Column::TIMESTAMP: hashFixed<int64_t>(column, start, count, result, combine); break;
+            case kinetica::ProcData::Column::DOUBLE: hashFixed<double>(column, start, count, result, combine); break;
+            case kinetica::ProcData::Column::FLOAT: hashFixed<float>(column, start, count, result, combine); break;
+            case kinetica::ProcData::Column::INT: hashFixed<int32_t>(column, start, count, result, combine); break;
+            case kinetica::ProcData::Column::INT16: hashFixed<int16_t>(column, start, count, result, combine); break;
+            case kinetica::ProcData::Column::IPV4: hashFixed<uint32_t>(column, start, count, result, combine); break;
+            case kinetica::ProcData::Column::TIME: hashFixed<kinetica::Time>(column, start, count, result, combine); break;
+            case kinetica::ProcData::Column::ULONG: hashFixed<uint64_t>(column, start, count, result, combine); break;
+            case kinetica::ProcData::Column::UUID: hashFixed<kinetica::UUID>(column, start, count, result, combine); break;
+            default: throw std::runtime_error("Invalid data type");
+        }
+
+        if (column.isNullable())
+        {
+            const uint8_t* nulls = column.getNulls() + start;
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                if (nulls[i])
+                {
+                    result[i] = combine ? kinetica::combineHashes(result[i], kinetica::NULL_HASH) : kinetica::NULL_HASH;
+                }
+            }
+        }
+    }
+}
+
+namespace kinetica
+{
+    uint64_t hashBytes(const void* data, const std::size_t size, const uint64_t seed)
+    {
+        const uint8_t* pos = (const uint8_t*)data;
+        const uint8_t* end = pos + size;
+        uint64_t result;
+
+        if (size >= 32)
+        {
+            uint64_t v1 = seed + PRIME1 + PRIME2;
+            uint64_t v2 = seed + PRIME2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - PRIME1;
+
+            for (const uint8_t* limit = end - 32; pos <= limit; pos += 32)
+            {
+                v1 = accumulate(v1, read64(pos));
+                v2 = accumulate(v2, read64(pos + 8));
+                v3 = accumulate(v3, read64(pos + 16));
+                v4 = accumulate(v4, read64(pos + 24));
+            }
+
+            result = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+            result = mergeRound(result, v1);
+            result = mergeRound(result, v2);
+            result = mergeRound(result, v3);
+            result = mergeRound(result, v4);
+        }
+        else
+        {
+            result = seed + PRIME5;
+        }
+
+        result += size;
+
+        for (; pos + 8 <= end; pos += 8)
+        {
+            result = rotateLeft(result ^ accumulate(0, read64(pos)), 27) * PRIME1 + PRIME4;
+        }
+
+        if (pos + 4 <= end)
+        {
+            result = rotateLeft(result ^ (read32(pos) * PRIME1), 23) * PRIME2 + PRIME3;
+            pos += 4;
+        }
+
+        for (; pos < end; ++pos)
+        {
+            result = rotateLeft(result ^ (*pos * PRIME5), 11) * PRIME1;
+        }
+
+        result ^= result >> 33;
+        result *= PRIME2;
+        result ^= result >> 29;
+        result *= PRIME3;
+        return result ^ (result >> 32);
+    }
+
+    void hashColumn(const ProcData::Column& column, const std::size_t start, const std::size_t count, uint64_t* result)
+    {
+        ::hashColumn(column, start, count, result, false);
+    }
+
+    void combineColumnHashes(const ProcData::Column& column, const std::size_t start, const std::size_t count, uint64_t* result)
+    {
+        ::hashColumn(column, start, count, result, true);
+    }
+}
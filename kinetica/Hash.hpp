@@ -0,0 +1,119 @@
+#ifndef _KINETICA_HASH_HPP_
+#define _KINETICA_HASH_HPP_
+
+#include "Proc.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+#include <string>
+
+namespace kinetica
+{
+    // 64-bit hashes of column values. Values that compare equal hash equally
+    // (including 0.0 and -0.0, all NaNs, and dates/times that differ only in
+    // unused bits), signed integers of any width hash by value, and a
+    // std::string hashes the same as the equal STRING column value.
+
+    // XXH64 of a byte sequence
+    uint64_t hashBytes(const void* data, const std::size_t size, const uint64_t seed = 0);
+
+    // SplitMix64 finalizer; a bijection with full avalanche
+    inline uint64_t mixHash(uint64_t value)
+    {
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+        return value ^ (value >> 31);
+    }
+
+    // Order-dependent combination of a hash with the hash of another value,
+    // e.g. the next key column
+    inline uint64_t combineHashes(const uint64_t seed, const uint64_t value)
+    {
+        return mixHash(seed * 0x9e3779b97f4a7c15 + value);
+    }
+
+    inline uint64_t hash(const int8_t value) { return mixHash((uint64_t)(int64_t)value); }
+    inline uint64_t hash(const int16_t value) { return mixHash((uint64_t)(int64_t)value); }
+    inline uint64_t hash(const int32_t value) { return mixHash((uint64_t)(int64_t)value); }
+    inline uint64_t hash(const int64_t value) { return mixHash((uint64_t)value); }
+    inline uint64_t hash(const uint32_t value) { return mixHash(value); }
+    inline uint64_t hash(const uint64_t value) { return mixHash(value); }
+
+    inline uint64_t hash(const double value)
+    {
+        uint64_t bits;
+
+        if (value == 0)
+        {
+            bits = 0;
+        }
+        else if (value != value)
+        {
+            bits = 0x7ff8000000000000;
+        }
+        else
+        {
+            std::memcpy(&bits, &value, 8);
+        }
+
+        return mixHash(bits);
+    }
+
+    inline uint64_t hash(const float value) { return hash((double)value); }
+    inline uint64_t hash(const Date& value) { return hash((int32_t)(value.raw & 0xFFFFF000)); }
+    inline uint64_t hash(const DateTime& value) { return hash(value.raw & (int64_t)0xFFFFFFFFFFFE0000); }
+    inline uint64_t hash(const Time& value) { return hash(value.raw & 0xFFFFFFF0); }
+
+    inline uint64_t hash(const UUID& value)
+    {
+        uint64_t words[2];
+        std::memcpy(words, value.raw, 16);
+        return combineHashes(mixHash(words[1]), words[0]);
+    }
+
+    template<std::size_t N>
+    inline uint64_t hash(const CharN<N>& value) { return hashBytes(value.raw, N); }
+
+    inline uint64_t hash(const CharN<1>& value) { return mixHash(value.buffer); }
+    inline uint64_t hash(const CharN<2>& value) { return mixHash(value.buffer); }
+    inline uint64_t hash(const CharN<4>& value) { return mixHash(value.buffer); }
+    inline uint64_t hash(const CharN<8>& value) { return mixHash(value.buffer); }
+
+    inline uint64_t hash(const CharN<16>& value)
+    {
+        return combineHashes(mixHash(value.buffer[1]), value.buffer[0]);
+    }
+
+    inline uint64_t hash(const std::string& value) { return hashBytes(value.data(), value.size()); }
+
+    template<typename T>
+    struct Hash
+    {
+        uint64_t operator ()(const T& value) const
+        {
+            return hash(value);
+        }
+    };
+
+    template<typename T>
+    void hashValues(const T* values, const std::size_t count, uint64_t* result)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            result[i] = hash(values[i]);
+        }
+    }
+
+    // Hash of a null value of any type
+    const uint64_t NULL_HASH = 0x2545f4914f6cdd1d;
+
+    // Hashes rows [start, start + count) of a column of any type
+    void hashColumn(const ProcData::Column& column, const std::size_t start, const std::size_t count, uint64_t* result);
+
+    // Combines the hashes of rows [start, start + count) of a column into
+    // result, for hashing multi-column keys
+    void combineColumnHashes(const ProcData::Column& column, const std::size_t start, const std::size_t count, uint64_t* result);
+}
+
+#endif
@@ -0,0 +1,724 @@
+#include "Join.hpp"
+#include "Hash.hpp"
+#include "Parallel.hpp"
+#include "Spill.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    typedef kinetica::ProcData::Column Column;
+    typedef kinetica::ProcData::OutputColumn OutputColumn;
+
+    // Hash chains link build rows by 32-bit index, so build tables are
+    // limited to fewer rows than this
+    const uint32_t NO_ENTRY = 0xffffffff;
+
+    // Target number of build rows per partition, which keeps each partition's
+    // hashes, rows and hash table within a typical L2 cache
+    const std::size_t PARTITION_SIZE = 8192;
+
+    const std::size_t MAX_PARTITION_BITS = 12;
+
+    // Bytes held per probe and build row by an in-memory join: hashes, null
+    // flags, partitioned hashes and rows, hash table entries and matches
+    const std::size_t JOIN_ROW_BYTES = 64;
+
+    // Rows per batch of hashed rows spilled to partitions
+    const std::size_t SPILL_BLOCK_SIZE = 4096;
+
+    // Most partitions each side is spilled to
+    const std::size_t MAX_SPILL_PARTITIONS = 256;
+
+    //--------------------------------------------------------------------------
+    // Keys
+    //--------------------------------------------------------------------------
+
+    // Compares values of two columns of the same type with the same
+    // semantics as their hashes, except that NaN does not equal itself
+    bool equals(const Column& a, const std::size_t i, const Column& b, const std::size_t j)
+    {
+        switch (a.getType())
+        {
+            case Column::BYTES:
+            case Column::STRING:
+            {
+                std::size_t size = a.getVarValueSize<uint8_t>(i);
+                return size == b.getVarValueSize<uint8_t>(j)
+                       && std::memcmp(a.getVarValue<uint8_t>(i), b.getVarValue<uint8_t>(j), size) == 0;
+            }
+
+            case Column::DATE: return ((a.getValue<kinetica::Date>(i).raw ^ b.getValue<kinetica::Date>(j).raw) & ~0xfff) == 0;
+            case Column::DATETIME: return ((a.getValue<kinetica::DateTime>(i).raw ^ b.getValue<kinetica::DateTime>(j).raw) & ~(int64_t)0x1ffff) == 0;
+            case Column::TIME: return ((a.getValue<kinetica::Time>(i).raw ^ b.getValue<kinetica::Time>(j).raw) & ~0xf) == 0;
+            case Column::DOUBLE: return a.getValue<double>(i) == b.getValue<double>(j);
+            case Column::FLOAT: return a.getValue<float>(i) == b.getValue<float>(j);
+            case Column::BOOLEAN:
+            case Column::INT8: return a.getValue<int8_t>(i) == b.getValue<int8_t>(j);
+            case Column::INT16: return a.getValue<int16_t>(i) == b.getValue<int16_t>(j);
+            case Column::INT:
+            case Column::IPV4: return a.getValue<int32_t>(i) == b.getValue<int32_t>(j);
+            case Column::DECIMAL:
+            case Column::LONG:
+            case Column::TIMESTAMP:
+            case Column::ULONG: return a.getValue<int64_t>(i) == b.getValue<int64_t>(j);
+
+            default:
+            {
+                std::size_t size = Column::getTypeSize(a.getType());
+                return std::memcmp(a.getData<uint8_t>() + i * size, b.getData<uint8_t>() + j * size, size) == 0;
+            }
+        }
+    }
+
+    class KeyEqual
+    {
+    public:
+        KeyEqual(const std::vector<const Column*>& probeKeys, const std::vector<const Column*>& buildKeys) :
+            m_probeKeys(probeKeys),
+            m_buildKeys(buildKeys)
+        {
+        }
+
+        bool operator ()(const std::size_t probeRow, const std::size_t buildRow) const
+        {
+            for (std::size_t i = 0; i < m_probeKeys.size(); ++i)
+            {
+                if (!equals(*m_probeKeys[i], probeRow, *m_buildKeys[i], buildRow))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+    private:
+        const std::vector<const Column*>& m_probeKeys;
+        const std::vector<const Column*>& m_buildKeys;
+    };
+
+    //--------------------------------------------------------------------------
+    // Partitioning
+    //--------------------------------------------------------------------------
+
+    // Rows of one side of the join, radix-partitioned on the top bits of their
+    // key hashes. Rows with a null key are placed in an extra partition after
+    // the others.
+    struct Side
+    {
+        std::vector<const Column*> keys;
+        std::size_t size;
+        std::size_t chunkCount;
+
+        // Table row of each row when joining a spilled partition rather than
+        // the whole table, whose hashes are then loaded rather than computed
+        std::vector<std::size_t> rows;
+
+        // Per-row hashes and null key flags in row order, then hashes and row
+        // numbers in partition order
+        std::vector<uint64_t> hashes;
+        std::vector<uint8_t> isNull;
+        std::vector<uint64_t> partitionHashes;
+        std::vector<std::size_t> partitionRows;
+
+        // Number of rows of each chunk in each partition, then the position
+        // in partition order of the chunk's first row in each partition
+        std::vector<std::size_t> counts;
+
+        // Start of each partition in partition order, and the end of the last
+        std::vector<std::size_t> starts;
+    };
+
+    struct JoinContext
+    {
+        Side probe;
+        Side build;
+        kinetica::JoinType type;
+        std::size_t partitionBits;
+        std::size_t partitionCount;
+
+        // Matches found in each partition; the extra last partition holds
+        // unmatched probe rows with null keys
+        std::vector<std::vector<std::size_t> > probeRows;
+        std::vector<std::vector<std::size_t> > buildRows;
+
+        inline std::size_t getPartition(const uint64_t hash) const
+        {
+            return partitionBits == 0 ? 0 : (std::size_t)(hash >> (64 - partitionBits));
+        }
+    };
+
+    // Hashes the keys of count rows of side from row start and sets isNull
+    // (which must be zeroed) for rows with a null key
+    void hashKeys(const Side& side, const std::size_t start, const std::size_t count, uint64_t* hashes, uint8_t* isNull)
+    {
+        kinetica::hashColumn(*side.keys[0], start, count, hashes);
+
+        for (std::size_t i = 1; i < side.keys.size(); ++i)
+        {
+            kinetica::combineColumnHashes(*side.keys[i], start, count, hashes);
+        }
+
+        for (std::size_t i = 0; i < side.keys.size(); ++i)
+        {
+            if (side.keys[i]->isNullable())
+            {
+                const uint8_t* nulls = side.keys[i]->getNulls() + start;
+
+                for (std::size_t j = 0; j < count; ++j)
+                {
+                    isNull[j] |= nulls[j];
+                }
+            }
+        }
+    }
+
+    class HashTask : public kinetica::ParallelTask
+    {
+    public:
+        HashTask(const JoinContext& context, Side& side) :
+            m_context(context),
+            m_side(side)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            Side& side = m_side;
+            std::size_t start = kinetica::getRangeStart(side.size, side.chunkCount, index);
+            std::size_t count = kinetica::getRangeStart(side.size, side.chunkCount, index + 1) - start;
+            std::size_t* counts = &side.counts[index * (m_context.partitionCount + 1)];
+
+            if (count == 0)
+            {
+                return;
+            }
+
+            uint64_t* hashes = &side.hashes[start];
+            uint8_t* isNull = &side.isNull[start];
+
+            if (side.rows.empty())
+            {
+                hashKeys(side, start, count, hashes, isNull);
+            }
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                counts[isNull[i] ? m_context.partitionCount : m_context.getPartition(hashes[i])]++;
+            }
+        }
+
+    private:
+        const JoinContext& m_context;
+        Side& m_side;
+    };
+
+    class ScatterTask : public kinetica::ParallelTask
+    {
+    public:
+        ScatterTask(const JoinContext& context, Side& side) :
+            m_context(context),
+            m_side(side)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            Side& side = m_side;
+            std::size_t start = kinetica::getRangeStart(side.size, side.chunkCount, index);
+            std::size_t end = kinetica::getRangeStart(side.size, side.chunkCount, index + 1);
+            std::size_t* positions = &side.counts[index * (m_context.partitionCount + 1)];
+
+            for (std::size_t i = start; i < end; ++i)
+            {
+                uint64_t hash = side.hashes[i];
+                std::size_t partition = side.isNull[i] ? m_context.partitionCount : m_context.getPartition(hash);
+                std::size_t position = positions[partition]++;
+                side.partitionHashes[position] = hash;
+                side.partitionRows[position] = side.rows.empty() ? i : side.rows[i];
+            }
+        }
+
+    private:
+        const JoinContext& m_context;
+        Side& m_side;
+    };
+
+    // Hashes (unless loaded along with side.rows) and partitions the rows of
+    // side
+    void partition(JoinContext& context, Side& side, const std::size_t threadCount)
+    {
+        std::size_t stride = context.partitionCount + 1;
+        side.chunkCount = side.size >= kinetica::MIN_PARALLEL_SIZE && threadCount > 1 ? threadCount * 4 : 1;
+        side.hashes.resize(side.size);
+        side.isNull.assign(side.size, 0);
+        side.partitionHashes.resize(side.size);
+        side.partitionRows.resize(side.size);
+        side.counts.assign(side.chunkCount * stride, 0);
+
+        HashTask hashTask(context, side);
+        kinetica::runParallel(hashTask, side.chunkCount, threadCount);
+
+        side.starts.resize(stride + 1);
+        std::size_t position = 0;
+
+        for (std::size_t i = 0; i < stride; ++i)
+        {
+            side.starts[i] = position;
+
+            for (std::size_t j = 0; j < side.chunkCount; ++j)
+            {
+                std::size_t count = side.counts[j * stride + i];
+                side.counts[j * stride + i] = position;
+                position += count;
+            }
+        }
+
+        side.starts[stride] = position;
+
+        ScatterTask scatterTask(context, side);
+        kinetica::runParallel(scatterTask, side.chunkCount, threadCount);
+        std::vector<uint64_t>().swap(side.hashes);
+        std::vector<uint8_t>().swap(side.isNull);
+        std::vector<std::size_t>().swap(side.rows);
+    }
+
+    //--------------------------------------------------------------------------
+    // Join
+    //--------------------------------------------------------------------------
+
+    class JoinTask : public kinetica::ParallelTask
+    {
+    public:
+        JoinTask(JoinContext& context) :
+            m_context(context),
+            m_equal(context.probe.keys, context.build.keys)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            JoinContext& context = m_context;
+            std::vector<std::size_t>& probeRows = context.probeRows[index];
+            std::vector<std::size_t>& buildRows = context.buildRows[index];
+            std::size_t probeStart = context.probe.starts[index];
+            std::size_t probeEnd = context.probe.starts[index + 1];
+
+            if (index == context.partitionCount)
+            {
+                // Null probe keys never match
+                if (context.type == kinetica::LEFT_JOIN || context.type == kinetica::ANTI_JOIN)
+                {
+                    probeRows.assign(context.probe.partitionRows.begin() + probeStart, context.probe.partitionRows.begin() + probeEnd);
+
+                    if (context.type == kinetica::LEFT_JOIN)
+                    {
+                        buildRows.assign(probeEnd - probeStart, OutputColumn::NO_ROW);
+                    }
+                }
+
+                return;
+            }
+
+            std::size_t buildStart = context.build.starts[index];
+            std::size_t buildCount = context.build.starts[index + 1] - buildStart;
+            const uint64_t* buildHashes = buildCount == 0 ? NULL : &context.build.partitionHashes[buildStart];
+            const std::size_t* buildPartitionRows = buildCount == 0 ? NULL : &context.build.partitionRows[buildStart];
+
+            // Chained hash table over the partition's build rows; rows are
+            // inserted in reverse so that chains list them in row order
+            std::size_t bucketCount = 1;
+
+            while (bucketCount < buildCount)
+            {
+                bucketCount <<= 1;
+            }
+
+            std::size_t mask = bucketCount - 1;
+            std::vector<uint32_t> heads(bucketCount, NO_ENTRY);
+            std::vector<uint32_t> next(buildCount);
+
+            for (std::size_t i = buildCount; i-- > 0; )
+            {
+                uint32_t& head = heads[buildHashes[i] & mask];
+                next[i] = head;
+                head = (uint32_t)i;
+            }
+
+            for (std::size_t i = probeStart; i < probeEnd; ++i)
+            {
+                uint64_t hash = context.probe.partitionHashes[i];
+                std::size_t row = context.probe.partitionRows[i];
+                bool isMatched = false;
+
+                for (uint32_t entry = buildCount == 0 ? NO_ENTRY : heads[hash & mask]; entry != NO_ENTRY; entry = next[entry])
+                {
+                    if (buildHashes[entry] != hash || !m_equal(row, buildPartitionRows[entry]))
+                    {
+                        continue;
+                    }
+
+                    isMatched = true;
+
+                    if (context.type == kinetica::INNER_JOIN || context.type == kinetica::LEFT_JOIN)
+                    {
+                        probeRows.push_back(row);
+                        buildRows.push_back(buildPartitionRows[entry]);
+                    }
+                    else
+                    {
+                        break;
+                    }
+                }
+
+                if (isMatched ? context.type == kinetica::SEMI_JOIN
+                    : (context.type == kinetica::LEFT_JOIN || context.type == kinetica::ANTI_JOIN))
+                {
+                    probeRows.push_back(row);
+
+                    if (context.type == kinetica::LEFT_JOIN)
+                    {
+                        buildRows.push_back(OutputColumn::NO_ROW);
+                    }
+                }
+            }
+        }
+
+    private:
+        JoinContext& m_context;
+        KeyEqual m_equal;
+    };
+
+    std::vector<const Column*> getKeys(const kinetica::ProcData::InputTable& table, const std::vector<std::size_t>& keys)
+    {
+        std::vector<const Column*> result;
+
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            result.push_back(&table.getColumn(keys[i]));
+        }
+
+        return result;
+    }
+
+    // Checks the key columns and sets up context to join them
+    void initialize(JoinContext& context, const kinetica::ProcData::InputTable& probe, const std::vector<std::size_t>& probeKeys,
+                    const kinetica::ProcData::InputTable& build, const std::vector<std::size_t>& buildKeys,
+                    const kinetica::JoinType type)
+    {
+        if (probeKeys.empty() || probeKeys.size() != buildKeys.size())
+        {
+            throw std::invalid_argument("Probe and build tables must have the same number of key columns");
+        }
+
+        context.type = type;
+        context.probe.keys = getKeys(probe, probeKeys);
+        context.probe.size = probe.getSize();
+        context.build.keys = getKeys(build, buildKeys);
+        context.build.size = build.getSize();
+
+        if (context.build.size >= NO_ENTRY)
+        {
+            throw std::invalid_argument("Build table " + build.getName() + " has too many rows");
+        }
+
+        for (std::size_t i = 0; i < probeKeys.size(); ++i)
+        {
+            if (context.probe.keys[i]->getType() != context.build.keys[i]->getType())
+            {
+                throw std::invalid_argument("Key column " + context.probe.keys[i]->getName() + " does not match key column "
+                                            + context.build.keys[i]->getName());
+            }
+        }
+    }
+
+    // Partitions both sides and joins the partitions into context.probeRows
+    // and context.buildRows
+    void joinSides(JoinContext& context, const std::size_t threadCount)
+    {
+        context.partitionBits = 0;
+
+        while (context.partitionBits < MAX_PARTITION_BITS
+               && ((context.build.size >> context.partitionBits) > PARTITION_SIZE
+                   || (threadCount > 1 && context.probe.size >= kinetica::MIN_PARALLEL_SIZE
+                       && ((std::size_t)1 << context.partitionBits) < threadCount * 4)))
+        {
+            context.partitionBits++;
+        }
+
+        context.partitionCount = (std::size_t)1 << context.partitionBits;
+        partition(context, context.build, threadCount);
+        partition(context, context.probe, threadCount);
+
+        context.probeRows.assign(context.partitionCount + 1, std::vector<std::size_t>());
+        context.buildRows.assign(context.partitionCount + 1, std::vector<std::size_t>());
+        JoinTask joinTask(context);
+        kinetica::runParallel(joinTask, context.partitionCount + 1, threadCount);
+    }
+
+    // Appends the matches of context to probeRows and buildRows and returns
+    // their number
+    std::size_t collectRows(const JoinContext& context, std::vector<std::size_t>& probeRows, std::vector<std::size_t>& buildRows)
+    {
+        std::size_t count = 0;
+
+        for (std::size_t i = 0; i <= context.partitionCount; ++i)
+        {
+            count += context.probeRows[i].size();
+        }
+
+        probeRows.reserve(probeRows.size() + count);
+
+        if (context.type == kinetica::INNER_JOIN || context.type == kinetica::LEFT_JOIN)
+        {
+            buildRows.reserve(buildRows.size() + count);
+        }
+
+        for (std::size_t i = 0; i <= context.partitionCount; ++i)
+        {
+            probeRows.insert(probeRows.end(), context.probeRows[i].begin(), context.probeRows[i].end());
+            buildRows.insert(buildRows.end(), context.buildRows[i].begin(), context.buildRows[i].end());
+        }
+
+        return count;
+    }
+
+    //--------------------------------------------------------------------------
+    // Spilled join
+    //--------------------------------------------------------------------------
+
+    // Spills the rows of side to partitions by key hash as their row and
+    // hash. Rows with a null key go to the extra last partition if keepNulls
+    // is set and are dropped otherwise.
+    void spillSide(const Side& side, const bool keepNulls, kinetica::SpillPartitions& partitions)
+    {
+        std::size_t partitionCount = partitions.getPartitionCount() - 1;
+        std::vector<uint64_t> hashes(SPILL_BLOCK_SIZE);
+        std::vector<uint8_t> isNull(SPILL_BLOCK_SIZE);
+        uint64_t values[2];
+
+        for (std::size_t start = 0; start < side.size; start += SPILL_BLOCK_SIZE)
+        {
+            std::size_t count = std::min(SPILL_BLOCK_SIZE, side.size - start);
+            std::fill(isNull.begin(), isNull.end(), 0);
+            hashKeys(side, start, count, &hashes[0], &isNull[0]);
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                values[0] = start + i;
+                values[1] = hashes[i];
+
+                if (!isNull[i])
+                {
+                    partitions.add((std::size_t)((hashes[i] >> 32) % partitionCount), values);
+                }
+                else if (keepNulls)
+                {
+                    partitions.add(partitionCount, values);
+                }
+            }
+        }
+    }
+
+    // Loads the rows and hashes of a spilled partition into side
+    void loadSide(Side& side, kinetica::SpillFile& file)
+    {
+        std::vector<std::vector<uint64_t> > block;
+        side.rows.clear();
+        side.hashes.clear();
+
+        while (file.read(block))
+        {
+            side.rows.insert(side.rows.end(), block[0].begin(), block[0].end());
+            side.hashes.insert(side.hashes.end(), block[1].begin(), block[1].end());
+        }
+
+        side.size = side.rows.size();
+    }
+
+    //--------------------------------------------------------------------------
+    // Output
+    //--------------------------------------------------------------------------
+
+    struct GatherColumn
+    {
+        const Column* source;
+        const std::vector<std::size_t>* rows;
+        OutputColumn* target;
+    };
+
+    // Each output column is written by a single task
+    class GatherTask : public kinetica::ParallelTask
+    {
+    public:
+        GatherTask(const std::vector<GatherColumn>& columns) :
+            m_columns(columns)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            const GatherColumn& column = m_columns[index];
+            const std::vector<std::size_t>& rows = *column.rows;
+            column.target->appendRows(*column.source, rows.empty() ? NULL : &rows[0], rows.size());
+        }
+
+    private:
+        const std::vector<GatherColumn>& m_columns;
+    };
+
+    // Sets up the output columns of a join, which gather probeRows and
+    // buildRows
+    void getColumns(const kinetica::ProcData::InputTable& probe, const std::vector<std::size_t>& probeColumns,
+                    const kinetica::ProcData::InputTable& build, const std::vector<std::size_t>& buildColumns,
+                    const kinetica::JoinType type, kinetica::ProcData::OutputTable& result,
+                    const std::vector<std::size_t>& probeRows, const std::vector<std::size_t>& buildRows,
+                    std::vector<GatherColumn>& columns)
+    {
+        if (result.getColumnCount() != probeColumns.size() + buildColumns.size())
+        {
+            throw std::invalid_argument("Output table " + result.getName() + " must have one column per probe and build column");
+        }
+
+        if (!buildColumns.empty() && (type == kinetica::SEMI_JOIN || type == kinetica::ANTI_JOIN))
+        {
+            throw std::invalid_argument("Semi and anti joins cannot output build columns");
+        }
+
+        for (std::size_t i = 0; i < probeColumns.size() + buildColumns.size(); ++i)
+        {
+            bool isProbe = i < probeColumns.size();
+            GatherColumn column;
+            column.source = isProbe ? &probe.getColumn(probeColumns[i]) : &build.getColumn(buildColumns[i - probeColumns.size()]);
+            column.rows = isProbe ? &probeRows : &buildRows;
+            column.target = &result.getColumn(i);
+
+            if (column.target->getType() != column.source->getType())
+            {
+                throw std::invalid_argument("Output column " + column.target->getName() + " does not match column " + column.source->getName());
+            }
+
+            if (!isProbe && type == kinetica::LEFT_JOIN && !column.target->isNullable())
+            {
+                throw std::invalid_argument("Output column " + column.target->getName() + " must be nullable");
+            }
+
+            columns.push_back(column);
+        }
+    }
+
+    // Appends count rows gathered by columns to result
+    void writeRows(const std::vector<GatherColumn>& columns, const std::size_t count, kinetica::ProcData::OutputTable& result,
+                   const std::size_t threadCount)
+    {
+        result.setSize(result.getSize() + count);
+        GatherTask gatherTask(columns);
+        kinetica::runParallel(gatherTask, columns.size(), threadCount);
+    }
+}
+
+namespace kinetica
+{
+    std::size_t joinRows(const ProcData::InputTable& probe, const std::vector<std::size_t>& probeKeys,
+                         const ProcData::InputTable& build, const std::vector<std::size_t>& buildKeys,
+                         const JoinType type, std::vector<std::size_t>& probeRows, std::vector<std::size_t>& buildRows,
+                         std::size_t threadCount)
+    {
+        JoinContext context;
+        initialize(context, probe, probeKeys, build, buildKeys, type);
+
+        if (threadCount == 0)
+        {
+            threadCount = getHardwareThreadCount();
+        }
+
+        joinSides(context, threadCount);
+        return collectRows(context, probeRows, buildRows);
+    }
+
+    std::size_t join(const ProcData::InputTable& probe, const std::vector<std::size_t>& probeKeys,
+                     const std::vector<std::size_t>& probeColumns,
+                     const ProcData::InputTable& build, const std::vector<std::size_t>& buildKeys,
+                     const std::vector<std::size_t>& buildColumns,
+                     const JoinType type, ProcData::OutputTable& result, const std::size_t threadCount)
+    {
+        std::vector<std::size_t> probeRows;
+        std::vector<std::size_t> buildRows;
+        std::vector<GatherColumn> columns;
+        getColumns(probe, probeColumns, build, buildColumns, type, result, probeRows, buildRows, columns);
+
+        std::size_t count = joinRows(probe, probeKeys, build, buildKeys, type, probeRows, buildRows, threadCount);
+        writeRows(columns, count, result, threadCount);
+        return count;
+    }
+
+    std::size_t join(const ProcData::InputTable& probe, const std::vector<std::size_t>& probeKeys,
+                     const std::vector<std::size_t>& probeColumns,
+                     const ProcData::InputTable& build, const std::vector<std::size_t>& buildKeys,
+                     const std::vector<std::size_t>& buildColumns,
+                     const JoinType type, ProcData::OutputTable& result, SpillManager& spill, std::size_t threadCount)
+    {
+        std::vector<std::size_t> probeRows;
+        std::vector<std::size_t> buildRows;
+        std::vector<GatherColumn> columns;
+        getColumns(probe, probeColumns, build, buildColumns, type, result, probeRows, buildRows, columns);
+
+        JoinContext context;
+        initialize(context, probe, probeKeys, build, buildKeys, type);
+
+        if (threadCount == 0)
+        {
+            threadCount = getHardwareThreadCount();
+        }
+
+        std::size_t joinBytes = (context.probe.size + context.build.size) * JOIN_ROW_BYTES;
+
+        if (joinBytes <= spill.getMemoryBudget())
+        {
+            joinSides(context, threadCount);
+            std::size_t count = collectRows(context, probeRows, buildRows);
+            writeRows(columns, count, result, threadCount);
+            return count;
+        }
+
+        // Both sides are spilled by key hash into partitions that each fit
+        // the budget, plus one of probe rows with a null key for LEFT_JOIN and
+        // ANTI_JOIN, which never match. Each side's partition buffers take at
+        // most half the budget.
+        std::size_t partitionCount = std::min(MAX_SPILL_PARTITIONS,
+                                              std::max((std::size_t)2, joinBytes / std::max((std::size_t)1, spill.getMemoryBudget()) + 1));
+        SpillPartitions buildPartitions(spill, partitionCount + 1, 2, spill.getMemoryBudget() / 2);
+        SpillPartitions probePartitions(spill, partitionCount + 1, 2, spill.getMemoryBudget() / 2);
+        spillSide(context.build, false, buildPartitions);
+        spillSide(context.probe, type == LEFT_JOIN || type == ANTI_JOIN, probePartitions);
+        std::size_t count = 0;
+
+        for (std::size_t i = 0; i < partitionCount; ++i)
+        {
+            loadSide(context.build, buildPartitions.getFile(i));
+            loadSide(context.probe, probePartitions.getFile(i));
+            joinSides(context, threadCount);
+            probeRows.clear();
+            buildRows.clear();
+            std::size_t matchCount = collectRows(context, probeRows, buildRows);
+            writeRows(columns, matchCount, result, threadCount);
+            count += matchCount;
+        }
+
+        SpillFile& nulls = probePartitions.getFile(partitionCount);
+        std::vector<std::vector<uint64_t> > block;
+
+        while (nulls.read(block))
+        {
+            probeRows.assign(block[0].begin(), block[0].end());
+            buildRows.assign(type == LEFT_JOIN ? probeRows.size() : 0, ProcData::OutputColumn::NO_ROW);
+            writeRows(columns, probeRows.size(), result, threadCount);
+            count += probeRows.size();
+        }
+
+        return count;
+    }
+}
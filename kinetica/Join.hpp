@@ -0,0 +1,67 @@
+#ifndef _KINETICA_JOIN_HPP_
+#define _KINETICA_JOIN_HPP_
+
+#include "Proc.hpp"
+#include "Spill.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace kinetica
+{
+    enum JoinType
+    {
+        // Pairs of matching probe and build rows
+        INNER_JOIN,
+
+        // As INNER_JOIN, plus probe rows with no match paired with NO_ROW
+        LEFT_JOIN,
+
+        // Probe rows with at least one match
+        SEMI_JOIN,
+
+        // Probe rows with no match
+        ANTI_JOIN
+    };
+
+    // Matches the rows of probe against the rows of build on equality of the
+    // key columns, which must have the same types on both sides. Both tables
+    // are radix-partitioned by key hash so that each build partition's hash
+    // table fits in cache, and partitions are joined in parallel. Rows with a
+    // null key never match. Appends the matching probe row numbers to
+    // probeRows and, for INNER_JOIN and LEFT_JOIN, the build row numbers to
+    // buildRows (ProcData::OutputColumn::NO_ROW for unmatched LEFT_JOIN rows).
+    // Pairs are grouped by partition rather than in probe row order. Returns
+    // the number of rows appended. Throws std::invalid_argument if build has
+    // 2^32 - 1 or more rows.
+    std::size_t joinRows(const ProcData::InputTable& probe, const std::vector<std::size_t>& probeKeys,
+                         const ProcData::InputTable& build, const std::vector<std::size_t>& buildKeys,
+                         const JoinType type, std::vector<std::size_t>& probeRows, std::vector<std::size_t>& buildRows,
+                         const std::size_t threadCount = 0);
+
+    // Joins as above and appends one row per result to result: the values of
+    // probeColumns followed by those of buildColumns, which must be empty for
+    // SEMI_JOIN and ANTI_JOIN. Result columns must have the types of their
+    // source columns; for LEFT_JOIN the build columns must be nullable.
+    std::size_t join(const ProcData::InputTable& probe, const std::vector<std::size_t>& probeKeys,
+                     const std::vector<std::size_t>& probeColumns,
+                     const ProcData::InputTable& build, const std::vector<std::size_t>& buildKeys,
+                     const std::vector<std::size_t>& buildColumns,
+                     const JoinType type, ProcData::OutputTable& result, const std::size_t threadCount = 0);
+
+    // Joins as above, holding to the memory budget of spill when the tables
+    // are too large to join at once: the row numbers and key hashes of both
+    // sides are spilled to disk in partitions by key hash (a Grace hash
+    // join), then each pair of partitions is joined in memory and its results
+    // appended to result. The matches of one partition are held in memory
+    // until they are appended, so a key with very many matches may still
+    // exceed the budget.
+    std::size_t join(const ProcData::InputTable& probe, const std::vector<std::size_t>& probeKeys,
+                     const std::vector<std::size_t>& probeColumns,
+                     const ProcData::InputTable& build, const std::vector<std::size_t>& buildKeys,
+                     const std::vector<std::size_t>& buildColumns,
+                     const JoinType type, ProcData::OutputTable& result, SpillManager& spill,
+                     const std::size_t threadCount = 0);
+}
+
+#endif
@@ -0,0 +1,176 @@
+#include "Numeric.hpp"
+#include "Decimal.hpp"
+
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    typedef kinetica::ProcData::Column Column;
+    typedef kinetica::ProcData::OutputColumn OutputColumn;
+
+    const double POWERS_OF_TEN[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+        1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18
+    };
+
+    unsigned getScale(const Column::ColumnType type)
+    {
+        return type == Column::DECIMAL ? kinetica::DECIMAL_SCALE : 0;
+    }
+
+    bool isReal(const Column::ColumnType type)
+    {
+        return type == Column::DOUBLE || type == Column::FLOAT;
+    }
+
+    template<typename S, typename T>
+    std::size_t writeValues(OutputColumn& column, const S* values, const std::size_t count)
+    {
+        std::size_t index = column.getPos();
+        T* data = column.appendValues<T>(count);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            data[i] = kinetica::convertNumber<T>(values[i]);
+        }
+
+        return index;
+    }
+
+    template<typename S>
+    std::size_t writeBooleans(OutputColumn& column, const S* values, const std::size_t count)
+    {
+        std::size_t index = column.getPos();
+        int8_t* data = column.appendValues<int8_t>(count);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            data[i] = kinetica::toBoolean(values[i]);
+        }
+
+        return index;
+    }
+
+    // Appends values already at the scale of the column, converted to its
+    // type
+    template<typename S>
+    std::size_t writeNumbers(OutputColumn& column, const S* values, const std::size_t count)
+    {
+        switch (column.getType())
+        {
+            case Column::BOOLEAN: return writeBooleans(column, values, count);
+            case Column::INT8: return writeValues<S, int8_t>(column, values, count);
+            case Column::DECIMAL:
+            case Column::LONG:
+            case Column::TIMESTAMP: return writeValues<S, int64_t>(column, values, count);
+            case Column::DOUBLE: return writeValues<S, double>(column, values, count);
+            case Column::FLOAT: return writeValues<S, float>(column, values, count);
+            case Column::INT: return writeValues<S, int32_t>(column, values, count);
+            case Column::INT16: return writeValues<S, int16_t>(column, values, count);
+            case Column::ULONG: return writeValues<S, uint64_t>(column, values, count);
+            default: throw std::invalid_argument("Column " + column.getName() + " is not numeric");
+        }
+    }
+}
+
+namespace kinetica
+{
+    bool isNumeric(const ProcData::Column::ColumnType type)
+    {
+        switch (type)
+        {
+            case Column::BOOLEAN:
+            case Column::DECIMAL:
+            case Column::DOUBLE:
+            case Column::FLOAT:
+            case Column::INT:
+            case Column::INT8:
+            case Column::INT16:
+            case Column::LONG:
+            case Column::TIMESTAMP:
+            case Column::ULONG: return true;
+            default: return false;
+        }
+    }
+
+    std::size_t appendNumbers(ProcData::OutputColumn& column, const int64_t* values, const std::size_t count,
+                              const unsigned scale)
+    {
+        unsigned resultScale = getScale(column.getType());
+
+        if (isReal(column.getType()) && scale != 0)
+        {
+            std::vector<double> reals(count);
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                reals[i] = (double)values[i] / POWERS_OF_TEN[scale];
+            }
+
+            return writeNumbers(column, count == 0 ? NULL : &reals[0], count);
+        }
+        else if (isReal(column.getType()) || scale == resultScale)
+        {
+            return writeNumbers(column, values, count);
+        }
+
+        // Values that overflow the result scale saturate
+        std::vector<int64_t> rescaled(count);
+        std::vector<uint8_t> errors(count);
+
+        if (count != 0 && rescaleDecimals(values, scale, count, resultScale, &rescaled[0], &errors[0]) != 0)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                if (errors[i])
+                {
+                    rescaled[i] = values[i] < 0 ? std::numeric_limits<int64_t>::min() : std::numeric_limits<int64_t>::max();
+                }
+            }
+        }
+
+        return writeNumbers(column, count == 0 ? NULL : &rescaled[0], count);
+    }
+
+    std::size_t appendNumbers(ProcData::OutputColumn& column, const uint64_t* values, const std::size_t count,
+                              const unsigned scale)
+    {
+        if (isReal(column.getType()) ? scale == 0 : scale == getScale(column.getType()))
+        {
+            return writeNumbers(column, values, count);
+        }
+
+        std::vector<int64_t> integers(count);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            integers[i] = convertNumber<int64_t>(values[i]);
+        }
+
+        return appendNumbers(column, count == 0 ? NULL : &integers[0], count, scale);
+    }
+
+    std::size_t appendNumbers(ProcData::OutputColumn& column, const double* values, const std::size_t count,
+                              const unsigned scale)
+    {
+        unsigned resultScale = getScale(column.getType());
+
+        if (scale == resultScale)
+        {
+            return writeNumbers(column, values, count);
+        }
+
+        std::vector<double> scaled(count);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            scaled[i] = scale < resultScale ? values[i] * POWERS_OF_TEN[resultScale - scale]
+                                            : values[i] / POWERS_OF_TEN[scale - resultScale];
+        }
+
+        return writeNumbers(column, count == 0 ? NULL : &scaled[0], count);
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef _KINETICA_NUMERIC_HPP_
+#define _KINETICA_NUMERIC_HPP_
+
+#include "Proc.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdint.h>
+
+namespace kinetica
+{
+    // Numeric accumulation and output shared by Aggregate, Window and
+    // Expression, for counts, sums, averages and computed values written to
+    // numeric columns of any type.
+
+    // BOOLEAN, integer, real, DECIMAL and TIMESTAMP columns
+    bool isNumeric(const ProcData::Column::ColumnType type);
+
+    // Integer sums wrap around on overflow rather than being undefined
+    inline int64_t add(const int64_t a, const int64_t b) { return (int64_t)((uint64_t)a + (uint64_t)b); }
+    inline int64_t subtract(const int64_t a, const int64_t b) { return (int64_t)((uint64_t)a - (uint64_t)b); }
+    inline uint64_t add(const uint64_t a, const uint64_t b) { return a + b; }
+    inline uint64_t subtract(const uint64_t a, const uint64_t b) { return a - b; }
+    inline double add(const double a, const double b) { return a + b; }
+    inline double subtract(const double a, const double b) { return a - b; }
+
+    // Converts a value at scale 0 to type T as appendNumbers does: integers
+    // are rounded half away from zero and clamped to the range of T, and
+    // NaNs convert to 0
+    template<typename T>
+    inline T convertNumber(const double value)
+    {
+        if (!std::numeric_limits<T>::is_integer)
+        {
+            return (T)value;
+        }
+        else if (value != value)
+        {
+            return 0;
+        }
+
+        double rounded = value < 0 ? std::ceil(value - 0.5) : std::floor(value + 0.5);
+
+        if (rounded <= (double)std::numeric_limits<T>::min())
+        {
+            return std::numeric_limits<T>::min();
+        }
+        else if (rounded >= (double)std::numeric_limits<T>::max())
+        {
+            return std::numeric_limits<T>::max();
+        }
+
+        return (T)rounded;
+    }
+
+    template<typename T>
+    inline T convertNumber(const int64_t value)
+    {
+        if (!std::numeric_limits<T>::is_integer)
+        {
+            return (T)value;
+        }
+        else if (value < (int64_t)std::numeric_limits<T>::min())
+        {
+            return std::numeric_limits<T>::min();
+        }
+        else if (sizeof(T) < sizeof(int64_t) && value > (int64_t)std::numeric_limits<T>::max())
+        {
+            return std::numeric_limits<T>::max();
+        }
+
+        return (T)value;
+    }
+
+    template<typename T>
+    inline T convertNumber(const uint64_t value)
+    {
+        if (std::numeric_limits<T>::is_integer && value > (uint64_t)std::numeric_limits<T>::max())
+        {
+            return std::numeric_limits<T>::max();
+        }
+
+        return (T)value;
+    }
+
+    // BOOLEAN values are 1 for any nonzero value and 0 otherwise, including
+    // for NaNs
+    template<typename S>
+    inline int8_t toBoolean(const S value) { return value != 0 && value == value; }
+
+    // Appends count values at scale decimal places (DECIMAL_SCALE for sums
+    // and averages of DECIMAL values, otherwise 0) to a numeric column,
+    // converted to its type and scale (DECIMAL_SCALE for DECIMAL columns,
+    // otherwise 0). Values written to integer and DECIMAL columns are
+    // rounded half away from zero and clamped to the range of the type,
+    // BOOLEAN columns get 1 for any nonzero value, and NaNs are written as 0.
+    // Returns the index of the first appended row.
+    // Throws std::invalid_argument if the column is not numeric.
+    std::size_t appendNumbers(ProcData::OutputColumn& column, const int64_t* values, const std::size_t count,
+                              const unsigned scale = 0);
+    std::size_t appendNumbers(ProcData::OutputColumn& column, const uint64_t* values, const std::size_t count,
+                              const unsigned scale = 0);
+    std::size_t appendNumbers(ProcData::OutputColumn& column, const double* values, const std::size_t count,
+                              const unsigned scale = 0);
+}
+
+#endif
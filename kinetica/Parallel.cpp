@@ -0,0 +1,138 @@
+#include "Parallel.hpp"
+
+#include <exception>
+#include <pthread.h>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+    struct ParallelContext
+    {
+        kinetica::ParallelTask* task;
+        std::size_t taskCount;
+        volatile std::size_t next;
+        volatile int failed;
+        pthread_mutex_t errorMutex;
+        std::string error;
+    };
+
+    void runTasks(ParallelContext& context)
+    {
+        while (!context.failed)
+        {
+            std::size_t index = __sync_fetch_and_add(&context.next, (std::size_t)1);
+
+            if (index >= context.taskCount)
+            {
+                return;
+            }
+
+            try
+            {
+                context.task->run(index);
+            }
+            catch (const std::exception& ex)
+            {
+                pthread_mutex_lock(&context.errorMutex);
+
+                if (!context.failed)
+                {
+                    context.error = ex.what();
+                    context.failed = 1;
+                }
+
+                pthread_mutex_unlock(&context.errorMutex);
+            }
+            catch (...)
+            {
+                pthread_mutex_lock(&context.errorMutex);
+
+                if (!context.failed)
+                {
+                    context.error = "Unknown error in parallel task";
+                    context.failed = 1;
+                }
+
+                pthread_mutex_unlock(&context.errorMutex);
+            }
+        }
+    }
+
+    extern "C" void* runTasksThread(void* context)
+    {
+        runTasks(*(ParallelContext*)context);
+        return NULL;
+    }
+}
+
+namespace kinetica
+{
+    std::size_t getHardwareThreadCount()
+    {
+        long count = sysconf(_SC_NPROCESSORS_ONLN);
+        return count > 0 ? (std::size_t)count : 1;
+    }
+
+    void runParallel(ParallelTask& task, const std::size_t taskCount, std::size_t threadCount)
+    {
+        if (threadCount == 0)
+        {
+            threadCount = getHardwareThreadCount();
+        }
+
+        if (threadCount > taskCount)
+        {
+            threadCount = taskCount;
+        }
+
+        if (threadCount <= 1)
+        {
+            for (std::size_t i = 0; i < taskCount; ++i)
+            {
+                task.run(i);
+            }
+
+            return;
+        }
+
+        ParallelContext context;
+        context.task = &task;
+        context.taskCount = taskCount;
+        context.next = 0;
+        context.failed = 0;
+        pthread_mutex_init(&context.errorMutex, NULL);
+
+        std::vector<pthread_t> threads;
+        threads.reserve(threadCount - 1);
+
+        for (std::size_t i = 1; i < threadCount; ++i)
+        {
+            pthread_t thread;
+
+            if (pthread_create(&thread, NULL, runTasksThread, &context) != 0)
+            {
+                // The calling thread alone is enough to finish all the tasks
+                break;
+            }
+
+            threads.push_back(thread);
+        }
+
+        runTasks(context);
+
+        for (std::size_t i = 0; i < threads.size(); ++i)
+        {
+            pthread_join(threads[i], NULL);
+        }
+
+        pthread_mutex_destroy(&context.errorMutex);
+
+        if (context.failed)
+        {
+            throw std::runtime_error(context.error);
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef _KINETICA_PARALLEL_HPP_
+#define _KINETICA_PARALLEL_HPP_
+
+#include <cstddef>
+
+namespace kinetica
+{
+    // Row counts below this are processed in a single chunk rather than
+    // split across threads
+    const std::size_t MIN_PARALLEL_SIZE = 65536;
+
+    std::size_t getHardwareThreadCount();
+
+    // run() is called concurrently from multiple threads, once per task index
+    class ParallelTask
+    {
+    public:
+        virtual ~ParallelTask() {}
+        virtual void run(const std::size_t index) = 0;
+    };
+
+    // Runs task.run(i) for every i in [0, taskCount) on up to threadCount
+    // threads (0 = all hardware threads), including the calling thread. If a
+    // task throws, remaining tasks are skipped and the first error is
+    // rethrown: as is when the tasks run on the calling thread alone, and
+    // otherwise as a std::runtime_error with the same message.
+    void runParallel(ParallelTask& task, const std::size_t taskCount, std::size_t threadCount = 0);
+
+    // Start of range index when splitting [0, size) into partCount ranges
+    inline std::size_t getRangeStart(const std::size_t size, const std::size_t partCount, const std::size_t index)
+    {
+        return (std::size_t)(((unsigned long long)size * index) / partCount);
+    }
+}
+
+#endif
@@ -0,0 +1,389 @@
+#include "Partition.hpp"
+#include "Hash.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+    typedef kinetica::ProcData::Column Column;
+    typedef kinetica::ProcData::InputTable InputTable;
+    typedef kinetica::ProcData::OutputTable OutputTable;
+
+    // Rows hashed at a time by each task
+    const std::size_t HASH_BATCH_SIZE = 1024;
+
+    // Bytes of row numbers staged by each thread, which should fit in the
+    // L2 cache of a core along with the rows being appended
+    const std::size_t STAGING_SIZE = 256 * 1024;
+
+    // Fewest rows staged per partition, so that appends stay in bulk when
+    // there are many partitions
+    const std::size_t MIN_STAGING_ROWS = 256;
+
+    std::size_t getThreadCount(const std::size_t size, const std::size_t threadCount)
+    {
+        std::size_t threads = threadCount == 0 ? kinetica::getHardwareThreadCount() : threadCount;
+        return size >= kinetica::MIN_PARALLEL_SIZE ? threads : 1;
+    }
+
+    std::size_t getChunkCount(const std::size_t size, const std::size_t threadCount)
+    {
+        std::size_t threads = getThreadCount(size, threadCount);
+        return threads > 1 ? threads * 4 : 1;
+    }
+
+    //--------------------------------------------------------------------------
+    // Hash partitions
+    //--------------------------------------------------------------------------
+
+    class HashTask : public kinetica::ParallelTask
+    {
+    public:
+        HashTask(const std::vector<const Column*>& keys, const std::size_t partitionCount, const std::size_t chunkCount,
+                 uint32_t* partitions) :
+            m_keys(keys),
+            m_partitionCount(partitionCount),
+            m_chunkCount(chunkCount),
+            m_partitions(partitions)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            std::size_t size = m_keys[0]->getSize();
+            std::size_t start = kinetica::getRangeStart(size, m_chunkCount, index);
+            std::size_t end = kinetica::getRangeStart(size, m_chunkCount, index + 1);
+            uint64_t hashes[HASH_BATCH_SIZE];
+
+            for (std::size_t batch = start; batch < end; batch += HASH_BATCH_SIZE)
+            {
+                std::size_t count = std::min(HASH_BATCH_SIZE, end - batch);
+                kinetica::hashColumn(*m_keys[0], batch, count, hashes);
+
+                for (std::size_t i = 1; i < m_keys.size(); ++i)
+                {
+                    kinetica::combineColumnHashes(*m_keys[i], batch, count, hashes);
+                }
+
+                // Maps the high bits of each hash onto [0, partitionCount)
+                // without a division
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    m_partitions[batch + i] = (uint32_t)(((hashes[i] >> 32) * m_partitionCount) >> 32);
+                }
+            }
+        }
+
+    private:
+        const std::vector<const Column*>& m_keys;
+        uint64_t m_partitionCount;
+        std::size_t m_chunkCount;
+        uint32_t* m_partitions;
+    };
+
+    //--------------------------------------------------------------------------
+    // Range partitions
+    //--------------------------------------------------------------------------
+
+    template<typename T>
+    void findRanges(const Column& column, const std::vector<uint64_t>& bounds, const std::size_t start,
+                    const std::size_t end, uint32_t* partitions)
+    {
+        const T* values = column.getData<T>();
+        const uint8_t* nulls = column.isNullable() ? column.getNulls() : NULL;
+
+        for (std::size_t i = start; i < end; ++i)
+        {
+            if (nulls != NULL && nulls[i])
+            {
+                partitions[i] = 0;
+                continue;
+            }
+
+            uint64_t key = kinetica::getSortKey(values[i]);
+            partitions[i] = (uint32_t)(std::upper_bound(bounds.begin(), bounds.end(), key) - bounds.begin());
+        }
+    }
+
+    void findRanges(const Column& column, const std::vector<uint64_t>& bounds, const std::size_t start,
+                    const std::size_t end, uint32_t* partitions)
+    {
+        switch (column.getType())
+        {
+            case Column::BOOLEAN:
+            case Column::INT8: findRanges<int8_t>(column, bounds, start, end, partitions); break;
+            case Column::CHAR1: findRanges<kinetica::CharN<1> >(column, bounds, start, end, partitions); break;
+            case Column::CHAR2: findRanges<kinetica::CharN<2> >(column, bounds, start, end, partitions); break;
+            case Column::CHAR4: findRanges<kinetica::CharN<4> >(column, bounds, start, end, partitions); break;
+            case Column::CHAR8: findRanges<kinetica::CharN<8> >(column, bounds, start, end, partitions); break;
+            case Column::CHAR16: findRanges<kinetica::CharN<16> >(column, bounds, start, end, partitions); break;
+            case Column::CHAR32: findRanges<kinetica::CharN<32> >(column, bounds, start, end, partitions); break;
+            case Column::CHAR64: findRanges<kinetica::CharN<64> >(column, bounds, start, end, partitions); break;
+            case Column::CHAR128: findRanges<kinetica::CharN<128> >(column, bounds, start, end, partitions); break;
+            case Column::CHAR256: findRanges<kinetica::CharN<256> >(column, bounds, start, end, partitions); break;
+            case Column::DATE: findRanges<kinetica::Date>(column, bounds, start, end, partitions); break;
+            case Column::DATETIME: findRanges<kinetica::DateTime>(column, bounds, start, end, partitions); break;
+            case Column::DECIMAL:
+            case Column::LONG:
+            case Column::TIMESTAMP: findRanges<int64_t>(column, bounds, start, end, partitions); break;
+            case Column::DOUBLE: findRanges<double>(column, bounds, start, end, partitions); break;
+            case Column::FLOAT: findRanges<float>(column, bounds, start, end, partitions); break;
+            case Column::INT: findRanges<int32_t>(column, bounds, start, end, partitions); break;
+            case Column::INT16: findRanges<int16_t>(column, bounds, start, end, partitions); break;
+            case Column::IPV4: findRanges<uint32_t>(column, bounds, start, end, partitions); break;
+            case Column::TIME: findRanges<kinetica::Time>(column, bounds, start, end, partitions); break;
+            case Column::ULONG: findRanges<uint64_t>(column, bounds, start, end, partitions); break;
+            case Column::UUID: findRanges<kinetica::UUID>(column, bounds, start, end, partitions); break;
+            default: throw std::invalid_argument("Column " + column.getName() + " is not fixed-width");
+        }
+    }
+
+    class RangeTask : public kinetica::ParallelTask
+    {
+    public:
+        RangeTask(const Column& column, const std::vector<uint64_t>& bounds, const std::size_t chunkCount,
+                  uint32_t* partitions) :
+            m_column(column),
+            m_bounds(bounds),
+            m_chunkCount(chunkCount),
+            m_partitions(partitions)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            std::size_t start = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index);
+            std::size_t end = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index + 1);
+            findRanges(m_column, m_bounds, start, end, m_partitions);
+        }
+
+    private:
+        const Column& m_column;
+        const std::vector<uint64_t>& m_bounds;
+        std::size_t m_chunkCount;
+        uint32_t* m_partitions;
+    };
+
+    //--------------------------------------------------------------------------
+    // Writing
+    //--------------------------------------------------------------------------
+
+    void checkOutput(const InputTable& table, OutputTable& result)
+    {
+        if (result.getColumnCount() != table.getColumnCount())
+        {
+            throw std::invalid_argument("Output table " + result.getName() + " does not match table " + table.getName());
+        }
+
+        for (std::size_t i = 0; i < table.getColumnCount(); ++i)
+        {
+            if (result.getColumn(i).getType() != table.getColumn(i).getType())
+            {
+                throw std::invalid_argument("Output column " + result.getColumn(i).getName() + " does not match column "
+                                            + table.getColumn(i).getName());
+            }
+        }
+    }
+
+    // Each task writes the partitions p with p % groupCount == index, staging
+    // their rows while scanning the partition ids once
+    class WriteTask : public kinetica::ParallelTask
+    {
+    public:
+        WriteTask(const InputTable& table, const std::vector<uint32_t>& partitions,
+                  const std::vector<OutputTable*>& results, const std::size_t groupCount) :
+            m_table(table),
+            m_partitions(partitions),
+            m_results(results),
+            m_groupCount(groupCount)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            std::size_t slotCount = (m_results.size() - index + m_groupCount - 1) / m_groupCount;
+            std::size_t capacity = std::max(MIN_STAGING_ROWS, STAGING_SIZE / sizeof(std::size_t) / slotCount);
+            std::vector<std::size_t> staging(slotCount * capacity);
+            std::vector<std::size_t> counts(slotCount, 0);
+
+            for (std::size_t row = 0; row < m_partitions.size(); ++row)
+            {
+                std::size_t partition = m_partitions[row];
+
+                if (partition % m_groupCount != index)
+                {
+                    continue;
+                }
+
+                std::size_t slot = partition / m_groupCount;
+                std::size_t* rows = &staging[slot * capacity];
+                rows[counts[slot]++] = row;
+
+                if (counts[slot] == capacity)
+                {
+                    flush(partition, rows, capacity);
+                    counts[slot] = 0;
+                }
+            }
+
+            for (std::size_t slot = 0; slot < slotCount; ++slot)
+            {
+                if (counts[slot] > 0)
+                {
+                    flush(slot * m_groupCount + index, &staging[slot * capacity], counts[slot]);
+                }
+            }
+        }
+
+    private:
+        const InputTable& m_table;
+        const std::vector<uint32_t>& m_partitions;
+        const std::vector<OutputTable*>& m_results;
+        std::size_t m_groupCount;
+
+        void flush(const std::size_t partition, const std::size_t* rows, const std::size_t count)
+        {
+            OutputTable& result = *m_results[partition];
+
+            for (std::size_t i = 0; i < m_table.getColumnCount(); ++i)
+            {
+                result.getColumn(i).appendRows(m_table.getColumn(i), rows, count);
+            }
+        }
+    };
+}
+
+namespace kinetica
+{
+    void getHashPartitions(const ProcData::InputTable& table, const std::vector<std::size_t>& keys,
+                           const std::size_t partitionCount, std::vector<uint32_t>& partitions,
+                           const std::size_t threadCount)
+    {
+        if (keys.empty())
+        {
+            throw std::invalid_argument("No partition keys specified");
+        }
+
+        if (partitionCount == 0 || partitionCount > (uint64_t)1 << 32)
+        {
+            throw std::invalid_argument("Partition count must be in [1, 2^32]");
+        }
+
+        std::vector<const Column*> keyColumns(keys.size());
+
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            keyColumns[i] = &table.getColumn(keys[i]);
+        }
+
+        partitions.resize(table.getSize());
+
+        if (partitions.empty())
+        {
+            return;
+        }
+
+        std::size_t chunkCount = getChunkCount(table.getSize(), threadCount);
+        HashTask hashTask(keyColumns, partitionCount, chunkCount, &partitions[0]);
+        runParallel(hashTask, chunkCount, threadCount);
+    }
+
+    void getRangePartitions(const ProcData::Column& column, const std::vector<uint64_t>& bounds,
+                            std::vector<uint32_t>& partitions, const std::size_t threadCount)
+    {
+        if (bounds.size() >= (uint64_t)1 << 32)
+        {
+            throw std::invalid_argument("Too many partition bounds");
+        }
+
+        for (std::size_t i = 1; i < bounds.size(); ++i)
+        {
+            if (bounds[i] < bounds[i - 1])
+            {
+                throw std::invalid_argument("Partition bounds must be ascending");
+            }
+        }
+
+        partitions.resize(column.getSize());
+
+        if (partitions.empty())
+        {
+            return;
+        }
+
+        std::size_t chunkCount = getChunkCount(column.getSize(), threadCount);
+        RangeTask rangeTask(column, bounds, chunkCount, &partitions[0]);
+        runParallel(rangeTask, chunkCount, threadCount);
+    }
+
+    void writePartitions(const ProcData::InputTable& table, const std::vector<uint32_t>& partitions,
+                         const std::vector<ProcData::OutputTable*>& results, const std::size_t threadCount)
+    {
+        if (partitions.size() != table.getSize())
+        {
+            throw std::invalid_argument("Partition count does not match size of table " + table.getName());
+        }
+
+        std::vector<ProcData::OutputTable*> sortedResults(results);
+        std::sort(sortedResults.begin(), sortedResults.end());
+
+        if (std::adjacent_find(sortedResults.begin(), sortedResults.end()) != sortedResults.end())
+        {
+            throw std::invalid_argument("Output tables must be distinct");
+        }
+
+        std::vector<std::size_t> counts(results.size(), 0);
+
+        for (std::size_t i = 0; i < partitions.size(); ++i)
+        {
+            if (partitions[i] >= results.size())
+            {
+                throw std::out_of_range("Partition out of range");
+            }
+
+            ++counts[partitions[i]];
+        }
+
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            checkOutput(table, *results[i]);
+        }
+
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            results[i]->setSize(results[i]->getSize() + counts[i]);
+        }
+
+        if (partitions.empty())
+        {
+            return;
+        }
+
+        std::size_t groupCount = std::min(results.size(), getThreadCount(table.getSize(), threadCount));
+        WriteTask writeTask(table, partitions, results, groupCount);
+        runParallel(writeTask, groupCount, threadCount);
+    }
+
+    void writePartitions(const ProcData::InputTable& table, const std::vector<uint32_t>& partitions,
+                         ProcData::OutputDataSet& results, const std::size_t threadCount)
+    {
+        std::vector<ProcData::OutputTable*> resultTables(results.getTableCount());
+
+        for (std::size_t i = 0; i < resultTables.size(); ++i)
+        {
+            resultTables[i] = &results.getTable(i);
+        }
+
+        writePartitions(table, partitions, resultTables, threadCount);
+    }
+
+    void writeHashPartitions(const ProcData::InputTable& table, const std::vector<std::size_t>& keys,
+                             ProcData::OutputDataSet& results, const std::size_t threadCount)
+    {
+        std::vector<uint32_t> partitions;
+        getHashPartitions(table, keys, results.getTableCount(), partitions, threadCount);
+        writePartitions(table, partitions, results, threadCount);
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef _KINETICA_PARTITION_HPP_
+#define _KINETICA_PARTITION_HPP_
+
+#include "Proc.hpp"
+#include "Sort.hpp"
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace kinetica
+{
+    // Routing of the rows of an input table into several output tables, such
+    // as those of ProcData::getOutputData. Partition ids are computed for the
+    // whole table in parallel; the rows of each partition are then staged in
+    // buffers that together fit in L2 cache and appended to its output table
+    // in bulk with OutputColumn::appendRows, with each thread writing a
+    // separate set of tables.
+
+    // Replaces partitions with the partition of each row of table, in
+    // [0, partitionCount), by the hash of its key columns (see Hash.hpp).
+    // Rows with equal keys, including null keys, have the same partition.
+    void getHashPartitions(const ProcData::InputTable& table, const std::vector<std::size_t>& keys,
+                           const std::size_t partitionCount, std::vector<uint32_t>& partitions,
+                           const std::size_t threadCount = 0);
+
+    // Replaces partitions with the partition of each row of a fixed-width
+    // column by value range, given ascending sort keys of the bounds between
+    // partitions (see getSortKey): partition i holds the values with keys in
+    // [bounds[i - 1], bounds[i]), for bounds.size() + 1 partitions in all.
+    // Nulls are in partition 0, as they sort first.
+    void getRangePartitions(const ProcData::Column& column, const std::vector<uint64_t>& bounds,
+                            std::vector<uint32_t>& partitions, const std::size_t threadCount = 0);
+
+    // As above, with bounds given as values of the column's value type
+    template<typename T>
+    void getRangePartitions(const ProcData::Column& column, const std::vector<T>& bounds,
+                            std::vector<uint32_t>& partitions, const std::size_t threadCount = 0)
+    {
+        std::vector<uint64_t> keys(bounds.size());
+
+        for (std::size_t i = 0; i < bounds.size(); ++i)
+        {
+            keys[i] = getSortKey(bounds[i]);
+        }
+
+        getRangePartitions(column, keys, partitions, threadCount);
+    }
+
+    // Appends each row of table to results[partitions[row]]. The output
+    // tables must be distinct and have the same column types as table.
+    void writePartitions(const ProcData::InputTable& table, const std::vector<uint32_t>& partitions,
+                         const std::vector<ProcData::OutputTable*>& results, const std::size_t threadCount = 0);
+
+    // As above, writing partition i to table i of results
+    void writePartitions(const ProcData::InputTable& table, const std::vector<uint32_t>& partitions,
+                         ProcData::OutputDataSet& results, const std::size_t threadCount = 0);
+
+    // Hash partitions table by the key columns into the tables of results
+    void writeHashPartitions(const ProcData::InputTable& table, const std::vector<std::size_t>& keys,
+                             ProcData::OutputDataSet& results, const std::size_t threadCount = 0);
+}
+
+#endif
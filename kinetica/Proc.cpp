@@ -43,6 +43,37 @@ namespace
         std::size_t length = sprintf(buffer, "%d.%d.%d.%d", (int)value[3], (int)value[2], (int)value[1], (int)value[0]);
         return std::string(buffer, length);
     }
+
+    template<std::size_t N>
+    struct Bytes
+    {
+        uint8_t data[N];
+    };
+
+    // Copies the values of rows from source to target, returning whether any
+    // row is NO_ROW
+    template<typename T>
+    bool gatherValues(const void* source, const std::size_t* rows, const std::size_t count, void* target)
+    {
+        const T* values = (const T*)source;
+        T* data = (T*)target;
+        bool hasMissing = false;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (rows[i] != kinetica::ProcData::OutputColumn::NO_ROW)
+            {
+                data[i] = values[rows[i]];
+            }
+            else
+            {
+                std::memset(&data[i], 0, sizeof(T));
+                hasMissing = true;
+            }
+        }
+
+        return hasMissing;
+    }
 }
 
 namespace kinetica
@@ -280,32 +311,32 @@ namespace kinetica
 
     bool Time::operator ==(const Time& value) const
     {
-        return raw == value.raw;
+        return (raw & 0xFFFFFFF0) == (value.raw & 0xFFFFFFF0);
     }
 
     bool Time::operator !=(const Time& value) const
     {
-        return raw != value.raw;
+        return (raw & 0xFFFFFFF0) != (value.raw & 0xFFFFFFF0);
     }
 
     bool Time::operator <(const Time& value) const
     {
-        return raw < value.raw;
+        return (raw & 0xFFFFFFF0) < (value.raw & 0xFFFFFFF0);
     }
 
     bool Time::operator <=(const Time& value) const
     {
-        return raw <= value.raw;
+        return (raw & 0xFFFFFFF0) <= (value.raw & 0xFFFFFFF0);
     }
 
     bool Time::operator >(const Time& value) const
     {
-        return raw > value.raw;
+        return (raw & 0xFFFFFFF0) > (value.raw & 0xFFFFFFF0);
     }
 
     bool Time::operator >=(const Time& value) const
     {
-        return raw >= value.raw;
+        return (raw & 0xFFFFFFF0) >= (value.raw & 0xFFFFFFF0);
     }
 
     std::ostream& operator <<(std::ostream& os, const Time& value)
@@ -379,6 +410,11 @@ namespace kinetica
         return *this;
     }
 
+    int UUID::compare(const UUID& value) const
+    {
+        return compareLittleEndian((const char*)raw, (const char*)value.raw, 16);
+    }
+
     bool UUID::operator ==(const UUID& value) const
     {
         return std::memcmp(raw, value.raw, 16) == 0;
@@ -391,54 +427,22 @@ namespace kinetica
 
     bool UUID::operator <(const UUID& value) const
     {
-        for (std::size_t i = 0; i < 16; ++i)
-        {
-            if (raw[15 - i] == value.raw[15 - i])
-            {
-                continue;
-            }
-            else if (raw[15 - i] < value.raw[15 - i])
-            {
-                return true;
-            }
-            else
-            {
-                return false;
-            }
-        }
-
-        return false;
+        return compare(value) < 0;
     }
 
     bool UUID::operator <=(const UUID& value) const
     {
-        for (std::size_t i = 0; i < 16; ++i)
-        {
-            if (raw[15 - i] == value.raw[15 - i])
-            {
-                continue;
-            }
-            else if (raw[15 - i] < value.raw[15 - i])
-            {
-                return true;
-            }
-            else
-            {
-                return false;
-            }
-        }
-
-        return true;
+        return compare(value) <= 0;
     }
 
     bool UUID::operator >(const UUID& value) const
     {
-        return !(*this <= value);
+        return compare(value) > 0;
     }
 
     bool UUID::operator >=(const UUID& value) const
     {
-        return !(*this < value);
+        return compare(value) >= 0;
     }
 
     uint8_t& UUID::operator [](std::size_t index)
@@ -721,12 +725,11 @@ namespace kinetica
         controlFile.read(m_name);
         m_type = ColumnType(controlFile.next<uint64_t>());
         m_typeSize = getTypeSize(m_type);
-        std::string dataPath;
-        controlFile.read(dataPath);
+        controlFile.read(m_dataPath);
 
-        if (!dataPath.empty())
+        if (!m_dataPath.empty())
         {
-            m_data.map(dataPath, writable);
+            m_data.map(m_dataPath, writable);
             m_size = m_data.getSize() / m_typeSize;
         }
         else
@@ -776,6 +779,11 @@ namespace kinetica
         return m_size;
     }
 
+    const std::string& ProcData::Column::getDataPath() const
+    {
+        return m_dataPath;
+    }
+
     const uint8_t* ProcData::Column::getNulls() const
     {
         return m_nulls.getData<uint8_t>();
@@ -860,6 +868,11 @@ namespace kinetica
     {
     }
 
+    uint8_t* ProcData::OutputColumn::getNulls()
+    {
+        return m_nulls.getData<uint8_t>();
+    }
+
     void ProcData::OutputColumn::setNull(const std::size_t index)
     {
         if (!m_isNullable)
@@ -894,6 +907,67 @@ namespace kinetica
         return appendVarValue<char>(value.c_str(), value.length() + 1);
     }
 
+    const std::size_t ProcData::OutputColumn::NO_ROW;
+
+    std::size_t ProcData::OutputColumn::appendRows(const Column& column, const std::size_t* rows, const std::size_t count)
+    {
+        if (column.getType() != m_type)
+        {
+            throw std::invalid_argument("Column " + column.getName() + " does not match column " + m_name);
+        }
+
+        const uint8_t* nulls = column.isNullable() ? column.getNulls() : NULL;
+        std::size_t index = m_pos;
+
+        if (m_type == BYTES || m_type == STRING)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                if (rows[i] == NO_ROW || (nulls != NULL && nulls[rows[i]]))
+                {
+                    appendNull();
+                }
+                else
+                {
+                    appendVarValue<uint8_t>(column.getVarValue<uint8_t>(rows[i]), column.getVarValueSize<uint8_t>(rows[i]));
+                }
+            }
+
+            return index;
+        }
+
+        const void* values = column.getData<uint8_t>();
+        void* data = appendValues(count);
+        bool hasMissing;
+
+        switch (m_typeSize)
+        {
+            case 1: hasMissing = gatherValues<uint8_t>(values, rows, count, data); break;
+            case 2: hasMissing = gatherValues<uint16_t>(values, rows, count, data); break;
+            case 4: hasMissing = gatherValues<uint32_t>(values, rows, count, data); break;
+            case 8: hasMissing = gatherValues<uint64_t>(values, rows, count, data); break;
+            case 16: hasMissing = gatherValues<Bytes<16> >(values, rows, count, data); break;
+            case 32: hasMissing = gatherValues<Bytes<32> >(values, rows, count, data); break;
+            case 64: hasMissing = gatherValues<Bytes<64> >(values, rows, count, data); break;
+            case 128: hasMissing = gatherValues<Bytes<128> >(values, rows, count, data); break;
+            case 256: hasMissing = gatherValues<Bytes<256> >(values, rows, count, data); break;
+            default: throw std::runtime_error("Invalid data type");
+        }
+
+        if (nulls != NULL || hasMissing)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                if (rows[i] == NO_ROW || (nulls != NULL && nulls[rows[i]]))
+                {
+                    setNull(index + i);
+                }
+            }
+        }
+
+        return index;
+    }
+
     void ProcData::OutputColumn::complete()
     {
         if (m_type == BYTES || m_type == STRING)
@@ -10,6 +10,10 @@
 #include <string>
 #include <vector>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace kinetica
 {
     inline uint8_t swapBytes(const uint8_t value)
@@ -43,6 +47,60 @@ namespace kinetica
                 | ((value & 0xFF00000000000000) >> 56);
     }
 
+    // Three-way comparison of two little-endian unsigned integers of the
+    // given width in bytes
+    inline int compareLittleEndian(const char* a, const char* b, const std::size_t width)
+    {
+        if (width == 16)
+        {
+            uint64_t x[2];
+            uint64_t y[2];
+            std::memcpy(x, a, 16);
+            std::memcpy(y, b, 16);
+            return 2 * ((x[1] > y[1]) - (x[1] < y[1])) + ((x[0] > y[0]) - (x[0] < y[0]));
+        }
+
+        std::size_t i = width;
+
+        #ifdef __SSE2__
+        for (; i >= 16; i -= 16)
+        {
+            __m128i x = _mm_loadu_si128((const __m128i*)(a + i - 16));
+            __m128i y = _mm_loadu_si128((const __m128i*)(b + i - 16));
+            unsigned mask = ~(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) & 0xffff;
+
+            if (mask != 0)
+            {
+                std::size_t pos = i - 16 + (31 - __builtin_clz(mask));
+                return (uint8_t)a[pos] < (uint8_t)b[pos] ? -1 : 1;
+            }
+        }
+        #endif
+
+        for (; i >= 8; i -= 8)
+        {
+            uint64_t x;
+            uint64_t y;
+            std::memcpy(&x, a + i - 8, 8);
+            std::memcpy(&y, b + i - 8, 8);
+
+            if (x != y)
+            {
+                return x < y ? -1 : 1;
+            }
+        }
+
+        for (; i > 0; --i)
+        {
+            if (a[i - 1] != b[i - 1])
+            {
+                return (uint8_t)a[i - 1] < (uint8_t)b[i - 1] ? -1 : 1;
+            }
+        }
+
+        return 0;
+    }
+
     template<typename T>
     struct CharNInt
     {
@@ -61,8 +119,7 @@ namespace kinetica
 
         int compare(const CharNInt<T>& value) const
         {
-            return buffer == value.buffer ? 0 :
-                (buffer < value.buffer ? -1 : 1);
+            return (buffer > value.buffer) - (buffer < value.buffer);
         }
 
         void set(const char value)
@@ -135,17 +192,7 @@ namespace kinetica
 
         int compare(const CharNIntBuffer<T, N>& value) const
         {
-            for (std::size_t i = 0; i < N; ++i)
-            {
-                if (buffer[N - 1 - i] == value.buffer[N - 1 - i])
-                {
-                    continue;
-                }
-
-                return buffer[N - 1 - i] < value.buffer[N - 1 - i] ? -1 : 1;
-            }
-
-            return 0;
+            return compareLittleEndian(raw, value.raw, width);
         }
 
         void set(const char value)
@@ -389,6 +436,7 @@ namespace kinetica
         UUID& operator =(const UUID& value);
         uint8_t& operator [](std::size_t index);
         const uint8_t& operator [](std::size_t index) const;
+        int compare(const UUID& value) const;
         bool operator ==(const UUID& value) const;
         bool operator !=(const UUID& value) const;
         bool operator <(const UUID& value) const;
@@ -430,6 +478,10 @@ namespace kinetica
             std::size_t getPos() const;
             void seek(const std::size_t pos);
 
+            // Grows a writable file so that length more bytes fit past the
+            // position
+            void ensure(const std::size_t length);
+
             template<typename T>
             T& next()
             {
@@ -510,7 +562,6 @@ namespace kinetica
 
             MemoryMappedFile(const MemoryMappedFile&);
             MemoryMappedFile& operator=(const MemoryMappedFile&);
-            void ensure(const std::size_t length);
         };
 
 
@@ -557,6 +608,9 @@ namespace kinetica
             bool isNullable() const;
             std::size_t getSize() const;
 
+            // Path of the file holding the column's fixed-width data
+            const std::string& getDataPath() const;
+
             template<typename T>
             const T* getData() const
             {
@@ -605,6 +659,7 @@ namespace kinetica
         protected:
             std::string m_name;
             ColumnType m_type;
+            std::string m_dataPath;
             std::size_t m_typeSize;
             bool m_isNullable;
             std::size_t m_size;
@@ -657,6 +712,12 @@ namespace kinetica
             void setNull(const std::size_t index);
             std::size_t appendNull();
 
+            // Index of the next row to be appended
+            std::size_t getPos() const
+            {
+                return m_pos;
+            }
+
             template<typename T>
             void setValue(const std::size_t index, const T& value)
             {
@@ -693,9 +754,101 @@ namespace kinetica
                 return index;
             }
 
+            template<typename T>
+            T* appendValues(const std::size_t count)
+            {
+                std::size_t index = m_pos;
+
+                if (m_isNullable)
+                {
+                    std::memset(&m_nulls.getData<uint8_t>()[index], 0, count);
+                }
+
+                m_pos += count;
+                return &m_data.getData<T>()[index];
+            }
+
+            // Untyped form of appendValues<T>(count) for fixed-width types
+            void* appendValues(const std::size_t count)
+            {
+                std::size_t index = m_pos;
+
+                if (m_isNullable)
+                {
+                    std::memset(&m_nulls.getData<uint8_t>()[index], 0, count);
+                }
+
+                m_pos += count;
+                return m_data.getData<uint8_t>() + index * m_typeSize;
+            }
+
+            template<typename T>
+            std::size_t appendValues(const T* values, const std::size_t count)
+            {
+                std::size_t index = m_pos;
+                std::memcpy(appendValues<T>(count), values, count * sizeof(T));
+                return index;
+            }
+
+            template<typename T>
+            std::size_t appendVarValues(const T* values, const std::size_t size, const uint64_t* offsets, const std::size_t count)
+            {
+                std::size_t index = m_pos;
+                uint64_t base = m_varData.getPos();
+                uint64_t* data = appendValues<uint64_t>(count);
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    data[i] = base + offsets[i] * sizeof(T);
+                }
+
+                // values may be NULL when size is 0
+                if (size > 0)
+                {
+                    m_varData.write(values, size * sizeof(T));
+                }
+
+                return index;
+            }
+
             std::size_t appendVarBytes(const std::vector<uint8_t>& value);
             std::size_t appendVarString(const std::string& value);
 
+            // Builds the next var value in place, with no intermediate copy:
+            // reserveVarValue returns the start of the value with room for
+            // capacity elements, and may be called again with a larger
+            // capacity to extend it (keeping what was written, though the
+            // value may move); commitVarValue then appends a row holding its
+            // first size elements (for STRING, including the NUL).
+            template<typename T>
+            T* reserveVarValue(const std::size_t capacity)
+            {
+                m_varData.ensure(capacity * sizeof(T));
+                return (T*)(m_varData.getData<uint8_t>() + m_varData.getPos());
+            }
+
+            template<typename T>
+            std::size_t commitVarValue(const std::size_t size)
+            {
+                std::size_t index = m_pos;
+
+                if (m_isNullable)
+                {
+                    m_nulls.getData<uint8_t>()[index] = false;
+                }
+
+                m_data.getData<uint64_t>()[index] = m_varData.getPos();
+                m_varData.seek(m_varData.getPos() + size * sizeof(T));
+                m_pos++;
+                return index;
+            }
+
+            // Row index that appendRows appends as a null
+            static const std::size_t NO_ROW = (std::size_t)-1;
+
+            // Appends the values of the given rows of a column of the same type
+            std::size_t appendRows(const Column& column, const std::size_t* rows, const std::size_t count);
+
         private:
             std::size_t m_pos;
 
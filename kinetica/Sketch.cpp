@@ -0,0 +1,653 @@
+#include "Sketch.hpp"
+#include "Hash.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    typedef kinetica::ProcData::Column Column;
+
+    // Rows hashed at a time by each HyperLogLog task
+    const std::size_t HASH_BATCH_SIZE = 1024;
+
+    // Smallest number of values a quantile sketch level holds before it is
+    // compacted
+    const std::size_t MIN_LEVEL_CAPACITY = 8;
+
+    const uint8_t HYPER_LOG_LOG_FORMAT = 1;
+    const uint8_t QUANTILE_SKETCH_FORMAT = 2;
+    const uint8_t FORMAT_VERSION = 1;
+
+    std::size_t getChunkCount(const Column& column, const std::size_t threadCount)
+    {
+        std::size_t threads = threadCount == 0 ? kinetica::getHardwareThreadCount() : threadCount;
+        return column.getSize() >= kinetica::MIN_PARALLEL_SIZE && threads > 1 ? threads * 4 : 1;
+    }
+
+    //--------------------------------------------------------------------------
+    // Serialization
+    //--------------------------------------------------------------------------
+
+    void writeWord(std::vector<uint8_t>& data, const uint64_t value)
+    {
+        for (unsigned i = 0; i < 8; ++i)
+        {
+            data.push_back((uint8_t)(value >> (i * 8)));
+        }
+    }
+
+    void writeDouble(std::vector<uint8_t>& data, const double value)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &value, 8);
+        writeWord(data, bits);
+    }
+
+    void checkSize(const std::vector<uint8_t>& data, const std::size_t pos, const std::size_t size)
+    {
+        if (size > data.size() || pos > data.size() - size)
+        {
+            throw std::invalid_argument("Invalid serialized sketch");
+        }
+    }
+
+    uint64_t readWord(const std::vector<uint8_t>& data, std::size_t& pos)
+    {
+        checkSize(data, pos, 8);
+        uint64_t value = 0;
+
+        for (unsigned i = 0; i < 8; ++i)
+        {
+            value |= (uint64_t)data[pos++] << (i * 8);
+        }
+
+        return value;
+    }
+
+    double readDouble(const std::vector<uint8_t>& data, std::size_t& pos)
+    {
+        uint64_t bits = readWord(data, pos);
+        double value;
+        std::memcpy(&value, &bits, 8);
+        return value;
+    }
+
+    void readHeader(const std::vector<uint8_t>& data, std::size_t& pos, const uint8_t format)
+    {
+        checkSize(data, pos, 2);
+
+        if (data[pos] != format || data[pos + 1] != FORMAT_VERSION)
+        {
+            throw std::invalid_argument("Invalid serialized sketch");
+        }
+
+        pos += 2;
+    }
+
+    //--------------------------------------------------------------------------
+    // HyperLogLog
+    //--------------------------------------------------------------------------
+
+    class HashTask : public kinetica::ParallelTask
+    {
+    public:
+        HashTask(const Column& column, const std::size_t chunkCount, std::vector<kinetica::HyperLogLog>& sketches) :
+            m_column(column),
+            m_chunkCount(chunkCount),
+            m_sketches(sketches)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            std::size_t start = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index);
+            std::size_t end = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index + 1);
+            const uint8_t* nulls = m_column.isNullable() ? m_column.getNulls() : NULL;
+            kinetica::HyperLogLog& sketch = m_sketches[index];
+            uint64_t hashes[HASH_BATCH_SIZE];
+
+            for (std::size_t batch = start; batch < end; batch += HASH_BATCH_SIZE)
+            {
+                std::size_t count = std::min(HASH_BATCH_SIZE, end - batch);
+                kinetica::hashColumn(m_column, batch, count, hashes);
+
+                if (nulls == NULL)
+                {
+                    sketch.add(hashes, count);
+                    continue;
+                }
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    if (!nulls[batch + i])
+                    {
+                        sketch.add(hashes[i]);
+                    }
+                }
+            }
+        }
+
+    private:
+        const Column& m_column;
+        std::size_t m_chunkCount;
+        std::vector<kinetica::HyperLogLog>& m_sketches;
+    };
+
+    //--------------------------------------------------------------------------
+    // Quantiles
+    //--------------------------------------------------------------------------
+
+    template<typename T>
+    void addValues(kinetica::QuantileSketch& sketch, const Column& column, const std::size_t start, const std::size_t end)
+    {
+        const T* values = column.getData<T>();
+        const uint8_t* nulls = column.isNullable() ? column.getNulls() : NULL;
+
+        for (std::size_t i = start; i < end; ++i)
+        {
+            if (nulls == NULL || !nulls[i])
+            {
+                sketch.add((double)values[i]);
+            }
+        }
+    }
+
+    void addValues(kinetica::QuantileSketch& sketch, const Column& column, const std::size_t start, const std::size_t end)
+    {
+        switch (column.getType())
+        {
+            case Column::DOUBLE: addValues<double>(sketch, column, start, end); break;
+            case Column::FLOAT: addValues<float>(sketch, column, start, end); break;
+            case Column::INT8: addValues<int8_t>(sketch, column, start, end); break;
+            case Column::INT16: addValues<int16_t>(sketch, column, start, end); break;
+            case Column::INT: addValues<int32_t>(sketch, column, start, end); break;
+            case Column::LONG:
+            case Column::TIMESTAMP: addValues<int64_t>(sketch, column, start, end); break;
+            case Column::ULONG: addValues<uint64_t>(sketch, column, start, end); break;
+            default: throw std::invalid_argument("Column " + column.getName() + " is not numeric");
+        }
+    }
+
+    class QuantileTask : public kinetica::ParallelTask
+    {
+    public:
+        QuantileTask(const Column& column, const std::size_t chunkCount, std::vector<kinetica::QuantileSketch>& sketches) :
+            m_column(column),
+            m_chunkCount(chunkCount),
+            m_sketches(sketches)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            std::size_t start = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index);
+            std::size_t end = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index + 1);
+            addValues(m_sketches[index], m_column, start, end);
+        }
+
+    private:
+        const Column& m_column;
+        std::size_t m_chunkCount;
+        std::vector<kinetica::QuantileSketch>& m_sketches;
+    };
+
+    struct WeightedValue
+    {
+        double value;
+        uint64_t weight;
+
+        bool operator <(const WeightedValue& other) const
+        {
+            return value < other.value;
+        }
+    };
+
+    void getWeightedValues(const std::vector<std::vector<double> >& levels, std::vector<WeightedValue>& result)
+    {
+        for (std::size_t i = 0; i < levels.size(); ++i)
+        {
+            for (std::size_t j = 0; j < levels[i].size(); ++j)
+            {
+                WeightedValue value;
+                value.value = levels[i][j];
+                value.weight = (uint64_t)1 << i;
+                result.push_back(value);
+            }
+        }
+
+        std::sort(result.begin(), result.end());
+    }
+}
+
+namespace kinetica
+{
+    //--------------------------------------------------------------------------
+    // HyperLogLog
+    //--------------------------------------------------------------------------
+
+    const unsigned HyperLogLog::MIN_PRECISION;
+    const unsigned HyperLogLog::MAX_PRECISION;
+    const unsigned HyperLogLog::DEFAULT_PRECISION;
+
+    HyperLogLog::HyperLogLog(const unsigned precision) :
+        m_precision(precision)
+    {
+        if (precision < MIN_PRECISION || precision > MAX_PRECISION)
+        {
+            throw std::invalid_argument("HyperLogLog precision out of range");
+        }
+
+        m_registers.resize((std::size_t)1 << precision, 0);
+    }
+
+    unsigned HyperLogLog::getPrecision() const
+    {
+        return m_precision;
+    }
+
+    void HyperLogLog::add(const uint64_t* hashes, const std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            add(hashes[i]);
+        }
+    }
+
+    void HyperLogLog::add(const ProcData::Column& column, const std::size_t threadCount)
+    {
+        std::size_t chunkCount = getChunkCount(column, threadCount);
+        std::vector<HyperLogLog> sketches(chunkCount, HyperLogLog(m_precision));
+        HashTask hashTask(column, chunkCount, sketches);
+        runParallel(hashTask, chunkCount, threadCount);
+
+        for (std::size_t i = 0; i < chunkCount; ++i)
+        {
+            merge(sketches[i]);
+        }
+    }
+
+    void HyperLogLog::merge(const HyperLogLog& sketch)
+    {
+        if (sketch.m_precision != m_precision)
+        {
+            throw std::invalid_argument("HyperLogLog precisions do not match");
+        }
+
+        for (std::size_t i = 0; i < m_registers.size(); ++i)
+        {
+            m_registers[i] = std::max(m_registers[i], sketch.m_registers[i]);
+        }
+    }
+
+    double HyperLogLog::estimate() const
+    {
+        double m = (double)m_registers.size();
+        double sum = 0;
+        std::size_t zeroCount = 0;
+
+        for (std::size_t i = 0; i < m_registers.size(); ++i)
+        {
+            sum += std::ldexp(1.0, -(int)m_registers[i]);
+            zeroCount += m_registers[i] == 0;
+        }
+
+        double alpha;
+
+        switch (m_precision)
+        {
+            case 4: alpha = 0.673; break;
+            case 5: alpha = 0.697; break;
+            case 6: alpha = 0.709; break;
+            default: alpha = 0.7213 / (1 + 1.079 / m);
+        }
+
+        double result = alpha * m * m / sum;
+
+        // Linear counting is more accurate while many registers are unset
+        if (result <= 2.5 * m && zeroCount > 0)
+        {
+            result = m * std::log(m / (double)zeroCount);
+        }
+
+        return result;
+    }
+
+    void HyperLogLog::serialize(std::vector<uint8_t>& data) const
+    {
+        data.assign(3, 0);
+        data[0] = HYPER_LOG_LOG_FORMAT;
+        data[1] = FORMAT_VERSION;
+        data[2] = (uint8_t)m_precision;
+        data.resize(3 + m_registers.size() * 6 / 8, 0);
+
+        for (std::size_t i = 0; i < m_registers.size(); ++i)
+        {
+            std::size_t bit = i * 6;
+            unsigned value = (unsigned)m_registers[i] << (bit % 8);
+            data[3 + bit / 8] |= (uint8_t)value;
+
+            if (bit % 8 > 2)
+            {
+                data[3 + bit / 8 + 1] |= (uint8_t)(value >> 8);
+            }
+        }
+    }
+
+    void HyperLogLog::deserialize(const std::vector<uint8_t>& data)
+    {
+        std::size_t pos = 0;
+        readHeader(data, pos, HYPER_LOG_LOG_FORMAT);
+        checkSize(data, pos, 1);
+        HyperLogLog sketch(data[pos++]);
+        checkSize(data, pos, sketch.m_registers.size() * 6 / 8);
+
+        for (std::size_t i = 0; i < sketch.m_registers.size(); ++i)
+        {
+            std::size_t bit = i * 6;
+            unsigned value = data[pos + bit / 8];
+
+            if (bit % 8 > 2)
+            {
+                value |= (unsigned)data[pos + bit / 8 + 1] << 8;
+            }
+
+            sketch.m_registers[i] = (uint8_t)((value >> (bit % 8)) & 0x3f);
+        }
+
+        *this = sketch;
+    }
+
+    //--------------------------------------------------------------------------
+    // QuantileSketch
+    //--------------------------------------------------------------------------
+
+    const std::size_t QuantileSketch::DEFAULT_K;
+
+    QuantileSketch::QuantileSketch(const std::size_t k) :
+        m_k(k),
+        m_count(0),
+        m_min(std::numeric_limits<double>::quiet_NaN()),
+        m_max(std::numeric_limits<double>::quiet_NaN()),
+        m_random(0x9e3779b97f4a7c15),
+        m_levels(1)
+    {
+        if (k < 8)
+        {
+            throw std::invalid_argument("Quantile sketch k must be at least 8");
+        }
+    }
+
+    std::size_t QuantileSketch::getK() const
+    {
+        return m_k;
+    }
+
+    uint64_t QuantileSketch::getCount() const
+    {
+        return m_count;
+    }
+
+    double QuantileSketch::getMin() const
+    {
+        return m_min;
+    }
+
+    double QuantileSketch::getMax() const
+    {
+        return m_max;
+    }
+
+    void QuantileSketch::add(const double value)
+    {
+        if (value != value)
+        {
+            return;
+        }
+
+        if (m_count == 0 || value < m_min)
+        {
+            m_min = value;
+        }
+
+        if (m_count == 0 || value > m_max)
+        {
+            m_max = value;
+        }
+
+        ++m_count;
+        m_levels[0].push_back(value);
+
+        if (m_levels[0].size() >= getCapacity(0))
+        {
+            compress();
+        }
+    }
+
+    void QuantileSketch::add(const ProcData::Column& column, const std::size_t threadCount)
+    {
+        std::size_t chunkCount = getChunkCount(column, threadCount);
+
+        if (chunkCount == 1)
+        {
+            addValues(*this, column, 0, column.getSize());
+            return;
+        }
+
+        std::vector<QuantileSketch> sketches(chunkCount, QuantileSketch(m_k));
+        QuantileTask quantileTask(column, chunkCount, sketches);
+        runParallel(quantileTask, chunkCount, threadCount);
+
+        for (std::size_t i = 0; i < chunkCount; ++i)
+        {
+            merge(sketches[i]);
+        }
+    }
+
+    void QuantileSketch::merge(const QuantileSketch& sketch)
+    {
+        if (sketch.m_k != m_k)
+        {
+            throw std::invalid_argument("Quantile sketch sizes do not match");
+        }
+
+        if (sketch.m_count == 0)
+        {
+            return;
+        }
+
+        m_min = m_count == 0 || sketch.m_min < m_min ? sketch.m_min : m_min;
+        m_max = m_count == 0 || sketch.m_max > m_max ? sketch.m_max : m_max;
+        m_count += sketch.m_count;
+
+        if (sketch.m_levels.size() > m_levels.size())
+        {
+            m_levels.resize(sketch.m_levels.size());
+        }
+
+        for (std::size_t i = 0; i < sketch.m_levels.size(); ++i)
+        {
+            m_levels[i].insert(m_levels[i].end(), sketch.m_levels[i].begin(), sketch.m_levels[i].end());
+        }
+
+        compress();
+    }
+
+    double QuantileSketch::getQuantile(const double rank) const
+    {
+        if (rank < 0 || rank > 1)
+        {
+            throw std::out_of_range("Quantile rank must be in [0, 1]");
+        }
+
+        if (m_count == 0)
+        {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        else if (rank == 0)
+        {
+            return m_min;
+        }
+        else if (rank == 1)
+        {
+            return m_max;
+        }
+
+        std::vector<WeightedValue> values;
+        getWeightedValues(m_levels, values);
+        uint64_t total = 0;
+
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            total += values[i].weight;
+        }
+
+        double target = rank * (double)total;
+        uint64_t weight = 0;
+
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            weight += values[i].weight;
+
+            if ((double)weight >= target)
+            {
+                return values[i].value;
+            }
+        }
+
+        return m_max;
+    }
+
+    double QuantileSketch::getRank(const double value) const
+    {
+        if (m_count == 0)
+        {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+
+        uint64_t total = 0;
+        uint64_t weight = 0;
+
+        for (std::size_t i = 0; i < m_levels.size(); ++i)
+        {
+            for (std::size_t j = 0; j < m_levels[i].size(); ++j)
+            {
+                total += (uint64_t)1 << i;
+                weight += m_levels[i][j] <= value ? (uint64_t)1 << i : 0;
+            }
+        }
+
+        return (double)weight / (double)total;
+    }
+
+    void QuantileSketch::serialize(std::vector<uint8_t>& data) const
+    {
+        data.assign(2, 0);
+        data[0] = QUANTILE_SKETCH_FORMAT;
+        data[1] = FORMAT_VERSION;
+        writeWord(data, m_k);
+        writeWord(data, m_count);
+        writeDouble(data, m_min);
+        writeDouble(data, m_max);
+        writeWord(data, m_levels.size());
+
+        for (std::size_t i = 0; i < m_levels.size(); ++i)
+        {
+            writeWord(data, m_levels[i].size());
+        }
+
+        for (std::size_t i = 0; i < m_levels.size(); ++i)
+        {
+            for (std::size_t j = 0; j < m_levels[i].size(); ++j)
+            {
+                writeDouble(data, m_levels[i][j]);
+            }
+        }
+    }
+
+    void QuantileSketch::deserialize(const std::vector<uint8_t>& data)
+    {
+        std::size_t pos = 0;
+        readHeader(data, pos, QUANTILE_SKETCH_FORMAT);
+        QuantileSketch sketch((std::size_t)readWord(data, pos));
+        sketch.m_count = readWord(data, pos);
+        sketch.m_min = readDouble(data, pos);
+        sketch.m_max = readDouble(data, pos);
+        uint64_t levelCount = readWord(data, pos);
+
+        if (levelCount == 0 || levelCount > 64)
+        {
+            throw std::invalid_argument("Invalid serialized sketch");
+        }
+
+        sketch.m_levels.resize((std::size_t)levelCount);
+
+        for (std::size_t i = 0; i < sketch.m_levels.size(); ++i)
+        {
+            uint64_t size = readWord(data, pos);
+
+            if (size > (data.size() - pos) / 8)
+            {
+                throw std::invalid_argument("Invalid serialized sketch");
+            }
+
+            sketch.m_levels[i].resize((std::size_t)size);
+        }
+
+        for (std::size_t i = 0; i < sketch.m_levels.size(); ++i)
+        {
+            for (std::size_t j = 0; j < sketch.m_levels[i].size(); ++j)
+            {
+                sketch.m_levels[i][j] = readDouble(data, pos);
+            }
+        }
+
+        *this = sketch;
+    }
+
+    // Lower levels hold fewer values, shrinking geometrically by 2/3 from k
+    // at the top level
+    std::size_t QuantileSketch::getCapacity(const std::size_t level) const
+    {
+        double capacity = std::ceil((double)m_k * std::pow(2.0 / 3.0, (double)(m_levels.size() - 1 - level)));
+        return std::max(MIN_LEVEL_CAPACITY, (std::size_t)capacity);
+    }
+
+    // Compacts each full level by sorting it and promoting every other value,
+    // starting at a random one of the first two, to the next level up
+    void QuantileSketch::compress()
+    {
+        for (std::size_t i = 0; i < m_levels.size(); ++i)
+        {
+            if (m_levels[i].size() < getCapacity(i))
+            {
+                continue;
+            }
+
+            if (i + 1 == m_levels.size())
+            {
+                m_levels.resize(m_levels.size() + 1);
+            }
+
+            std::vector<double>& level = m_levels[i];
+            std::sort(level.begin(), level.end());
+
+            // An odd value out stays at this level
+            std::size_t start = level.size() % 2;
+            m_random ^= m_random << 13;
+            m_random ^= m_random >> 7;
+            m_random ^= m_random << 17;
+
+            for (std::size_t j = start + (std::size_t)(m_random & 1); j < level.size(); j += 2)
+            {
+                m_levels[i + 1].push_back(level[j]);
+            }
+
+            level.resize(start);
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#ifndef _KINETICA_SKETCH_HPP_
+#define _KINETICA_SKETCH_HPP_
+
+#include "Proc.hpp"
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace kinetica
+{
+    // Approximate summaries of column values that can be built on each rank,
+    // serialized into a few KB (e.g. for ProcData::getBinResults) and merged.
+    // Serialized sketches are little-endian and include a format version.
+
+    // HyperLogLog distinct count estimator over value hashes (see Hash.hpp),
+    // with 2^precision registers and a relative standard error of about
+    // 1.04 / sqrt(2^precision)
+    class HyperLogLog
+    {
+    public:
+        static const unsigned MIN_PRECISION = 4;
+        static const unsigned MAX_PRECISION = 18;
+        static const unsigned DEFAULT_PRECISION = 12;
+
+        HyperLogLog(const unsigned precision = DEFAULT_PRECISION);
+
+        unsigned getPrecision() const;
+
+        void add(const uint64_t hash)
+        {
+            unsigned shift = 64 - m_precision;
+            uint64_t rest = hash << m_precision;
+            uint8_t rank = rest == 0 ? (uint8_t)(shift + 1) : (uint8_t)(__builtin_clzll(rest) + 1);
+            uint8_t& reg = m_registers[(std::size_t)(hash >> shift)];
+            reg = rank > reg ? rank : reg;
+        }
+
+        void add(const uint64_t* hashes, const std::size_t count);
+
+        // Adds the non-null values of a column of any type, hashing parts of
+        // it in parallel
+        void add(const ProcData::Column& column, const std::size_t threadCount = 0);
+
+        // Combines the values of a sketch of the same precision into this one
+        void merge(const HyperLogLog& sketch);
+
+        // Estimated number of distinct values added
+        double estimate() const;
+
+        // Replaces data with the serialized sketch, 6 bits per register
+        void serialize(std::vector<uint8_t>& data) const;
+
+        // Replaces the sketch with a serialized one
+        void deserialize(const std::vector<uint8_t>& data);
+
+    private:
+        unsigned m_precision;
+        std::vector<uint8_t> m_registers;
+    };
+
+    // KLL quantile sketch of numeric values, whose rank error is about
+    // 1.7 / k for the default k; memory use grows only with log(count).
+    // Values of any integer or floating-point column type, including
+    // TIMESTAMP, are summarized as doubles; nulls and NaN are ignored.
+    class QuantileSketch
+    {
+    public:
+        static const std::size_t DEFAULT_K = 200;
+
+        QuantileSketch(const std::size_t k = DEFAULT_K);
+
+        std::size_t getK() const;
+
+        // Number of values added
+        uint64_t getCount() const;
+
+        double getMin() const;
+        double getMax() const;
+
+        void add(const double value);
+
+        // Adds the values of a column, building sketches of parts of it in
+        // parallel and merging them
+        void add(const ProcData::Column& column, const std::size_t threadCount = 0);
+
+        // Combines the values of a sketch with the same k into this one
+        void merge(const QuantileSketch& sketch);
+
+        // Approximate value of the given rank in [0, 1]: 0 is the minimum,
+        // 0.5 the median and 1 the maximum. Returns NaN if the sketch is
+        // empty.
+        double getQuantile(const double rank) const;
+
+        // Approximate fraction of values less than or equal to value
+        double getRank(const double value) const;
+
+        void serialize(std::vector<uint8_t>& data) const;
+        void deserialize(const std::vector<uint8_t>& data);
+
+    private:
+        std::size_t m_k;
+        uint64_t m_count;
+        double m_min;
+        double m_max;
+        uint64_t m_random;
+
+        // Values of weight 2^i at level i
+        std::vector<std::vector<double> > m_levels;
+
+        std::size_t getCapacity(const std::size_t level) const;
+        void compress();
+    };
+}
+
+#endif
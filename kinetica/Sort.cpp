@@ -0,0 +1,1147 @@
+#include "Sort.hpp"
+#include "Parallel.hpp"
+#include "Spill.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    typedef kinetica::ProcData::Column Column;
+
+    //--------------------------------------------------------------------------
+    // Keys
+    //--------------------------------------------------------------------------
+
+    // Each key column is encoded as a sequence of 64-bit words, most
+    // significant first, that compare as unsigned integers in the order of
+    // the column's values: a null flag for nullable columns followed by the
+    // value itself for fixed-width types. Descending keys invert every word.
+    // STRING and BYTES values are compared directly.
+
+    template<typename T>
+    void encodeValues(const Column& column, const std::size_t start, const std::size_t count, uint64_t* words)
+    {
+        const T* values = column.getData<T>() + start;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            words[i] = kinetica::getSortKey(values[i]);
+        }
+    }
+
+    // Values of 16 bytes or more are little-endian integers (UUID) or
+    // byte-reversed text (CharN), so their last 8 bytes are most significant
+    void encodeWideValues(const Column& column, const std::size_t start, const std::size_t count, uint64_t* const* words)
+    {
+        std::size_t width = Column::getTypeSize(column.getType());
+        std::size_t wordCount = width / 8;
+        const uint8_t* values = column.getData<uint8_t>() + start * width;
+
+        for (std::size_t i = 0; i < count; ++i, values += width)
+        {
+            for (std::size_t j = 0; j < wordCount; ++j)
+            {
+                std::memcpy(&words[j][i], values + width - 8 * (j + 1), 8);
+            }
+        }
+    }
+
+    bool isVarType(const Column::ColumnType type)
+    {
+        return type == Column::BYTES || type == Column::STRING;
+    }
+
+    // Number of value words of a column
+    std::size_t getValueWordCount(const Column::ColumnType type)
+    {
+        if (isVarType(type))
+        {
+            return 0;
+        }
+
+        std::size_t size = Column::getTypeSize(type);
+        return size <= 8 ? 1 : size / 8;
+    }
+
+    // Encodes rows [start, start + count) of column into words, one array
+    // per value word
+    void encodeColumn(const Column& column, const std::size_t start, const std::size_t count, uint64_t* const* words)
+    {
+        switch (column.getType())
+        {
+            case Column::BOOLEAN:
+            case Column::INT8: encodeValues<int8_t>(column, start, count, words[0]); break;
+            case Column::CHAR1: encodeValues<kinetica::CharN<1> >(column, start, count, words[0]); break;
+            case Column::CHAR2: encodeValues<kinetica::CharN<2> >(column, start, count, words[0]); break;
+            case Column::CHAR4: encodeValues<kinetica::CharN<4> >(column, start, count, words[0]); break;
+            case Column::CHAR8: encodeValues<kinetica::CharN<8> >(column, start, count, words[0]); break;
+            case Column::DATE: encodeValues<kinetica::Date>(column, start, count, words[0]); break;
+            case Column::DATETIME: encodeValues<kinetica::DateTime>(column, start, count, words[0]); break;
+            case Column::DECIMAL:
+            case Column::LONG:
+            case Column::TIMESTAMP: encodeValues<int64_t>(column, start, count, words[0]); break;
+            case Column::DOUBLE: encodeValues<double>(column, start, count, words[0]); break;
+            case Column::FLOAT: encodeValues<float>(column, start, count, words[0]); break;
+            case Column::INT: encodeValues<int32_t>(column, start, count, words[0]); break;
+            case Column::INT16: encodeValues<int16_t>(column, start, count, words[0]); break;
+            case Column::IPV4: encodeValues<uint32_t>(column, start, count, words[0]); break;
+            case Column::TIME: encodeValues<kinetica::Time>(column, start, count, words[0]); break;
+            case Column::ULONG: encodeValues<uint64_t>(column, start, count, words[0]); break;
+            case Column::CHAR16:
+            case Column::CHAR32:
+            case Column::CHAR64:
+            case Column::CHAR128:
+            case Column::CHAR256:
+            case Column::UUID: encodeWideValues(column, start, count, words); break;
+            default: throw std::runtime_error("Invalid data type");
+        }
+    }
+
+    struct KeyColumn
+    {
+        const Column* column;
+        bool ascending;
+
+        // Index of the column's first word and of the word after its last
+        std::size_t word;
+        std::size_t end;
+    };
+
+    struct SortContext
+    {
+        std::vector<KeyColumn> keys;
+
+        // Sorted rows are [first, first + size); words are indexed from first
+        std::size_t first;
+        std::size_t size;
+        std::size_t chunkCount;
+        std::vector<std::vector<uint64_t> > words;
+        bool hasVarKeys;
+
+        // Current permutation and encoded keys in its order, plus scatter
+        // targets for each radix pass
+        std::vector<std::size_t> rows;
+        std::vector<std::size_t> tempRows;
+        std::vector<uint64_t> values;
+        std::vector<uint64_t> tempValues;
+
+        // Number of rows of each chunk with each digit value, then the
+        // position of the chunk's first row with each digit value
+        std::vector<std::size_t> counts;
+        unsigned shift;
+
+        std::size_t getChunkStart(const std::size_t index) const
+        {
+            return kinetica::getRangeStart(size, chunkCount, index);
+        }
+    };
+
+    // Encodes rows [start, start + count) of the key columns; words[j]
+    // receives word j of every row
+    void encodeKeys(const std::vector<KeyColumn>& keys, const std::size_t start, const std::size_t count, uint64_t* const* words)
+    {
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            const KeyColumn& key = keys[i];
+            const Column& column = *key.column;
+            const uint8_t* nulls = column.isNullable() ? column.getNulls() + start : NULL;
+            std::size_t word = key.word;
+
+            if (nulls != NULL)
+            {
+                uint64_t* flags = words[word++];
+
+                for (std::size_t j = 0; j < count; ++j)
+                {
+                    flags[j] = nulls[j] ? 0 : 1;
+                }
+            }
+
+            if (word < key.end)
+            {
+                encodeColumn(column, start, count, words + word);
+
+                // Null values all encode the same
+                if (nulls != NULL)
+                {
+                    for (std::size_t j = 0; j < count; ++j)
+                    {
+                        if (nulls[j])
+                        {
+                            for (std::size_t k = word; k < key.end; ++k)
+                            {
+                                words[k][j] = 0;
+                            }
+                        }
+                    }
+                }
+            }
+
+            if (!key.ascending)
+            {
+                for (std::size_t j = key.word; j < key.end; ++j)
+                {
+                    for (std::size_t k = 0; k < count; ++k)
+                    {
+                        words[j][k] = ~words[j][k];
+                    }
+                }
+            }
+        }
+    }
+
+    // Compares STRING or BYTES key values of two rows that are not null
+    inline int compareVarValues(const KeyColumn& key, const std::size_t a, const std::size_t b)
+    {
+        const Column& column = *key.column;
+        std::size_t sizeA = column.getVarValueSize<uint8_t>(a);
+        std::size_t sizeB = column.getVarValueSize<uint8_t>(b);
+        int result = std::memcmp(column.getVarValue<uint8_t>(a), column.getVarValue<uint8_t>(b), std::min(sizeA, sizeB));
+
+        if (result == 0)
+        {
+            result = (sizeA > sizeB) - (sizeA < sizeB);
+        }
+
+        return key.ascending ? result : -result;
+    }
+
+    void addKey(std::vector<KeyColumn>& keys, const Column& column, const bool ascending)
+    {
+        KeyColumn key;
+        key.column = &column;
+        key.ascending = ascending;
+        key.word = keys.empty() ? 0 : keys.back().end;
+        key.end = key.word + (column.isNullable() ? 1 : 0) + getValueWordCount(column.getType());
+        keys.push_back(key);
+    }
+
+    std::vector<KeyColumn> getKeys(const kinetica::ProcData::InputTable& table, const std::vector<kinetica::SortKey>& keys)
+    {
+        std::vector<KeyColumn> result;
+
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            addKey(result, table.getColumn(keys[i].column), keys[i].ascending);
+        }
+
+        return result;
+    }
+
+    class EncodeTask : public kinetica::ParallelTask
+    {
+    public:
+        EncodeTask(SortContext& context) :
+            m_context(context)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            SortContext& context = m_context;
+            std::size_t start = context.getChunkStart(index);
+            std::size_t count = context.getChunkStart(index + 1) - start;
+            std::vector<uint64_t*> words;
+
+            if (count == 0 || context.words.empty())
+            {
+                return;
+            }
+
+            for (std::size_t i = 0; i < context.words.size(); ++i)
+            {
+                words.push_back(&context.words[i][start]);
+            }
+
+            encodeKeys(context.keys, context.first + start, count, &words[0]);
+        }
+
+    private:
+        SortContext& m_context;
+    };
+
+    //--------------------------------------------------------------------------
+    // Radix sort
+    //--------------------------------------------------------------------------
+
+    // Loads one word of every row in permutation order
+    class LoadTask : public kinetica::ParallelTask
+    {
+    public:
+        LoadTask(SortContext& context, const std::vector<uint64_t>& words) :
+            m_context(context),
+            m_words(words)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            SortContext& context = m_context;
+            std::size_t end = context.getChunkStart(index + 1);
+
+            for (std::size_t i = context.getChunkStart(index); i < end; ++i)
+            {
+                context.values[i] = m_words[context.rows[i] - context.first];
+            }
+        }
+
+    private:
+        SortContext& m_context;
+        const std::vector<uint64_t>& m_words;
+    };
+
+    class CountTask : public kinetica::ParallelTask
+    {
+    public:
+        CountTask(SortContext& context) :
+            m_context(context)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            SortContext& context = m_context;
+            std::size_t* counts = &context.counts[index * 256];
+            std::size_t end = context.getChunkStart(index + 1);
+            std::fill(counts, counts + 256, 0);
+
+            for (std::size_t i = context.getChunkStart(index); i < end; ++i)
+            {
+                counts[(context.values[i] >> context.shift) & 0xff]++;
+            }
+        }
+
+    private:
+        SortContext& m_context;
+    };
+
+    class ScatterTask : public kinetica::ParallelTask
+    {
+    public:
+        ScatterTask(SortContext& context) :
+            m_context(context)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            SortContext& context = m_context;
+            std::size_t* positions = &context.counts[index * 256];
+            std::size_t end = context.getChunkStart(index + 1);
+            const uint64_t* values = context.values.empty() ? NULL : &context.values[0];
+            const std::size_t* rows = context.rows.empty() ? NULL : &context.rows[0];
+
+            for (std::size_t i = context.getChunkStart(index); i < end; ++i)
+            {
+                std::size_t position = positions[(values[i] >> context.shift) & 0xff]++;
+                context.tempValues[position] = values[i];
+                context.tempRows[position] = rows[i];
+            }
+        }
+
+    private:
+        SortContext& m_context;
+    };
+
+    // Stable sort of the permutation on each word from least to most
+    // significant, skipping digits that are the same for every row
+    void radixSort(SortContext& context, const std::size_t threadCount)
+    {
+        context.values.resize(context.size);
+        context.tempValues.resize(context.size);
+        context.tempRows.resize(context.size);
+        context.counts.resize(context.chunkCount * 256);
+        CountTask countTask(context);
+        ScatterTask scatterTask(context);
+
+        for (std::size_t i = context.words.size(); i-- > 0; )
+        {
+            LoadTask loadTask(context, context.words[i]);
+            kinetica::runParallel(loadTask, context.chunkCount, threadCount);
+            uint64_t same = 0;
+
+            for (std::size_t j = 1; j < context.size; ++j)
+            {
+                same |= context.values[j] ^ context.values[0];
+            }
+
+            for (context.shift = 0; context.shift < 64; context.shift += 8)
+            {
+                if (((same >> context.shift) & 0xff) == 0)
+                {
+                    continue;
+                }
+
+                kinetica::runParallel(countTask, context.chunkCount, threadCount);
+                std::size_t position = 0;
+
+                for (std::size_t digit = 0; digit < 256; ++digit)
+                {
+                    for (std::size_t chunk = 0; chunk < context.chunkCount; ++chunk)
+                    {
+                        std::size_t count = context.counts[chunk * 256 + digit];
+                        context.counts[chunk * 256 + digit] = position;
+                        position += count;
+                    }
+                }
+
+                kinetica::runParallel(scatterTask, context.chunkCount, threadCount);
+                context.values.swap(context.tempValues);
+                context.rows.swap(context.tempRows);
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Merge sort
+    //--------------------------------------------------------------------------
+
+    class RowLess
+    {
+    public:
+        RowLess(const SortContext& context) :
+            m_context(context)
+        {
+        }
+
+        bool operator ()(const std::size_t a, const std::size_t b) const
+        {
+            return compare(a, b) < 0;
+        }
+
+        int compare(const std::size_t a, const std::size_t b) const
+        {
+            const SortContext& context = m_context;
+
+            for (std::size_t i = 0; i < context.keys.size(); ++i)
+            {
+                const KeyColumn& key = context.keys[i];
+
+                for (std::size_t j = key.word; j < key.end; ++j)
+                {
+                    uint64_t x = context.words[j][a - context.first];
+                    uint64_t y = context.words[j][b - context.first];
+
+                    if (x != y)
+                    {
+                        return x < y ? -1 : 1;
+                    }
+                }
+
+                if (isVarType(key.column->getType()) && !(key.column->isNullable() && key.column->getNulls()[a]))
+                {
+                    int result = compareVarValues(key, a, b);
+
+                    if (result != 0)
+                    {
+                        return result;
+                    }
+                }
+            }
+
+            return 0;
+        }
+
+    private:
+        const SortContext& m_context;
+    };
+
+    class RunTask : public kinetica::ParallelTask
+    {
+    public:
+        RunTask(SortContext& context) :
+            m_context(context)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            SortContext& context = m_context;
+            std::size_t start = context.getChunkStart(index);
+            std::size_t end = context.getChunkStart(index + 1);
+            std::stable_sort(context.rows.begin() + start, context.rows.begin() + end, RowLess(context));
+        }
+
+    private:
+        SortContext& m_context;
+    };
+
+    // Orders runs by their current rows for a min-heap; ties go to the
+    // earlier run so that the merge is stable
+    class RunGreater
+    {
+    public:
+        RunGreater(const RowLess& less, const std::vector<std::size_t>& rows, const std::vector<std::size_t>& positions) :
+            m_less(less),
+            m_rows(rows),
+            m_positions(positions)
+        {
+        }
+
+        bool operator ()(const std::size_t a, const std::size_t b) const
+        {
+            int result = m_less.compare(m_rows[m_positions[a]], m_rows[m_positions[b]]);
+            return result > 0 || (result == 0 && a > b);
+        }
+
+    private:
+        const RowLess& m_less;
+        const std::vector<std::size_t>& m_rows;
+        const std::vector<std::size_t>& m_positions;
+    };
+
+    // Sorts chunks of the permutation in parallel and merges them
+    void mergeSort(SortContext& context, const std::size_t threadCount)
+    {
+        RunTask runTask(context);
+        kinetica::runParallel(runTask, context.chunkCount, threadCount);
+
+        if (context.chunkCount == 1)
+        {
+            return;
+        }
+
+        RowLess less(context);
+        std::vector<std::size_t> positions(context.chunkCount);
+        std::vector<std::size_t> heap;
+        RunGreater greater(less, context.rows, positions);
+
+        for (std::size_t i = 0; i < context.chunkCount; ++i)
+        {
+            positions[i] = context.getChunkStart(i);
+
+            if (positions[i] < context.getChunkStart(i + 1))
+            {
+                heap.push_back(i);
+            }
+        }
+
+        std::make_heap(heap.begin(), heap.end(), greater);
+        context.tempRows.resize(context.size);
+
+        for (std::size_t i = 0; i < context.size; ++i)
+        {
+            std::pop_heap(heap.begin(), heap.end(), greater);
+            std::size_t run = heap.back();
+            context.tempRows[i] = context.rows[positions[run]++];
+
+            if (positions[run] < context.getChunkStart(run + 1))
+            {
+                std::push_heap(heap.begin(), heap.end(), greater);
+            }
+            else
+            {
+                heap.pop_back();
+            }
+        }
+
+        context.rows.swap(context.tempRows);
+    }
+
+    // Sorts rows [first, first + size) into context.rows, leaving their
+    // encoded keys in context.words
+    void sortRange(SortContext& context, const std::vector<KeyColumn>& keys, const std::size_t first, const std::size_t size,
+                   std::size_t threadCount)
+    {
+        if (threadCount == 0)
+        {
+            threadCount = kinetica::getHardwareThreadCount();
+        }
+
+        context.keys = keys;
+        context.first = first;
+        context.size = size;
+        context.chunkCount = size >= kinetica::MIN_PARALLEL_SIZE && threadCount > 1 ? threadCount * 4 : 1;
+        context.hasVarKeys = false;
+        std::size_t wordCount = keys.empty() ? 0 : keys.back().end;
+
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            context.hasVarKeys |= isVarType(keys[i].column->getType());
+        }
+
+        context.words.resize(wordCount);
+
+        for (std::size_t i = 0; i < wordCount; ++i)
+        {
+            context.words[i].resize(size);
+        }
+
+        EncodeTask encodeTask(context);
+        kinetica::runParallel(encodeTask, context.chunkCount, threadCount);
+        context.rows.resize(size);
+
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            context.rows[i] = first + i;
+        }
+
+        if (context.hasVarKeys)
+        {
+            // Runs are merged on a single thread, so use one run per thread
+            context.chunkCount = size >= kinetica::MIN_PARALLEL_SIZE && threadCount > 1 ? threadCount : 1;
+            mergeSort(context, threadCount);
+        }
+        else if (size > 1)
+        {
+            radixSort(context, threadCount);
+        }
+    }
+
+    void sort(const std::vector<KeyColumn>& keys, const std::size_t size, std::vector<std::size_t>& result, const std::size_t threadCount)
+    {
+        SortContext context;
+        sortRange(context, keys, 0, size, threadCount);
+        result.swap(context.rows);
+    }
+
+    //--------------------------------------------------------------------------
+    // Top rows
+    //--------------------------------------------------------------------------
+
+    // Rows encoded at a time while scanning for the top rows
+    const std::size_t TOP_BLOCK_SIZE = 256;
+
+    // Compares two rows given their words; ties go to the earlier row
+    int compareRows(const std::vector<KeyColumn>& keys, const uint64_t* wordsA, const std::size_t a,
+                    const uint64_t* wordsB, const std::size_t b)
+    {
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            const KeyColumn& key = keys[i];
+
+            for (std::size_t j = key.word; j < key.end; ++j)
+            {
+                if (wordsA[j] != wordsB[j])
+                {
+                    return wordsA[j] < wordsB[j] ? -1 : 1;
+                }
+            }
+
+            if (isVarType(key.column->getType()) && !(key.column->isNullable() && key.column->getNulls()[a]))
+            {
+                int result = compareVarValues(key, a, b);
+
+                if (result != 0)
+                {
+                    return result;
+                }
+            }
+        }
+
+        return (a > b) - (a < b);
+    }
+
+    // The best rows found by one task, each with its words stored
+    // contiguously in a slot; heap is a max-heap of slots, so the worst of
+    // the rows is first
+    struct TopRows
+    {
+        std::vector<std::size_t> rows;
+        std::vector<uint64_t> words;
+        std::vector<std::size_t> heap;
+    };
+
+    struct TopContext
+    {
+        std::vector<KeyColumn> keys;
+        std::size_t wordCount;
+        std::size_t size;
+        std::size_t chunkCount;
+        std::size_t count;
+        std::vector<TopRows> tops;
+
+        const uint64_t* getWords(const TopRows& top, const std::size_t slot) const
+        {
+            return wordCount == 0 ? NULL : &top.words[slot * wordCount];
+        }
+    };
+
+    class SlotLess
+    {
+    public:
+        SlotLess(const TopContext& context, const TopRows& top) :
+            m_context(context),
+            m_top(top)
+        {
+        }
+
+        bool operator ()(const std::size_t a, const std::size_t b) const
+        {
+            return compareRows(m_context.keys, m_context.getWords(m_top, a), m_top.rows[a],
+                               m_context.getWords(m_top, b), m_top.rows[b]) < 0;
+        }
+
+    private:
+        const TopContext& m_context;
+        const TopRows& m_top;
+    };
+
+    class TopTask : public kinetica::ParallelTask
+    {
+    public:
+        TopTask(TopContext& context) :
+            m_context(context)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            const TopContext& context = m_context;
+            TopRows& top = m_context.tops[index];
+            std::size_t wordCount = context.wordCount;
+            std::size_t start = kinetica::getRangeStart(context.size, context.chunkCount, index);
+            std::size_t end = kinetica::getRangeStart(context.size, context.chunkCount, index + 1);
+            std::vector<uint64_t> block(wordCount * TOP_BLOCK_SIZE);
+            std::vector<uint64_t*> words(wordCount);
+            std::vector<uint64_t> rowWords(wordCount);
+            SlotLess less(context, top);
+
+            for (std::size_t i = 0; i < wordCount; ++i)
+            {
+                words[i] = &block[i * TOP_BLOCK_SIZE];
+            }
+
+            for (std::size_t blockStart = start; blockStart < end; blockStart += TOP_BLOCK_SIZE)
+            {
+                std::size_t count = std::min(TOP_BLOCK_SIZE, end - blockStart);
+
+                if (wordCount > 0)
+                {
+                    encodeKeys(context.keys, blockStart, count, &words[0]);
+                }
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    std::size_t row = blockStart + i;
+                    bool isFull = top.heap.size() == context.count;
+
+                    // Most rows are rejected on their leading word alone
+                    if (isFull && wordCount > 0 && words[0][i] > top.words[top.heap[0] * wordCount])
+                    {
+                        continue;
+                    }
+
+                    for (std::size_t j = 0; j < wordCount; ++j)
+                    {
+                        rowWords[j] = words[j][i];
+                    }
+
+                    const uint64_t* current = wordCount == 0 ? NULL : &rowWords[0];
+                    std::size_t slot;
+
+                    if (!isFull)
+                    {
+                        slot = top.rows.size();
+                        top.rows.push_back(row);
+                        top.words.insert(top.words.end(), rowWords.begin(), rowWords.end());
+                    }
+                    else
+                    {
+                        slot = top.heap[0];
+
+                        if (compareRows(context.keys, current, row, context.getWords(top, slot), top.rows[slot]) >= 0)
+                        {
+                            continue;
+                        }
+
+                        std::pop_heap(top.heap.begin(), top.heap.end(), less);
+                        top.heap.pop_back();
+                        top.rows[slot] = row;
+                        std::copy(rowWords.begin(), rowWords.end(), top.words.begin() + slot * wordCount);
+                    }
+
+                    top.heap.push_back(slot);
+                    std::push_heap(top.heap.begin(), top.heap.end(), less);
+                }
+            }
+        }
+
+    private:
+        TopContext& m_context;
+    };
+
+    // Orders the rows found by all tasks, identified by task and slot
+    class CandidateLess
+    {
+    public:
+        CandidateLess(const TopContext& context) :
+            m_context(context)
+        {
+        }
+
+        bool operator ()(const std::pair<std::size_t, std::size_t>& a, const std::pair<std::size_t, std::size_t>& b) const
+        {
+            const TopRows& topA = m_context.tops[a.first];
+            const TopRows& topB = m_context.tops[b.first];
+            return compareRows(m_context.keys, m_context.getWords(topA, a.second), topA.rows[a.second],
+                               m_context.getWords(topB, b.second), topB.rows[b.second]) < 0;
+        }
+
+    private:
+        const TopContext& m_context;
+    };
+
+    void top(const std::vector<KeyColumn>& keys, const std::size_t size, const std::size_t count,
+             std::vector<std::size_t>& result, std::size_t threadCount)
+    {
+        if (threadCount == 0)
+        {
+            threadCount = kinetica::getHardwareThreadCount();
+        }
+
+        result.clear();
+
+        if (count == 0)
+        {
+            return;
+        }
+
+        TopContext context;
+        context.keys = keys;
+        context.wordCount = keys.empty() ? 0 : keys.back().end;
+        context.size = size;
+        context.chunkCount = size >= kinetica::MIN_PARALLEL_SIZE && threadCount > 1 ? threadCount * 4 : 1;
+        context.count = count;
+        context.tops.resize(context.chunkCount);
+
+        TopTask topTask(context);
+        kinetica::runParallel(topTask, context.chunkCount, threadCount);
+
+        std::vector<std::pair<std::size_t, std::size_t> > candidates;
+
+        for (std::size_t i = 0; i < context.chunkCount; ++i)
+        {
+            for (std::size_t j = 0; j < context.tops[i].rows.size(); ++j)
+            {
+                candidates.push_back(std::make_pair(i, j));
+            }
+        }
+
+        std::size_t resultCount = std::min(count, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + resultCount, candidates.end(), CandidateLess(context));
+
+        for (std::size_t i = 0; i < resultCount; ++i)
+        {
+            result.push_back(context.tops[candidates[i].first].rows[candidates[i].second]);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Output
+    //--------------------------------------------------------------------------
+
+    // Each output column is written by a single task
+    class GatherTask : public kinetica::ParallelTask
+    {
+    public:
+        GatherTask(const kinetica::ProcData::InputTable& table, const std::vector<std::size_t>& rows,
+                   kinetica::ProcData::OutputTable& result) :
+            m_table(table),
+            m_rows(rows),
+            m_result(result)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            m_result.getColumn(index).appendRows(m_table.getColumn(index), m_rows.empty() ? NULL : &m_rows[0], m_rows.size());
+        }
+
+    private:
+        const kinetica::ProcData::InputTable& m_table;
+        const std::vector<std::size_t>& m_rows;
+        kinetica::ProcData::OutputTable& m_result;
+    };
+
+    void checkOutput(const kinetica::ProcData::InputTable& table, kinetica::ProcData::OutputTable& result)
+    {
+        if (result.getColumnCount() != table.getColumnCount())
+        {
+            throw std::invalid_argument("Output table " + result.getName() + " does not match table " + table.getName());
+        }
+
+        for (std::size_t i = 0; i < table.getColumnCount(); ++i)
+        {
+            if (result.getColumn(i).getType() != table.getColumn(i).getType())
+            {
+                throw std::invalid_argument("Output column " + result.getColumn(i).getName() + " does not match column "
+                                            + table.getColumn(i).getName());
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // External sort
+    //--------------------------------------------------------------------------
+
+    // Rows per block of a spilled run and per batch of output rows
+    const std::size_t SPILL_BLOCK_SIZE = 4096;
+
+    // Spilled runs, each holding row numbers followed by encoded key words in
+    // sorted order
+    struct SpilledRuns
+    {
+        std::vector<kinetica::SpillFile*> files;
+
+        ~SpilledRuns()
+        {
+            for (std::size_t i = 0; i < files.size(); ++i)
+            {
+                delete files[i];
+            }
+        }
+    };
+
+    // Streams the rows of a spilled run one at a time
+    struct RunReader
+    {
+        kinetica::SpillFile* file;
+        std::vector<std::vector<uint64_t> > block;
+        std::size_t pos;
+        std::size_t row;
+        std::vector<uint64_t> words;
+
+        bool next()
+        {
+            if (block.empty() || ++pos >= block[0].size())
+            {
+                if (!file->read(block))
+                {
+                    return false;
+                }
+
+                pos = 0;
+            }
+
+            row = (std::size_t)block[0][pos];
+
+            for (std::size_t i = 0; i < words.size(); ++i)
+            {
+                words[i] = block[i + 1][pos];
+            }
+
+            return true;
+        }
+    };
+
+    class ReaderGreater
+    {
+    public:
+        ReaderGreater(const std::vector<KeyColumn>& keys, const std::vector<RunReader>& readers) :
+            m_keys(keys),
+            m_readers(readers)
+        {
+        }
+
+        bool operator ()(const std::size_t a, const std::size_t b) const
+        {
+            const RunReader& x = m_readers[a];
+            const RunReader& y = m_readers[b];
+            return compareRows(m_keys, x.words.empty() ? NULL : &x.words[0], x.row,
+                               y.words.empty() ? NULL : &y.words[0], y.row) > 0;
+        }
+
+    private:
+        const std::vector<KeyColumn>& m_keys;
+        const std::vector<RunReader>& m_readers;
+    };
+
+    // Merges runs into target, or appends the merged rows of table to result
+    // if target is NULL
+    void mergeRuns(const std::vector<KeyColumn>& keys, const std::vector<kinetica::SpillFile*>& runs, kinetica::SpillFile* target,
+                   const kinetica::ProcData::InputTable& table, kinetica::ProcData::OutputTable& result, const std::size_t threadCount)
+    {
+        std::size_t wordCount = keys.empty() ? 0 : keys.back().end;
+        std::vector<RunReader> readers(runs.size());
+        std::vector<std::size_t> heap;
+        ReaderGreater greater(keys, readers);
+
+        for (std::size_t i = 0; i < runs.size(); ++i)
+        {
+            readers[i].file = runs[i];
+            readers[i].words.resize(wordCount);
+            runs[i]->rewind();
+
+            if (readers[i].next())
+            {
+                heap.push_back(i);
+            }
+        }
+
+        std::make_heap(heap.begin(), heap.end(), greater);
+        std::vector<std::vector<uint64_t> > block(wordCount + 1, std::vector<uint64_t>(SPILL_BLOCK_SIZE));
+        std::vector<const uint64_t*> columns(wordCount + 1);
+        std::vector<std::size_t> rows;
+        std::size_t count = 0;
+
+        for (std::size_t i = 0; i <= wordCount; ++i)
+        {
+            columns[i] = &block[i][0];
+        }
+
+        while (!heap.empty())
+        {
+            std::pop_heap(heap.begin(), heap.end(), greater);
+            RunReader& reader = readers[heap.back()];
+            block[0][count] = reader.row;
+
+            for (std::size_t i = 0; i < wordCount; ++i)
+            {
+                block[i + 1][count] = reader.words[i];
+            }
+
+            if (reader.next())
+            {
+                std::push_heap(heap.begin(), heap.end(), greater);
+            }
+            else
+            {
+                heap.pop_back();
+            }
+
+            if (++count == SPILL_BLOCK_SIZE || heap.empty())
+            {
+                if (target != NULL)
+                {
+                    target->write(&columns[0], count);
+                }
+                else
+                {
+                    rows.assign(block[0].begin(), block[0].begin() + count);
+                    GatherTask gatherTask(table, rows, result);
+                    kinetica::runParallel(gatherTask, table.getColumnCount(), threadCount);
+                }
+
+                count = 0;
+            }
+        }
+    }
+}
+
+namespace kinetica
+{
+    SortKey::SortKey(const std::size_t column, const bool ascending) :
+        column(column),
+        ascending(ascending)
+    {
+    }
+
+    void sortRows(const ProcData::InputTable& table, const std::vector<SortKey>& keys, std::vector<std::size_t>& result,
+                  const std::size_t threadCount)
+    {
+        sort(getKeys(table, keys), table.getSize(), result, threadCount);
+    }
+
+    void sortRows(const ProcData::Column& column, const bool ascending, std::vector<std::size_t>& result,
+                  const std::size_t threadCount)
+    {
+        std::vector<KeyColumn> keys;
+        addKey(keys, column, ascending);
+        sort(keys, column.getSize(), result, threadCount);
+    }
+
+    void topRows(const ProcData::InputTable& table, const std::vector<SortKey>& keys, const std::size_t count,
+                 std::vector<std::size_t>& result, const std::size_t threadCount)
+    {
+        top(getKeys(table, keys), table.getSize(), count, result, threadCount);
+    }
+
+    std::size_t gatherTopRows(const ProcData::InputTable& table, const std::vector<SortKey>& keys, const std::size_t count,
+                              ProcData::OutputTable& result, const std::size_t threadCount)
+    {
+        std::vector<std::size_t> rows;
+        topRows(table, keys, count, rows, threadCount);
+        return gatherRows(table, rows, result, threadCount);
+    }
+
+    std::size_t gatherRows(const ProcData::InputTable& table, const std::vector<std::size_t>& rows,
+                           ProcData::OutputTable& result, const std::size_t threadCount)
+    {
+        checkOutput(table, result);
+        std::size_t index = result.getSize();
+        result.setSize(index + rows.size());
+        GatherTask gatherTask(table, rows, result);
+        runParallel(gatherTask, table.getColumnCount(), threadCount);
+        return index;
+    }
+
+    std::size_t gatherSortedRows(const ProcData::InputTable& table, const std::vector<SortKey>& keys,
+                                 ProcData::OutputTable& result, SpillManager& spill, const std::size_t threadCount)
+    {
+        checkOutput(table, result);
+        std::vector<KeyColumn> keyColumns = getKeys(table, keys);
+        std::size_t wordCount = keyColumns.empty() ? 0 : keyColumns.back().end;
+        std::size_t size = table.getSize();
+
+        // Sorting a run holds its encoded keys plus two copies of its
+        // permutation and of one key word
+        std::size_t runSize = std::max(SPILL_BLOCK_SIZE, spill.getMemoryBudget() / ((wordCount + 4) * 8));
+
+        if (size <= runSize)
+        {
+            std::vector<std::size_t> rows;
+            sort(keyColumns, size, rows, threadCount);
+            return gatherRows(table, rows, result, threadCount);
+        }
+
+        SpilledRuns runs;
+        std::vector<std::vector<uint64_t> > block(wordCount + 1, std::vector<uint64_t>(SPILL_BLOCK_SIZE));
+        std::vector<const uint64_t*> columns(wordCount + 1);
+
+        for (std::size_t i = 0; i <= wordCount; ++i)
+        {
+            columns[i] = &block[i][0];
+        }
+
+        for (std::size_t first = 0; first < size; first += runSize)
+        {
+            SortContext context;
+            sortRange(context, keyColumns, first, std::min(runSize, size - first), threadCount);
+            runs.files.push_back(new SpillFile(spill, wordCount + 1));
+
+            for (std::size_t start = 0; start < context.size; start += SPILL_BLOCK_SIZE)
+            {
+                std::size_t count = std::min(SPILL_BLOCK_SIZE, context.size - start);
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    std::size_t row = context.rows[start + i];
+                    block[0][i] = row;
+
+                    for (std::size_t j = 0; j < wordCount; ++j)
+                    {
+                        block[j + 1][i] = context.words[j][row - first];
+                    }
+                }
+
+                runs.files.back()->write(&columns[0], count);
+            }
+        }
+
+        // Each run being merged holds a decoded block and its encoded form;
+        // merge in several passes if there are too many runs for the budget
+        std::size_t mergeWidth = std::max((std::size_t)2, spill.getMemoryBudget() / (SPILL_BLOCK_SIZE * (wordCount + 1) * 16));
+
+        while (runs.files.size() > mergeWidth)
+        {
+            SpilledRuns merged;
+
+            for (std::size_t i = 0; i < runs.files.size(); i += mergeWidth)
+            {
+                std::vector<SpillFile*> group(runs.files.begin() + i, runs.files.begin() + std::min(i + mergeWidth, runs.files.size()));
+                merged.files.push_back(new SpillFile(spill, wordCount + 1));
+                mergeRuns(keyColumns, group, merged.files.back(), table, result, threadCount);
+            }
+
+            runs.files.swap(merged.files);
+        }
+
+        std::size_t index = result.getSize();
+        result.setSize(index + size);
+        mergeRuns(keyColumns, runs.files, NULL, table, result, threadCount);
+        return index;
+    }
+}
@@ -0,0 +1,129 @@
+#ifndef _KINETICA_SORT_HPP_
+#define _KINETICA_SORT_HPP_
+
+#include "Proc.hpp"
+#include "Spill.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+
+namespace kinetica
+{
+    // Order-preserving encodings of fixed-width values as 64-bit words that
+    // compare as unsigned integers in the order sortRows uses. For values
+    // wider than 8 bytes (UUID and CHAR16 and up) the word is the most
+    // significant 8 bytes, so equal words do not imply equal values.
+
+    inline uint64_t getSortKey(const int8_t value) { return (uint8_t)value ^ 0x80; }
+    inline uint64_t getSortKey(const int16_t value) { return (uint16_t)value ^ 0x8000; }
+    inline uint64_t getSortKey(const int32_t value) { return (uint32_t)value ^ 0x80000000; }
+    inline uint64_t getSortKey(const int64_t value) { return (uint64_t)value ^ 0x8000000000000000; }
+    inline uint64_t getSortKey(const uint8_t value) { return value; }
+    inline uint64_t getSortKey(const uint16_t value) { return value; }
+    inline uint64_t getSortKey(const uint32_t value) { return value; }
+    inline uint64_t getSortKey(const uint64_t value) { return value; }
+    inline uint64_t getSortKey(const Date& value) { return ((uint32_t)value.raw ^ 0x80000000) >> 12; }
+    inline uint64_t getSortKey(const DateTime& value) { return ((uint64_t)value.raw ^ 0x8000000000000000) >> 17; }
+    inline uint64_t getSortKey(const Time& value) { return value.raw >> 4; }
+
+    // Flips the sign bit of positive values and all bits of negative ones;
+    // zeros are merged and NaNs sort last
+    template<typename F, typename B>
+    inline uint64_t getRealSortKey(F value)
+    {
+        const B sign = (B)1 << (sizeof(B) * 8 - 1);
+        B bits;
+
+        if (value != value)
+        {
+            return (B)~(B)0;
+        }
+        else if (value == 0)
+        {
+            value = 0;
+        }
+
+        std::memcpy(&bits, &value, sizeof(B));
+        return (bits & sign) ? (B)~bits : (B)(bits | sign);
+    }
+
+    inline uint64_t getSortKey(const float value) { return getRealSortKey<float, uint32_t>(value); }
+    inline uint64_t getSortKey(const double value) { return getRealSortKey<double, uint64_t>(value); }
+
+    template<typename T>
+    inline uint64_t getSortKey(const CharNInt<T>& value) { return value.buffer; }
+
+    // UUIDs are little-endian integers and CharN text is byte-reversed, so
+    // their last 8 bytes are most significant
+    template<typename T, std::size_t N>
+    inline uint64_t getSortKey(const CharNIntBuffer<T, N>& value)
+    {
+        uint64_t word;
+        std::memcpy(&word, value.raw + value.width - 8, 8);
+        return word;
+    }
+
+    inline uint64_t getSortKey(const UUID& value)
+    {
+        uint64_t word;
+        std::memcpy(&word, value.raw + 8, 8);
+        return word;
+    }
+
+    struct SortKey
+    {
+        std::size_t column;
+        bool ascending;
+
+        SortKey(const std::size_t column, const bool ascending = true);
+    };
+
+    // Replaces result with the permutation of the rows of table that orders
+    // them by the key columns; rows with equal keys keep their relative
+    // order. Nulls sort before all values, or after them when descending.
+    // Values sort by their natural order: dates and times chronologically,
+    // CharN, STRING and BYTES lexicographically by their bytes, UUID and IPV4
+    // as unsigned integers, and NaN after all other floating-point values.
+    //
+    // Keys of fixed-width types are sorted with a parallel LSD radix sort
+    // over order-preserving integer encodings of their values. Keys that
+    // include STRING or BYTES columns are sorted in parallel runs that are
+    // then combined with a multi-way merge.
+    void sortRows(const ProcData::InputTable& table, const std::vector<SortKey>& keys, std::vector<std::size_t>& result,
+                  const std::size_t threadCount = 0);
+
+    // Single-column form of the above
+    void sortRows(const ProcData::Column& column, const bool ascending, std::vector<std::size_t>& result,
+                  const std::size_t threadCount = 0);
+
+    // Replaces result with the first count rows of the permutation that
+    // sortRows would produce, in order, without sorting the table. Each
+    // thread keeps a heap of the best count rows of its part of the table,
+    // rejecting most rows by comparing their leading key word against the
+    // worst row in the heap, and the heaps are merged at the end; memory use
+    // is proportional to count rather than to the table size.
+    void topRows(const ProcData::InputTable& table, const std::vector<SortKey>& keys, const std::size_t count,
+                 std::vector<std::size_t>& result, const std::size_t threadCount = 0);
+
+    // Appends the given rows of every column of table to the corresponding
+    // column of result, which must have the same column types, with one
+    // thread per column. Returns the index of the first appended row.
+    std::size_t gatherRows(const ProcData::InputTable& table, const std::vector<std::size_t>& rows,
+                           ProcData::OutputTable& result, const std::size_t threadCount = 0);
+
+    // Appends the rows found by topRows to result as gatherRows does
+    std::size_t gatherTopRows(const ProcData::InputTable& table, const std::vector<SortKey>& keys, const std::size_t count,
+                              ProcData::OutputTable& result, const std::size_t threadCount = 0);
+
+    // Appends all rows of table to result in the order sortRows would
+    // produce, as gatherRows does, keeping the encoded keys within the
+    // memory budget of spill. Tables that do not fit are sorted in runs that
+    // are written to spill files and then merged, in several passes if there
+    // are too many runs to merge at once.
+    std::size_t gatherSortedRows(const ProcData::InputTable& table, const std::vector<SortKey>& keys,
+                                 ProcData::OutputTable& result, SpillManager& spill, const std::size_t threadCount = 0);
+}
+
+#endif
@@ -0,0 +1,551 @@
+#include "Spill.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace
+{
+    enum Encoding
+    {
+        RLE,
+        PACKED,
+        DELTA,
+        RAW
+    };
+
+    // Each block is its row count followed by a descriptor and base value per
+    // column, then the columns' encoded words
+    inline uint64_t getDescriptor(const Encoding encoding, const unsigned width, const std::size_t wordCount)
+    {
+        return (uint64_t)encoding | ((uint64_t)width << 8) | ((uint64_t)wordCount << 16);
+    }
+
+    inline unsigned getBitWidth(const uint64_t value)
+    {
+        return value == 0 ? 0 : 64 - __builtin_clzll(value);
+    }
+
+    inline std::size_t getPackedWordCount(const std::size_t count, const unsigned width)
+    {
+        return (std::size_t)(((uint64_t)count * width + 63) / 64);
+    }
+
+    // Bounds of the rows per block of SpillPartitions
+    const std::size_t MIN_PARTITION_BLOCK_SIZE = 256;
+    const std::size_t MAX_PARTITION_BLOCK_SIZE = 4096;
+
+    std::size_t getPartitionBlockSize(const std::size_t bufferSize, const std::size_t partitionCount,
+                                      const std::size_t columnCount)
+    {
+        std::size_t rowSize = std::max((std::size_t)1, partitionCount * columnCount) * sizeof(uint64_t);
+        return std::min(MAX_PARTITION_BLOCK_SIZE, std::max(MIN_PARTITION_BLOCK_SIZE, bufferSize / rowSize));
+    }
+
+    inline uint64_t zigzag(const uint64_t value)
+    {
+        return (value << 1) ^ (uint64_t)((int64_t)value >> 63);
+    }
+
+    inline uint64_t unzigzag(const uint64_t value)
+    {
+        return (value >> 1) ^ (uint64_t)-(int64_t)(value & 1);
+    }
+
+    // Packs the low width bits of each value into consecutive bits of result,
+    // which must be zeroed
+    void pack(const uint64_t* values, const std::size_t count, const unsigned width, uint64_t* result)
+    {
+        if (width == 0)
+        {
+            return;
+        }
+        else if (width == 64)
+        {
+            std::memcpy(result, values, count * 8);
+            return;
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            uint64_t pos = (uint64_t)i * width;
+            std::size_t word = (std::size_t)(pos >> 6);
+            unsigned shift = (unsigned)(pos & 63);
+            result[word] |= values[i] << shift;
+
+            if (shift + width > 64)
+            {
+                result[word + 1] |= values[i] >> (64 - shift);
+            }
+        }
+    }
+
+    void unpack(const uint64_t* data, const std::size_t count, const unsigned width, uint64_t* result)
+    {
+        if (width == 0)
+        {
+            std::memset(result, 0, count * 8);
+            return;
+        }
+        else if (width == 64)
+        {
+            std::memcpy(result, data, count * 8);
+            return;
+        }
+
+        uint64_t mask = ((uint64_t)1 << width) - 1;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            uint64_t pos = (uint64_t)i * width;
+            std::size_t word = (std::size_t)(pos >> 6);
+            unsigned shift = (unsigned)(pos & 63);
+            uint64_t value = data[word] >> shift;
+
+            if (shift + width > 64)
+            {
+                value |= data[word + 1] << (64 - shift);
+            }
+
+            result[i] = value & mask;
+        }
+    }
+
+    // Appends the encoding of values to buffer, returning its descriptor and
+    // setting base
+    uint64_t encode(const uint64_t* values, const std::size_t count, std::vector<uint64_t>& buffer, uint64_t& base)
+    {
+        uint64_t min = values[0];
+        uint64_t max = values[0];
+        uint64_t maxDelta = 0;
+        std::size_t runCount = 1;
+
+        for (std::size_t i = 1; i < count; ++i)
+        {
+            min = values[i] < min ? values[i] : min;
+            max = values[i] > max ? values[i] : max;
+            uint64_t delta = zigzag(values[i] - values[i - 1]);
+            maxDelta = delta > maxDelta ? delta : maxDelta;
+            runCount += values[i] != values[i - 1];
+        }
+
+        unsigned packedWidth = getBitWidth(max - min);
+        unsigned deltaWidth = getBitWidth(maxDelta);
+        std::size_t sizes[4];
+        sizes[RLE] = runCount * 2;
+        sizes[PACKED] = getPackedWordCount(count, packedWidth);
+        sizes[DELTA] = getPackedWordCount(count - 1, deltaWidth);
+        sizes[RAW] = count;
+        Encoding encoding = RLE;
+
+        for (int i = PACKED; i <= RAW; ++i)
+        {
+            if (sizes[i] < sizes[encoding])
+            {
+                encoding = (Encoding)i;
+            }
+        }
+
+        std::size_t start = buffer.size();
+        buffer.resize(start + sizes[encoding], 0);
+        uint64_t* data = sizes[encoding] == 0 ? NULL : &buffer[start];
+
+        switch (encoding)
+        {
+            case RLE:
+            {
+                base = 0;
+                std::size_t run = 0;
+                data[0] = values[0];
+                data[1] = 1;
+
+                for (std::size_t i = 1; i < count; ++i)
+                {
+                    if (values[i] == data[run * 2])
+                    {
+                        data[run * 2 + 1]++;
+                    }
+                    else
+                    {
+                        ++run;
+                        data[run * 2] = values[i];
+                        data[run * 2 + 1] = 1;
+                    }
+                }
+
+                return getDescriptor(encoding, 0, sizes[encoding]);
+            }
+
+            case PACKED:
+            {
+                base = min;
+                std::vector<uint64_t> offsets(count);
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    offsets[i] = values[i] - min;
+                }
+
+                pack(&offsets[0], count, packedWidth, data);
+                return getDescriptor(encoding, packedWidth, sizes[encoding]);
+            }
+
+            case DELTA:
+            {
+                base = values[0];
+                std::vector<uint64_t> deltas(count);
+
+                for (std::size_t i = 1; i < count; ++i)
+                {
+                    deltas[i - 1] = zigzag(values[i] - values[i - 1]);
+                }
+
+                pack(&deltas[0], count - 1, deltaWidth, data);
+                return getDescriptor(encoding, deltaWidth, sizes[encoding]);
+            }
+
+            default:
+                base = 0;
+                std::memcpy(data, values, count * 8);
+                return getDescriptor(encoding, 64, sizes[encoding]);
+        }
+    }
+
+    void decode(const uint64_t descriptor, const uint64_t base, const uint64_t* data, const std::size_t count, uint64_t* result)
+    {
+        unsigned width = (unsigned)((descriptor >> 8) & 0xff);
+        std::size_t wordCount = (std::size_t)(descriptor >> 16);
+
+        switch ((Encoding)(descriptor & 0xff))
+        {
+            case RLE:
+                for (std::size_t i = 0, pos = 0; i < wordCount; i += 2)
+                {
+                    for (uint64_t j = 0; j < data[i + 1]; ++j)
+                    {
+                        result[pos++] = data[i];
+                    }
+                }
+
+                break;
+
+            case PACKED:
+                unpack(data, count, width, result);
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    result[i] += base;
+                }
+
+                break;
+
+            case DELTA:
+                unpack(data, count - 1, width, result + 1);
+                result[0] = base;
+
+                for (std::size_t i = 1; i < count; ++i)
+                {
+                    result[i] = result[i - 1] + unzigzag(result[i]);
+                }
+
+                break;
+
+            case RAW:
+                std::memcpy(result, data, count * 8);
+                break;
+
+            default:
+                throw std::runtime_error("Invalid spill file encoding");
+        }
+    }
+
+    void writeFully(const int file, const void* data, std::size_t size)
+    {
+        const char* pos = (const char*)data;
+
+        while (size > 0)
+        {
+            ssize_t written = ::write(file, pos, size);
+
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                throw std::runtime_error("Could not write spill file: " + std::string(std::strerror(errno)));
+            }
+
+            pos += written;
+            size -= written;
+        }
+    }
+
+    void readFully(const int file, void* data, std::size_t size, uint64_t offset)
+    {
+        char* pos = (char*)data;
+
+        while (size > 0)
+        {
+            ssize_t count = ::pread(file, pos, size, (off_t)offset);
+
+            if (count < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                throw std::runtime_error("Could not read spill file: " + std::string(std::strerror(errno)));
+            }
+            else if (count == 0)
+            {
+                throw std::runtime_error("Unexpected end of spill file");
+            }
+
+            pos += count;
+            size -= count;
+            offset += count;
+        }
+    }
+}
+
+namespace kinetica
+{
+    //--------------------------------------------------------------------------
+    // SpillManager
+    //--------------------------------------------------------------------------
+
+    SpillManager::SpillManager(const std::size_t memoryBudget, const std::string& directory) :
+        m_memoryBudget(memoryBudget),
+        m_directory(directory),
+        m_spilledSize(0)
+    {
+        if (m_directory.empty())
+        {
+            const char* tmp = std::getenv("TMPDIR");
+            m_directory = tmp != NULL && *tmp != 0 ? tmp : "/tmp";
+        }
+    }
+
+    std::size_t SpillManager::getMemoryBudget() const
+    {
+        return m_memoryBudget;
+    }
+
+    const std::string& SpillManager::getDirectory() const
+    {
+        return m_directory;
+    }
+
+    uint64_t SpillManager::getSpilledSize() const
+    {
+        return m_spilledSize;
+    }
+
+    //--------------------------------------------------------------------------
+    // SpillFile
+    //--------------------------------------------------------------------------
+
+    SpillFile::SpillFile(SpillManager& manager, const std::size_t columnCount) :
+        m_manager(manager),
+        m_columnCount(columnCount),
+        m_rowCount(0),
+        m_size(0),
+        m_readPos(0)
+    {
+        std::string path = manager.getDirectory() + "/kinetica-spill-XXXXXX";
+        std::vector<char> buffer(path.begin(), path.end());
+        buffer.push_back(0);
+        m_file = mkstemp(&buffer[0]);
+
+        if (m_file == -1)
+        {
+            throw std::runtime_error("Could not create spill file: " + std::string(std::strerror(errno)));
+        }
+
+        unlink(&buffer[0]);
+    }
+
+    SpillFile::~SpillFile()
+    {
+        close(m_file);
+    }
+
+    std::size_t SpillFile::getColumnCount() const
+    {
+        return m_columnCount;
+    }
+
+    uint64_t SpillFile::getRowCount() const
+    {
+        return m_rowCount;
+    }
+
+    uint64_t SpillFile::getSize() const
+    {
+        return m_size;
+    }
+
+    void SpillFile::write(const uint64_t* const* columns, const std::size_t count)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        std::size_t headerSize = 1 + m_columnCount * 2;
+        m_buffer.assign(headerSize, 0);
+        m_buffer[0] = count;
+
+        for (std::size_t i = 0; i < m_columnCount; ++i)
+        {
+            uint64_t base;
+            uint64_t descriptor = encode(columns[i], count, m_buffer, base);
+            m_buffer[1 + i * 2] = descriptor;
+            m_buffer[2 + i * 2] = base;
+        }
+
+        writeFully(m_file, &m_buffer[0], m_buffer.size() * 8);
+        m_rowCount += count;
+        m_size += m_buffer.size() * 8;
+        m_manager.m_spilledSize += m_buffer.size() * 8;
+    }
+
+    bool SpillFile::read(std::vector<std::vector<uint64_t> >& columns)
+    {
+        if (m_readPos >= m_size)
+        {
+            return false;
+        }
+
+        std::size_t headerSize = 1 + m_columnCount * 2;
+        m_buffer.resize(headerSize);
+        readFully(m_file, &m_buffer[0], headerSize * 8, m_readPos);
+        std::size_t count = (std::size_t)m_buffer[0];
+        std::size_t dataSize = 0;
+
+        for (std::size_t i = 0; i < m_columnCount; ++i)
+        {
+            dataSize += (std::size_t)(m_buffer[1 + i * 2] >> 16);
+        }
+
+        m_buffer.resize(headerSize + dataSize);
+
+        if (dataSize > 0)
+        {
+            readFully(m_file, &m_buffer[headerSize], dataSize * 8, m_readPos + headerSize * 8);
+        }
+
+        m_readPos += (headerSize + dataSize) * 8;
+        columns.resize(m_columnCount);
+        const uint64_t* data = dataSize == 0 ? NULL : &m_buffer[headerSize];
+
+        for (std::size_t i = 0; i < m_columnCount; ++i)
+        {
+            columns[i].resize(count);
+            decode(m_buffer[1 + i * 2], m_buffer[2 + i * 2], data, count, &columns[i][0]);
+            data += (std::size_t)(m_buffer[1 + i * 2] >> 16);
+        }
+
+        return true;
+    }
+
+    void SpillFile::rewind()
+    {
+        m_readPos = 0;
+    }
+
+    //--------------------------------------------------------------------------
+    // SpillPartitions
+    //--------------------------------------------------------------------------
+
+    SpillPartitions::SpillPartitions(SpillManager& manager, const std::size_t partitionCount, const std::size_t columnCount,
+                                     const std::size_t bufferSize) :
+        m_columnCount(columnCount),
+        m_blockSize(getPartitionBlockSize(bufferSize, partitionCount, columnCount)),
+        m_buffers(partitionCount),
+        m_counts(partitionCount, 0)
+    {
+
+        try
+        {
+            for (std::size_t i = 0; i < partitionCount; ++i)
+            {
+                m_files.push_back(new SpillFile(manager, columnCount));
+            }
+        }
+        catch (...)
+        {
+            for (std::size_t i = 0; i < m_files.size(); ++i)
+            {
+                delete m_files[i];
+            }
+
+            throw;
+        }
+    }
+
+    SpillPartitions::~SpillPartitions()
+    {
+        for (std::size_t i = 0; i < m_files.size(); ++i)
+        {
+            delete m_files[i];
+        }
+    }
+
+    std::size_t SpillPartitions::getPartitionCount() const
+    {
+        return m_files.size();
+    }
+
+    void SpillPartitions::add(const std::size_t partition, const uint64_t* values)
+    {
+        if (m_buffers[partition].empty())
+        {
+            m_buffers[partition].resize(m_columnCount * m_blockSize);
+        }
+
+        uint64_t* buffer = &m_buffers[partition][m_counts[partition]];
+
+        for (std::size_t i = 0; i < m_columnCount; ++i)
+        {
+            buffer[i * m_blockSize] = values[i];
+        }
+
+        if (++m_counts[partition] == m_blockSize)
+        {
+            write(partition);
+        }
+    }
+
+    SpillFile& SpillPartitions::getFile(const std::size_t partition)
+    {
+        write(partition);
+        m_files[partition]->rewind();
+        return *m_files[partition];
+    }
+
+    void SpillPartitions::write(const std::size_t partition)
+    {
+        if (m_counts[partition] == 0)
+        {
+            return;
+        }
+
+        std::vector<const uint64_t*> columns(m_columnCount);
+
+        for (std::size_t i = 0; i < m_columnCount; ++i)
+        {
+            columns[i] = &m_buffers[partition][i * m_blockSize];
+        }
+
+        m_files[partition]->write(columns.empty() ? NULL : &columns[0], m_counts[partition]);
+        m_counts[partition] = 0;
+    }
+}
@@ -0,0 +1,111 @@
+#ifndef _KINETICA_SPILL_HPP_
+#define _KINETICA_SPILL_HPP_
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace kinetica
+{
+    // Memory budget and temporary file location shared by operators that
+    // spill intermediate state to disk: sort runs (gatherSortedRows), partial
+    // groups (aggregate) and join partitions (join)
+    class SpillManager
+    {
+    public:
+        // An empty directory uses $TMPDIR, or /tmp if it is not set
+        SpillManager(const std::size_t memoryBudget, const std::string& directory = "");
+
+        std::size_t getMemoryBudget() const;
+        const std::string& getDirectory() const;
+
+        // Total number of bytes written to spill files so far
+        uint64_t getSpilledSize() const;
+
+    private:
+        friend class SpillFile;
+
+        std::size_t m_memoryBudget;
+        std::string m_directory;
+        uint64_t m_spilledSize;
+    };
+
+    // Temporary file of blocks of rows with a fixed number of 64-bit columns,
+    // written once and then read back block by block. Each column of a block
+    // is stored in the most compact of raw, bit-packed (frame of reference),
+    // delta (zigzag deltas, bit-packed) and run-length encodings. The file is
+    // unlinked on creation and removed when closed.
+    class SpillFile
+    {
+    public:
+        SpillFile(SpillManager& manager, const std::size_t columnCount);
+        ~SpillFile();
+
+        std::size_t getColumnCount() const;
+        uint64_t getRowCount() const;
+        uint64_t getSize() const;
+
+        // Appends a block of count rows; columns[i] points to the values of
+        // column i
+        void write(const uint64_t* const* columns, const std::size_t count);
+
+        // Reads the next block into columns, resizing each to the block's
+        // row count; returns false after the last block
+        bool read(std::vector<std::vector<uint64_t> >& columns);
+
+        // Restarts reading from the first block
+        void rewind();
+
+    private:
+        SpillManager& m_manager;
+        std::size_t m_columnCount;
+        int m_file;
+        uint64_t m_rowCount;
+        uint64_t m_size;
+        uint64_t m_readPos;
+        std::vector<uint64_t> m_buffer;
+
+        SpillFile(const SpillFile&);
+        SpillFile& operator=(const SpillFile&);
+    };
+
+    // Spill files with the same columns, one per partition of a hash
+    // partitioned operator. Rows are added one at a time, buffered per
+    // partition and written a block at a time. A partition's buffer is
+    // allocated when its first row is added, and blocks are sized so that
+    // all buffers together take at most bufferSize bytes, within a minimum
+    // and maximum number of rows.
+    class SpillPartitions
+    {
+    public:
+        SpillPartitions(SpillManager& manager, const std::size_t partitionCount, const std::size_t columnCount,
+                        const std::size_t bufferSize);
+        ~SpillPartitions();
+
+        std::size_t getPartitionCount() const;
+
+        // Appends a row of columnCount values to a partition
+        void add(const std::size_t partition, const uint64_t* values);
+
+        // Writes the buffered rows of a partition and returns its file,
+        // rewound for reading
+        SpillFile& getFile(const std::size_t partition);
+
+    private:
+        std::vector<SpillFile*> m_files;
+        std::size_t m_columnCount;
+        std::size_t m_blockSize;
+
+        // Buffered rows of each partition, column after column
+        std::vector<std::vector<uint64_t> > m_buffers;
+        std::vector<std::size_t> m_counts;
+
+        void write(const std::size_t partition);
+
+        SpillPartitions(const SpillPartitions&);
+        SpillPartitions& operator=(const SpillPartitions&);
+    };
+}
+
+#endif
@@ -0,0 +1,652 @@
+#include "StringSearch.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    typedef kinetica::ProcData::Column Column;
+
+    inline char foldCase(const char c)
+    {
+        return c >= 'A' && c <= 'Z' ? (char)(c + ('a' - 'A')) : c;
+    }
+
+    inline bool isLower(const char c)
+    {
+        return c >= 'a' && c <= 'z';
+    }
+
+    void checkPattern(const std::string& pattern)
+    {
+        if (pattern.find('\0') != std::string::npos)
+        {
+            throw std::invalid_argument("String pattern must not contain NUL characters");
+        }
+    }
+
+    // Offset of the end of a row's value, including its NUL, in the var data
+    inline std::size_t getValueEnd(const Column& column, const std::size_t row)
+    {
+        const uint64_t* offsets = column.getData<uint64_t>();
+        return row + 1 < column.getSize() ? (std::size_t)offsets[row + 1] : (std::size_t)offsets[row] + column.getVarValueSize<char>(row);
+    }
+
+    //--------------------------------------------------------------------------
+    // Scanners
+    //--------------------------------------------------------------------------
+
+    // Finds a literal needle, lowercase if ignoring case
+    class NeedleScanner
+    {
+    public:
+        NeedleScanner(const std::string& needle, const bool ignoreCase) :
+            m_needle(needle),
+            m_ignoreCase(ignoreCase)
+        {
+        }
+
+        // Position of the first occurrence of the needle starting in
+        // [pos, end - length], or end if there is none
+        std::size_t find(const char* data, std::size_t pos, const std::size_t end) const
+        {
+            const std::size_t length = m_needle.size();
+
+            if (end - pos < length)
+            {
+                return end;
+            }
+
+            const std::size_t last = end - length;
+
+            #ifdef __SSE2__
+            // Compare the first and last bytes of the needle at 16 positions
+            // at once and check candidates in full. Letters are compared with
+            // the case bit set when ignoring case.
+            const char firstByte = m_needle[0];
+            const char lastByte = m_needle[length - 1];
+            const __m128i firstBytes = _mm_set1_epi8(firstByte);
+            const __m128i lastBytes = _mm_set1_epi8(lastByte);
+            const __m128i firstCase = _mm_set1_epi8(m_ignoreCase && isLower(firstByte) ? 0x20 : 0);
+            const __m128i lastCase = _mm_set1_epi8(m_ignoreCase && isLower(lastByte) ? 0x20 : 0);
+
+            for (; pos <= last && last - pos >= 15; pos += 16)
+            {
+                __m128i firstBlock = _mm_loadu_si128((const __m128i*)(data + pos));
+                __m128i lastBlock = _mm_loadu_si128((const __m128i*)(data + pos + length - 1));
+                unsigned mask = (unsigned)_mm_movemask_epi8(_mm_and_si128(
+                    _mm_cmpeq_epi8(_mm_or_si128(firstBlock, firstCase), firstBytes),
+                    _mm_cmpeq_epi8(_mm_or_si128(lastBlock, lastCase), lastBytes)));
+
+                while (mask != 0)
+                {
+                    std::size_t candidate = pos + __builtin_ctz(mask);
+
+                    if (equals(data + candidate))
+                    {
+                        return candidate;
+                    }
+
+                    mask &= mask - 1;
+                }
+            }
+            #endif
+
+            for (; pos <= last; ++pos)
+            {
+                if (equals(data + pos))
+                {
+                    return pos;
+                }
+            }
+
+            return end;
+        }
+
+    private:
+        const std::string& m_needle;
+        bool m_ignoreCase;
+
+        bool equals(const char* value) const
+        {
+            if (!m_ignoreCase)
+            {
+                return std::memcmp(value, m_needle.data(), m_needle.size()) == 0;
+            }
+
+            for (std::size_t i = 0; i < m_needle.size(); ++i)
+            {
+                if (foldCase(value[i]) != m_needle[i])
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+    };
+
+    // Runs an Aho-Corasick automaton (see MultiStringMatcher) until it
+    // completes a pattern. No pattern contains a NUL, so no match spans two
+    // values.
+    class AutomatonScanner
+    {
+    public:
+        AutomatonScanner(const uint32_t* classes, const uint32_t* transitions, const uint32_t matchState) :
+            m_classes(classes),
+            m_transitions(transitions),
+            m_matchState(matchState)
+        {
+        }
+
+        // Position of the last byte of the first match ending in [pos, end),
+        // or end if there is none
+        std::size_t find(const char* data, std::size_t pos, const std::size_t end) const
+        {
+            uint32_t state = 0;
+
+            for (; pos < end; ++pos)
+            {
+                state = m_transitions[state + m_classes[(uint8_t)data[pos]]];
+
+                if (state >= m_matchState)
+                {
+                    return pos;
+                }
+            }
+
+            return end;
+        }
+
+    private:
+        const uint32_t* m_classes;
+        const uint32_t* m_transitions;
+        uint32_t m_matchState;
+    };
+
+    //--------------------------------------------------------------------------
+    // Tasks
+    //--------------------------------------------------------------------------
+
+    // Finds the matching rows of a chunk of the column. With a scanner, the
+    // var data of the chunk is scanned once and only rows with hits are
+    // checked; otherwise every row is checked.
+    template<typename Matcher, typename Scanner>
+    class SearchTask : public kinetica::ParallelTask
+    {
+    public:
+        SearchTask(const Matcher& matcher, const Scanner* scanner, const Column& column, const std::size_t chunkCount,
+                   std::vector<std::vector<std::size_t> >& rows) :
+            m_matcher(matcher),
+            m_scanner(scanner),
+            m_column(column),
+            m_chunkCount(chunkCount),
+            m_rows(rows)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            std::size_t start = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index);
+            std::size_t end = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index + 1);
+            const uint8_t* nulls = m_column.isNullable() ? m_column.getNulls() : NULL;
+            const uint64_t* offsets = m_column.getData<uint64_t>();
+            const char* data = m_column.getVarData<char>();
+            std::vector<std::size_t>& rows = m_rows[index];
+
+            if (start == end)
+            {
+                return;
+            }
+
+            if (m_scanner == NULL)
+            {
+                for (std::size_t row = start; row < end; ++row)
+                {
+                    if ((nulls == NULL || !nulls[row]) && matches(row, offsets[row], getValueEnd(m_column, row)))
+                    {
+                        rows.push_back(row);
+                    }
+                }
+
+                return;
+            }
+
+            std::size_t dataEnd = getValueEnd(m_column, end - 1);
+            std::size_t pos = offsets[start];
+            std::size_t row = start;
+
+            while ((pos = m_scanner->find(data, pos, dataEnd)) < dataEnd)
+            {
+                // The row holding the hit is the last starting at or before it
+                row = (std::upper_bound(offsets + row + 1, offsets + end, (uint64_t)pos) - offsets) - 1;
+                std::size_t valueEnd = getValueEnd(m_column, row);
+
+                if ((nulls == NULL || !nulls[row]) && matches(row, offsets[row], valueEnd))
+                {
+                    rows.push_back(row);
+                }
+
+                pos = valueEnd;
+            }
+        }
+
+    private:
+        const Matcher& m_matcher;
+        const Scanner* m_scanner;
+        const Column& m_column;
+        std::size_t m_chunkCount;
+        std::vector<std::vector<std::size_t> >& m_rows;
+
+        bool matches(const std::size_t row, const std::size_t valueStart, const std::size_t valueEnd) const
+        {
+            std::size_t size = valueEnd - valueStart;
+            return m_matcher.matches(m_column.getVarValue<char>(row), size > 0 ? size - 1 : 0);
+        }
+    };
+
+    template<typename Matcher, typename Scanner>
+    void findRows(const Matcher& matcher, const Scanner* scanner, const Column& column, std::vector<std::size_t>& rows,
+                  const std::size_t threadCount)
+    {
+        if (column.getType() != Column::STRING)
+        {
+            throw std::invalid_argument("Column " + column.getName() + " must be STRING");
+        }
+
+        std::size_t threads = threadCount == 0 ? kinetica::getHardwareThreadCount() : threadCount;
+        std::size_t chunkCount = column.getSize() >= kinetica::MIN_PARALLEL_SIZE && threads > 1 ? threads * 4 : 1;
+        std::vector<std::vector<std::size_t> > chunkRows(chunkCount);
+        SearchTask<Matcher, Scanner> searchTask(matcher, scanner, column, chunkCount, chunkRows);
+        kinetica::runParallel(searchTask, chunkCount, threadCount);
+
+        for (std::size_t i = 0; i < chunkCount; ++i)
+        {
+            rows.insert(rows.end(), chunkRows[i].begin(), chunkRows[i].end());
+        }
+    }
+}
+
+namespace kinetica
+{
+    //--------------------------------------------------------------------------
+    // StringMatcher
+    //--------------------------------------------------------------------------
+
+    StringMatcher::StringMatcher(const std::string& pattern, const Kind kind, const bool ignoreCase, const char escape) :
+        m_isAnchoredStart(kind == PREFIX || kind == EQUALS),
+        m_isAnchoredEnd(kind == SUFFIX || kind == EQUALS),
+        m_ignoreCase(ignoreCase),
+        m_minLength(0)
+    {
+        checkPattern(pattern);
+        Segment segment;
+
+        if (kind != LIKE)
+        {
+            segment.text = pattern;
+        }
+        else
+        {
+            m_isAnchoredStart = pattern.empty() || pattern[0] != '%';
+            m_isAnchoredEnd = true;
+
+            for (std::size_t i = 0; i < pattern.size(); ++i)
+            {
+                char c = pattern[i];
+
+                if (c == escape)
+                {
+                    if (++i == pattern.size())
+                    {
+                        throw std::invalid_argument("LIKE pattern must not end with an escape character");
+                    }
+
+                    segment.text += pattern[i];
+                    segment.isAny.push_back(0);
+                    m_isAnchoredEnd = true;
+                }
+                else if (c == '%')
+                {
+                    if (!segment.text.empty())
+                    {
+                        m_segments.push_back(segment);
+                        segment = Segment();
+                    }
+
+                    m_isAnchoredEnd = false;
+                }
+                else
+                {
+                    segment.text += c;
+                    segment.isAny.push_back(c == '_');
+                    m_isAnchoredEnd = true;
+                }
+            }
+
+            // Segments without wildcards are compared directly
+            if (std::find(segment.isAny.begin(), segment.isAny.end(), 1) == segment.isAny.end())
+            {
+                segment.isAny.clear();
+            }
+
+            for (std::size_t i = 0; i < m_segments.size(); ++i)
+            {
+                std::vector<uint8_t>& isAny = m_segments[i].isAny;
+
+                if (std::find(isAny.begin(), isAny.end(), 1) == isAny.end())
+                {
+                    isAny.clear();
+                }
+            }
+        }
+
+        if (!segment.text.empty())
+        {
+            m_segments.push_back(segment);
+        }
+
+        // Without literal text, only an anchored (empty) pattern constrains
+        // the value
+        if (m_segments.empty() && !(m_isAnchoredStart && m_isAnchoredEnd))
+        {
+            m_isAnchoredStart = false;
+            m_isAnchoredEnd = false;
+        }
+
+        for (std::size_t i = 0; i < m_segments.size(); ++i)
+        {
+            Segment& current = m_segments[i];
+            m_minLength += current.text.size();
+
+            if (m_ignoreCase)
+            {
+                for (std::size_t j = 0; j < current.text.size(); ++j)
+                {
+                    current.text[j] = foldCase(current.text[j]);
+                }
+            }
+
+            // The needle is the longest run of literal text
+            std::size_t runStart = 0;
+
+            for (std::size_t j = 0; j <= current.text.size(); ++j)
+            {
+                if (j == current.text.size() || (!current.isAny.empty() && current.isAny[j]))
+                {
+                    if (j - runStart > m_needle.size())
+                    {
+                        m_needle = current.text.substr(runStart, j - runStart);
+                    }
+
+                    runStart = j + 1;
+                }
+            }
+        }
+    }
+
+    bool StringMatcher::matchesAt(const Segment& segment, const char* value) const
+    {
+        const std::string& text = segment.text;
+
+        if (!m_ignoreCase && segment.isAny.empty())
+        {
+            return std::memcmp(value, text.data(), text.size()) == 0;
+        }
+
+        for (std::size_t i = 0; i < text.size(); ++i)
+        {
+            if ((segment.isAny.empty() || !segment.isAny[i]) && (m_ignoreCase ? foldCase(value[i]) : value[i]) != text[i])
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool StringMatcher::matches(const char* value, const std::size_t length) const
+    {
+        if (length < m_minLength)
+        {
+            return false;
+        }
+
+        // A pattern without % matches the whole value
+        if (m_isAnchoredStart && m_isAnchoredEnd && m_segments.size() <= 1)
+        {
+            return length == m_minLength && (m_segments.empty() || matchesAt(m_segments[0], value));
+        }
+
+        std::size_t first = 0;
+        std::size_t last = m_segments.size();
+        std::size_t pos = 0;
+        std::size_t end = length;
+
+        if (m_isAnchoredStart)
+        {
+            if (!matchesAt(m_segments[0], value))
+            {
+                return false;
+            }
+
+            pos = m_segments[0].text.size();
+            ++first;
+        }
+
+        if (m_isAnchoredEnd)
+        {
+            end -= m_segments[last - 1].text.size();
+
+            if (!matchesAt(m_segments[last - 1], value + end))
+            {
+                return false;
+            }
+
+            --last;
+        }
+
+        // Segments between %s match at their leftmost positions
+        for (std::size_t i = first; i < last; ++i)
+        {
+            const Segment& segment = m_segments[i];
+
+            while (true)
+            {
+                if (end - pos < segment.text.size())
+                {
+                    return false;
+                }
+
+                if (matchesAt(segment, value + pos))
+                {
+                    break;
+                }
+
+                ++pos;
+            }
+
+            pos += segment.text.size();
+        }
+
+        return true;
+    }
+
+    void StringMatcher::find(const ProcData::Column& column, std::vector<std::size_t>& rows, const std::size_t threadCount) const
+    {
+        // Patterns anchored at the start are cheaper to check row by row
+        if (m_isAnchoredStart || m_needle.empty())
+        {
+            findRows<StringMatcher, NeedleScanner>(*this, NULL, column, rows, threadCount);
+        }
+        else
+        {
+            NeedleScanner scanner(m_needle, m_ignoreCase);
+            findRows(*this, &scanner, column, rows, threadCount);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // MultiStringMatcher
+    //--------------------------------------------------------------------------
+
+    MultiStringMatcher::MultiStringMatcher(const std::vector<std::string>& patterns, const bool ignoreCase) :
+        m_classCount(1),
+        m_matchState(0),
+        m_matchesAll(false)
+    {
+        std::fill(m_classes, m_classes + 256, 0);
+
+        for (std::size_t i = 0; i < patterns.size(); ++i)
+        {
+            checkPattern(patterns[i]);
+            m_matchesAll = m_matchesAll || patterns[i].empty();
+
+            for (std::size_t j = 0; j < patterns[i].size(); ++j)
+            {
+                uint8_t c = (uint8_t)(ignoreCase ? foldCase(patterns[i][j]) : patterns[i][j]);
+
+                if (m_classes[c] == 0)
+                {
+                    m_classes[c] = m_classCount++;
+                }
+            }
+        }
+
+        if (ignoreCase)
+        {
+            for (unsigned c = 'A'; c <= 'Z'; ++c)
+            {
+                m_classes[c] = m_classes[c + ('a' - 'A')];
+            }
+        }
+
+        // Build the trie of the patterns, with -1 for missing children
+        std::vector<int64_t> next(m_classCount, -1);
+        std::vector<uint8_t> isMatch(1, 0);
+
+        for (std::size_t i = 0; i < patterns.size(); ++i)
+        {
+            std::size_t state = 0;
+
+            for (std::size_t j = 0; j < patterns[i].size(); ++j)
+            {
+                std::size_t c = m_classes[(uint8_t)patterns[i][j]];
+
+                if (next[state * m_classCount + c] < 0)
+                {
+                    next[state * m_classCount + c] = (int64_t)isMatch.size();
+                    next.resize(next.size() + m_classCount, -1);
+                    isMatch.push_back(0);
+                }
+
+                state = (std::size_t)next[state * m_classCount + c];
+            }
+
+            isMatch[state] = 1;
+        }
+
+        // Fill in the transitions breadth first, following failure links for
+        // missing children; a state matches if its longest proper suffix does
+        std::size_t stateCount = isMatch.size();
+        std::vector<std::size_t> failures(stateCount, 0);
+        std::vector<std::size_t> queue;
+
+        for (std::size_t c = 0; c < m_classCount; ++c)
+        {
+            if (next[c] < 0)
+            {
+                next[c] = 0;
+            }
+            else
+            {
+                queue.push_back((std::size_t)next[c]);
+            }
+        }
+
+        for (std::size_t i = 0; i < queue.size(); ++i)
+        {
+            std::size_t state = queue[i];
+            isMatch[state] |= isMatch[failures[state]];
+
+            for (std::size_t c = 0; c < m_classCount; ++c)
+            {
+                int64_t& child = next[state * m_classCount + c];
+                int64_t fallback = next[failures[state] * m_classCount + c];
+
+                if (child < 0)
+                {
+                    child = fallback;
+                }
+                else
+                {
+                    failures[(std::size_t)child] = (std::size_t)fallback;
+                    queue.push_back((std::size_t)child);
+                }
+            }
+        }
+
+        // Number the states that do not match first, as table offsets
+        std::vector<uint32_t> numbers(stateCount);
+        uint32_t count = 0;
+
+        for (std::size_t pass = 0; pass < 2; ++pass)
+        {
+            for (std::size_t state = 0; state < stateCount; ++state)
+            {
+                if (isMatch[state] == pass)
+                {
+                    numbers[state] = count++ * m_classCount;
+                }
+            }
+
+            if (pass == 0)
+            {
+                m_matchState = count * m_classCount;
+            }
+        }
+
+        m_transitions.resize(m_matchState);
+
+        for (std::size_t state = 0; state < stateCount; ++state)
+        {
+            if (!isMatch[state])
+            {
+                for (std::size_t c = 0; c < m_classCount; ++c)
+                {
+                    m_transitions[numbers[state] + c] = numbers[(std::size_t)next[state * m_classCount + c]];
+                }
+            }
+        }
+    }
+
+    bool MultiStringMatcher::matches(const char* value, const std::size_t length) const
+    {
+        if (m_matchesAll)
+        {
+            return true;
+        }
+
+        AutomatonScanner scanner(m_classes, &m_transitions[0], m_matchState);
+        return scanner.find(value, 0, length) < length;
+    }
+
+    void MultiStringMatcher::find(const ProcData::Column& column, std::vector<std::size_t>& rows, const std::size_t threadCount) const
+    {
+        if (m_matchesAll)
+        {
+            findRows<MultiStringMatcher, AutomatonScanner>(*this, NULL, column, rows, threadCount);
+        }
+        else
+        {
+            AutomatonScanner scanner(m_classes, &m_transitions[0], m_matchState);
+            findRows(*this, &scanner, column, rows, threadCount);
+        }
+    }
+}
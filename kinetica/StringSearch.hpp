@@ -0,0 +1,98 @@
+#ifndef _KINETICA_STRING_SEARCH_HPP_
+#define _KINETICA_STRING_SEARCH_HPP_
+
+#include "Proc.hpp"
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace kinetica
+{
+    // Matches STRING values against a substring, prefix, suffix, whole value
+    // or SQL LIKE pattern. Searching a column scans its packed var data once
+    // for the longest literal part of the pattern (16 bytes at a time with
+    // SSE2), maps each hit back to its row through the offsets and checks
+    // only that row in full; patterns anchored at the start are checked row
+    // by row. Case-insensitive matching folds ASCII letters only.
+    class StringMatcher
+    {
+    public:
+        enum Kind
+        {
+            CONTAINS,
+            PREFIX,
+            SUFFIX,
+            EQUALS,
+
+            // % matches any run of bytes and _ any single byte; escape
+            // makes the next character literal
+            LIKE
+        };
+
+        // Throws std::invalid_argument if the pattern contains a NUL or ends
+        // with an unescaped escape character
+        StringMatcher(const std::string& pattern, const Kind kind = CONTAINS, const bool ignoreCase = false,
+                      const char escape = '\\');
+
+        bool matches(const char* value, const std::size_t length) const;
+
+        // Appends the rows, in order, of a STRING column whose values match;
+        // null rows never match. Parts of the column are searched in
+        // parallel. Throws std::invalid_argument if the column is not STRING.
+        void find(const ProcData::Column& column, std::vector<std::size_t>& rows, const std::size_t threadCount = 0) const;
+
+    private:
+        // Literal text between %s, with _ positions flagged in isAny; text is
+        // lowercase when ignoring case
+        struct Segment
+        {
+            std::string text;
+            std::vector<uint8_t> isAny;
+        };
+
+        std::vector<Segment> m_segments;
+        bool m_isAnchoredStart;
+        bool m_isAnchoredEnd;
+        bool m_ignoreCase;
+        std::size_t m_minLength;
+
+        // Longest run of literal text, which every matching value contains
+        std::string m_needle;
+
+        bool matchesAt(const Segment& segment, const char* value) const;
+    };
+
+    // Matches STRING values containing any of a set of substrings, searching
+    // a column's packed var data once with an Aho-Corasick automaton over the
+    // byte classes of the patterns. Case-insensitive matching folds ASCII
+    // letters only.
+    class MultiStringMatcher
+    {
+    public:
+        // Throws std::invalid_argument if a pattern contains a NUL
+        MultiStringMatcher(const std::vector<std::string>& patterns, const bool ignoreCase = false);
+
+        bool matches(const char* value, const std::size_t length) const;
+
+        // As StringMatcher::find
+        void find(const ProcData::Column& column, std::vector<std::size_t>& rows, const std::size_t threadCount = 0) const;
+
+    private:
+        // Class of each byte; bytes in no pattern share class 0
+        uint32_t m_classes[256];
+        uint32_t m_classCount;
+
+        // Next state of each state and class. States are numbered by their
+        // offset into the table, and states at or past m_matchState complete
+        // a pattern (and have no transitions).
+        std::vector<uint32_t> m_transitions;
+        uint32_t m_matchState;
+
+        // An empty pattern matches every value
+        bool m_matchesAll;
+    };
+}
+
+#endif
@@ -0,0 +1,247 @@
+#include "StringTransform.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+    typedef kinetica::ProcData::Column Column;
+    typedef kinetica::ProcData::OutputColumn OutputColumn;
+
+    void checkString(const Column& column)
+    {
+        if (column.getType() != Column::STRING)
+        {
+            throw std::invalid_argument("Column " + column.getName() + " must be STRING");
+        }
+    }
+
+    // Length of a value, excluding its NUL
+    inline std::size_t getLength(const Column& column, const std::size_t row)
+    {
+        std::size_t size = column.getVarValueSize<char>(row);
+        return size > 0 ? size - 1 : 0;
+    }
+
+    // Appends a null, or an empty string if the result is not nullable
+    inline void appendNull(OutputColumn& result)
+    {
+        if (result.isNullable())
+        {
+            result.appendNull();
+            return;
+        }
+
+        *result.reserveVarValue<char>(1) = '\0';
+        result.commitVarValue<char>(1);
+    }
+
+    //--------------------------------------------------------------------------
+    // Transforms
+    //--------------------------------------------------------------------------
+
+    // Each writes the transformed value, which is no longer than the input,
+    // and returns its length
+
+    class CaseTransform
+    {
+    public:
+        CaseTransform(const bool upper) :
+            m_first(upper ? 'a' : 'A')
+        {
+        }
+
+        std::size_t operator ()(const char* value, const std::size_t length, char* result) const
+        {
+            // Flips the case bit of letters of the other case, branch-free so
+            // the loop vectorizes
+            for (std::size_t i = 0; i < length; ++i)
+            {
+                result[i] = (char)(value[i] ^ ((uint8_t)(value[i] - m_first) < 26 ? 0x20 : 0));
+            }
+
+            return length;
+        }
+
+    private:
+        char m_first;
+    };
+
+    class TrimTransform
+    {
+    public:
+        TrimTransform(const kinetica::TrimSide side) :
+            m_side(side)
+        {
+        }
+
+        std::size_t operator ()(const char* value, const std::size_t length, char* result) const
+        {
+            std::size_t start = 0;
+            std::size_t end = length;
+
+            while ((m_side & kinetica::TRIM_LEADING) && start < end && std::isspace((unsigned char)value[start]))
+            {
+                ++start;
+            }
+
+            while ((m_side & kinetica::TRIM_TRAILING) && end > start && std::isspace((unsigned char)value[end - 1]))
+            {
+                --end;
+            }
+
+            std::memcpy(result, value + start, end - start);
+            return end - start;
+        }
+
+    private:
+        kinetica::TrimSide m_side;
+    };
+
+    class SubstringTransform
+    {
+    public:
+        SubstringTransform(const int64_t start, const int64_t length) :
+            m_start(start > std::numeric_limits<int64_t>::min() ? start - 1 : start),
+            m_length(length)
+        {
+        }
+
+        std::size_t operator ()(const char* value, const std::size_t length, char* result) const
+        {
+            int64_t size = (int64_t)length;
+            int64_t start = m_start;
+            int64_t end = size;
+
+            if (m_length >= 0)
+            {
+                end = start > size - m_length ? size : std::max(start + m_length, (int64_t)0);
+            }
+
+            start = std::min(std::max(start, (int64_t)0), size);
+            end = std::max(end, start);
+            std::memcpy(result, value + start, (std::size_t)(end - start));
+            return (std::size_t)(end - start);
+        }
+
+    private:
+        int64_t m_start;
+        int64_t m_length;
+    };
+
+    template<typename Transform>
+    std::size_t transformStrings(const Column& column, OutputColumn& result, const Transform& transform)
+    {
+        checkString(column);
+        checkString(result);
+        const uint8_t* nulls = column.isNullable() ? column.getNulls() : NULL;
+        std::size_t index = result.getPos();
+
+        for (std::size_t row = 0; row < column.getSize(); ++row)
+        {
+            if (nulls != NULL && nulls[row])
+            {
+                appendNull(result);
+                continue;
+            }
+
+            std::size_t length = getLength(column, row);
+            char* value = result.reserveVarValue<char>(length + 1);
+            length = transform(column.getVarValue<char>(row), length, value);
+            value[length] = '\0';
+            result.commitVarValue<char>(length + 1);
+        }
+
+        return index;
+    }
+}
+
+namespace kinetica
+{
+    std::size_t toLowerCase(const ProcData::Column& column, ProcData::OutputColumn& result)
+    {
+        return transformStrings(column, result, CaseTransform(false));
+    }
+
+    std::size_t toUpperCase(const ProcData::Column& column, ProcData::OutputColumn& result)
+    {
+        return transformStrings(column, result, CaseTransform(true));
+    }
+
+    std::size_t trimStrings(const ProcData::Column& column, ProcData::OutputColumn& result, const TrimSide side)
+    {
+        return transformStrings(column, result, TrimTransform(side));
+    }
+
+    std::size_t substrings(const ProcData::Column& column, ProcData::OutputColumn& result, const int64_t start,
+                           const int64_t length)
+    {
+        return transformStrings(column, result, SubstringTransform(start, length));
+    }
+
+    std::size_t concatStrings(const std::vector<const ProcData::Column*>& columns, ProcData::OutputColumn& result,
+                              const std::string& separator)
+    {
+        if (columns.empty())
+        {
+            throw std::invalid_argument("No columns to concatenate");
+        }
+
+        checkString(result);
+
+        for (std::size_t i = 0; i < columns.size(); ++i)
+        {
+            checkString(*columns[i]);
+
+            if (columns[i]->getSize() != columns[0]->getSize())
+            {
+                throw std::invalid_argument("Column " + columns[i]->getName() + " does not match the size of column "
+                                            + columns[0]->getName());
+            }
+        }
+
+        std::size_t index = result.getPos();
+
+        for (std::size_t row = 0; row < columns[0]->getSize(); ++row)
+        {
+            bool isNull = false;
+            std::size_t capacity = separator.size() * (columns.size() - 1) + 1;
+
+            for (std::size_t i = 0; i < columns.size() && !isNull; ++i)
+            {
+                isNull = columns[i]->isNullable() && columns[i]->getNulls()[row];
+                capacity += getLength(*columns[i], row);
+            }
+
+            if (isNull)
+            {
+                appendNull(result);
+                continue;
+            }
+
+            char* value = result.reserveVarValue<char>(capacity);
+            char* pos = value;
+
+            for (std::size_t i = 0; i < columns.size(); ++i)
+            {
+                if (i > 0)
+                {
+                    std::memcpy(pos, separator.data(), separator.size());
+                    pos += separator.size();
+                }
+
+                std::size_t length = getLength(*columns[i], row);
+                std::memcpy(pos, columns[i]->getVarValue<char>(row), length);
+                pos += length;
+            }
+
+            *pos = '\0';
+            result.commitVarValue<char>(capacity);
+        }
+
+        return index;
+    }
+}
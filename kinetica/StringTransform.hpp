@@ -0,0 +1,50 @@
+#ifndef _KINETICA_STRING_TRANSFORM_HPP_
+#define _KINETICA_STRING_TRANSFORM_HPP_
+
+#include "Proc.hpp"
+
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace kinetica
+{
+    // Bulk transforms of STRING columns, written straight from the var data
+    // of the input into the var data of a STRING result column (see
+    // OutputColumn::reserveVarValue) with no std::string per row. Each
+    // appends a row for every input row, as Expression evaluates the
+    // functions of the same names: case mapping is of ASCII letters, and
+    // positions and lengths count bytes. Null rows are empty, and null if
+    // result is nullable. The table of result must already be sized for the
+    // rows. Throw std::invalid_argument if a column is not STRING. Return
+    // the index of the first appended row.
+
+    std::size_t toLowerCase(const ProcData::Column& column, ProcData::OutputColumn& result);
+    std::size_t toUpperCase(const ProcData::Column& column, ProcData::OutputColumn& result);
+
+    enum TrimSide
+    {
+        TRIM_LEADING = 1,
+        TRIM_TRAILING = 2,
+        TRIM_BOTH = 3
+    };
+
+    // Removes whitespace (as isspace in the C locale) from either or both
+    // ends of each value
+    std::size_t trimStrings(const ProcData::Column& column, ProcData::OutputColumn& result, const TrimSide side = TRIM_BOTH);
+
+    // Part of each value from start (counting from 1) for length bytes, or
+    // to the end if length is negative; positions before the first byte
+    // count against the length, as in SQL
+    std::size_t substrings(const ProcData::Column& column, ProcData::OutputColumn& result, const int64_t start,
+                           const int64_t length = -1);
+
+    // Values of each row of the columns joined by separator; null if any of
+    // them is null. Throws std::invalid_argument if there are no columns or
+    // they differ in size.
+    std::size_t concatStrings(const std::vector<const ProcData::Column*>& columns, ProcData::OutputColumn& result,
+                              const std::string& separator = "");
+}
+
+#endif
@@ -0,0 +1,1224 @@
+#include "Temporal.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    const int64_t MS_PER_DAY = 86400000;
+
+    // Day numbers count days since 0000-03-01, which keeps them positive for
+    // all supported years and avoids signed divisions
+    const int64_t EPOCH_DAY_NUMBER = 719468;
+
+    inline int32_t getDayNumber(const int32_t year, const int32_t month, const int32_t day)
+    {
+        int32_t march = month > 2;
+        int32_t y = year - 1 + march;
+        int32_t m = month + 9 - (march ? 12 : 0);
+        return y * 365 + y / 4 - y / 100 + y / 400 + (153 * m + 2) / 5 + day - 1;
+    }
+
+    inline int32_t getMillisecondOfDay(const int32_t hour, const int32_t minute, const int32_t second, const int32_t millisecond)
+    {
+        return ((hour * 60 + minute) * 60 + second) * 1000 + millisecond;
+    }
+
+    inline void decodeDate(const int32_t raw, int32_t& year, int32_t& month, int32_t& day)
+    {
+        year = 1900 + (raw >> 21);
+        month = (raw >> 17) & 0xf;
+        day = (raw >> 12) & 0x1f;
+    }
+
+    inline void decodeDateTime(const int64_t raw, int32_t* fields)
+    {
+        fields[0] = 1900 + (int32_t)(raw >> 53);
+        fields[1] = (int32_t)(raw >> 49) & 0xf;
+        fields[2] = (int32_t)(raw >> 44) & 0x1f;
+        fields[3] = (int32_t)(raw >> 39) & 0x1f;
+        fields[4] = (int32_t)(raw >> 33) & 0x3f;
+        fields[5] = (int32_t)(raw >> 27) & 0x3f;
+        fields[6] = (int32_t)(raw >> 17) & 0x3ff;
+    }
+
+    inline void decodeTime(const uint32_t raw, int32_t* fields)
+    {
+        fields[0] = raw >> 26;
+        fields[1] = (raw >> 20) & 0x3f;
+        fields[2] = (raw >> 14) & 0x3f;
+        fields[3] = (raw >> 4) & 0x3ff;
+    }
+
+    inline int32_t encodeDate(const int32_t year, const int32_t month, const int32_t day)
+    {
+        return (int32_t)(((uint32_t)(year - 1900) << 21) | ((uint32_t)month << 17) | ((uint32_t)day << 12));
+    }
+
+    inline int64_t encodeDateTime(const int32_t year, const int32_t month, const int32_t day,
+                                  const int32_t hour, const int32_t minute, const int32_t second, const int32_t millisecond)
+    {
+        return (int64_t)(((uint64_t)(int64_t)(year - 1900) << 53)
+                         | ((uint64_t)month << 49)
+                         | ((uint64_t)day << 44)
+                         | ((uint64_t)hour << 39)
+                         | ((uint64_t)minute << 33)
+                         | ((uint64_t)second << 27)
+                         | ((uint64_t)millisecond << 17));
+    }
+
+    inline uint32_t encodeTime(const int32_t hour, const int32_t minute, const int32_t second, const int32_t millisecond)
+    {
+        return ((uint32_t)hour << 26) | ((uint32_t)minute << 20) | ((uint32_t)second << 14) | ((uint32_t)millisecond << 4);
+    }
+
+    inline int64_t fromEpochDay(const int64_t epochDay)
+    {
+        unsigned year, month, day;
+        kinetica::getCivilDate(epochDay, year, month, day);
+        return encodeDateTime(year, month, day, 0, 0, 0, 0);
+    }
+
+    inline int64_t fromEpochMillisecond(const int64_t value)
+    {
+        int64_t epochDay = kinetica::floorDivide(value, MS_PER_DAY);
+        int32_t ms = (int32_t)(value - epochDay * MS_PER_DAY);
+        unsigned year, month, day;
+        kinetica::getCivilDate(epochDay, year, month, day);
+        return encodeDateTime(year, month, day, ms / 3600000, ms / 60000 % 60, ms / 1000 % 60, ms % 1000);
+    }
+
+    #ifdef __SSE2__
+    inline __m128i multiplyBy60(const __m128i value)
+    {
+        return _mm_sub_epi32(_mm_slli_epi32(value, 6), _mm_slli_epi32(value, 2));
+    }
+
+    inline __m128i multiplyBy1000(const __m128i value)
+    {
+        return _mm_sub_epi32(_mm_slli_epi32(value, 10), _mm_add_epi32(_mm_slli_epi32(value, 4), _mm_slli_epi32(value, 3)));
+    }
+
+    // Multiplies non-negative 16-bit lanes (stored in 32-bit lanes) by a
+    // 16-bit constant, yielding 32-bit products
+    inline __m128i multiplyShort(const __m128i value, const int factor)
+    {
+        return _mm_madd_epi16(value, _mm_set1_epi32(factor));
+    }
+
+    // Vector form of getDayNumber; the constant divisions are exact
+    // multiply-shift sequences for the year range of Date and DateTime
+    inline __m128i getDayNumbers(const __m128i years, const __m128i months, const __m128i days)
+    {
+        __m128i march = _mm_cmpgt_epi32(months, _mm_set1_epi32(2));
+        __m128i y = _mm_add_epi32(years, _mm_sub_epi32(_mm_and_si128(march, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+        __m128i m = _mm_sub_epi32(_mm_add_epi32(months, _mm_set1_epi32(9)), _mm_and_si128(march, _mm_set1_epi32(12)));
+        __m128i centuries = _mm_srli_epi32(multiplyShort(y, 5243), 19);
+        __m128i result = _mm_add_epi32(multiplyShort(y, 365), _mm_srli_epi32(y, 2));
+        result = _mm_add_epi32(_mm_sub_epi32(result, centuries), _mm_srli_epi32(centuries, 2));
+        __m128i monthDays = _mm_srli_epi32(multiplyShort(_mm_add_epi32(multiplyShort(m, 153), _mm_set1_epi32(2)), 13108), 16);
+        return _mm_add_epi32(result, _mm_add_epi32(monthDays, _mm_sub_epi32(days, _mm_set1_epi32(1))));
+    }
+
+    // Low 32 bits of the four 64-bit lanes of a and b
+    inline __m128i packLow32(const __m128i a, const __m128i b)
+    {
+        return _mm_unpacklo_epi64(_mm_shuffle_epi32(a, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_epi32(b, _MM_SHUFFLE(2, 0, 2, 0)));
+    }
+
+    inline void storeInt64(int64_t* result, const __m128i value)
+    {
+        __m128i sign = _mm_srai_epi32(value, 31);
+        _mm_storeu_si128((__m128i*)result, _mm_unpacklo_epi32(value, sign));
+        _mm_storeu_si128((__m128i*)(result + 2), _mm_unpackhi_epi32(value, sign));
+    }
+
+    // Stores dayNumber * MS_PER_DAY + millisecondOfDay relative to the epoch
+    inline void storeEpochMilliseconds(int64_t* result, const __m128i dayNumbers, const __m128i milliseconds)
+    {
+        const __m128i msPerDay = _mm_set1_epi32((int)MS_PER_DAY);
+        const __m128i epoch = _mm_set1_epi64x(EPOCH_DAY_NUMBER * MS_PER_DAY);
+        __m128i even = _mm_mul_epu32(dayNumbers, msPerDay);
+        __m128i odd = _mm_mul_epu32(_mm_srli_epi64(dayNumbers, 32), msPerDay);
+        __m128i zero = _mm_setzero_si128();
+        __m128i low = _mm_add_epi64(_mm_unpacklo_epi64(even, odd), _mm_unpacklo_epi32(milliseconds, zero));
+        __m128i high = _mm_add_epi64(_mm_unpackhi_epi64(even, odd), _mm_unpackhi_epi32(milliseconds, zero));
+        _mm_storeu_si128((__m128i*)result, _mm_sub_epi64(low, epoch));
+        _mm_storeu_si128((__m128i*)(result + 2), _mm_sub_epi64(high, epoch));
+    }
+
+    inline void storeIfSet(int32_t* result, const std::size_t index, const __m128i value)
+    {
+        if (result)
+        {
+            _mm_storeu_si128((__m128i*)(result + index), value);
+        }
+    }
+
+    struct DateLanes
+    {
+        __m128i years;
+        __m128i months;
+        __m128i days;
+
+        void load(const kinetica::Date* values)
+        {
+            __m128i raw = _mm_loadu_si128((const __m128i*)values);
+            years = _mm_add_epi32(_mm_srai_epi32(raw, 21), _mm_set1_epi32(1900));
+            months = _mm_and_si128(_mm_srli_epi32(raw, 17), _mm_set1_epi32(0xf));
+            days = _mm_and_si128(_mm_srli_epi32(raw, 12), _mm_set1_epi32(0x1f));
+        }
+    };
+
+    struct TimeLanes
+    {
+        __m128i hours;
+        __m128i minutes;
+        __m128i seconds;
+        __m128i milliseconds;
+
+        void load(const kinetica::Time* values)
+        {
+            __m128i raw = _mm_loadu_si128((const __m128i*)values);
+            hours = _mm_srli_epi32(raw, 26);
+            minutes = _mm_and_si128(_mm_srli_epi32(raw, 20), _mm_set1_epi32(0x3f));
+            seconds = _mm_and_si128(_mm_srli_epi32(raw, 14), _mm_set1_epi32(0x3f));
+            milliseconds = _mm_and_si128(_mm_srli_epi32(raw, 4), _mm_set1_epi32(0x3ff));
+        }
+
+        __m128i getMillisecondsOfDay() const
+        {
+            __m128i totalSeconds = _mm_add_epi32(multiplyBy60(_mm_add_epi32(multiplyBy60(hours), minutes)), seconds);
+            return _mm_add_epi32(multiplyBy1000(totalSeconds), milliseconds);
+        }
+    };
+
+    struct DateTimeLanes : DateLanes, TimeLanes
+    {
+        void load(const kinetica::DateTime* values)
+        {
+            __m128i first = _mm_loadu_si128((const __m128i*)values);
+            __m128i second = _mm_loadu_si128((const __m128i*)(values + 2));
+            __m128i date = packLow32(_mm_srli_epi64(first, 44), _mm_srli_epi64(second, 44));
+            __m128i time = packLow32(_mm_srli_epi64(first, 17), _mm_srli_epi64(second, 17));
+
+            // The year is an 11-bit two's complement offset from 1900
+            __m128i year = _mm_and_si128(_mm_srli_epi32(date, 9), _mm_set1_epi32(0x7ff));
+            year = _mm_sub_epi32(_mm_xor_si128(year, _mm_set1_epi32(0x400)), _mm_set1_epi32(0x400));
+            years = _mm_add_epi32(year, _mm_set1_epi32(1900));
+            months = _mm_and_si128(_mm_srli_epi32(date, 5), _mm_set1_epi32(0xf));
+            days = _mm_and_si128(date, _mm_set1_epi32(0x1f));
+            hours = _mm_and_si128(_mm_srli_epi32(time, 22), _mm_set1_epi32(0x1f));
+            minutes = _mm_and_si128(_mm_srli_epi32(time, 16), _mm_set1_epi32(0x3f));
+            seconds = _mm_and_si128(_mm_srli_epi32(time, 10), _mm_set1_epi32(0x3f));
+            milliseconds = _mm_and_si128(time, _mm_set1_epi32(0x3ff));
+        }
+    };
+    #endif
+
+    //--------------------------------------------------------------------------
+    // Truncation and arithmetic helpers
+    //--------------------------------------------------------------------------
+
+    const std::size_t BLOCK_SIZE = 256;
+
+    // Monday 1970-01-05, the origin of week buckets
+    const int64_t WEEK_ORIGIN = 4 * MS_PER_DAY;
+
+    const int64_t DATE_TIME_DATE_BITS = ~(((int64_t)1 << 44) - 1);
+    const int64_t DATE_TIME_TIME_BITS = (((int64_t)1 << 44) - 1) & ~(int64_t)0x1ffff;
+
+    inline int64_t floorModulo(const int64_t value, const int64_t divisor)
+    {
+        return value - kinetica::floorDivide(value, divisor) * divisor;
+    }
+
+    inline int32_t getDaysInMonth(const int64_t year, const int32_t month)
+    {
+        static const int32_t days[16] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31, 31, 31, 31, 31 };
+        bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+        return days[(month - 1) & 15] + (month == 2 && leap);
+    }
+
+    inline void addMonths(int64_t& year, int32_t& month, int32_t& day, const int64_t months)
+    {
+        int64_t total = year * 12 + (month - 1) + months;
+        year = kinetica::floorDivide(total, 12);
+        month = (int32_t)(total - year * 12) + 1;
+        int32_t last = getDaysInMonth(year, month);
+
+        if (day > last)
+        {
+            day = last;
+        }
+    }
+
+    inline int32_t getFirstMonth(const int32_t month, const kinetica::TimeUnit::Type unit)
+    {
+        return unit == kinetica::TimeUnit::YEAR ? 1 : (unit == kinetica::TimeUnit::QUARTER ? (month - 1) / 3 * 3 + 1 : month);
+    }
+
+    inline int64_t getMonthCount(const int64_t months, const kinetica::TimeUnit::Type unit)
+    {
+        return unit == kinetica::TimeUnit::YEAR ? months / 12 : (unit == kinetica::TimeUnit::QUARTER ? months / 3 : months);
+    }
+
+    inline int64_t getMonthMultiplier(const kinetica::TimeUnit::Type unit)
+    {
+        return unit == kinetica::TimeUnit::YEAR ? 12 : (unit == kinetica::TimeUnit::QUARTER ? 3 : 1);
+    }
+
+    inline void checkUnit(const kinetica::TimeUnit::Type unit, const kinetica::TimeUnit::Type min, const kinetica::TimeUnit::Type max, const char* type)
+    {
+        if (unit < min || unit > max)
+        {
+            throw std::invalid_argument(std::string("Invalid time unit for ") + type);
+        }
+    }
+
+    template<typename T>
+    void maskValues(const T* values, const std::size_t count, const T keep, const T set, T* result)
+    {
+        std::size_t i = 0;
+
+        #ifdef __SSE2__
+        __m128i keepMask;
+        __m128i setMask;
+
+        if (sizeof(T) == 8)
+        {
+            keepMask = _mm_set1_epi64x((long long)keep);
+            setMask = _mm_set1_epi64x((long long)set);
+        }
+        else
+        {
+            keepMask = _mm_set1_epi32((int)keep);
+            setMask = _mm_set1_epi32((int)set);
+        }
+
+        for (const std::size_t step = 16 / sizeof(T); i + step <= count; i += step)
+        {
+            __m128i value = _mm_loadu_si128((const __m128i*)(values + i));
+            _mm_storeu_si128((__m128i*)(result + i), _mm_or_si128(_mm_and_si128(value, keepMask), setMask));
+        }
+        #endif
+
+        for (; i < count; ++i)
+        {
+            result[i] = (values[i] & keep) | set;
+        }
+    }
+
+    // In-place floor of each value to the start of its bucket; the quotient
+    // is estimated with a floating-point reciprocal and then corrected
+    void bucketMilliseconds(int64_t* values, const std::size_t count, const int64_t width, const int64_t origin)
+    {
+        double inverse = 1.0 / (double)width;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            int64_t offset = values[i] - origin;
+            int64_t remainder = offset - (int64_t)((double)offset * inverse) * width;
+
+            while (remainder < 0)
+            {
+                remainder += width;
+            }
+
+            while (remainder >= width)
+            {
+                remainder -= width;
+            }
+
+            values[i] -= remainder;
+        }
+    }
+
+    inline void loadMilliseconds(const kinetica::Date* values, const std::size_t count, int64_t* result)
+    {
+        kinetica::toEpochMilliseconds(values, count, result);
+    }
+
+    inline void loadMilliseconds(const kinetica::DateTime* values, const std::size_t count, int64_t* result)
+    {
+        kinetica::toEpochMilliseconds(values, count, result);
+    }
+
+    inline void loadMilliseconds(const kinetica::Time* values, const std::size_t count, int64_t* result)
+    {
+        kinetica::toMillisecondsOfDay(values, count, result);
+    }
+
+    inline void loadMilliseconds(const int64_t* values, const std::size_t count, int64_t* result)
+    {
+        std::memmove(result, values, count * sizeof(int64_t));
+    }
+
+    inline void storeMilliseconds(const int64_t* values, const std::size_t count, kinetica::Date* result)
+    {
+        kinetica::fromEpochMilliseconds(values, count, result);
+    }
+
+    inline void storeMilliseconds(const int64_t* values, const std::size_t count, kinetica::DateTime* result)
+    {
+        kinetica::fromEpochMilliseconds(values, count, result);
+    }
+
+    inline void storeMilliseconds(const int64_t* values, const std::size_t count, kinetica::Time* result)
+    {
+        kinetica::fromMillisecondsOfDay(values, count, result);
+    }
+
+    inline void storeMilliseconds(const int64_t* values, const std::size_t count, int64_t* result)
+    {
+        std::memmove(result, values, count * sizeof(int64_t));
+    }
+
+    struct BucketOperation
+    {
+        int64_t width;
+        int64_t origin;
+
+        void operator ()(int64_t* values, const std::size_t, const std::size_t count) const
+        {
+            bucketMilliseconds(values, count, width, origin);
+        }
+    };
+
+    struct AddOperation
+    {
+        const int64_t* amounts;
+        std::size_t stride;
+        int64_t scale;
+
+        void operator ()(int64_t* values, const std::size_t start, const std::size_t count) const
+        {
+            const int64_t* amount = amounts + start * stride;
+
+            for (std::size_t i = 0; i < count; ++i, amount += stride)
+            {
+                values[i] += *amount * scale;
+            }
+        }
+    };
+
+    // Applies operation to the values as milliseconds (epoch milliseconds, or
+    // milliseconds of day for Time) one cache-resident block at a time
+    template<typename T, typename Operation>
+    void transformMilliseconds(const T* values, const std::size_t count, const Operation& operation, T* result)
+    {
+        int64_t buffer[BLOCK_SIZE];
+
+        for (std::size_t i = 0; i < count; i += BLOCK_SIZE)
+        {
+            std::size_t n = count - i < BLOCK_SIZE ? count - i : BLOCK_SIZE;
+            loadMilliseconds(values + i, n, buffer);
+            operation(buffer, i, n);
+            storeMilliseconds(buffer, n, result + i);
+        }
+    }
+
+    template<typename T>
+    void addMillisecondIntervals(const T* values, const int64_t* amounts, const std::size_t stride, const std::size_t count,
+                                 const kinetica::TimeUnit::Type unit, T* result)
+    {
+        AddOperation operation;
+        operation.amounts = amounts;
+        operation.stride = stride;
+        operation.scale = kinetica::TimeUnit::getMilliseconds(unit);
+        transformMilliseconds(values, count, operation, result);
+    }
+
+    void addDateIntervals(const kinetica::Date* values, const int64_t* amounts, const std::size_t stride, const std::size_t count,
+                          const kinetica::TimeUnit::Type unit, kinetica::Date* result)
+    {
+        checkUnit(unit, kinetica::TimeUnit::DAY, kinetica::TimeUnit::YEAR, "DATE");
+
+        if (unit <= kinetica::TimeUnit::WEEK)
+        {
+            addMillisecondIntervals(values, amounts, stride, count, unit, result);
+            return;
+        }
+
+        int64_t multiplier = getMonthMultiplier(unit);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            int32_t year32, month, day;
+            decodeDate(values[i].raw, year32, month, day);
+            int64_t year = year32;
+            addMonths(year, month, day, amounts[i * stride] * multiplier);
+            result[i].raw = encodeDate((int32_t)year, month, day);
+        }
+    }
+
+    void addDateTimeIntervals(const kinetica::DateTime* values, const int64_t* amounts, const std::size_t stride, const std::size_t count,
+                              const kinetica::TimeUnit::Type unit, kinetica::DateTime* result)
+    {
+        if (unit <= kinetica::TimeUnit::WEEK)
+        {
+            addMillisecondIntervals(values, amounts, stride, count, unit, result);
+            return;
+        }
+
+        int64_t multiplier = getMonthMultiplier(unit);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            int64_t raw = values[i].raw;
+            int64_t year = 1900 + (int32_t)(raw >> 53);
+            int32_t month = (int32_t)(raw >> 49) & 0xf;
+            int32_t day = (int32_t)(raw >> 44) & 0x1f;
+            addMonths(year, month, day, amounts[i * stride] * multiplier);
+            result[i].raw = encodeDateTime((int32_t)year, month, day, 0, 0, 0, 0) | (raw & DATE_TIME_TIME_BITS);
+        }
+    }
+
+    void addTimeIntervals(const kinetica::Time* values, const int64_t* amounts, const std::size_t stride, const std::size_t count,
+                          const kinetica::TimeUnit::Type unit, kinetica::Time* result)
+    {
+        checkUnit(unit, kinetica::TimeUnit::MILLISECOND, kinetica::TimeUnit::WEEK, "TIME");
+        addMillisecondIntervals(values, amounts, stride, count, unit, result);
+    }
+
+    void addTimestampIntervals(const int64_t* values, const int64_t* amounts, const std::size_t stride, const std::size_t count,
+                               const kinetica::TimeUnit::Type unit, int64_t* result)
+    {
+        if (unit <= kinetica::TimeUnit::WEEK)
+        {
+            addMillisecondIntervals(values, amounts, stride, count, unit, result);
+            return;
+        }
+
+        int64_t multiplier = getMonthMultiplier(unit);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            int64_t epochDay = kinetica::floorDivide(values[i], MS_PER_DAY);
+            int64_t ms = values[i] - epochDay * MS_PER_DAY;
+            unsigned civilYear, civilMonth, civilDay;
+            kinetica::getCivilDate(epochDay, civilYear, civilMonth, civilDay);
+            int64_t year = civilYear;
+            int32_t month = civilMonth;
+            int32_t day = civilDay;
+            addMonths(year, month, day, amounts[i * stride] * multiplier);
+            result[i] = kinetica::getEpochDay((unsigned)year, month, day) * MS_PER_DAY + ms;
+        }
+    }
+
+    template<typename T>
+    void getDaysOfWeekFromMilliseconds(const T* values, const std::size_t count, int32_t* result)
+    {
+        int64_t buffer[BLOCK_SIZE];
+
+        for (std::size_t i = 0; i < count; i += BLOCK_SIZE)
+        {
+            std::size_t n = count - i < BLOCK_SIZE ? count - i : BLOCK_SIZE;
+            loadMilliseconds(values + i, n, buffer);
+
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                // 1970-01-01 was a Thursday
+                result[i + j] = (int32_t)floorModulo(kinetica::floorDivide(buffer[j], MS_PER_DAY) + 4, 7) + 1;
+            }
+        }
+    }
+
+    template<typename T>
+    void getMillisecondDifferences(const T* start, const T* end, const std::size_t count, const kinetica::TimeUnit::Type unit, int64_t* result)
+    {
+        int64_t unitLength = kinetica::TimeUnit::getMilliseconds(unit);
+        int64_t startBuffer[BLOCK_SIZE];
+        int64_t endBuffer[BLOCK_SIZE];
+
+        for (std::size_t i = 0; i < count; i += BLOCK_SIZE)
+        {
+            std::size_t n = count - i < BLOCK_SIZE ? count - i : BLOCK_SIZE;
+            loadMilliseconds(start + i, n, startBuffer);
+            loadMilliseconds(end + i, n, endBuffer);
+
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                result[i + j] = (endBuffer[j] - startBuffer[j]) / unitLength;
+            }
+        }
+    }
+
+    // Whole months between two dates whose remaining fields (day and time,
+    // packed so that they compare in order) are startRest and endRest
+    inline int64_t getMonthDifference(const int64_t startMonths, const int64_t startRest, const int64_t endMonths, const int64_t endRest)
+    {
+        int64_t months = endMonths - startMonths;
+
+        if (months > 0 && endRest < startRest)
+        {
+            --months;
+        }
+        else if (months < 0 && endRest > startRest)
+        {
+            ++months;
+        }
+
+        return months;
+    }
+}
+
+namespace kinetica
+{
+    //--------------------------------------------------------------------------
+    // Date
+    //--------------------------------------------------------------------------
+
+    void decodeDates(const Date* values, const std::size_t count, const DateFields& result)
+    {
+        std::size_t i = 0;
+
+        #ifdef __SSE2__
+        for (; i + 4 <= count; i += 4)
+        {
+            DateLanes lanes;
+            lanes.load(values + i);
+            storeIfSet(result.years, i, lanes.years);
+            storeIfSet(result.months, i, lanes.months);
+            storeIfSet(result.days, i, lanes.days);
+        }
+        #endif
+
+        for (; i < count; ++i)
+        {
+            int32_t year, month, day;
+            decodeDate(values[i].raw, year, month, day);
+
+            if (result.years) result.years[i] = year;
+            if (result.months) result.months[i] = month;
+            if (result.days) result.days[i] = day;
+        }
+    }
+
+    void encodeDates(const DateFields& fields, const std::size_t count, Date* result)
+    {
+        std::size_t i = 0;
+
+        #ifdef __SSE2__
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i years = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(fields.years + i)), _mm_set1_epi32(1900));
+            __m128i months = _mm_loadu_si128((const __m128i*)(fields.months + i));
+            __m128i days = _mm_loadu_si128((const __m128i*)(fields.days + i));
+            __m128i raw = _mm_or_si128(_mm_slli_epi32(years, 21), _mm_or_si128(_mm_slli_epi32(months, 17), _mm_slli_epi32(days, 12)));
+            _mm_storeu_si128((__m128i*)(result + i), raw);
+        }
+        #endif
+
+        for (; i < count; ++i)
+        {
+            result[i].raw = encodeDate(fields.years[i], fields.months[i], fields.days[i]);
+        }
+    }
+
+    void toEpochDays(const Date* values, const std::size_t count, int64_t* result)
+    {
+        std::size_t i = 0;
+
+        #ifdef __SSE2__
+        for (; i + 4 <= count; i += 4)
+        {
+            DateLanes lanes;
+            lanes.load(values + i);
+            __m128i dayNumbers = getDayNumbers(lanes.years, lanes.months, lanes.days);
+            storeInt64(result + i, _mm_sub_epi32(dayNumbers, _mm_set1_epi32((int)EPOCH_DAY_NUMBER)));
+        }
+        #endif
+
+        for (; i < count; ++i)
+        {
+            int32_t year, month, day;
+            decodeDate(values[i].raw, year, month, day);
+            result[i] = getDayNumber(year, month, day) - EPOCH_DAY_NUMBER;
+        }
+    }
+
+    void toEpochMilliseconds(const Date* values, const std::size_t count, int64_t* result)
+    {
+        std::size_t i = 0;
+
+        #ifdef __SSE2__
+        for (; i + 4 <= count; i += 4)
+        {
+            DateLanes lanes;
+            lanes.load(values + i);
+            storeEpochMilliseconds(result + i, getDayNumbers(lanes.years, lanes.months, lanes.days), _mm_setzero_si128());
+        }
+        #endif
+
+        for (; i < count; ++i)
+        {
+            int32_t year, month, day;
+            decodeDate(values[i].raw, year, month, day);
+            result[i] = (getDayNumber(year, month, day) - EPOCH_DAY_NUMBER) * MS_PER_DAY;
+        }
+    }
+
+    void fromEpochDays(const int64_t* values, const std::size_t count, Date* result)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            unsigned year, month, day;
+            getCivilDate(values[i], year, month, day);
+            result[i].raw = encodeDate(year, month, day);
+        }
+    }
+
+    void fromEpochMilliseconds(const int64_t* values, const std::size_t count, Date* result)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            unsigned year, month, day;
+            getCivilDate(floorDivide(values[i], MS_PER_DAY), year, month, day);
+            result[i].raw = encodeDate(year, month, day);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // DateTime
+    //--------------------------------------------------------------------------
+
+    void decodeDateTimes(const DateTime* values, const std::size_t count, const DateTimeFields& result)
+    {
+        std::size_t i = 0;
+
+        #ifdef __SSE2__
+        for (; i + 4 <= count; i += 4)
+        {
+            DateTimeLanes lanes;
+            lanes.load(values + i);
+            storeIfSet(result.years, i, lanes.years);
+            storeIfSet(result.months, i, lanes.months);
+            storeIfSet(result.days, i, lanes.days);
+            storeIfSet(result.hours, i, lanes.hours);
+            storeIfSet(result.minutes, i, lanes.minutes);
+            storeIfSet(result.seconds, i, lanes.seconds);
+            storeIfSet(result.milliseconds, i, lanes.milliseconds);
+        }
+        #endif
+
+        for (; i < count; ++i)
+        {
+            int32_t fields[7];
+            decodeDateTime(values[i].raw, fields);
+
+            if (result.years) result.years[i] = fields[0];
+            if (result.months) result.months[i] = fields[1];
+            if (result.days) result.days[i] = fields[2];
+            if (result.hours) result.hours[i] = fields[3];
+            if (result.minutes) result.minutes[i] = fields[4];
+            if (result.seconds) result.seconds[i] = fields[5];
+            if (result.milliseconds) result.milliseconds[i] = fields[6];
+        }
+    }
+
+    void encodeDateTimes(const DateTimeFields& fields, const std::size_t count, DateTime* result)
+    {
+        std::size_t i = 0;
+
+        #ifdef __SSE2__
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i years = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(fields.years + i)), _mm_set1_epi32(1900));
+            __m128i months = _mm_loadu_si128((const __m128i*)(fields.months + i));
+            __m128i days = _mm_loadu_si128((const __m128i*)(fields.days + i));
+            __m128i hours = _mm_loadu_si128((const __m128i*)(fields.hours + i));
+            __m128i minutes = _mm_loadu_si128((const __m128i*)(fields.minutes + i));
+            __m128i seconds = _mm_loadu_si128((const __m128i*)(fields.seconds + i));
+            __m128i milliseconds = _mm_loadu_si128((const __m128i*)(fields.milliseconds + i));
+
+            // Build the upper and lower 32 bits of each value separately; the
+            // seconds field straddles the two halves
+            __m128i high = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(years, 21), _mm_slli_epi32(months, 17)),
+                                        _mm_or_si128(_mm_slli_epi32(days, 12), _mm_slli_epi32(hours, 7)));
+            high = _mm_or_si128(high, _mm_or_si128(_mm_slli_epi32(minutes, 1), _mm_srli_epi32(seconds, 5)));
+            __m128i low = _mm_or_si128(_mm_slli_epi32(seconds, 27), _mm_slli_epi32(milliseconds, 17));
+            _mm_storeu_si128((__m128i*)(result + i), _mm_unpacklo_epi32(low, high));
+            _mm_storeu_si128((__m128i*)(result + i + 2), _mm_unpackhi_epi32(low, high));
+        }
+        #endif
+
+        for (; i < count; ++i)
+        {
+            result[i].raw = encodeDateTime(fields.years[i], fields.months[i], fields.days[i],
+                                           fields.hours[i], fields.minutes[i], fields.seconds[i], fields.milliseconds[i]);
+        }
+    }
+
+    void toEpochDays(const DateTime* values, const std::size_t count, int64_t* result)
+    {
+        std::size_t i = 0;
+
+        #ifdef __SSE2__
+        for (; i + 4 <= count; i += 4)
+        {
+            DateTimeLanes lanes;
+            lanes.load(values + i);
+            __m128i dayNumbers = getDayNumbers(lanes.years, lanes.months, lanes.days);
+            storeInt64(result + i, _mm_sub_epi32(dayNumbers, _mm_set1_epi32((int)EPOCH_DAY_NUMBER)));
+        }
+        #endif
+
+        for (; i < count; ++i)
+        {
+            int32_t fields[7];
+            decodeDateTime(values[i].raw, fields);
+            result[i] = getDayNumber(fields[0], fields[1], fields[2]) - EPOCH_DAY_NUMBER;
+        }
+    }
+
+    void toEpochMilliseconds(const DateTime* values, const std::size_t count, int64_t* result)
+    {
+        std::size_t i = 0;
+
+        #ifdef __SSE2__
+        for (; i + 4 <= count; i += 4)
+        {
+            DateTimeLanes lanes;
+            lanes.load(values + i);
+            storeEpochMilliseconds(result + i, getDayNumbers(lanes.years, lanes.months, lanes.days), lanes.getMillisecondsOfDay());
+        }
+        #endif
+
+        for (; i < count; ++i)
+        {
+            int32_t fields[7];
+            decodeDateTime(values[i].raw, fields);
+            result[i] = (getDayNumber(fields[0], fields[1], fields[2]) - EPOCH_DAY_NUMBER) * MS_PER_DAY
+                        + getMillisecondOfDay(fields[3], fields[4], fields[5], fields[6]);
+        }
+    }
+
+    void toMillisecondsOfDay(const DateTime* values, const std::size_t count, int64_t* result)
+    {
+        std::size_t i = 0;
+
+        #ifdef __SSE2__
+        for (; i + 4 <= count; i += 4)
+        {
+            DateTimeLanes lanes;
+            lanes.load(values + i);
+            storeInt64(result + i, lanes.getMillisecondsOfDay());
+        }
+        #endif
+
+        for (; i < count; ++i)
+        {
+            int32_t fields[7];
+            decodeDateTime(values[i].raw, fields);
+            result[i] = getMillisecondOfDay(fields[3], fields[4], fields[5], fields[6]);
+        }
+    }
+
+    void fromEpochDays(const int64_t* values, const std::size_t count, DateTime* result)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            result[i].raw = fromEpochDay(values[i]);
+        }
+    }
+
+    void fromEpochMilliseconds(const int64_t* values, const std::size_t count, DateTime* result)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            result[i].raw = fromEpochMillisecond(values[i]);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Time
+    //--------------------------------------------------------------------------
+
+    void decodeTimes(const Time* values, const std::size_t count, const TimeFields& result)
+    {
+        std::size_t i = 0;
+
+        #ifdef __SSE2__
+        for (; i + 4 <= count; i += 4)
+        {
+            TimeLanes lanes;
+            lanes.load(values + i);
+            storeIfSet(result.hours, i, lanes.hours);
+            storeIfSet(result.minutes, i, lanes.minutes);
+            storeIfSet(result.seconds, i, lanes.seconds);
+            storeIfSet(result.milliseconds, i, lanes.milliseconds);
+        }
+        #endif
+
+        for (; i < count; ++i)
+        {
+            int32_t fields[4];
+            decodeTime(values[i].raw, fields);
+
+            if (result.hours) result.hours[i] = fields[0];
+            if (result.minutes) result.minutes[i] = fields[1];
+            if (result.seconds) result.seconds[i] = fields[2];
+            if (result.milliseconds) result.milliseconds[i] = fields[3];
+        }
+    }
+
+    void encodeTimes(const TimeFields& fields, const std::size_t count, Time* result)
+    {
+        std::size_t i = 0;
+
+        #ifdef __SSE2__
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i hours = _mm_loadu_si128((const __m128i*)(fields.hours + i));
+            __m128i minutes = _mm_loadu_si128((const __m128i*)(fields.minutes + i));
+            __m128i seconds = _mm_loadu_si128((const __m128i*)(fields.seconds + i));
+            __m128i milliseconds = _mm_loadu_si128((const __m128i*)(fields.milliseconds + i));
+            __m128i raw = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(hours, 26), _mm_slli_epi32(minutes, 20)),
+                                       _mm_or_si128(_mm_slli_epi32(seconds, 14), _mm_slli_epi32(milliseconds, 4)));
+            _mm_storeu_si128((__m128i*)(result + i), raw);
+        }
+        #endif
+
+        for (; i < count; ++i)
+        {
+            result[i].raw = encodeTime(fields.hours[i], fields.minutes[i], fields.seconds[i], fields.milliseconds[i]);
+        }
+    }
+
+    void toMillisecondsOfDay(const Time* values, const std::size_t count, int64_t* result)
+    {
+        std::size_t i = 0;
+
+        #ifdef __SSE2__
+        for (; i + 4 <= count; i += 4)
+        {
+            TimeLanes lanes;
+            lanes.load(values + i);
+            storeInt64(result + i, lanes.getMillisecondsOfDay());
+        }
+        #endif
+
+        for (; i < count; ++i)
+        {
+            int32_t fields[4];
+            decodeTime(values[i].raw, fields);
+            result[i] = getMillisecondOfDay(fields[0], fields[1], fields[2], fields[3]);
+        }
+    }
+
+    void fromMillisecondsOfDay(const int64_t* values, const std::size_t count, Time* result)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            int64_t ms = values[i] - floorDivide(values[i], MS_PER_DAY) * MS_PER_DAY;
+            result[i].raw = encodeTime((int32_t)(ms / 3600000), (int32_t)(ms / 60000 % 60), (int32_t)(ms / 1000 % 60), (int32_t)(ms % 1000));
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // TimeUnit
+    //--------------------------------------------------------------------------
+
+    int64_t TimeUnit::getMilliseconds(const Type unit)
+    {
+        switch (unit)
+        {
+            case MILLISECOND: return 1;
+            case SECOND: return 1000;
+            case MINUTE: return 60000;
+            case HOUR: return 3600000;
+            case DAY: return MS_PER_DAY;
+            case WEEK: return 7 * MS_PER_DAY;
+            default: throw std::invalid_argument("Time unit has no fixed length");
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Truncation and bucketing
+    //--------------------------------------------------------------------------
+
+    void truncate(const Date* values, const std::size_t count, const TimeUnit::Type unit, Date* result)
+    {
+        checkUnit(unit, TimeUnit::DAY, TimeUnit::YEAR, "DATE");
+
+        switch (unit)
+        {
+            case TimeUnit::DAY:
+                maskValues<int32_t>(&values->raw, count, ~0xfff, 0, &result->raw);
+                break;
+
+            case TimeUnit::WEEK:
+            {
+                BucketOperation operation;
+                operation.width = 7 * MS_PER_DAY;
+                operation.origin = WEEK_ORIGIN;
+                transformMilliseconds(values, count, operation, result);
+                break;
+            }
+
+            case TimeUnit::MONTH:
+                maskValues<int32_t>(&values->raw, count, ~((1 << 17) - 1), 1 << 12, &result->raw);
+                break;
+
+            case TimeUnit::QUARTER:
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    int32_t month = getFirstMonth((values[i].raw >> 17) & 0xf, unit);
+                    result[i].raw = (values[i].raw & ~((1 << 21) - 1)) | (month << 17) | (1 << 12);
+                }
+
+                break;
+
+            case TimeUnit::YEAR:
+                maskValues<int32_t>(&values->raw, count, ~((1 << 21) - 1), (1 << 17) | (1 << 12), &result->raw);
+                break;
+
+            default:
+                throw std::invalid_argument("Invalid time unit");
+        }
+    }
+
+    void truncate(const DateTime* values, const std::size_t count, const TimeUnit::Type unit, DateTime* result)
+    {
+        static const int shifts[] = { 17, 27, 33, 39, 44 };
+
+        switch (unit)
+        {
+            case TimeUnit::MILLISECOND:
+            case TimeUnit::SECOND:
+            case TimeUnit::MINUTE:
+            case TimeUnit::HOUR:
+            case TimeUnit::DAY:
+                maskValues<int64_t>(&values->raw, count, ~(((int64_t)1 << shifts[unit]) - 1), 0, &result->raw);
+                break;
+
+            case TimeUnit::WEEK:
+            {
+                BucketOperation operation;
+                operation.width = 7 * MS_PER_DAY;
+                operation.origin = WEEK_ORIGIN;
+                transformMilliseconds(values, count, operation, result);
+                break;
+            }
+
+            case TimeUnit::MONTH:
+                maskValues<int64_t>(&values->raw, count, ~(((int64_t)1 << 49) - 1), (int64_t)1 << 44, &result->raw);
+                break;
+
+            case TimeUnit::QUARTER:
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    int64_t month = getFirstMonth((int32_t)(values[i].raw >> 49) & 0xf, unit);
+                    result[i].raw = (values[i].raw & ~(((int64_t)1 << 53) - 1)) | (month << 49) | ((int64_t)1 << 44);
+                }
+
+                break;
+
+            case TimeUnit::YEAR:
+                maskValues<int64_t>(&values->raw, count, ~(((int64_t)1 << 53) - 1), ((int64_t)1 << 49) | ((int64_t)1 << 44), &result->raw);
+                break;
+
+            default:
+                throw std::invalid_argument("Invalid time unit");
+        }
+    }
+
+    void truncate(const Time* values, const std::size_t count, const TimeUnit::Type unit, Time* result)
+    {
+        static const int shifts[] = { 4, 14, 20, 26 };
+        checkUnit(unit, TimeUnit::MILLISECOND, TimeUnit::DAY, "TIME");
+        uint32_t keep = unit == TimeUnit::DAY ? 0 : ~((1u << shifts[unit]) - 1);
+        maskValues<uint32_t>(&values->raw, count, keep, 0, &result->raw);
+    }
+
+    void truncate(const int64_t* values, const std::size_t count, const TimeUnit::Type unit, int64_t* result)
+    {
+        if (unit <= TimeUnit::WEEK)
+        {
+            bucket(values, count, TimeUnit::getMilliseconds(unit), unit == TimeUnit::WEEK ? WEEK_ORIGIN : 0, result);
+            return;
+        }
+
+        checkUnit(unit, TimeUnit::MILLISECOND, TimeUnit::YEAR, "TIMESTAMP");
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            unsigned year, month, day;
+            getCivilDate(floorDivide(values[i], MS_PER_DAY), year, month, day);
+            result[i] = getEpochDay(year, getFirstMonth(month, unit), 1) * MS_PER_DAY;
+        }
+    }
+
+    void bucket(const DateTime* values, const std::size_t count, const int64_t width, const int64_t origin, DateTime* result)
+    {
+        if (width <= 0)
+        {
+            throw std::invalid_argument("Bucket width must be positive");
+        }
+
+        if (MS_PER_DAY % width != 0 || floorModulo(origin, width) != 0)
+        {
+            BucketOperation operation;
+            operation.width = width;
+            operation.origin = origin;
+            transformMilliseconds(values, count, operation, result);
+            return;
+        }
+
+        // Buckets never cross midnight, so only the time fields change
+        int64_t buffer[BLOCK_SIZE];
+
+        for (std::size_t i = 0; i < count; i += BLOCK_SIZE)
+        {
+            std::size_t n = count - i < BLOCK_SIZE ? count - i : BLOCK_SIZE;
+            toMillisecondsOfDay(values + i, n, buffer);
+
+            for (std::size_t j = 0; j < n; ++j)
+            {
+                int32_t ms = (int32_t)(buffer[j] - buffer[j] % width);
+                result[i + j].raw = (values[i + j].raw & DATE_TIME_DATE_BITS)
+                                    | encodeDateTime(1900, 0, 0, ms / 3600000, ms / 60000 % 60, ms / 1000 % 60, ms % 1000);
+            }
+        }
+    }
+
+    void bucket(const int64_t* values, const std::size_t count, const int64_t width, const int64_t origin, int64_t* result)
+    {
+        if (width <= 0)
+        {
+            throw std::invalid_argument("Bucket width must be positive");
+        }
+
+        BucketOperation operation;
+        operation.width = width;
+        operation.origin = origin;
+        transformMilliseconds(values, count, operation, result);
+    }
+
+    //--------------------------------------------------------------------------
+    // Arithmetic
+    //--------------------------------------------------------------------------
+
+    void addInterval(const Date* values, const std::size_t count, const int64_t amount, const TimeUnit::Type unit, Date* result)
+    {
+        addDateIntervals(values, &amount, 0, count, unit, result);
+    }
+
+    void addInterval(const DateTime* values, const std::size_t count, const int64_t amount, const TimeUnit::Type unit, DateTime* result)
+    {
+        addDateTimeIntervals(values, &amount, 0, count, unit, result);
+    }
+
+    void addInterval(const Time* values, const std::size_t count, const int64_t amount, const TimeUnit::Type unit, Time* result)
+    {
+        addTimeIntervals(values, &amount, 0, count, unit, result);
+    }
+
+    void addInterval(const int64_t* values, const std::size_t count, const int64_t amount, const TimeUnit::Type unit, int64_t* result)
+    {
+        addTimestampIntervals(values, &amount, 0, count, unit, result);
+    }
+
+    void addIntervals(const Date* values, const int64_t* amounts, const std::size_t count, const TimeUnit::Type unit, Date* result)
+    {
+        addDateIntervals(values, amounts, 1, count, unit, result);
+    }
+
+    void addIntervals(const DateTime* values, const int64_t* amounts, const std::size_t count, const TimeUnit::Type unit, DateTime* result)
+    {
+        addDateTimeIntervals(values, amounts, 1, count, unit, result);
+    }
+
+    void addIntervals(const Time* values, const int64_t* amounts, const std::size_t count, const TimeUnit::Type unit, Time* result)
+    {
+        addTimeIntervals(values, amounts, 1, count, unit, result);
+    }
+
+    void addIntervals(const int64_t* values, const int64_t* amounts, const std::size_t count, const TimeUnit::Type unit, int64_t* result)
+    {
+        addTimestampIntervals(values, amounts, 1, count, unit, result);
+    }
+
+    void getDaysOfWeek(const Date* values, const std::size_t count, int32_t* result)
+    {
+        getDaysOfWeekFromMilliseconds(values, count, result);
+    }
+
+    void getDaysOfWeek(const DateTime* values, const std::size_t count, int32_t* result)
+    {
+        getDaysOfWeekFromMilliseconds(values, count, result);
+    }
+
+    void getDaysOfWeek(const int64_t* values, const std::size_t count, int32_t* result)
+    {
+        getDaysOfWeekFromMilliseconds(values, count, result);
+    }
+
+    void getDifferences(const Date* start, const Date* end, const std::size_t count, const TimeUnit::Type unit, int64_t* result)
+    {
+        checkUnit(unit, TimeUnit::DAY, TimeUnit::YEAR, "DATE");
+
+        if (unit <= TimeUnit::WEEK)
+        {
+            getMillisecondDifferences(start, end, count, unit, result);
+            return;
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            int32_t startMonths = (start[i].raw >> 21) * 12 + ((start[i].raw >> 17) & 0xf);
+            int32_t endMonths = (end[i].raw >> 21) * 12 + ((end[i].raw >> 17) & 0xf);
+            int64_t months = getMonthDifference(startMonths, start[i].raw & 0x1f000, endMonths, end[i].raw & 0x1f000);
+            result[i] = getMonthCount(months, unit);
+        }
+    }
+
+    void getDifferences(const DateTime* start, const DateTime* end, const std::size_t count, const TimeUnit::Type unit, int64_t* result)
+    {
+        if (unit <= TimeUnit::WEEK)
+        {
+            getMillisecondDifferences(start, end, count, unit, result);
+            return;
+        }
+
+        checkUnit(unit, TimeUnit::MILLISECOND, TimeUnit::YEAR, "DATETIME");
+        const int64_t rest = (((int64_t)1 << 49) - 1) & ~(int64_t)0x1ffff;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            int64_t startMonths = (start[i].raw >> 53) * 12 + ((start[i].raw >> 49) & 0xf);
+            int64_t endMonths = (end[i].raw >> 53) * 12 + ((end[i].raw >> 49) & 0xf);
+            int64_t months = getMonthDifference(startMonths, start[i].raw & rest, endMonths, end[i].raw & rest);
+            result[i] = getMonthCount(months, unit);
+        }
+    }
+
+    void getDifferences(const int64_t* start, const int64_t* end, const std::size_t count, const TimeUnit::Type unit, int64_t* result)
+    {
+        if (unit <= TimeUnit::WEEK)
+        {
+            getMillisecondDifferences(start, end, count, unit, result);
+            return;
+        }
+
+        checkUnit(unit, TimeUnit::MILLISECOND, TimeUnit::YEAR, "TIMESTAMP");
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            int64_t startDay = floorDivide(start[i], MS_PER_DAY);
+            int64_t endDay = floorDivide(end[i], MS_PER_DAY);
+            unsigned startYear, startMonth, startDayOfMonth, endYear, endMonth, endDayOfMonth;
+            getCivilDate(startDay, startYear, startMonth, startDayOfMonth);
+            getCivilDate(endDay, endYear, endMonth, endDayOfMonth);
+            int64_t months = getMonthDifference((int64_t)startYear * 12 + startMonth, startDayOfMonth * MS_PER_DAY + (start[i] - startDay * MS_PER_DAY),
+                                                (int64_t)endYear * 12 + endMonth, endDayOfMonth * MS_PER_DAY + (end[i] - endDay * MS_PER_DAY));
+            result[i] = getMonthCount(months, unit);
+        }
+    }
+}
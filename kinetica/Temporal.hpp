@@ -0,0 +1,148 @@
+#ifndef _KINETICA_TEMPORAL_HPP_
+#define _KINETICA_TEMPORAL_HPP_
+
+#include "Proc.hpp"
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace kinetica
+{
+    // Struct-of-arrays views of date/time components. When decoding, NULL
+    // arrays are skipped; when encoding, all arrays must be provided.
+
+    struct DateFields
+    {
+        int32_t* years;
+        int32_t* months;
+        int32_t* days;
+    };
+
+    struct TimeFields
+    {
+        int32_t* hours;
+        int32_t* minutes;
+        int32_t* seconds;
+        int32_t* milliseconds;
+    };
+
+    struct DateTimeFields
+    {
+        int32_t* years;
+        int32_t* months;
+        int32_t* days;
+        int32_t* hours;
+        int32_t* minutes;
+        int32_t* seconds;
+        int32_t* milliseconds;
+    };
+
+    // Days since 1970-01-01 of a proleptic Gregorian date
+    inline int64_t getEpochDay(const unsigned year, const unsigned month, const unsigned day)
+    {
+        int64_t y = (int64_t)year - (month <= 2);
+        int64_t era = (y >= 0 ? y : y - 399) / 400;
+        int64_t yearOfEra = y - era * 400;
+        int64_t dayOfYear = (153 * ((int64_t)month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + dayOfEra - 719468;
+    }
+
+    inline void getCivilDate(const int64_t epochDay, unsigned& year, unsigned& month, unsigned& day)
+    {
+        int64_t z = epochDay + 719468;
+        int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+        int64_t dayOfEra = z - era * 146097;
+        int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        int64_t monthOfYear = (5 * dayOfYear + 2) / 153;
+        day = (unsigned)(dayOfYear - (153 * monthOfYear + 2) / 5 + 1);
+        month = (unsigned)(monthOfYear < 10 ? monthOfYear + 3 : monthOfYear - 9);
+        year = (unsigned)(yearOfEra + era * 400 + (month <= 2));
+    }
+
+    inline int64_t floorDivide(const int64_t value, const int64_t divisor)
+    {
+        int64_t quotient = value / divisor;
+        return quotient - ((value % divisor != 0) & ((value < 0) != (divisor < 0)));
+    }
+
+    void decodeDates(const Date* values, const std::size_t count, const DateFields& result);
+    void encodeDates(const DateFields& fields, const std::size_t count, Date* result);
+    void decodeDateTimes(const DateTime* values, const std::size_t count, const DateTimeFields& result);
+    void encodeDateTimes(const DateTimeFields& fields, const std::size_t count, DateTime* result);
+    void decodeTimes(const Time* values, const std::size_t count, const TimeFields& result);
+    void encodeTimes(const TimeFields& fields, const std::size_t count, Time* result);
+
+    // Days or milliseconds since 1970-01-01 00:00:00.000 (the TIMESTAMP
+    // representation); times convert to milliseconds since midnight
+
+    void toEpochDays(const Date* values, const std::size_t count, int64_t* result);
+    void toEpochDays(const DateTime* values, const std::size_t count, int64_t* result);
+    void toEpochMilliseconds(const Date* values, const std::size_t count, int64_t* result);
+    void toEpochMilliseconds(const DateTime* values, const std::size_t count, int64_t* result);
+    void toMillisecondsOfDay(const DateTime* values, const std::size_t count, int64_t* result);
+    void toMillisecondsOfDay(const Time* values, const std::size_t count, int64_t* result);
+
+    void fromEpochDays(const int64_t* values, const std::size_t count, Date* result);
+    void fromEpochDays(const int64_t* values, const std::size_t count, DateTime* result);
+    void fromEpochMilliseconds(const int64_t* values, const std::size_t count, Date* result);
+    void fromEpochMilliseconds(const int64_t* values, const std::size_t count, DateTime* result);
+    void fromMillisecondsOfDay(const int64_t* values, const std::size_t count, Time* result);
+
+    // Truncation, bucketing and arithmetic. int64_t values are TIMESTAMPs
+    // (epoch milliseconds). Weeks start on Monday. Units that do not apply to
+    // a type (e.g. HOUR for Date, MONTH for Time) throw std::invalid_argument.
+
+    struct TimeUnit
+    {
+        enum Type
+        {
+            MILLISECOND,
+            SECOND,
+            MINUTE,
+            HOUR,
+            DAY,
+            WEEK,
+            MONTH,
+            QUARTER,
+            YEAR
+        };
+
+        // Length in milliseconds of units up to WEEK
+        static int64_t getMilliseconds(const Type unit);
+    };
+
+    void truncate(const Date* values, const std::size_t count, const TimeUnit::Type unit, Date* result);
+    void truncate(const DateTime* values, const std::size_t count, const TimeUnit::Type unit, DateTime* result);
+    void truncate(const Time* values, const std::size_t count, const TimeUnit::Type unit, Time* result);
+    void truncate(const int64_t* values, const std::size_t count, const TimeUnit::Type unit, int64_t* result);
+
+    // Start of the width-millisecond bucket containing each value, with
+    // buckets aligned to origin (epoch milliseconds)
+    void bucket(const DateTime* values, const std::size_t count, const int64_t width, const int64_t origin, DateTime* result);
+    void bucket(const int64_t* values, const std::size_t count, const int64_t width, const int64_t origin, int64_t* result);
+
+    // Adding months clamps the day to the end of the resulting month; adding
+    // to a Time wraps around midnight
+    void addInterval(const Date* values, const std::size_t count, const int64_t amount, const TimeUnit::Type unit, Date* result);
+    void addInterval(const DateTime* values, const std::size_t count, const int64_t amount, const TimeUnit::Type unit, DateTime* result);
+    void addInterval(const Time* values, const std::size_t count, const int64_t amount, const TimeUnit::Type unit, Time* result);
+    void addInterval(const int64_t* values, const std::size_t count, const int64_t amount, const TimeUnit::Type unit, int64_t* result);
+    void addIntervals(const Date* values, const int64_t* amounts, const std::size_t count, const TimeUnit::Type unit, Date* result);
+    void addIntervals(const DateTime* values, const int64_t* amounts, const std::size_t count, const TimeUnit::Type unit, DateTime* result);
+    void addIntervals(const Time* values, const int64_t* amounts, const std::size_t count, const TimeUnit::Type unit, Time* result);
+    void addIntervals(const int64_t* values, const int64_t* amounts, const std::size_t count, const TimeUnit::Type unit, int64_t* result);
+
+    // 1 (Sunday) to 7 (Saturday)
+    void getDaysOfWeek(const Date* values, const std::size_t count, int32_t* result);
+    void getDaysOfWeek(const DateTime* values, const std::size_t count, int32_t* result);
+    void getDaysOfWeek(const int64_t* values, const std::size_t count, int32_t* result);
+
+    // Number of whole units from start to end, truncated toward zero
+    void getDifferences(const Date* start, const Date* end, const std::size_t count, const TimeUnit::Type unit, int64_t* result);
+    void getDifferences(const DateTime* start, const DateTime* end, const std::size_t count, const TimeUnit::Type unit, int64_t* result);
+    void getDifferences(const int64_t* start, const int64_t* end, const std::size_t count, const TimeUnit::Type unit, int64_t* result);
+}
+
+#endif
@@ -0,0 +1,488 @@
+#include "TextParse.hpp"
+#include "Temporal.hpp"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <strings.h>
+
+namespace
+{
+    const double POWERS_OF_10[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    inline bool isEightDigits(const char* value, uint64_t& result)
+    {
+        #if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        uint64_t chunk;
+        std::memcpy(&chunk, value, 8);
+
+        if (((chunk & 0xF0F0F0F0F0F0F0F0ULL) | (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) != 0x3333333333333333ULL)
+        {
+            return false;
+        }
+
+        chunk -= 0x3030303030303030ULL;
+        chunk = (chunk * 10 + (chunk >> 8)) & 0x00FF00FF00FF00FFULL;
+        chunk = (chunk * 100 + (chunk >> 16)) & 0x0000FFFF0000FFFFULL;
+        result = (chunk * 10000 + (chunk >> 32)) & 0xFFFFFFFFULL;
+        return true;
+        #else
+        result = 0;
+
+        for (std::size_t i = 0; i < 8; ++i)
+        {
+            if (!kinetica::isDigit(value[i]))
+            {
+                return false;
+            }
+
+            result = result * 10 + (value[i] - '0');
+        }
+
+        return true;
+        #endif
+    }
+
+    // Parses up to 19 digits (which cannot overflow); returns the number of
+    // digits consumed
+    inline std::size_t parseDigits(const char* value, const std::size_t length, uint64_t& result)
+    {
+        std::size_t limit = length < 19 ? length : 19;
+        std::size_t i = 0;
+        uint64_t eight;
+        result = 0;
+
+        while (i + 8 <= limit && isEightDigits(value + i, eight))
+        {
+            result = result * 100000000 + eight;
+            i += 8;
+        }
+
+        for (; i < limit && kinetica::isDigit(value[i]); ++i)
+        {
+            result = result * 10 + (value[i] - '0');
+        }
+
+        return i;
+    }
+
+    // Unsigned digits with no sign
+    bool parseMagnitude(const char* value, const std::size_t length, uint64_t& result)
+    {
+        if (length == 0)
+        {
+            return false;
+        }
+
+        std::size_t i = parseDigits(value, length, result);
+
+        if (i == 0)
+        {
+            return false;
+        }
+
+        if (i < length)
+        {
+            // Only a 20th digit is possible without overflowing
+            if (i != 19 || length != 20 || !kinetica::isDigit(value[19]) || result > 1844674407370955161ULL
+                || (result == 1844674407370955161ULL && value[19] > '5'))
+            {
+                return false;
+            }
+
+            result = result * 10 + (value[19] - '0');
+        }
+
+        return true;
+    }
+
+    // strtod skips leading whitespace, which is not accepted
+    bool parseDoubleSlow(const char* value, const std::size_t length, double& result)
+    {
+        if (length == 0 || std::isspace((unsigned char)value[0]))
+        {
+            return false;
+        }
+
+        std::string buffer(value, length);
+        char* end;
+        errno = 0;
+        result = std::strtod(buffer.c_str(), &end);
+        return end == buffer.c_str() + length;
+    }
+
+    // Parses a run of 1 to maxDigits digits
+    inline bool parseField(const char* value, const std::size_t length, std::size_t& pos, const std::size_t maxDigits, unsigned& result)
+    {
+        std::size_t start = pos;
+        result = 0;
+
+        for (; pos < length && pos - start < maxDigits && kinetica::isDigit(value[pos]); ++pos)
+        {
+            result = result * 10 + (value[pos] - '0');
+        }
+
+        return pos > start;
+    }
+
+    inline bool isLeapYear(const unsigned year)
+    {
+        return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    }
+
+    inline unsigned getDaysInMonth(const unsigned year, const unsigned month)
+    {
+        static const unsigned days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+        return month == 2 && isLeapYear(year) ? 29 : days[month - 1];
+    }
+
+    bool parseDateFields(const char* value, const std::size_t length, std::size_t& pos, unsigned& year, unsigned& month, unsigned& day)
+    {
+        if (!parseField(value, length, pos, 4, year) || pos != 4
+            || pos >= length || value[pos++] != '-'
+            || !parseField(value, length, pos, 2, month)
+            || pos >= length || value[pos++] != '-'
+            || !parseField(value, length, pos, 2, day))
+        {
+            return false;
+        }
+
+        return year >= 1000 && year <= 2900 && month >= 1 && month <= 12 && day >= 1 && day <= getDaysInMonth(year, month);
+    }
+
+    bool parseTimeFields(const char* value, const std::size_t length, std::size_t& pos,
+                         unsigned& hour, unsigned& minute, unsigned& second, unsigned& millisecond)
+    {
+        if (!parseField(value, length, pos, 2, hour)
+            || pos >= length || value[pos++] != ':'
+            || !parseField(value, length, pos, 2, minute))
+        {
+            return false;
+        }
+
+        second = 0;
+        millisecond = 0;
+
+        if (pos < length && value[pos] == ':')
+        {
+            ++pos;
+
+            if (!parseField(value, length, pos, 2, second))
+            {
+                return false;
+            }
+
+            if (pos < length && value[pos] == '.')
+            {
+                std::size_t start = ++pos;
+
+                if (!parseField(value, length, pos, 3, millisecond))
+                {
+                    return false;
+                }
+
+                for (std::size_t i = pos - start; i < 3; ++i)
+                {
+                    millisecond *= 10;
+                }
+
+                // Precision beyond milliseconds is truncated
+                while (pos < length && kinetica::isDigit(value[pos]))
+                {
+                    ++pos;
+                }
+            }
+        }
+
+        return hour < 24 && minute < 60 && second < 60;
+    }
+
+    bool parseDateTimeFields(const char* value, const std::size_t length, unsigned* fields)
+    {
+        std::size_t pos = 0;
+
+        if (!parseDateFields(value, length, pos, fields[0], fields[1], fields[2]))
+        {
+            return false;
+        }
+
+        fields[3] = fields[4] = fields[5] = fields[6] = 0;
+
+        if (pos < length)
+        {
+            if ((value[pos] != ' ' && value[pos] != 'T') || !parseTimeFields(value, length, ++pos, fields[3], fields[4], fields[5], fields[6]))
+            {
+                return false;
+            }
+
+            if (pos < length && value[pos] == 'Z')
+            {
+                ++pos;
+            }
+        }
+
+        return pos == length;
+    }
+}
+
+namespace kinetica
+{
+    void trimBlanks(const char*& value, std::size_t& length)
+    {
+        while (length > 0 && (value[0] == ' ' || value[0] == '\t'))
+        {
+            ++value;
+            --length;
+        }
+
+        while (length > 0 && (value[length - 1] == ' ' || value[length - 1] == '\t'))
+        {
+            --length;
+        }
+    }
+
+    bool parseUnsigned(const char* value, const std::size_t length, uint64_t& result)
+    {
+        std::size_t start = length > 0 && value[0] == '+' ? 1 : 0;
+        return parseMagnitude(value + start, length - start, result);
+    }
+
+    bool parseSigned(const char* value, const std::size_t length, const int64_t min, const int64_t max, int64_t& result)
+    {
+        bool negative = length > 0 && value[0] == '-';
+        std::size_t start = length > 0 && (value[0] == '-' || value[0] == '+') ? 1 : 0;
+        uint64_t magnitude;
+
+        if (!parseMagnitude(value + start, length - start, magnitude))
+        {
+            return false;
+        }
+
+        if (negative)
+        {
+            if (magnitude > (uint64_t)max + 1 || (magnitude > 0 && -(int64_t)(magnitude - 1) - 1 < min))
+            {
+                return false;
+            }
+
+            result = magnitude == 0 ? 0 : -(int64_t)(magnitude - 1) - 1;
+        }
+        else
+        {
+            if (magnitude > (uint64_t)max)
+            {
+                return false;
+            }
+
+            result = (int64_t)magnitude;
+        }
+
+        return true;
+    }
+
+    bool parseDouble(const char* value, const std::size_t length, double& result)
+    {
+        std::size_t i = 0;
+        bool negative = false;
+
+        if (i < length && (value[i] == '-' || value[i] == '+'))
+        {
+            negative = value[i] == '-';
+            ++i;
+        }
+
+        uint64_t mantissa = 0;
+        std::size_t digits = 0;
+        int exponent = 0;
+
+        for (; i < length && isDigit(value[i]); ++i, ++digits)
+        {
+            mantissa = mantissa * 10 + (value[i] - '0');
+        }
+
+        if (i < length && value[i] == '.')
+        {
+            ++i;
+
+            for (; i < length && isDigit(value[i]); ++i, ++digits, --exponent)
+            {
+                mantissa = mantissa * 10 + (value[i] - '0');
+            }
+        }
+
+        if (digits == 0 || digits > 19)
+        {
+            return parseDoubleSlow(value, length, result);
+        }
+
+        if (i < length && (value[i] == 'e' || value[i] == 'E'))
+        {
+            int64_t explicitExponent;
+
+            if (!parseSigned(value + i + 1, length - i - 1, -100000, 100000, explicitExponent))
+            {
+                return false;
+            }
+
+            exponent += (int)explicitExponent;
+            i = length;
+        }
+
+        if (i != length)
+        {
+            return false;
+        }
+
+        // Exact when both the mantissa and the power of 10 are exactly
+        // representable as doubles
+        if (mantissa > ((uint64_t)1 << 53) || exponent < -22 || exponent > 22)
+        {
+            return parseDoubleSlow(value, length, result);
+        }
+
+        double magnitude = (double)mantissa;
+        magnitude = exponent < 0 ? magnitude / POWERS_OF_10[-exponent] : magnitude * POWERS_OF_10[exponent];
+        result = negative ? -magnitude : magnitude;
+        return true;
+    }
+
+    bool parseBoolean(const char* value, const std::size_t length, int8_t& result)
+    {
+        if (length == 1 && (value[0] == '0' || value[0] == '1'))
+        {
+            result = value[0] - '0';
+            return true;
+        }
+
+        if (length == 4 && strncasecmp(value, "true", 4) == 0)
+        {
+            result = 1;
+            return true;
+        }
+
+        if (length == 5 && strncasecmp(value, "false", 5) == 0)
+        {
+            result = 0;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool parseDate(const char* value, const std::size_t length, Date& result)
+    {
+        std::size_t pos = 0;
+        unsigned year, month, day;
+
+        if (!parseDateFields(value, length, pos, year, month, day) || pos != length)
+        {
+            return false;
+        }
+
+        result = Date(year, month, day);
+        return true;
+    }
+
+    bool parseDateTime(const char* value, const std::size_t length, DateTime& result)
+    {
+        unsigned fields[7];
+
+        if (!parseDateTimeFields(value, length, fields))
+        {
+            return false;
+        }
+
+        result = DateTime(fields[0], fields[1], fields[2], fields[3], fields[4], fields[5], fields[6]);
+        return true;
+    }
+
+    bool parseTime(const char* value, const std::size_t length, Time& result)
+    {
+        std::size_t pos = 0;
+        unsigned hour, minute, second, millisecond;
+
+        if (!parseTimeFields(value, length, pos, hour, minute, second, millisecond) || pos != length)
+        {
+            return false;
+        }
+
+        result = Time(hour, minute, second, millisecond);
+        return true;
+    }
+
+    bool parseTimestamp(const char* value, const std::size_t length, int64_t& result)
+    {
+        if (length > 4 && value[4] == '-')
+        {
+            unsigned fields[7];
+
+            if (!parseDateTimeFields(value, length, fields))
+            {
+                return false;
+            }
+
+            result = getEpochDay(fields[0], fields[1], fields[2]) * 86400000
+                     + ((int64_t)fields[3] * 3600 + fields[4] * 60 + fields[5]) * 1000 + fields[6];
+            return true;
+        }
+
+        return parseSigned(value, length, -9223372036854775807LL - 1, 9223372036854775807LL, result);
+    }
+
+    bool parseIPv4(const char* value, const std::size_t length, uint32_t& result)
+    {
+        std::size_t pos = 0;
+        result = 0;
+
+        for (unsigned i = 0; i < 4; ++i)
+        {
+            unsigned octet;
+
+            if ((i > 0 && (pos >= length || value[pos++] != '.'))
+                || !parseField(value, length, pos, 3, octet) || octet > 255)
+            {
+                return false;
+            }
+
+            result = (result << 8) | octet;
+        }
+
+        return pos == length;
+    }
+
+    bool parseUUID(const char* value, const std::size_t length, UUID& result)
+    {
+        if (length != 32 && length != 36)
+        {
+            return false;
+        }
+
+        std::size_t pos = 0;
+
+        for (std::size_t i = 0; i < 16; ++i)
+        {
+            if (length == 36 && (i == 4 || i == 6 || i == 8 || i == 10) && value[pos++] != '-')
+            {
+                return false;
+            }
+
+            int high = getHexValue(value[pos++]);
+            int low = getHexValue(value[pos++]);
+
+            if (high < 0 || low < 0)
+            {
+                return false;
+            }
+
+            result[i] = (uint8_t)((high << 4) | low);
+        }
+
+        return true;
+    }
+}
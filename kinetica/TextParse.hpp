@@ -0,0 +1,71 @@
+#ifndef _KINETICA_TEXT_PARSE_HPP_
+#define _KINETICA_TEXT_PARSE_HPP_
+
+#include "Proc.hpp"
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace kinetica
+{
+    // Parsing of column values from text, shared by CsvReader, Cast and
+    // Expression so that they accept the same text. Each parser takes the
+    // whole of length characters, with no surrounding blanks, and returns
+    // false (leaving result unspecified) if they are not a valid value.
+
+    inline bool isDigit(const char value)
+    {
+        return (unsigned)(value - '0') < 10;
+    }
+
+    // Value of a hexadecimal digit, or -1
+    inline int getHexValue(const char value)
+    {
+        if (isDigit(value))
+        {
+            return value - '0';
+        }
+
+        char lower = value | 0x20;
+        return lower >= 'a' && lower <= 'f' ? lower - 'a' + 10 : -1;
+    }
+
+    // Removes leading and trailing spaces and tabs, for callers that accept
+    // padded text
+    void trimBlanks(const char*& value, std::size_t& length);
+
+    // Decimal digits with an optional leading +
+    bool parseUnsigned(const char* value, const std::size_t length, uint64_t& result);
+
+    // Decimal digits with an optional leading + or -, within min and max
+    bool parseSigned(const char* value, const std::size_t length, const int64_t min, const int64_t max, int64_t& result);
+
+    // Exact for up to 19 significant digits with exponents up to 22 in
+    // magnitude; other text (including inf and nan) is read by strtod
+    bool parseDouble(const char* value, const std::size_t length, double& result);
+
+    // 0, 1, true or false, ignoring case
+    bool parseBoolean(const char* value, const std::size_t length, int8_t& result);
+
+    // YYYY-M-D, with a year from 1000 to 2900
+    bool parseDate(const char* value, const std::size_t length, Date& result);
+
+    // A date optionally followed by a space or T and a time, and an optional
+    // Z
+    bool parseDateTime(const char* value, const std::size_t length, DateTime& result);
+
+    // H:M, optionally followed by :S and a fraction, of which precision
+    // beyond milliseconds is truncated
+    bool parseTime(const char* value, const std::size_t length, Time& result);
+
+    // A date and time as for parseDateTime, or epoch milliseconds
+    bool parseTimestamp(const char* value, const std::size_t length, int64_t& result);
+
+    // Dotted quad
+    bool parseIPv4(const char* value, const std::size_t length, uint32_t& result);
+
+    // 32 hexadecimal digits, with or without hyphens in the standard places
+    bool parseUUID(const char* value, const std::size_t length, UUID& result);
+}
+
+#endif
@@ -0,0 +1,555 @@
+#include "VectorSearch.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    typedef kinetica::ProcData::Column Column;
+    typedef kinetica::VectorSearch VectorSearch;
+    typedef kinetica::VectorSearch::Match Match;
+
+    // Columns below this size are searched in a single chunk; each row is
+    // compared with every query, so chunks are worth splitting sooner than
+    // for scans
+    const std::size_t MIN_PARALLEL_SEARCH_SIZE = 4096;
+
+    std::size_t getElementSize(const VectorSearch::ElementType type)
+    {
+        switch (type)
+        {
+            case VectorSearch::FLOAT16: return 2;
+            case VectorSearch::INT8: return 1;
+            default: return 4;
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Kernels
+    //--------------------------------------------------------------------------
+
+    // Kernels for AVX-512 and AVX2 with FMA are compiled whatever the target
+    // flags and chosen by the running CPU, so a portable build still uses
+    // them
+    #if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define KINETICA_VECTOR_DISPATCH
+    #endif
+
+    float dotScalar(const float* a, const float* b, const std::size_t n)
+    {
+        // Eight independent sums, which the compiler can keep in vectors
+        float sums[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+        std::size_t i = 0;
+
+        for (; i + 8 <= n; i += 8)
+        {
+            for (std::size_t j = 0; j < 8; ++j)
+            {
+                sums[j] += a[i + j] * b[i + j];
+            }
+        }
+
+        float result = ((sums[0] + sums[1]) + (sums[2] + sums[3])) + ((sums[4] + sums[5]) + (sums[6] + sums[7]));
+
+        for (; i < n; ++i)
+        {
+            result += a[i] * b[i];
+        }
+
+        return result;
+    }
+
+    float squaredDistanceScalar(const float* a, const float* b, const std::size_t n)
+    {
+        float sums[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+        std::size_t i = 0;
+
+        for (; i + 8 <= n; i += 8)
+        {
+            for (std::size_t j = 0; j < 8; ++j)
+            {
+                float difference = a[i + j] - b[i + j];
+                sums[j] += difference * difference;
+            }
+        }
+
+        float result = ((sums[0] + sums[1]) + (sums[2] + sums[3])) + ((sums[4] + sums[5]) + (sums[6] + sums[7]));
+
+        for (; i < n; ++i)
+        {
+            float difference = a[i] - b[i];
+            result += difference * difference;
+        }
+
+        return result;
+    }
+
+    inline float halfToFloat(const uint16_t value)
+    {
+        uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+        uint32_t exponent = (value >> 10) & 0x1f;
+        uint32_t mantissa = value & 0x3ff;
+        uint32_t bits;
+
+        if (exponent == 0x1f)
+        {
+            bits = sign | 0x7f800000 | (mantissa << 13);
+        }
+        else if (exponent != 0)
+        {
+            bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+        }
+        else
+        {
+            // Zero or subnormal, mantissa * 2^-24
+            float result = (float)mantissa * (1.0f / 16777216.0f);
+            return sign != 0 ? -result : result;
+        }
+
+        float result;
+        std::memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    void halvesToFloatsScalar(const uint8_t* values, const std::size_t n, float* result)
+    {
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            uint16_t half;
+            std::memcpy(&half, values + i * 2, sizeof(half));
+            result[i] = halfToFloat(half);
+        }
+    }
+
+    #ifdef KINETICA_VECTOR_DISPATCH
+    __attribute__((target("avx2,fma")))
+    inline float sumLanes(const __m256 sum)
+    {
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+        return _mm_cvtss_f32(half);
+    }
+
+    __attribute__((target("avx2,fma")))
+    float dotAvx2(const float* a, const float* b, const std::size_t n)
+    {
+        __m256 sum0 = _mm256_setzero_ps();
+        __m256 sum1 = _mm256_setzero_ps();
+        std::size_t i = 0;
+
+        for (; i + 16 <= n; i += 16)
+        {
+            sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum0);
+            sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), sum1);
+        }
+
+        float result = sumLanes(_mm256_add_ps(sum0, sum1));
+
+        for (; i < n; ++i)
+        {
+            result += a[i] * b[i];
+        }
+
+        return result;
+    }
+
+    __attribute__((target("avx2,fma")))
+    float squaredDistanceAvx2(const float* a, const float* b, const std::size_t n)
+    {
+        __m256 sum0 = _mm256_setzero_ps();
+        __m256 sum1 = _mm256_setzero_ps();
+        std::size_t i = 0;
+
+        for (; i + 16 <= n; i += 16)
+        {
+            __m256 difference0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+            __m256 difference1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+            sum0 = _mm256_fmadd_ps(difference0, difference0, sum0);
+            sum1 = _mm256_fmadd_ps(difference1, difference1, sum1);
+        }
+
+        float result = sumLanes(_mm256_add_ps(sum0, sum1));
+
+        for (; i < n; ++i)
+        {
+            float difference = a[i] - b[i];
+            result += difference * difference;
+        }
+
+        return result;
+    }
+
+    // Sums the lanes through memory; _mm512_reduce_add_ps and the 512-bit
+    // extracts build on _mm512_undefined_ps, which GCC flags with
+    // -Wuninitialized
+    __attribute__((target("avx512f")))
+    inline float sumLanes(const __m512 sum)
+    {
+        float lanes[16];
+        _mm512_storeu_ps(lanes, sum);
+
+        for (std::size_t i = 0; i < 8; ++i)
+        {
+            lanes[i] += lanes[i + 8];
+        }
+
+        return ((lanes[0] + lanes[4]) + (lanes[1] + lanes[5])) + ((lanes[2] + lanes[6]) + (lanes[3] + lanes[7]));
+    }
+
+    __attribute__((target("avx512f")))
+    float dotAvx512(const float* a, const float* b, const std::size_t n)
+    {
+        __m512 sum = _mm512_setzero_ps();
+        std::size_t i = 0;
+
+        for (; i + 16 <= n; i += 16)
+        {
+            sum = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), sum);
+        }
+
+        if (i < n)
+        {
+            __mmask16 mask = (__mmask16)((1u << (n - i)) - 1);
+            sum = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i), sum);
+        }
+
+        return sumLanes(sum);
+    }
+
+    __attribute__((target("avx512f")))
+    float squaredDistanceAvx512(const float* a, const float* b, const std::size_t n)
+    {
+        __m512 sum = _mm512_setzero_ps();
+        std::size_t i = 0;
+
+        for (; i + 16 <= n; i += 16)
+        {
+            __m512 difference = _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+            sum = _mm512_fmadd_ps(difference, difference, sum);
+        }
+
+        if (i < n)
+        {
+            __mmask16 mask = (__mmask16)((1u << (n - i)) - 1);
+            __m512 difference = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i));
+            sum = _mm512_fmadd_ps(difference, difference, sum);
+        }
+
+        return sumLanes(sum);
+    }
+
+    __attribute__((target("avx,f16c")))
+    void halvesToFloatsF16c(const uint8_t* values, const std::size_t n, float* result)
+    {
+        std::size_t i = 0;
+
+        for (; i + 8 <= n; i += 8)
+        {
+            _mm256_storeu_ps(result + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(values + i * 2))));
+        }
+
+        halvesToFloatsScalar(values + i * 2, n - i, result + i);
+    }
+    #endif
+
+    struct Kernels
+    {
+        float (*dot)(const float* a, const float* b, const std::size_t n);
+        float (*squaredDistance)(const float* a, const float* b, const std::size_t n);
+        void (*halvesToFloats)(const uint8_t* values, const std::size_t n, float* result);
+    };
+
+    Kernels getKernels()
+    {
+        Kernels kernels;
+        kernels.dot = dotScalar;
+        kernels.squaredDistance = squaredDistanceScalar;
+        kernels.halvesToFloats = halvesToFloatsScalar;
+
+        #ifdef KINETICA_VECTOR_DISPATCH
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx512f"))
+        {
+            kernels.dot = dotAvx512;
+            kernels.squaredDistance = squaredDistanceAvx512;
+        }
+        else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        {
+            kernels.dot = dotAvx2;
+            kernels.squaredDistance = squaredDistanceAvx2;
+        }
+
+        if (__builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c"))
+        {
+            kernels.halvesToFloats = halvesToFloatsF16c;
+        }
+        #endif
+
+        return kernels;
+    }
+
+    // Chosen once, at load time
+    const Kernels KERNELS = getKernels();
+
+    inline float dot(const float* a, const float* b, const std::size_t n)
+    {
+        return KERNELS.dot(a, b, n);
+    }
+
+    inline float squaredDistance(const float* a, const float* b, const std::size_t n)
+    {
+        return KERNELS.squaredDistance(a, b, n);
+    }
+
+    // Returns the elements of a value as floats, in place if it is suitably
+    // aligned FLOAT32 and otherwise widened or copied into buffer
+    const float* getFloats(const uint8_t* value, const VectorSearch::ElementType type, const float scale,
+                           const std::size_t n, float* buffer)
+    {
+        switch (type)
+        {
+            case VectorSearch::INT8:
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    buffer[i] = (float)(int8_t)value[i] * scale;
+                }
+
+                return buffer;
+
+            case VectorSearch::FLOAT16:
+                KERNELS.halvesToFloats(value, n, buffer);
+                return buffer;
+
+            default:
+                if (((uintptr_t)value & (sizeof(float) - 1)) == 0)
+                {
+                    return (const float*)value;
+                }
+
+                std::memcpy(buffer, value, n * sizeof(float));
+                return buffer;
+        }
+    }
+
+    inline float getDistance(const VectorSearch::Metric metric, const float* value, const float* query, const std::size_t n,
+                             const float valueNorm, const float queryNorm)
+    {
+        switch (metric)
+        {
+            case VectorSearch::L2:
+                return squaredDistance(value, query, n);
+
+            case VectorSearch::COSINE:
+            {
+                float norms = valueNorm * queryNorm;
+                return norms == 0 ? 1 : 1 - dot(value, query, n) / norms;
+            }
+
+            default:
+                return -dot(value, query, n);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Top-k
+    //--------------------------------------------------------------------------
+
+    inline bool isNearer(const Match& a, const Match& b)
+    {
+        return a.distance < b.distance || (a.distance == b.distance && a.row < b.row);
+    }
+
+    // Keeps the k nearest matches in a heap with the farthest on top
+    inline void addMatch(std::vector<Match>& heap, const std::size_t k, const Match& match)
+    {
+        if (heap.size() < k)
+        {
+            heap.push_back(match);
+            std::push_heap(heap.begin(), heap.end(), isNearer);
+        }
+        else if (isNearer(match, heap.front()))
+        {
+            std::pop_heap(heap.begin(), heap.end(), isNearer);
+            heap.back() = match;
+            std::push_heap(heap.begin(), heap.end(), isNearer);
+        }
+    }
+
+    class SearchTask : public kinetica::ParallelTask
+    {
+    public:
+        // Heaps of each chunk for each query
+        std::vector<std::vector<Match> > heaps;
+
+        SearchTask(const Column& column, const std::size_t dimension, const VectorSearch::ElementType type,
+                   const VectorSearch::Metric metric, const float scale, const float* queries, const std::size_t queryCount,
+                   const std::size_t k, const std::size_t chunkCount) :
+            heaps(chunkCount * queryCount),
+            m_column(column),
+            m_dimension(dimension),
+            m_type(type),
+            m_metric(metric),
+            m_scale(scale),
+            m_queries(queries),
+            m_queryCount(queryCount),
+            m_queryNorms(queryCount),
+            m_k(k),
+            m_chunkCount(chunkCount)
+        {
+            for (std::size_t i = 0; i < queryCount; ++i)
+            {
+                const float* query = queries + i * dimension;
+                m_queryNorms[i] = metric == VectorSearch::COSINE ? std::sqrt(dot(query, query, dimension)) : 0;
+            }
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            std::size_t start = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index);
+            std::size_t end = kinetica::getRangeStart(m_column.getSize(), m_chunkCount, index + 1);
+            const uint8_t* nulls = m_column.isNullable() ? m_column.getNulls() : NULL;
+            std::size_t size = m_dimension * getElementSize(m_type);
+            std::vector<float> buffer(m_dimension);
+            std::vector<Match>* heaps = &this->heaps[index * m_queryCount];
+
+            for (std::size_t row = start; row < end; ++row)
+            {
+                if (nulls != NULL && nulls[row])
+                {
+                    continue;
+                }
+
+                if (m_column.getVarValueSize<uint8_t>(row) != size)
+                {
+                    std::ostringstream message;
+                    message << "Row " << row << " of column " << m_column.getName() << " is not a vector of "
+                            << m_dimension << " elements";
+                    throw std::runtime_error(message.str());
+                }
+
+                const float* value = getFloats(m_column.getVarValue<uint8_t>(row), m_type, m_scale, m_dimension, &buffer[0]);
+                float valueNorm = m_metric == VectorSearch::COSINE ? std::sqrt(dot(value, value, m_dimension)) : 0;
+                Match match;
+                match.row = row;
+
+                for (std::size_t i = 0; i < m_queryCount; ++i)
+                {
+                    match.distance = getDistance(m_metric, value, m_queries + i * m_dimension, m_dimension, valueNorm, m_queryNorms[i]);
+
+                    if (match.distance == match.distance)
+                    {
+                        addMatch(heaps[i], m_k, match);
+                    }
+                }
+            }
+        }
+
+    private:
+        const Column& m_column;
+        std::size_t m_dimension;
+        VectorSearch::ElementType m_type;
+        VectorSearch::Metric m_metric;
+        float m_scale;
+        const float* m_queries;
+        std::size_t m_queryCount;
+        std::vector<float> m_queryNorms;
+        std::size_t m_k;
+        std::size_t m_chunkCount;
+    };
+}
+
+namespace kinetica
+{
+    VectorSearch::VectorSearch(const std::size_t dimension, const ElementType type, const Metric metric, const float scale) :
+        m_dimension(dimension),
+        m_type(type),
+        m_metric(metric),
+        m_scale(scale)
+    {
+        if (dimension == 0)
+        {
+            throw std::invalid_argument("Vector dimension must be at least 1");
+        }
+    }
+
+    std::size_t VectorSearch::getDimension() const
+    {
+        return m_dimension;
+    }
+
+    float VectorSearch::getDistance(const void* value, const float* query) const
+    {
+        std::vector<float> buffer(m_dimension);
+        const float* values = getFloats((const uint8_t*)value, m_type, m_scale, m_dimension, &buffer[0]);
+        bool isCosine = m_metric == COSINE;
+        float valueNorm = isCosine ? std::sqrt(dot(values, values, m_dimension)) : 0;
+        float queryNorm = isCosine ? std::sqrt(dot(query, query, m_dimension)) : 0;
+        return ::getDistance(m_metric, values, query, m_dimension, valueNorm, queryNorm);
+    }
+
+    void VectorSearch::findNearest(const ProcData::Column& column, const float* queries, const std::size_t queryCount,
+                                   const std::size_t k, std::vector<std::vector<Match> >& results,
+                                   const std::size_t threadCount) const
+    {
+        if (column.getType() != ProcData::Column::BYTES)
+        {
+            throw std::invalid_argument("Column " + column.getName() + " must be BYTES");
+        }
+
+        results.assign(queryCount, std::vector<Match>());
+
+        if (queryCount == 0 || k == 0)
+        {
+            return;
+        }
+
+        std::size_t threads = threadCount == 0 ? getHardwareThreadCount() : threadCount;
+        std::size_t chunkCount = column.getSize() >= MIN_PARALLEL_SEARCH_SIZE && threads > 1 ? threads * 4 : 1;
+        SearchTask searchTask(column, m_dimension, m_type, m_metric, m_scale, queries, queryCount, k, chunkCount);
+        runParallel(searchTask, chunkCount, threadCount);
+
+        for (std::size_t i = 0; i < queryCount; ++i)
+        {
+            std::vector<Match>& result = results[i];
+
+            for (std::size_t j = 0; j < chunkCount; ++j)
+            {
+                const std::vector<Match>& heap = searchTask.heaps[j * queryCount + i];
+                result.insert(result.end(), heap.begin(), heap.end());
+            }
+
+            std::sort(result.begin(), result.end(), isNearer);
+            result.resize(std::min(result.size(), k));
+        }
+    }
+
+    void VectorSearch::findNearest(const ProcData::Column& column, const std::vector<uint8_t>& queries, const std::size_t k,
+                                   std::vector<std::vector<Match> >& results, const std::size_t threadCount) const
+    {
+        std::size_t size = m_dimension * sizeof(float);
+
+        if (queries.size() % size != 0)
+        {
+            throw std::invalid_argument("Query vectors must be a multiple of the vector size");
+        }
+
+        std::vector<float> values(queries.size() / sizeof(float));
+
+        if (!queries.empty())
+        {
+            std::memcpy(&values[0], &queries[0], queries.size());
+        }
+
+        findNearest(column, values.empty() ? NULL : &values[0], queries.size() / size, k, results, threadCount);
+    }
+}
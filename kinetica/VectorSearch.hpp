@@ -0,0 +1,79 @@
+#ifndef _KINETICA_VECTOR_SEARCH_HPP_
+#define _KINETICA_VECTOR_SEARCH_HPP_
+
+#include "Proc.hpp"
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace kinetica
+{
+    // Brute-force nearest neighbour search over embedding vectors stored in
+    // BYTES columns, each value holding dimension elements packed in host
+    // byte order. Values are read in place from the var data and compared
+    // with every query in turn, with AVX-512 or AVX2 and FMA kernels chosen
+    // at run time by the CPU. INT8 and FLOAT16 rows are widened to float
+    // once per row and then scored as FLOAT32, so they save storage but not
+    // scoring work. Each part of the column keeps its own top-k heaps,
+    // merged at the end.
+    class VectorSearch
+    {
+    public:
+        enum ElementType
+        {
+            FLOAT32,
+            FLOAT16,
+            INT8
+        };
+
+        // Distances are smaller for nearer vectors: the squared Euclidean
+        // distance, 1 - cosine similarity, or the negated inner product
+        enum Metric
+        {
+            L2,
+            COSINE,
+            INNER_PRODUCT
+        };
+
+        struct Match
+        {
+            std::size_t row;
+            float distance;
+        };
+
+        // INT8 elements are multiplied by scale. Throws std::invalid_argument
+        // if dimension is 0.
+        VectorSearch(const std::size_t dimension, const ElementType type = FLOAT32, const Metric metric = L2,
+                     const float scale = 1);
+
+        std::size_t getDimension() const;
+
+        // Distance between a value (dimension elements) and a query
+        float getDistance(const void* value, const float* query) const;
+
+        // Sets results[i] to the k rows nearest to query i, nearest first
+        // and ties in row order, for queryCount queries of dimension floats.
+        // Null rows and NaN distances are skipped. Parts of the column are
+        // searched in parallel. Throws std::invalid_argument if the column is
+        // not BYTES, and std::runtime_error if a value is not dimension
+        // elements long.
+        void findNearest(const ProcData::Column& column, const float* queries, const std::size_t queryCount,
+                         const std::size_t k, std::vector<std::vector<Match> >& results,
+                         const std::size_t threadCount = 0) const;
+
+        // As above, with queries packed as float32 values (e.g. from
+        // ProcData::getBinParams). Throws std::invalid_argument if they are
+        // not a whole number of vectors.
+        void findNearest(const ProcData::Column& column, const std::vector<uint8_t>& queries, const std::size_t k,
+                         std::vector<std::vector<Match> >& results, const std::size_t threadCount = 0) const;
+
+    private:
+        std::size_t m_dimension;
+        ElementType m_type;
+        Metric m_metric;
+        float m_scale;
+    };
+}
+
+#endif
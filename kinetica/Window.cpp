@@ -0,0 +1,948 @@
+#include "Window.hpp"
+#include "Decimal.hpp"
+#include "Numeric.hpp"
+#include "Parallel.hpp"
+#include "Temporal.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+    typedef kinetica::ProcData::Column Column;
+    typedef kinetica::ProcData::OutputColumn OutputColumn;
+    typedef kinetica::WindowFunction WindowFunction;
+
+    const int64_t MAX_OFFSET = WindowFunction::UNBOUNDED;
+    const int64_t MIN_OFFSET = -MAX_OFFSET - 1;
+
+    // Flags of rows in sorted order
+    const uint8_t PEER_START = 1;
+    const uint8_t PARTITION_START = 2;
+
+    //--------------------------------------------------------------------------
+    // Keys
+    //--------------------------------------------------------------------------
+
+    // Compares values of two rows as sortRows orders them
+    bool equals(const Column& column, const std::size_t a, const std::size_t b)
+    {
+        if (column.isNullable())
+        {
+            bool isNull = column.getNulls()[a] != 0;
+
+            if (isNull != (column.getNulls()[b] != 0))
+            {
+                return false;
+            }
+            else if (isNull)
+            {
+                return true;
+            }
+        }
+
+        switch (column.getType())
+        {
+            case Column::BYTES:
+            case Column::STRING:
+            {
+                std::size_t size = column.getVarValueSize<uint8_t>(a);
+                return size == column.getVarValueSize<uint8_t>(b)
+                       && std::memcmp(column.getVarValue<uint8_t>(a), column.getVarValue<uint8_t>(b), size) == 0;
+            }
+
+            case Column::DATE: return kinetica::getSortKey(column.getValue<kinetica::Date>(a)) == kinetica::getSortKey(column.getValue<kinetica::Date>(b));
+            case Column::DATETIME: return kinetica::getSortKey(column.getValue<kinetica::DateTime>(a)) == kinetica::getSortKey(column.getValue<kinetica::DateTime>(b));
+            case Column::TIME: return kinetica::getSortKey(column.getValue<kinetica::Time>(a)) == kinetica::getSortKey(column.getValue<kinetica::Time>(b));
+            case Column::DOUBLE: return kinetica::getSortKey(column.getValue<double>(a)) == kinetica::getSortKey(column.getValue<double>(b));
+            case Column::FLOAT: return kinetica::getSortKey(column.getValue<float>(a)) == kinetica::getSortKey(column.getValue<float>(b));
+
+            default:
+            {
+                std::size_t size = Column::getTypeSize(column.getType());
+                const uint8_t* data = column.getData<uint8_t>();
+                return std::memcmp(data + a * size, data + b * size, size) == 0;
+            }
+        }
+    }
+
+    // Types whose sort keys order all values exactly
+    bool isOrdered(const Column::ColumnType type)
+    {
+        switch (type)
+        {
+            case Column::CHAR1:
+            case Column::CHAR2:
+            case Column::CHAR4:
+            case Column::CHAR8:
+            case Column::DATE:
+            case Column::DATETIME:
+            case Column::IPV4:
+            case Column::TIME: return true;
+            default: return kinetica::isNumeric(type);
+        }
+    }
+
+    bool isRangeType(const Column::ColumnType type)
+    {
+        switch (type)
+        {
+            case Column::DATE:
+            case Column::DATETIME:
+            case Column::DECIMAL:
+            case Column::INT:
+            case Column::INT8:
+            case Column::INT16:
+            case Column::LONG:
+            case Column::TIMESTAMP: return true;
+            default: return false;
+        }
+    }
+
+    inline int64_t addOffset(const int64_t value, const int64_t offset)
+    {
+        if (offset > 0 ? value > MAX_OFFSET - offset : value < MIN_OFFSET - offset)
+        {
+            return offset > 0 ? MAX_OFFSET : MIN_OFFSET;
+        }
+
+        return value + offset;
+    }
+
+    //--------------------------------------------------------------------------
+    // Functions
+    //--------------------------------------------------------------------------
+
+    enum Accumulator
+    {
+        INTEGER,
+        UNSIGNED,
+        REAL
+    };
+
+    struct FunctionInfo
+    {
+        WindowFunction function;
+
+        // NULL for COUNT of all rows and for ranks
+        const Column* column;
+
+        Accumulator accumulator;
+
+        FunctionInfo(const WindowFunction& function) :
+            function(function),
+            column(NULL),
+            accumulator(INTEGER)
+        {
+        }
+    };
+
+    // Results by input row: ranks, counts and sums, non-null value counts,
+    // and the rows whose values LAG, LEAD, MIN and MAX write. Sums with the
+    // UNSIGNED accumulator are stored in integers as uint64_t.
+    struct FunctionState
+    {
+        std::vector<int64_t> integers;
+        std::vector<double> reals;
+        std::vector<int64_t> counts;
+        std::vector<std::size_t> rows;
+    };
+
+    struct WindowContext
+    {
+        const Column* rangeColumn;
+        bool isDescending;
+        std::vector<FunctionInfo> functions;
+        std::vector<FunctionState> states;
+
+        // Rows in sorted order, with their flags
+        std::vector<std::size_t> rows;
+        std::vector<uint8_t> flags;
+
+        // Order key values of RANGE frames, by input row
+        std::vector<int64_t> rangeValues;
+
+        std::size_t chunkCount;
+    };
+
+    // Scratch space of a task, sized for one partition
+    struct Frames
+    {
+        std::vector<std::size_t> starts;
+        std::vector<std::size_t> ends;
+        std::vector<uint64_t> keys;
+        std::vector<std::size_t> queue;
+        std::vector<int64_t> values;
+    };
+
+    // Computes the frame [starts[i], ends[i]) of each row of a partition of
+    // count rows; both bounds never decrease
+    void getRowFrames(const FunctionInfo& info, const std::size_t count, Frames& frames)
+    {
+        const WindowFunction& function = info.function;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            int64_t start = function.preceding == MAX_OFFSET ? 0 : addOffset((int64_t)i, -function.preceding);
+            int64_t end = function.following == MAX_OFFSET ? (int64_t)count : addOffset(addOffset((int64_t)i, function.following), 1);
+            start = std::min(std::max(start, (int64_t)0), (int64_t)count);
+            end = std::min(std::max(end, start), (int64_t)count);
+            frames.starts[i] = (std::size_t)start;
+            frames.ends[i] = (std::size_t)end;
+        }
+    }
+
+    // As above for RANGE frames, over a segment of rows whose order keys are
+    // all null or all non-null
+    void getRangeFrames(const FunctionInfo& info, const std::vector<int64_t>& values, const bool isNull,
+                        const std::size_t start, const std::size_t end, Frames& frames)
+    {
+        if (isNull)
+        {
+            std::fill(frames.starts.begin() + start, frames.starts.begin() + end, start);
+            std::fill(frames.ends.begin() + start, frames.ends.begin() + end, end);
+            return;
+        }
+
+        const WindowFunction& function = info.function;
+        std::size_t low = start;
+        std::size_t high = start;
+
+        for (std::size_t i = start; i < end; ++i)
+        {
+            if (function.preceding == MAX_OFFSET)
+            {
+                low = start;
+            }
+            else
+            {
+                int64_t min = addOffset(values[i], -function.preceding);
+
+                while (low < end && values[low] < min)
+                {
+                    ++low;
+                }
+            }
+
+            if (function.following == MAX_OFFSET)
+            {
+                high = end;
+            }
+            else
+            {
+                int64_t max = addOffset(values[i], function.following);
+
+                while (high < end && values[high] <= max)
+                {
+                    ++high;
+                }
+            }
+
+            frames.starts[i] = low;
+            frames.ends[i] = std::max(low, high);
+        }
+    }
+
+    void getFrames(const WindowContext& context, const FunctionInfo& info, const std::size_t* rows,
+                   const std::size_t count, Frames& frames)
+    {
+        if (info.function.frame == WindowFunction::ROWS)
+        {
+            getRowFrames(info, count, frames);
+            return;
+        }
+
+        // Sorted order puts null order keys first, or last when descending;
+        // descending values are complemented so that they ascend
+        const uint8_t* nulls = context.rangeColumn->isNullable() ? context.rangeColumn->getNulls() : NULL;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            int64_t value = context.rangeValues[rows[i]];
+            frames.values[i] = context.isDescending ? ~value : value;
+        }
+
+        std::size_t start = 0;
+
+        while (start < count)
+        {
+            bool isNull = nulls != NULL && nulls[rows[start]];
+            std::size_t end = start + 1;
+
+            while (end < count && (nulls != NULL && nulls[rows[end]]) == isNull)
+            {
+                ++end;
+            }
+
+            getRangeFrames(info, frames.values, isNull, start, end, frames);
+            start = end;
+        }
+    }
+
+    template<typename A, typename T>
+    inline A load(const T& value) { return (A)value; }
+
+    // Slides a frame along a partition, adding the values that enter it and
+    // subtracting those that leave
+    template<typename T, typename A>
+    void slideSums(const FunctionInfo& info, const std::size_t* rows, const std::size_t count, const Frames& frames,
+                   A* sums, int64_t* counts)
+    {
+        const T* data = info.column == NULL ? NULL : info.column->getData<T>();
+        const uint8_t* nulls = info.column != NULL && info.column->isNullable() ? info.column->getNulls() : NULL;
+        bool isCount = info.function.function == WindowFunction::COUNT;
+        A sum = 0;
+        int64_t valueCount = 0;
+        std::size_t low = 0;
+        std::size_t high = 0;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            while (low < frames.starts[i] && low < high)
+            {
+                std::size_t row = rows[low++];
+
+                if (nulls == NULL || !nulls[row])
+                {
+                    sum = isCount ? sum : kinetica::subtract(sum, load<A>(data[row]));
+                    --valueCount;
+                }
+            }
+
+            if (low < frames.starts[i])
+            {
+                low = high = frames.starts[i];
+            }
+
+            while (high < frames.ends[i])
+            {
+                std::size_t row = rows[high++];
+
+                if (nulls == NULL || !nulls[row])
+                {
+                    sum = isCount ? sum : kinetica::add(sum, load<A>(data[row]));
+                    ++valueCount;
+                }
+            }
+
+            // Keeps floating-point error from outliving the values
+            if (valueCount == 0)
+            {
+                sum = 0;
+            }
+
+            sums[rows[i]] = isCount ? (A)valueCount : sum;
+            counts[rows[i]] = valueCount;
+        }
+    }
+
+    void slideSums(const FunctionInfo& info, const std::size_t* rows, const std::size_t count, const Frames& frames,
+                   FunctionState& state)
+    {
+        int64_t* integers = state.integers.empty() ? NULL : &state.integers[0];
+        uint64_t* unsignedIntegers = (uint64_t*)integers;
+        double* reals = state.reals.empty() ? NULL : &state.reals[0];
+        int64_t* counts = &state.counts[0];
+
+        // Counts need no values, so columns of any type can be counted
+        if (info.function.function == WindowFunction::COUNT)
+        {
+            slideSums<uint8_t>(info, rows, count, frames, integers, counts);
+            return;
+        }
+
+        switch (info.column->getType())
+        {
+            case Column::BOOLEAN:
+            case Column::INT8: slideSums<int8_t>(info, rows, count, frames, integers, counts); break;
+            case Column::DECIMAL:
+            case Column::LONG:
+            case Column::TIMESTAMP: slideSums<int64_t>(info, rows, count, frames, integers, counts); break;
+            case Column::DOUBLE: slideSums<double>(info, rows, count, frames, reals, counts); break;
+            case Column::FLOAT: slideSums<float>(info, rows, count, frames, reals, counts); break;
+            case Column::INT: slideSums<int32_t>(info, rows, count, frames, integers, counts); break;
+            case Column::INT16: slideSums<int16_t>(info, rows, count, frames, integers, counts); break;
+            case Column::ULONG: slideSums<uint64_t>(info, rows, count, frames, unsignedIntegers, counts); break;
+            default: throw std::runtime_error("Invalid data type");
+        }
+    }
+
+    template<typename T>
+    void loadSortKeys(const Column& column, const std::size_t* rows, const std::size_t count, uint64_t* keys)
+    {
+        const T* data = column.getData<T>();
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            keys[i] = kinetica::getSortKey(data[rows[i]]);
+        }
+    }
+
+    void loadSortKeys(const Column& column, const std::size_t* rows, const std::size_t count, uint64_t* keys)
+    {
+        switch (column.getType())
+        {
+            case Column::BOOLEAN:
+            case Column::INT8: loadSortKeys<int8_t>(column, rows, count, keys); break;
+            case Column::CHAR1: loadSortKeys<kinetica::CharN<1> >(column, rows, count, keys); break;
+            case Column::CHAR2: loadSortKeys<kinetica::CharN<2> >(column, rows, count, keys); break;
+            case Column::CHAR4: loadSortKeys<kinetica::CharN<4> >(column, rows, count, keys); break;
+            case Column::CHAR8: loadSortKeys<kinetica::CharN<8> >(column, rows, count, keys); break;
+            case Column::DATE: loadSortKeys<kinetica::Date>(column, rows, count, keys); break;
+            case Column::DATETIME: loadSortKeys<kinetica::DateTime>(column, rows, count, keys); break;
+            case Column::DECIMAL:
+            case Column::LONG:
+            case Column::TIMESTAMP: loadSortKeys<int64_t>(column, rows, count, keys); break;
+            case Column::DOUBLE: loadSortKeys<double>(column, rows, count, keys); break;
+            case Column::FLOAT: loadSortKeys<float>(column, rows, count, keys); break;
+            case Column::INT: loadSortKeys<int32_t>(column, rows, count, keys); break;
+            case Column::INT16: loadSortKeys<int16_t>(column, rows, count, keys); break;
+            case Column::IPV4: loadSortKeys<uint32_t>(column, rows, count, keys); break;
+            case Column::TIME: loadSortKeys<kinetica::Time>(column, rows, count, keys); break;
+            case Column::ULONG: loadSortKeys<uint64_t>(column, rows, count, keys); break;
+            default: throw std::runtime_error("Invalid data type");
+        }
+    }
+
+    // Slides a frame along a partition, keeping a queue of the rows that may
+    // still become its minimum (or maximum) in order of position, so that
+    // the first one is the current minimum
+    void slideExtremes(const FunctionInfo& info, const std::size_t* rows, const std::size_t count, Frames& frames,
+                       std::size_t* results)
+    {
+        const uint8_t* nulls = info.column->isNullable() ? info.column->getNulls() : NULL;
+        bool isMin = info.function.function == WindowFunction::MIN;
+        uint64_t* keys = &frames.keys[0];
+        std::size_t* queue = &frames.queue[0];
+        std::size_t head = 0;
+        std::size_t tail = 0;
+        std::size_t low = 0;
+        std::size_t high = 0;
+        loadSortKeys(*info.column, rows, count, keys);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            low = std::max(low, frames.starts[i]);
+            high = std::max(high, low);
+
+            while (head < tail && queue[head] < low)
+            {
+                ++head;
+            }
+
+            while (high < frames.ends[i])
+            {
+                if (nulls == NULL || !nulls[rows[high]])
+                {
+                    while (head < tail && (isMin ? keys[queue[tail - 1]] >= keys[high] : keys[queue[tail - 1]] <= keys[high]))
+                    {
+                        --tail;
+                    }
+
+                    queue[tail++] = high;
+                }
+
+                ++high;
+            }
+
+            results[rows[i]] = head < tail ? rows[queue[head]] : OutputColumn::NO_ROW;
+        }
+    }
+
+    void computeFunction(const WindowContext& context, const FunctionInfo& info, const std::size_t* rows,
+                         const uint8_t* flags, const std::size_t count, Frames& frames, FunctionState& state)
+    {
+        switch (info.function.function)
+        {
+            case WindowFunction::ROW_NUMBER:
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    state.integers[rows[i]] = (int64_t)i + 1;
+                }
+
+                break;
+
+            case WindowFunction::RANK:
+            {
+                std::size_t rank = 0;
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    rank = flags[i] ? i + 1 : rank;
+                    state.integers[rows[i]] = (int64_t)rank;
+                }
+
+                break;
+            }
+
+            case WindowFunction::DENSE_RANK:
+            {
+                std::size_t rank = 0;
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    rank += flags[i] ? 1 : 0;
+                    state.integers[rows[i]] = (int64_t)rank;
+                }
+
+                break;
+            }
+
+            case WindowFunction::LAG:
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    state.rows[rows[i]] = i >= info.function.offset ? rows[i - info.function.offset] : OutputColumn::NO_ROW;
+                }
+
+                break;
+
+            case WindowFunction::LEAD:
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    state.rows[rows[i]] = count - i > info.function.offset ? rows[i + info.function.offset] : OutputColumn::NO_ROW;
+                }
+
+                break;
+
+            case WindowFunction::MIN:
+            case WindowFunction::MAX:
+                getFrames(context, info, rows, count, frames);
+                slideExtremes(info, rows, count, frames, &state.rows[0]);
+                break;
+
+            default:
+                getFrames(context, info, rows, count, frames);
+                slideSums(info, rows, count, frames, state);
+                break;
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Output
+    //--------------------------------------------------------------------------
+
+    // Decimal places of the sums of a function
+    unsigned getScale(const FunctionInfo& info)
+    {
+        bool isSum = info.function.function == WindowFunction::SUM || info.function.function == WindowFunction::AVG;
+        return isSum && info.column->getType() == Column::DECIMAL ? kinetica::DECIMAL_SCALE : 0;
+    }
+
+    void writeFunction(OutputColumn& column, const FunctionInfo& info, const FunctionState& state, const std::size_t size)
+    {
+        std::size_t index;
+
+        switch (info.function.function)
+        {
+            case WindowFunction::LAG:
+            case WindowFunction::LEAD:
+            case WindowFunction::MIN:
+            case WindowFunction::MAX:
+                column.appendRows(*info.column, &state.rows[0], size);
+                return;
+
+            case WindowFunction::SUM:
+                if (info.accumulator == REAL)
+                {
+                    index = kinetica::appendNumbers(column, &state.reals[0], size);
+                }
+                else if (info.accumulator == UNSIGNED)
+                {
+                    index = kinetica::appendNumbers(column, (const uint64_t*)&state.integers[0], size);
+                }
+                else
+                {
+                    index = kinetica::appendNumbers(column, &state.integers[0], size, getScale(info));
+                }
+
+                break;
+
+            case WindowFunction::AVG:
+            {
+                std::vector<double> averages(size);
+
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    double sum = info.accumulator == REAL ? state.reals[i]
+                                 : (info.accumulator == UNSIGNED ? (double)(uint64_t)state.integers[i] : (double)state.integers[i]);
+                    averages[i] = state.counts[i] == 0 ? 0 : sum / state.counts[i];
+                }
+
+                index = kinetica::appendNumbers(column, &averages[0], size, getScale(info));
+                break;
+            }
+
+            default:
+                kinetica::appendNumbers(column, &state.integers[0], size);
+                return;
+        }
+
+        if (column.isNullable())
+        {
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                if (state.counts[i] == 0)
+                {
+                    column.setNull(index + i);
+                }
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    // Tasks
+    //--------------------------------------------------------------------------
+
+    // Flags the first row of each partition and of each group of peers with
+    // equal order keys
+    class FlagTask : public kinetica::ParallelTask
+    {
+    public:
+        FlagTask(WindowContext& context, const std::vector<const Column*>& partitionKeys,
+                 const std::vector<const Column*>& orderKeys) :
+            m_context(context),
+            m_partitionKeys(partitionKeys),
+            m_orderKeys(orderKeys)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            const std::size_t* rows = &m_context.rows[0];
+            uint8_t* flags = &m_context.flags[0];
+            std::size_t start = kinetica::getRangeStart(m_context.rows.size(), m_context.chunkCount, index);
+            std::size_t end = kinetica::getRangeStart(m_context.rows.size(), m_context.chunkCount, index + 1);
+
+            for (std::size_t i = start; i < end; ++i)
+            {
+                if (i == 0 || !isEqual(m_partitionKeys, rows[i - 1], rows[i]))
+                {
+                    flags[i] = PARTITION_START | PEER_START;
+                }
+                else
+                {
+                    flags[i] = isEqual(m_orderKeys, rows[i - 1], rows[i]) ? 0 : PEER_START;
+                }
+            }
+        }
+
+    private:
+        WindowContext& m_context;
+        const std::vector<const Column*>& m_partitionKeys;
+        const std::vector<const Column*>& m_orderKeys;
+
+        static bool isEqual(const std::vector<const Column*>& keys, const std::size_t a, const std::size_t b)
+        {
+            for (std::size_t i = 0; i < keys.size(); ++i)
+            {
+                if (!equals(*keys[i], a, b))
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+    };
+
+    // Loads the order key values of RANGE frames
+    class RangeTask : public kinetica::ParallelTask
+    {
+    public:
+        RangeTask(WindowContext& context) :
+            m_context(context)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            const Column& column = *m_context.rangeColumn;
+            std::size_t start = kinetica::getRangeStart(column.getSize(), m_context.chunkCount, index);
+            std::size_t count = kinetica::getRangeStart(column.getSize(), m_context.chunkCount, index + 1) - start;
+            int64_t* values = &m_context.rangeValues[start];
+
+            switch (column.getType())
+            {
+                case Column::DATE: kinetica::toEpochDays(column.getData<kinetica::Date>() + start, count, values); break;
+                case Column::DATETIME: kinetica::toEpochMilliseconds(column.getData<kinetica::DateTime>() + start, count, values); break;
+                case Column::DECIMAL:
+                case Column::LONG:
+                case Column::TIMESTAMP: std::memcpy(values, column.getData<int64_t>() + start, count * sizeof(int64_t)); break;
+                case Column::INT: load(column.getData<int32_t>() + start, count, values); break;
+                case Column::INT8: load(column.getData<int8_t>() + start, count, values); break;
+                case Column::INT16: load(column.getData<int16_t>() + start, count, values); break;
+                default: throw std::runtime_error("Invalid data type");
+            }
+        }
+
+    private:
+        WindowContext& m_context;
+
+        template<typename T>
+        static void load(const T* data, const std::size_t count, int64_t* values)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                values[i] = data[i];
+            }
+        }
+    };
+
+    // Computes the functions over the partitions that start in a chunk of
+    // the sorted rows
+    class WindowTask : public kinetica::ParallelTask
+    {
+    public:
+        WindowTask(WindowContext& context) :
+            m_context(context)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            std::size_t size = m_context.rows.size();
+            std::size_t start = findPartition(kinetica::getRangeStart(size, m_context.chunkCount, index));
+            std::size_t end = findPartition(kinetica::getRangeStart(size, m_context.chunkCount, index + 1));
+            Frames frames;
+
+            while (start < end)
+            {
+                std::size_t next = findPartition(start + 1);
+                std::size_t count = next - start;
+
+                if (frames.starts.size() < count)
+                {
+                    frames.starts.resize(count);
+                    frames.ends.resize(count);
+                    frames.keys.resize(count);
+                    frames.queue.resize(count);
+                    frames.values.resize(count);
+                }
+
+                for (std::size_t i = 0; i < m_context.functions.size(); ++i)
+                {
+                    computeFunction(m_context, m_context.functions[i], &m_context.rows[start], &m_context.flags[start],
+                                    count, frames, m_context.states[i]);
+                }
+
+                start = next;
+            }
+        }
+
+    private:
+        WindowContext& m_context;
+
+        std::size_t findPartition(std::size_t position) const
+        {
+            while (position < m_context.rows.size() && !(m_context.flags[position] & PARTITION_START))
+            {
+                ++position;
+            }
+
+            return position;
+        }
+    };
+
+    class WriteTask : public kinetica::ParallelTask
+    {
+    public:
+        WriteTask(const WindowContext& context, kinetica::ProcData::OutputTable& result) :
+            m_context(context),
+            m_result(result)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            writeFunction(m_result.getColumn(index), m_context.functions[index], m_context.states[index], m_context.rows.size());
+        }
+
+    private:
+        const WindowContext& m_context;
+        kinetica::ProcData::OutputTable& m_result;
+    };
+}
+
+namespace kinetica
+{
+    const std::size_t WindowFunction::ALL_ROWS;
+    const int64_t WindowFunction::UNBOUNDED;
+
+    WindowFunction::WindowFunction(const Function function, const std::size_t column) :
+        function(function),
+        column(column),
+        frame(ROWS),
+        preceding(UNBOUNDED),
+        following(0),
+        offset(1)
+    {
+    }
+
+    std::size_t computeWindows(const ProcData::InputTable& input, const std::vector<std::size_t>& partitionKeys,
+                               const std::vector<SortKey>& orderKeys, const std::vector<WindowFunction>& functions,
+                               ProcData::OutputTable& result, std::size_t threadCount)
+    {
+        if (result.getColumnCount() != functions.size())
+        {
+            throw std::invalid_argument("Output table " + result.getName() + " must have one column per window function");
+        }
+
+        WindowContext context;
+        context.rangeColumn = NULL;
+        context.isDescending = false;
+
+        for (std::size_t i = 0; i < functions.size(); ++i)
+        {
+            const WindowFunction& function = functions[i];
+            const OutputColumn& output = result.getColumn(i);
+            FunctionInfo info(function);
+            info.column = function.column == WindowFunction::ALL_ROWS ? NULL : &input.getColumn(function.column);
+            bool isAggregate = function.function >= WindowFunction::COUNT;
+            bool isRank = function.function <= WindowFunction::DENSE_RANK;
+
+            if (info.column == NULL && !isRank && function.function != WindowFunction::COUNT)
+            {
+                throw std::invalid_argument("Only ranks and COUNT can be computed over all rows");
+            }
+
+            if (isRank)
+            {
+                info.column = NULL;
+            }
+
+            if (info.column != NULL)
+            {
+                Column::ColumnType type = info.column->getType();
+                info.accumulator = type == Column::DOUBLE || type == Column::FLOAT ? REAL : (type == Column::ULONG ? UNSIGNED : INTEGER);
+
+                if ((function.function == WindowFunction::SUM || function.function == WindowFunction::AVG) && !kinetica::isNumeric(type))
+                {
+                    throw std::invalid_argument("Column " + info.column->getName() + " is not numeric");
+                }
+
+                if ((function.function == WindowFunction::MIN || function.function == WindowFunction::MAX) && !isOrdered(type))
+                {
+                    throw std::invalid_argument("Column " + info.column->getName() + " is not ordered");
+                }
+            }
+
+            if (function.function == WindowFunction::LAG || function.function == WindowFunction::LEAD
+                || function.function == WindowFunction::MIN || function.function == WindowFunction::MAX)
+            {
+                if (output.getType() != info.column->getType())
+                {
+                    throw std::invalid_argument("Output column " + output.getName() + " does not match column " + info.column->getName());
+                }
+            }
+            else if (!kinetica::isNumeric(output.getType()))
+            {
+                throw std::invalid_argument("Output column " + output.getName() + " is not numeric");
+            }
+
+            if (isAggregate)
+            {
+                if (function.preceding == MIN_OFFSET || function.following == MIN_OFFSET)
+                {
+                    throw std::invalid_argument("Invalid window frame offset");
+                }
+
+                if (function.frame == WindowFunction::RANGE)
+                {
+                    if (orderKeys.size() != 1 || !isRangeType(input.getColumn(orderKeys[0].column).getType()))
+                    {
+                        throw std::invalid_argument("RANGE frames need a single integer or temporal order key");
+                    }
+
+                    context.rangeColumn = &input.getColumn(orderKeys[0].column);
+                    context.isDescending = !orderKeys[0].ascending;
+                }
+            }
+
+            context.functions.push_back(info);
+        }
+
+        std::vector<SortKey> keys;
+        std::vector<const Column*> partitionColumns;
+        std::vector<const Column*> orderColumns;
+
+        for (std::size_t i = 0; i < partitionKeys.size(); ++i)
+        {
+            keys.push_back(SortKey(partitionKeys[i]));
+            partitionColumns.push_back(&input.getColumn(partitionKeys[i]));
+        }
+
+        for (std::size_t i = 0; i < orderKeys.size(); ++i)
+        {
+            keys.push_back(orderKeys[i]);
+            orderColumns.push_back(&input.getColumn(orderKeys[i].column));
+        }
+
+        std::size_t size = input.getSize();
+        std::size_t index = result.getSize();
+        result.setSize(index + size);
+
+        if (size == 0)
+        {
+            return index;
+        }
+
+        if (threadCount == 0)
+        {
+            threadCount = getHardwareThreadCount();
+        }
+
+        context.chunkCount = size >= kinetica::MIN_PARALLEL_SIZE && threadCount > 1 ? threadCount * 4 : 1;
+        sortRows(input, keys, context.rows, threadCount);
+        context.flags.resize(size);
+        FlagTask flagTask(context, partitionColumns, orderColumns);
+        runParallel(flagTask, context.chunkCount, threadCount);
+
+        if (context.rangeColumn != NULL)
+        {
+            context.rangeValues.resize(size);
+            RangeTask rangeTask(context);
+            runParallel(rangeTask, context.chunkCount, threadCount);
+        }
+
+        context.states.resize(functions.size());
+
+        for (std::size_t i = 0; i < functions.size(); ++i)
+        {
+            const FunctionInfo& info = context.functions[i];
+            FunctionState& state = context.states[i];
+
+            switch (info.function.function)
+            {
+                case WindowFunction::LAG:
+                case WindowFunction::LEAD:
+                case WindowFunction::MIN:
+                case WindowFunction::MAX:
+                    state.rows.resize(size);
+                    break;
+
+                case WindowFunction::SUM:
+                case WindowFunction::AVG:
+                    state.integers.resize(info.accumulator == REAL ? 0 : size);
+                    state.reals.resize(info.accumulator == REAL ? size : 0);
+                    state.counts.resize(size);
+                    break;
+
+                case WindowFunction::COUNT:
+                    state.integers.resize(size);
+                    state.counts.resize(size);
+                    break;
+
+                default:
+                    state.integers.resize(size);
+                    break;
+            }
+        }
+
+        WindowTask windowTask(context);
+        runParallel(windowTask, context.chunkCount, threadCount);
+        WriteTask writeTask(context, result);
+        runParallel(writeTask, functions.size(), threadCount);
+        return index;
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef _KINETICA_WINDOW_HPP_
+#define _KINETICA_WINDOW_HPP_
+
+#include "Proc.hpp"
+#include "Sort.hpp"
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+namespace kinetica
+{
+    struct WindowFunction
+    {
+        enum Function
+        {
+            ROW_NUMBER,
+            RANK,
+            DENSE_RANK,
+            LAG,
+            LEAD,
+            COUNT,
+            SUM,
+            MIN,
+            MAX,
+            AVG
+        };
+
+        enum Frame
+        {
+            // Offsets count rows
+            ROWS,
+
+            // Offsets are differences of the order key value: days for DATE,
+            // milliseconds for DATETIME and TIMESTAMP, and raw values for
+            // other integer types. Rows with equal order keys are peers with
+            // the same frame.
+            RANGE
+        };
+
+        // Column index for COUNT of all rows
+        static const std::size_t ALL_ROWS = (std::size_t)-1;
+
+        // Frame offset with no limit
+        static const int64_t UNBOUNDED = (int64_t)((uint64_t)-1 >> 1);
+
+        Function function;
+        std::size_t column;
+
+        // Frame of the aggregate functions, from preceding before to
+        // following after the current row; negative offsets move the bound
+        // the other way. Defaults to a running aggregate (ROWS from
+        // UNBOUNDED preceding to the current row).
+        Frame frame;
+        int64_t preceding;
+        int64_t following;
+
+        // Rows before (LAG) or after (LEAD) the current row, 1 by default
+        std::size_t offset;
+
+        WindowFunction(const Function function, const std::size_t column = ALL_ROWS);
+    };
+
+    // Computes window functions over the rows of input grouped by the
+    // partition key columns and ordered within each partition by the order
+    // keys (as sortRows does, with rows of equal keys in input order), and
+    // appends one row per input row to result, in input order, with one
+    // column per function. Partitions are processed in parallel and each
+    // result column is written in bulk. Returns the index of the first
+    // appended row.
+    //
+    // ROW_NUMBER, RANK, DENSE_RANK and COUNT may be written to any numeric
+    // column. SUM and AVG take numeric columns and may be written to any
+    // numeric column, with SUM accumulating and results converted as aggregate
+    // does. LAG, LEAD, MIN and MAX write values of their input column to a
+    // column of the same type; MIN and MAX accept numeric, DATE, DATETIME,
+    // TIME, IPV4 and CHAR1 to CHAR8 columns. Aggregates are updated
+    // incrementally as the frame slides, in constant amortized time per row,
+    // and ignore nulls. SUM and AVG are null (or 0, if the result column is not
+    // nullable) when the frame has no values; MIN, MAX, and LAG and LEAD past
+    // the partition bounds are null, and need a nullable result column if that
+    // can occur. RANGE frames need a single order key of an integer, DATE,
+    // DATETIME or TIMESTAMP column; rows with a null order key have a frame of
+    // all such rows in their partition.
+    std::size_t computeWindows(const ProcData::InputTable& input, const std::vector<std::size_t>& partitionKeys,
+                               const std::vector<SortKey>& orderKeys, const std::vector<WindowFunction>& functions,
+                               ProcData::OutputTable& result, const std::size_t threadCount = 0);
+}
+
+#endif
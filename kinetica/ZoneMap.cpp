@@ -0,0 +1,378 @@
+#include "ZoneMap.hpp"
+#include "Hash.hpp"
+#include "Parallel.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    typedef kinetica::ProcData::Column Column;
+
+    // Blocks per parallel chunk
+    const std::size_t CHUNK_BLOCK_COUNT = 16;
+
+    const char SIDECAR_MAGIC[8] = { 'K', 'Z', 'O', 'N', 'E', 'M', 'A', 'P' };
+    // Version 2: TIME keys drop the 4 unused low bits
+    const uint64_t SIDECAR_VERSION = 2;
+
+    //--------------------------------------------------------------------------
+    // Blocks
+    //--------------------------------------------------------------------------
+
+    template<typename T>
+    void scanBlock(const Column& column, const std::size_t start, const std::size_t end,
+                   uint64_t& min, uint64_t& max, std::size_t& nullCount)
+    {
+        const T* values = column.getData<T>();
+        const uint8_t* nulls = column.isNullable() ? column.getNulls() : NULL;
+        min = (uint64_t)-1;
+        max = 0;
+        nullCount = 0;
+
+        for (std::size_t i = start; i < end; ++i)
+        {
+            if (nulls != NULL && nulls[i])
+            {
+                ++nullCount;
+                continue;
+            }
+
+            uint64_t key = kinetica::getSortKey(values[i]);
+            min = key < min ? key : min;
+            max = key > max ? key : max;
+        }
+
+        // Blocks of only nulls have an empty range
+        if (nullCount == end - start)
+        {
+            min = (uint64_t)-1;
+            max = 0;
+        }
+    }
+
+    void scanBlock(const Column& column, const std::size_t start, const std::size_t end,
+                   uint64_t& min, uint64_t& max, std::size_t& nullCount)
+    {
+        switch (column.getType())
+        {
+            case Column::BOOLEAN:
+            case Column::INT8: scanBlock<int8_t>(column, start, end, min, max, nullCount); break;
+            case Column::CHAR1: scanBlock<kinetica::CharN<1> >(column, start, end, min, max, nullCount); break;
+            case Column::CHAR2: scanBlock<kinetica::CharN<2> >(column, start, end, min, max, nullCount); break;
+            case Column::CHAR4: scanBlock<kinetica::CharN<4> >(column, start, end, min, max, nullCount); break;
+            case Column::CHAR8: scanBlock<kinetica::CharN<8> >(column, start, end, min, max, nullCount); break;
+            case Column::CHAR16: scanBlock<kinetica::CharN<16> >(column, start, end, min, max, nullCount); break;
+            case Column::CHAR32: scanBlock<kinetica::CharN<32> >(column, start, end, min, max, nullCount); break;
+            case Column::CHAR64: scanBlock<kinetica::CharN<64> >(column, start, end, min, max, nullCount); break;
+            case Column::CHAR128: scanBlock<kinetica::CharN<128> >(column, start, end, min, max, nullCount); break;
+            case Column::CHAR256: scanBlock<kinetica::CharN<256> >(column, start, end, min, max, nullCount); break;
+            case Column::DATE: scanBlock<kinetica::Date>(column, start, end, min, max, nullCount); break;
+            case Column::DATETIME: scanBlock<kinetica::DateTime>(column, start, end, min, max, nullCount); break;
+            case Column::DECIMAL:
+            case Column::LONG:
+            case Column::TIMESTAMP: scanBlock<int64_t>(column, start, end, min, max, nullCount); break;
+            case Column::DOUBLE: scanBlock<double>(column, start, end, min, max, nullCount); break;
+            case Column::FLOAT: scanBlock<float>(column, start, end, min, max, nullCount); break;
+            case Column::INT: scanBlock<int32_t>(column, start, end, min, max, nullCount); break;
+            case Column::INT16: scanBlock<int16_t>(column, start, end, min, max, nullCount); break;
+            case Column::IPV4: scanBlock<uint32_t>(column, start, end, min, max, nullCount); break;
+            case Column::TIME: scanBlock<kinetica::Time>(column, start, end, min, max, nullCount); break;
+            case Column::ULONG: scanBlock<uint64_t>(column, start, end, min, max, nullCount); break;
+            case Column::UUID: scanBlock<kinetica::UUID>(column, start, end, min, max, nullCount); break;
+            default: throw std::invalid_argument("Column " + column.getName() + " is not fixed-width");
+        }
+    }
+
+    class BlockTask : public kinetica::ParallelTask
+    {
+    public:
+        BlockTask(const Column& column, const std::size_t blockSize, uint64_t* mins, uint64_t* maxes, std::size_t* nullCounts) :
+            m_column(column),
+            m_blockSize(blockSize),
+            m_mins(mins),
+            m_maxes(maxes),
+            m_nullCounts(nullCounts)
+        {
+        }
+
+        virtual void run(const std::size_t index)
+        {
+            std::size_t blockCount = (m_column.getSize() + m_blockSize - 1) / m_blockSize;
+            std::size_t end = std::min((index + 1) * CHUNK_BLOCK_COUNT, blockCount);
+
+            for (std::size_t block = index * CHUNK_BLOCK_COUNT; block < end; ++block)
+            {
+                std::size_t start = block * m_blockSize;
+                scanBlock(m_column, start, std::min(start + m_blockSize, m_column.getSize()),
+                          m_mins[block], m_maxes[block], m_nullCounts[block]);
+            }
+        }
+
+    private:
+        const Column& m_column;
+        std::size_t m_blockSize;
+        uint64_t* m_mins;
+        uint64_t* m_maxes;
+        std::size_t* m_nullCounts;
+    };
+
+    //--------------------------------------------------------------------------
+    // Sidecar files
+    //--------------------------------------------------------------------------
+
+    // Identity of a column's data file; the sidecar is stale if any differ
+    struct FileInfo
+    {
+        uint64_t type;
+        uint64_t size;
+        uint64_t modifiedSeconds;
+        uint64_t modifiedNanoseconds;
+        uint64_t blockSize;
+        uint64_t blockCount;
+    };
+
+    void getFileInfo(const Column& column, const std::size_t blockSize, FileInfo& info)
+    {
+        struct stat st;
+
+        if (column.getDataPath().empty() || stat(column.getDataPath().c_str(), &st) != 0)
+        {
+            throw std::runtime_error("Could not get status of data file for column " + column.getName());
+        }
+
+        info.type = column.getType();
+        info.size = st.st_size;
+        info.modifiedSeconds = st.st_mtim.tv_sec;
+        info.modifiedNanoseconds = st.st_mtim.tv_nsec;
+        info.blockSize = blockSize;
+        info.blockCount = (column.getSize() + blockSize - 1) / blockSize;
+    }
+
+    std::string getSidecarPath(const std::string& directory, const Column& column)
+    {
+        char name[32];
+        const std::string& path = column.getDataPath();
+        std::sprintf(name, "/%016llx.zonemap", (unsigned long long)kinetica::hashBytes(path.data(), path.size()));
+        return directory + name;
+    }
+
+    bool readFully(FILE* file, void* data, const std::size_t size)
+    {
+        return size == 0 || std::fread(data, size, 1, file) == 1;
+    }
+
+    void writeFully(FILE* file, const void* data, const std::size_t size, const std::string& path)
+    {
+        if (size > 0 && std::fwrite(data, size, 1, file) != 1)
+        {
+            std::string error = std::strerror(errno);
+            std::fclose(file);
+            std::remove(path.c_str());
+            throw std::runtime_error("Could not write zone map file " + path + ": " + error);
+        }
+    }
+}
+
+namespace kinetica
+{
+    const std::size_t ZoneMap::DEFAULT_BLOCK_SIZE;
+
+    ZoneMap::ZoneMap() :
+        m_column(NULL),
+        m_blockSize(DEFAULT_BLOCK_SIZE)
+    {
+    }
+
+    void ZoneMap::build(const ProcData::Column& column, const std::size_t blockSize, const std::size_t threadCount)
+    {
+        if (blockSize == 0)
+        {
+            throw std::invalid_argument("Zone map block size must be positive");
+        }
+
+        std::size_t blockCount = (column.getSize() + blockSize - 1) / blockSize;
+        m_column = &column;
+        m_blockSize = blockSize;
+        m_mins.resize(blockCount);
+        m_maxes.resize(blockCount);
+        m_nullCounts.resize(blockCount);
+
+        if (blockCount > 0)
+        {
+            BlockTask blockTask(column, blockSize, &m_mins[0], &m_maxes[0], &m_nullCounts[0]);
+            runParallel(blockTask, (blockCount + CHUNK_BLOCK_COUNT - 1) / CHUNK_BLOCK_COUNT, threadCount);
+        }
+    }
+
+    bool ZoneMap::build(const ProcData::Column& column, const std::string& directory, const std::size_t blockSize,
+                        const std::size_t threadCount)
+    {
+        if (load(column, directory, blockSize))
+        {
+            return true;
+        }
+
+        build(column, blockSize, threadCount);
+        save(directory);
+        return false;
+    }
+
+    bool ZoneMap::load(const ProcData::Column& column, const std::string& directory, const std::size_t blockSize)
+    {
+        if (blockSize == 0)
+        {
+            throw std::invalid_argument("Zone map block size must be positive");
+        }
+
+        FileInfo info;
+        getFileInfo(column, blockSize, info);
+        FILE* file = std::fopen(getSidecarPath(directory, column).c_str(), "rb");
+
+        if (file == NULL)
+        {
+            return false;
+        }
+
+        char magic[sizeof(SIDECAR_MAGIC)];
+        uint64_t version;
+        uint64_t pathSize;
+        FileInfo fileInfo;
+        std::string path;
+        bool isValid = readFully(file, magic, sizeof(magic))
+                       && std::memcmp(magic, SIDECAR_MAGIC, sizeof(magic)) == 0
+                       && readFully(file, &version, 8) && version == SIDECAR_VERSION
+                       && readFully(file, &pathSize, 8) && pathSize == column.getDataPath().size();
+
+        if (isValid)
+        {
+            path.resize(pathSize);
+            isValid = readFully(file, &path[0], pathSize) && path == column.getDataPath()
+                      && readFully(file, &fileInfo, sizeof(fileInfo))
+                      && std::memcmp(&fileInfo, &info, sizeof(info)) == 0;
+        }
+
+        if (isValid)
+        {
+            std::size_t blockCount = (std::size_t)info.blockCount;
+            m_mins.resize(blockCount);
+            m_maxes.resize(blockCount);
+            m_nullCounts.resize(blockCount);
+            std::vector<uint64_t> nullCounts(blockCount);
+            isValid = blockCount == 0
+                      || (readFully(file, &m_mins[0], blockCount * 8)
+                          && readFully(file, &m_maxes[0], blockCount * 8)
+                          && readFully(file, &nullCounts[0], blockCount * 8));
+
+            for (std::size_t i = 0; i < blockCount; ++i)
+            {
+                m_nullCounts[i] = (std::size_t)nullCounts[i];
+            }
+        }
+
+        std::fclose(file);
+
+        if (!isValid)
+        {
+            m_column = NULL;
+            m_mins.clear();
+            m_maxes.clear();
+            m_nullCounts.clear();
+            return false;
+        }
+
+        m_column = &column;
+        m_blockSize = blockSize;
+        return true;
+    }
+
+    void ZoneMap::save(const std::string& directory) const
+    {
+        const ProcData::Column& column = getColumn();
+        FileInfo info;
+        getFileInfo(column, m_blockSize, info);
+
+        // Written under a temporary name and renamed into place, so that
+        // concurrent readers never see a partial file
+        std::string path = getSidecarPath(directory, column);
+        std::string tempPath = path + ".XXXXXX";
+        std::vector<char> buffer(tempPath.begin(), tempPath.end());
+        buffer.push_back(0);
+        int fd = mkstemp(&buffer[0]);
+
+        if (fd == -1)
+        {
+            throw std::runtime_error("Could not create zone map file " + path + ": " + std::string(std::strerror(errno)));
+        }
+
+        // mkstemp creates files readable only by their owner
+        tempPath = &buffer[0];
+        fchmod(fd, 0644);
+        FILE* file = fdopen(fd, "wb");
+
+        if (file == NULL)
+        {
+            close(fd);
+            std::remove(tempPath.c_str());
+            throw std::runtime_error("Could not create zone map file " + path + ": " + std::string(std::strerror(errno)));
+        }
+
+        uint64_t pathSize = column.getDataPath().size();
+        std::vector<uint64_t> nullCounts(m_nullCounts.begin(), m_nullCounts.end());
+        writeFully(file, SIDECAR_MAGIC, sizeof(SIDECAR_MAGIC), tempPath);
+        writeFully(file, &SIDECAR_VERSION, 8, tempPath);
+        writeFully(file, &pathSize, 8, tempPath);
+        writeFully(file, column.getDataPath().data(), pathSize, tempPath);
+        writeFully(file, &info, sizeof(info), tempPath);
+
+        if (!m_mins.empty())
+        {
+            writeFully(file, &m_mins[0], m_mins.size() * 8, tempPath);
+            writeFully(file, &m_maxes[0], m_maxes.size() * 8, tempPath);
+            writeFully(file, &nullCounts[0], nullCounts.size() * 8, tempPath);
+        }
+
+        if (std::fclose(file) != 0 || std::rename(tempPath.c_str(), path.c_str()) != 0)
+        {
+            std::string error = std::strerror(errno);
+            std::remove(tempPath.c_str());
+            throw std::runtime_error("Could not write zone map file " + path + ": " + error);
+        }
+    }
+
+    const ProcData::Column& ZoneMap::getColumn() const
+    {
+        if (m_column == NULL)
+        {
+            throw std::logic_error("Zone map has not been built");
+        }
+
+        return *m_column;
+    }
+
+    std::size_t ZoneMap::getBlockSize() const
+    {
+        return m_blockSize;
+    }
+
+    std::size_t ZoneMap::getBlockCount() const
+    {
+        return m_mins.size();
+    }
+
+    void ZoneMap::findBlocks(const uint64_t min, const uint64_t max, std::vector<std::size_t>& blocks) const
+    {
+        for (std::size_t i = 0; i < m_mins.size(); ++i)
+        {
+            if (m_mins[i] <= max && min <= m_maxes[i])
+            {
+                blocks.push_back(i);
+            }
+        }
+    }
+}
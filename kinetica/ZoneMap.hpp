@@ -0,0 +1,124 @@
+#ifndef _KINETICA_ZONE_MAP_HPP_
+#define _KINETICA_ZONE_MAP_HPP_
+
+#include "Proc.hpp"
+#include "Sort.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace kinetica
+{
+    // Minimum and maximum value and null count of each block of rows of a
+    // fixed-width column, so that range filters can skip blocks that cannot
+    // match. Values are kept as sort keys (see getSortKey), so they follow
+    // the order of sortRows: dates and times chronologically, NaN last, and
+    // wide values by their most significant 8 bytes.
+    class ZoneMap
+    {
+    public:
+        static const std::size_t DEFAULT_BLOCK_SIZE = 8192;
+
+        ZoneMap();
+
+        // Computes the zone map of column, processing blocks in parallel
+        void build(const ProcData::Column& column, const std::size_t blockSize = DEFAULT_BLOCK_SIZE,
+                   const std::size_t threadCount = 0);
+
+        // As build, but first tries to load the zone map from a sidecar file
+        // in directory, which is written if it is missing or stale. Sidecar
+        // files are named after the column's data file path and store its
+        // size and modification time. Returns true if the zone map was
+        // loaded.
+        bool build(const ProcData::Column& column, const std::string& directory,
+                   const std::size_t blockSize = DEFAULT_BLOCK_SIZE, const std::size_t threadCount = 0);
+
+        // Loads the zone map of column from its sidecar file in directory,
+        // returning false if there is none for the column's current data
+        // file with the given block size
+        bool load(const ProcData::Column& column, const std::string& directory, const std::size_t blockSize = DEFAULT_BLOCK_SIZE);
+
+        // Writes the zone map to its sidecar file in directory
+        void save(const std::string& directory) const;
+
+        const ProcData::Column& getColumn() const;
+        std::size_t getBlockSize() const;
+        std::size_t getBlockCount() const;
+
+        // Sort keys of the smallest and largest non-null values of a block;
+        // the minimum is greater than the maximum if all values are null
+        uint64_t getMin(const std::size_t block) const
+        {
+            return m_mins[block];
+        }
+
+        uint64_t getMax(const std::size_t block) const
+        {
+            return m_maxes[block];
+        }
+
+        std::size_t getNullCount(const std::size_t block) const
+        {
+            return m_nullCounts[block];
+        }
+
+        // Appends the blocks that may hold non-null values with sort keys in
+        // [min, max]
+        void findBlocks(const uint64_t min, const uint64_t max, std::vector<std::size_t>& blocks) const;
+
+    private:
+        const ProcData::Column* m_column;
+        std::size_t m_blockSize;
+        std::vector<uint64_t> m_mins;
+        std::vector<uint64_t> m_maxes;
+        std::vector<std::size_t> m_nullCounts;
+    };
+
+    template<typename T>
+    void findBlocks(const ZoneMap& zoneMap, const T& min, const T& max, std::vector<std::size_t>& blocks)
+    {
+        zoneMap.findBlocks(getSortKey(min), getSortKey(max), blocks);
+    }
+
+    // Appends the rows, in order, whose non-null values are in [min, max],
+    // scanning only the blocks the zone map cannot rule out. T must be the
+    // column's value type and no wider than 8 bytes.
+    template<typename T>
+    void filterRange(const ZoneMap& zoneMap, const T& min, const T& max, std::vector<std::size_t>& rows)
+    {
+        const ProcData::Column& column = zoneMap.getColumn();
+        const T* values = column.getData<T>();
+        const uint8_t* nulls = column.isNullable() ? column.getNulls() : NULL;
+        uint64_t minKey = getSortKey(min);
+        uint64_t maxKey = getSortKey(max);
+        std::vector<std::size_t> blocks;
+        zoneMap.findBlocks(minKey, maxKey, blocks);
+
+        for (std::size_t i = 0; i < blocks.size(); ++i)
+        {
+            std::size_t start = blocks[i] * zoneMap.getBlockSize();
+            std::size_t end = std::min(start + zoneMap.getBlockSize(), column.getSize());
+            bool isContained = minKey <= zoneMap.getMin(blocks[i]) && zoneMap.getMax(blocks[i]) <= maxKey;
+
+            for (std::size_t row = start; row < end; ++row)
+            {
+                if (nulls != NULL && nulls[row])
+                {
+                    continue;
+                }
+
+                uint64_t key = getSortKey(values[row]);
+
+                if (isContained || (minKey <= key && key <= maxKey))
+                {
+                    rows.push_back(row);
+                }
+            }
+        }
+    }
+}
+
+#endif